@@ -0,0 +1,59 @@
+#!/bin/bash
+# Use this script to time the techtree validation with one and with several
+# faction jobs and to check both give the same report
+# ----------------------------------------------------------------------------
+# Copyright (c) 2018 ZetaGlest Team under GNU GPL v3.0+
+#
+# usage: mg_validation_benchmark.sh [binary] [techtree] [jobs] [runs]
+
+BINARY=${1:-./zetaglest}
+TECHTREE=${2:-zetapack}
+JOBS=${3:-$(getconf _NPROCESSORS_ONLN)}
+RUNS=${4:-3}
+
+WORKDIR=$(mktemp -d)
+trap 'rm -rf "$WORKDIR"' EXIT
+
+# runs the validation RUNS times with the given job count, prints the
+# fastest total_milliseconds of the reports
+run_validation() {
+	local jobs=$1
+	local best=''
+	for run in $(seq 1 "$RUNS"); do
+		local report="$WORKDIR/report_${jobs}_${run}.json"
+		"$BINARY" --validate-techtrees="$TECHTREE" --validation-jobs="$jobs" \
+			--validation-report="$report" > "$WORKDIR/output_${jobs}_${run}.log" 2>&1
+		if [ ! -f "$report" ]; then
+			echo "Validation with $jobs job(s) wrote no report, see $WORKDIR/output_${jobs}_${run}.log" >&2
+			trap - EXIT
+			exit 1
+		fi
+		local millis=$(grep -o '"total_milliseconds": [0-9]*' "$report" | grep -o '[0-9]*$')
+		if [ -z "$best" ] || [ "$millis" -lt "$best" ]; then
+			best=$millis
+		fi
+	done
+	echo "$best"
+}
+
+echo "Validating techtree [$TECHTREE] with [$BINARY], best of $RUNS run(s)..."
+
+SEQUENTIAL=$(run_validation 1) || exit 1
+echo "1 job: ${SEQUENTIAL} ms"
+PARALLEL=$(run_validation "$JOBS") || exit 1
+echo "$JOBS jobs: ${PARALLEL} ms"
+
+if [ "$PARALLEL" -gt 0 ]; then
+	echo "Speedup: $(awk "BEGIN { printf \"%.2f\", $SEQUENTIAL / $PARALLEL }")x"
+fi
+
+# timings and the job count are the only fields allowed to differ
+if diff <(grep -v 'milliseconds\|"jobs"' "$WORKDIR/report_1_1.json") \
+		<(grep -v 'milliseconds\|"jobs"' "$WORKDIR/report_${JOBS}_1.json") > /dev/null; then
+	echo 'Reports match.'
+else
+	echo 'Reports DIFFER between 1 and '"$JOBS"' jobs!'
+	diff <(grep -v 'milliseconds\|"jobs"' "$WORKDIR/report_1_1.json") \
+		<(grep -v 'milliseconds\|"jobs"' "$WORKDIR/report_${JOBS}_1.json")
+	exit 1
+fi
@@ -0,0 +1,157 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martiño Figueroa
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "flow_field.h"
+
+#include <queue>
+#include <functional>
+#include "leak_dumper.h"
+
+namespace Glest{ namespace Game{
+
+// =====================================================
+//	class FlowField
+// =====================================================
+
+FlowField::FlowField() {
+	field= fLand;
+	unitSize= 1;
+	teamIndex= 0;
+	dirty= true;
+	lastUsed= 0;
+}
+
+// reverse Dijkstra from the goals over the passable cells. Costs are
+// integers and neighbours are visited in a fixed order so every client
+// gets the same distances.
+void FlowField::computeDistances() {
+	int cellCount= size.x * size.y;
+	distance.assign(cellCount, -1);
+
+	std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int> >,
+		std::greater<std::pair<int, int> > > openList;
+	for(std::set<Vec2i>::const_iterator iterGoal = goals.begin(); iterGoal != goals.end(); ++iterGoal) {
+		if(isInside(*iterGoal) == true) {
+			int cellIndex= (iterGoal->y - origin.y) * size.x + iterGoal->x - origin.x;
+			if(distance[cellIndex] != 0) {
+				distance[cellIndex]= 0;
+				openList.push(std::make_pair(0, cellIndex));
+			}
+		}
+	}
+
+	while(openList.empty() == false) {
+		std::pair<int, int> current= openList.top();
+		openList.pop();
+		if(current.first > distance[current.second]) {
+			continue;
+		}
+		Vec2i pos= origin + Vec2i(current.second % size.x, current.second / size.x);
+		for(int i = -1; i <= 1; ++i) {
+			for(int j = -1; j <= 1; ++j) {
+				if(i == 0 && j == 0) {
+					continue;
+				}
+				Vec2i nextPos= pos + Vec2i(i, j);
+				if(isPassable(nextPos) == false) {
+					continue;
+				}
+				// no cutting corners of buildings or objects
+				if(i != 0 && j != 0 &&
+					(isPassable(Vec2i(pos.x + i, pos.y)) == false ||
+					 isPassable(Vec2i(pos.x, pos.y + j)) == false)) {
+					continue;
+				}
+				int nextIndex= (nextPos.y - origin.y) * size.x + nextPos.x - origin.x;
+				int nextDistance= current.first + (i != 0 && j != 0 ? diagonalCost : straightCost);
+				if(distance[nextIndex] < 0 || nextDistance < distance[nextIndex]) {
+					distance[nextIndex]= nextDistance;
+					openList.push(std::make_pair(nextDistance, nextIndex));
+				}
+			}
+		}
+	}
+}
+
+// whether a change of the size x size cells at pos can change the field.
+// Units standing up to their size before the field overlap it, diagonal
+// moves check one cell more.
+bool FlowField::touches(const Vec2i &pos, int size) const {
+	return pos.x + size >= origin.x - unitSize &&
+		pos.y + size >= origin.y - unitSize &&
+		pos.x <= origin.x + this->size.x &&
+		pos.y <= origin.y + this->size.y;
+}
+
+// =====================================================
+//	class FlowFieldCache
+// =====================================================
+
+FlowFieldCache::FlowFieldCache(int maxFlowFields) {
+	this->useCount= 0;
+	this->maxFlowFields= maxFlowFields;
+}
+
+FlowFieldCache::~FlowFieldCache() {
+	clear();
+}
+
+void FlowFieldCache::clear() {
+	for(FlowFieldMap::iterator iterMap = flowFields.begin(); iterMap != flowFields.end(); ++iterMap) {
+		delete iterMap->second;
+	}
+	flowFields.clear();
+}
+
+// the field stored under key, a new dirty one when there is none yet.
+// The caller rebuilds dirty fields before following them.
+FlowField *FlowFieldCache::getFlowField(const Key &key) {
+	useCount++;
+
+	FlowField *flowField= NULL;
+	FlowFieldMap::iterator iterFind= flowFields.find(key);
+	if(iterFind != flowFields.end()) {
+		flowField= iterFind->second;
+	}
+	else {
+		if((int)flowFields.size() >= maxFlowFields && flowFields.empty() == false) {
+			FlowFieldMap::iterator iterOldest= flowFields.begin();
+			for(FlowFieldMap::iterator iterMap = flowFields.begin(); iterMap != flowFields.end(); ++iterMap) {
+				if(iterMap->second->lastUsed < iterOldest->second->lastUsed) {
+					iterOldest= iterMap;
+				}
+			}
+			delete iterOldest->second;
+			flowFields.erase(iterOldest);
+		}
+
+		flowField= new FlowField();
+		flowFields[key]= flowField;
+	}
+
+	flowField->lastUsed= useCount;
+	return flowField;
+}
+
+// marks the fields of teamIndex (all teams when -1) touching the
+// size x size cells at pos dirty
+void FlowFieldCache::markDirty(const Vec2i &pos, int size, int teamIndex) {
+	for(FlowFieldMap::iterator iterMap = flowFields.begin(); iterMap != flowFields.end(); ++iterMap) {
+		FlowField *flowField= iterMap->second;
+		if(flowField->dirty == false &&
+			(teamIndex < 0 || flowField->teamIndex == teamIndex) &&
+			flowField->touches(pos, size) == true) {
+			flowField->dirty= true;
+		}
+	}
+}
+
+}}//end namespace
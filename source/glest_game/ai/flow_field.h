@@ -0,0 +1,116 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martiño Figueroa
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _GLEST_GAME_FLOWFIELD_H_
+#define _GLEST_GAME_FLOWFIELD_H_
+
+#include <vector>
+#include <map>
+#include <set>
+#include "vec.h"
+#include "data_types.h"
+#include "skill_type.h"
+#include "leak_dumper.h"
+
+using std::vector;
+using Shared::Graphics::Vec2i;
+using Shared::Platform::int64;
+
+namespace Glest{ namespace Game{
+
+// =====================================================
+//	class FlowField
+//
+/// Distances to the destinations of one group order, shared by the
+/// units of the order moving in the same field with the same size
+// =====================================================
+
+class FlowField {
+public:
+	static const int straightCost= 10;
+	static const int diagonalCost= 14;
+
+	Field field;
+	int unitSize;
+	int teamIndex;
+	Vec2i origin;
+	Vec2i size;
+	// destinations the field leads to, other targets use A*
+	std::set<Vec2i> goals;
+	vector<int> distance;
+	vector<bool> passable;
+	bool dirty;
+	int64 lastUsed;
+
+public:
+	FlowField();
+
+	inline bool isInside(const Vec2i &pos) const {
+		return pos.x >= origin.x && pos.y >= origin.y &&
+			pos.x < origin.x + size.x && pos.y < origin.y + size.y;
+	}
+	// -1 when pos is outside the field or can't reach a destination
+	inline int getDistance(const Vec2i &pos) const {
+		if(isInside(pos) == false) {
+			return -1;
+		}
+		return distance[(pos.y - origin.y) * size.x + pos.x - origin.x];
+	}
+	inline bool isPassable(const Vec2i &pos) const {
+		if(isInside(pos) == false) {
+			return false;
+		}
+		return passable[(pos.y - origin.y) * size.x + pos.x - origin.x];
+	}
+
+	void computeDistances();
+	bool touches(const Vec2i &pos, int size) const;
+};
+
+// =====================================================
+//	class FlowFieldCache
+//
+/// The flow fields of one faction, the one used longest ago is deleted
+/// when a new one does not fit
+// =====================================================
+
+class FlowFieldCache {
+public:
+	// command group id and unit size * fieldCount + field
+	typedef std::pair<int, int> Key;
+
+private:
+	typedef std::map<Key, FlowField *> FlowFieldMap;
+
+	FlowFieldMap flowFields;
+	int64 useCount;
+	int maxFlowFields;
+
+public:
+	explicit FlowFieldCache(int maxFlowFields);
+	~FlowFieldCache();
+
+	FlowField *getFlowField(const Key &key);
+	void markDirty(const Vec2i &pos, int size, int teamIndex);
+
+	bool empty() const				{return flowFields.empty();}
+	int getCount() const			{return (int)flowFields.size();}
+	bool hasFlowField(const Key &key) const	{return flowFields.find(key) != flowFields.end();}
+	void clear();
+
+private:
+	FlowFieldCache(const FlowFieldCache &);
+	FlowFieldCache &operator=(const FlowFieldCache &);
+};
+
+}}//end namespace
+
+#endif
@@ -11,6 +11,7 @@
 #include "path_finder.h"
 
 #include <algorithm>
+#include <queue>
 
 #include "config.h"
 #include "map.h"
@@ -19,6 +20,7 @@
 #include "platform_common.h"
 #include "command.h"
 #include "faction.h"
+#include "world.h"
 #include "randomgen.h"
 #include "leak_dumper.h"
 
@@ -61,10 +63,24 @@ namespace
     const int
       PathFinder::pathFindExtendRefreshNodeCountMax = 40;
 
+    // group order units closer than this to their destination use A* right away
+    const int
+      PathFinder::flowFieldMinDistance = 20;
+    // a flow field is followed until this far from the nearest destination
+    // (10 per straight cell, 14 per diagonal cell)
+    const int
+      PathFinder::flowFieldArriveCost = 100;
+    // cells added around the units and destinations of a group order
+    const int
+      PathFinder::flowFieldMargin = 16;
+    const int
+      PathFinder::maxFlowFieldsPerFaction = 8;
+
     PathFinder::PathFinder ()
     {
       minorDebugPathfinder = false;
       map = NULL;
+      processedObstacleChanges = 0;
     }
 
     int
@@ -80,6 +96,7 @@ namespace
       minorDebugPathfinder = false;
 
       map = NULL;
+      processedObstacleChanges = 0;
       init (map);
     }
 
@@ -95,6 +112,8 @@ namespace
           faction.useMaxNodeCount = PathFinder::pathFindNodesMax;
         }
       this->map = map;
+      processedObstacleChanges =
+        (map != NULL ? map->getObstacleChangeCount () : 0);
     }
 
     void
@@ -102,6 +121,7 @@ namespace
     {
       minorDebugPathfinder = false;
       map = NULL;
+      processedObstacleChanges = 0;
     }
 
     PathFinder::~PathFinder ()
@@ -448,19 +468,30 @@ namespace
              unit->getPos ().getString ().c_str (),
              finalPos.getString ().c_str (), frameIndex);
 
-        if (SystemFlags::getSystemSettingType (SystemFlags::debugWorldSynch).
-            enabled == true && frameIndex < 0)
+        //units of a group order follow the order's flow field while they
+        //are far from its destinations
+        if (frameIndex < 0)
           {
-            char
-              szBuf[8096] = "";
-            snprintf (szBuf, 8096, "calling aStar()");
-            unit->logSynchData (extractFileFromDirectoryPath (__FILE__).
-                                c_str (), __LINE__, szBuf);
+            ts = followFlowField (unit, finalPos);
           }
 
-        ts =
-          aStar (unit, finalPos, false, frameIndex, maxNodeCount,
-                 &searched_node_count);
+        if (ts == tsImpossible)
+          {
+            if (SystemFlags::
+                getSystemSettingType (SystemFlags::debugWorldSynch).enabled ==
+                true && frameIndex < 0)
+              {
+                char
+                  szBuf[8096] = "";
+                snprintf (szBuf, 8096, "calling aStar()");
+                unit->logSynchData (extractFileFromDirectoryPath (__FILE__).
+                                    c_str (), __LINE__, szBuf);
+              }
+
+            ts =
+              aStar (unit, finalPos, false, frameIndex, maxNodeCount,
+                     &searched_node_count);
+          }
         //post actions
         switch (ts)
           {
@@ -1425,10 +1456,8 @@ namespace
 
             if (faction.closedNodesList.empty () == false)
               {
-                float
-                  bestHeuristic =
-                  truncateDecimal <
-                  float >(faction.closedNodesList.begin ()->first, 6);
+                Fixed
+                  bestHeuristic = faction.closedNodesList.begin ()->first;
                 if (lastNode != NULL && bestHeuristic < lastNode->heuristic)
                   {
                     lastNode =
@@ -1768,7 +1797,7 @@ namespace
     PathFinder::processNearestFreePos (const Vec2i & finalPos, int i, int j,
                                        int size, Field field, int teamIndex,
                                        Vec2i unitPos, Vec2i & nearestPos,
-                                       float &nearestDist)
+                                       Fixed & nearestDist)
     {
 
       try
@@ -1778,8 +1807,8 @@ namespace
 
         if (map->isAproxFreeCells (currPos, size, field, teamIndex))
           {
-            float
-              dist = currPos.dist (finalPos);
+            Fixed
+              dist = Vec2x (currPos).dist (Vec2x (finalPos));
 
             //if nearer from finalPos
             if (dist < nearestDist)
@@ -1790,7 +1819,8 @@ namespace
             //if the distance is the same compare distance to unit
             else if (dist == nearestDist)
               {
-                if (currPos.dist (unitPos) < nearestPos.dist (unitPos))
+                if (Vec2x (currPos).dist (Vec2x (unitPos)) <
+                    Vec2x (nearestPos).dist (Vec2x (unitPos)))
                   {
                     nearestPos = currPos;
                   }
@@ -1861,8 +1891,8 @@ namespace
           unitPos = unit->getPosNotThreadSafe ();
         nearestPos = unitPos;
 
-        float
-          nearestDist = unitPos.dist (finalPos);
+        Fixed
+          nearestDist = Vec2x (unitPos).dist (Vec2x (finalPos));
 
         for (int i = -maxFreeSearchRadius; i <= maxFreeSearchRadius; ++i)
           {
@@ -1904,6 +1934,411 @@ namespace
       return nearestPos;
     }
 
+    // cells a flow field may lead through, the team's knowledge of the map
+    // as in Map::isAproxFreeCell but only static obstacles count. A building
+    // blocks while the team sees the cell it stands on, updateFlowFields
+    // marks the fields dirty when that changes.
+    bool
+    PathFinder::isFlowFieldCellFree (const Vec2i & pos, Field field,
+                                     int teamIndex) const
+    {
+      if (map->isInside (pos) == false
+          || map->isInsideSurface (Map::toSurfCoords (pos)) == false)
+        {
+          return false;
+        }
+      const SurfaceCell *
+        sc = map->getSurfaceCell (Map::toSurfCoords (pos));
+      if (sc->isExplored (teamIndex) == false)
+        {
+          return true;
+        }
+      if (field == fLand
+          && (sc->isFree () == false
+              || map->getDeepSubmerged (map->getCell (pos)) == true))
+        {
+          return false;
+        }
+      Unit *
+        cellUnit = map->getCell (pos)->getUnit (field);
+      if (cellUnit != NULL && cellUnit->getType ()->isMobile () == false
+          && cellUnit->isPutrefacting () == false
+          && map->getSurfaceCell (Map::toSurfCoords (cellUnit->getPos ()))->
+          isVisible (teamIndex) == true)
+        {
+          return false;
+        }
+      return true;
+    }
+
+    // only orders to a fixed cell share a field, a unit target moves and
+    // harvest or repair orders go back and forth between their own targets
+    bool
+    PathFinder::isFlowFieldCommand (const Command * command)
+    {
+      CommandClass
+        commandClass = command->getCommandType ()->getClass ();
+      return (commandClass == ccMove || commandClass == ccAttack)
+        && command->getUnit () == NULL;
+    }
+
+    // marks the flow fields of teamIndex (all teams when -1) touching the
+    // size x size area at pos dirty
+    void
+    PathFinder::markFlowFieldsDirty (const Vec2i & pos, int size,
+                                     int teamIndex)
+    {
+      for (int factionIndex = 0; factionIndex < factions.size ();
+           ++factionIndex)
+        {
+          factions.getFactionState (factionIndex).flowFields.
+            markDirty (pos, size, teamIndex);
+        }
+    }
+
+    // marks the flow fields touching cells changed since the last call,
+    // they are rebuilt the next time a unit follows them
+    void
+    PathFinder::processObstacleChanges ()
+    {
+      int
+        changeCount = map->getObstacleChangeCount ();
+      for (; processedObstacleChanges < changeCount;
+           ++processedObstacleChanges)
+        {
+          const ObstacleChange &
+            change = map->getObstacleChange (processedObstacleChanges);
+          markFlowFieldsDirty (change.pos, change.size, change.teamIndex);
+        }
+    }
+
+    // called once per frame after the fog of war update. Besides the map's
+    // obstacle changes a building entering or leaving a team's sight changes
+    // which cells that team's fields may cross.
+    void
+    PathFinder::updateFlowFields (const World * world)
+    {
+      bool
+        hasFlowFields = false;
+      for (int factionIndex = 0;
+           factionIndex < factions.size () && hasFlowFields == false;
+           ++factionIndex)
+        {
+          hasFlowFields =
+            (factions.getFactionState (factionIndex).flowFields.empty () ==
+             false);
+        }
+
+      if (hasFlowFields == false)
+        {
+          // fields built later start from what the teams see by then
+          staticUnitVisibility.clear ();
+        }
+      else
+        {
+          std::map < int, int >
+            visibility;
+          for (int factionIndex = 0; factionIndex < world->getFactionCount ();
+               ++factionIndex)
+            {
+              const Faction *
+                faction = world->getFaction (factionIndex);
+              for (int unitIndex = 0; unitIndex < faction->getUnitCount ();
+                   ++unitIndex)
+                {
+                  Unit *
+                    unit = faction->getUnit (unitIndex);
+                  if (unit->getType ()->isMobile () == true)
+                    {
+                      continue;
+                    }
+                  const SurfaceCell *
+                    sc = map->getSurfaceCell (Map::toSurfCoords (unit->getPos ()));
+                  int
+                    teamMask = 0;
+                  for (int teamIndex = 0;
+                       teamIndex <
+                       GameConstants::maxPlayers +
+                       GameConstants::specialFactions; ++teamIndex)
+                    {
+                      if (sc->isVisible (teamIndex) == true)
+                        {
+                          teamMask |= (1 << teamIndex);
+                        }
+                    }
+                  visibility[unit->getId ()] = teamMask;
+
+                  // a new building was already logged by Map::putUnitCells
+                  std::map < int, int >::iterator iterFind =
+                    staticUnitVisibility.find (unit->getId ());
+                  if (iterFind == staticUnitVisibility.end ()
+                      || iterFind->second == teamMask)
+                    {
+                      continue;
+                    }
+                  int
+                    changedMask = iterFind->second ^ teamMask;
+                  for (int teamIndex = 0;
+                       teamIndex <
+                       GameConstants::maxPlayers +
+                       GameConstants::specialFactions; ++teamIndex)
+                    {
+                      if ((changedMask & (1 << teamIndex)) != 0)
+                        {
+                          markFlowFieldsDirty (unit->getPos (),
+                                               unit->getType ()->getSize (),
+                                               teamIndex);
+                        }
+                    }
+                }
+            }
+          staticUnitVisibility.swap (visibility);
+        }
+
+      processObstacleChanges ();
+    }
+
+    FlowField *
+    PathFinder::getFlowField (Unit * unit, const Vec2i & finalPos,
+                              int groupId)
+    {
+      FactionState & faction =
+        factions.getFactionState (unit->getFactionIndex ());
+      FlowFieldCache::Key
+      key (groupId,
+           unit->getType ()->getSize () * fieldCount +
+           unit->getCurrField ());
+
+      FlowField *
+        flowField = faction.flowFields.getFlowField (key);
+      if (flowField->dirty == true)
+        {
+          flowField->field = unit->getCurrField ();
+          flowField->unitSize = unit->getType ()->getSize ();
+          flowField->teamIndex = unit->getTeam ();
+          buildFlowField (flowField, unit, finalPos, groupId);
+        }
+      return flowField;
+    }
+
+    // distances to the destinations of every unit in the group order, over
+    // a box around the units and destinations
+    void
+    PathFinder::buildFlowField (FlowField * flowField, Unit * unit,
+                                const Vec2i & finalPos, int groupId)
+    {
+      flowField->goals.clear ();
+      flowField->goals.insert (finalPos);
+      Vec2i
+        minPos = finalPos;
+      Vec2i
+        maxPos = finalPos;
+      const Vec2i
+        unitPos = unit->getPos ();
+      minPos.x = min (minPos.x, unitPos.x);
+      minPos.y = min (minPos.y, unitPos.y);
+      maxPos.x = max (maxPos.x, unitPos.x);
+      maxPos.y = max (maxPos.y, unitPos.y);
+
+      Faction *
+        faction = unit->getFaction ();
+      for (int index = 0; index < faction->getUnitCount (); ++index)
+        {
+          Unit *
+            member = faction->getUnit (index);
+          Command *
+            command = member->getCurrCommand ();
+          if (member == unit || command == NULL
+              || command->getUnitCommandGroupId () != groupId
+              || isFlowFieldCommand (command) == false
+              || member->getType ()->getSize () != flowField->unitSize
+              || member->getCurrField () != flowField->field)
+            {
+              continue;
+            }
+          Vec2i
+            goal = command->getPos ();
+          flowField->goals.insert (goal);
+
+          const Vec2i
+            memberPos = member->getPos ();
+          minPos.x = min (minPos.x, min (goal.x, memberPos.x));
+          minPos.y = min (minPos.y, min (goal.y, memberPos.y));
+          maxPos.x = max (maxPos.x, max (goal.x, memberPos.x));
+          maxPos.y = max (maxPos.y, max (goal.y, memberPos.y));
+        }
+
+      flowField->origin.x = max (0, minPos.x - flowFieldMargin);
+      flowField->origin.y = max (0, minPos.y - flowFieldMargin);
+      flowField->size.x =
+        min (map->getW () - 1, maxPos.x + flowFieldMargin) -
+        flowField->origin.x + 1;
+      flowField->size.y =
+        min (map->getH () - 1, maxPos.y + flowFieldMargin) -
+        flowField->origin.y + 1;
+
+      int
+        cellCount = flowField->size.x * flowField->size.y;
+      flowField->passable.assign (cellCount, false);
+      for (int index = 0; index < cellCount; ++index)
+        {
+          Vec2i
+            pos = flowField->origin + Vec2i (index % flowField->size.x,
+                                             index / flowField->size.x);
+          bool
+            cellsFree = true;
+          for (int i = 0; i < flowField->unitSize && cellsFree == true; ++i)
+            {
+              for (int j = 0; j < flowField->unitSize && cellsFree == true;
+                   ++j)
+                {
+                  cellsFree =
+                    isFlowFieldCellFree (pos + Vec2i (i, j),
+                                         flowField->field,
+                                         flowField->teamIndex);
+                }
+            }
+          flowField->passable[index] = cellsFree;
+        }
+
+      flowField->computeDistances ();
+      flowField->dirty = false;
+
+      if (SystemFlags::getSystemSettingType (SystemFlags::debugWorldSynch).
+          enabled == true)
+        {
+          char
+            szBuf[8096] = "";
+          snprintf (szBuf, 8096,
+                    "built flow field for group %d goals " MG_SIZE_T_SPECIFIER
+                    " origin %s size %s", groupId, flowField->goals.size (),
+                    flowField->origin.getString ().c_str (),
+                    flowField->size.getString ().c_str ());
+          unit->logSynchData (extractFileFromDirectoryPath (__FILE__).
+                              c_str (), __LINE__, szBuf);
+        }
+    }
+
+    // fills the unit's path with the next cells down the flow field of its
+    // group order, tsImpossible means the caller should use A* instead
+    TravelState
+    PathFinder::followFlowField (Unit * unit, const Vec2i & finalPos)
+    {
+      Command *
+        command = unit->getCurrCommand ();
+      if (command == NULL || command->getUnitCommandGroupId () < 0
+          || isFlowFieldCommand (command) == false
+          || finalPos != command->getPos ()
+          || Vec2x (unit->getPos ()).dist (Vec2x (finalPos)) <
+          Fixed (flowFieldMinDistance))
+        {
+          return tsImpossible;
+        }
+
+      processObstacleChanges ();
+      FlowField *
+        flowField =
+        getFlowField (unit, finalPos, command->getUnitCommandGroupId ());
+      // a member that got its order after the field was built
+      if (flowField->goals.find (finalPos) == flowField->goals.end ())
+        {
+          return tsImpossible;
+        }
+
+      Vec2i
+        pos = unit->getPos ();
+      int
+        distance = flowField->getDistance (pos);
+      if (distance <= flowFieldArriveCost)
+        {
+          return tsImpossible;
+        }
+
+      std::vector < Vec2i > steps;
+      int
+        maxSteps = max (1, unit->getPathFindRefreshCellCount ());
+      for (int step = 0;
+           step < maxSteps && distance > flowFieldArriveCost; ++step)
+        {
+          Vec2i
+            nextPos = pos;
+          int
+            nextDistance = distance;
+          for (int i = -1; i <= 1; ++i)
+            {
+              for (int j = -1; j <= 1; ++j)
+                {
+                  if (i == 0 && j == 0)
+                    {
+                      continue;
+                    }
+                  Vec2i
+                    candidatePos = pos + Vec2i (i, j);
+                  int
+                    candidateDistance = flowField->getDistance (candidatePos);
+                  if (candidateDistance < 0
+                      || candidateDistance >= nextDistance
+                      || flowField->isPassable (candidatePos) == false)
+                    {
+                      continue;
+                    }
+                  if (i != 0 && j != 0
+                      && (flowField->isPassable (Vec2i (pos.x + i, pos.y)) ==
+                          false
+                          || flowField->isPassable (Vec2i (pos.x, pos.y + j))
+                          == false))
+                    {
+                      continue;
+                    }
+                  // other units only matter for the first step, later
+                  // steps are checked again when the unit gets there
+                  if (step == 0
+                      && map->canMove (unit, pos, candidatePos) == false)
+                    {
+                      continue;
+                    }
+                  nextPos = candidatePos;
+                  nextDistance = candidateDistance;
+                }
+            }
+          if (nextDistance == distance)
+            {
+              break;
+            }
+          steps.push_back (nextPos);
+          pos = nextPos;
+          distance = nextDistance;
+        }
+
+      if (steps.empty () == true)
+        {
+          return tsImpossible;
+        }
+
+      UnitPathInterface *
+        path = unit->getPath ();
+      path->clear ();
+      for (unsigned int index = 0; index < steps.size (); ++index)
+        {
+          path->add (steps[index]);
+        }
+
+      if (SystemFlags::getSystemSettingType (SystemFlags::debugWorldSynch).
+          enabled == true)
+        {
+          char
+            szBuf[8096] = "";
+          snprintf (szBuf, 8096,
+                    "following flow field of group %d steps "
+                    MG_SIZE_T_SPECIFIER " distance %d",
+                    command->getUnitCommandGroupId (), steps.size (),
+                    distance);
+          unit->logSynchData (extractFileFromDirectoryPath (__FILE__).
+                              c_str (), __LINE__, szBuf);
+        }
+      return tsMoving;
+    }
+
     int
     PathFinder::findNodeIndex (Node * node, Nodes & nodeList)
     {
@@ -2026,8 +2461,10 @@ namespace
                 findNodeIndex (curNode->prev, factionState.nodePool);
               nodePoolNode->addAttribute ("prev", intToStr (prevIdx),
                                           mapTagReplacements);
-              nodePoolNode->addAttribute ("heuristic",
-                                          floatToStr (curNode->heuristic, 6),
+              // the raw bits, a float would not load back the same value
+              nodePoolNode->addAttribute ("heuristicRaw",
+                                          intToStr (curNode->heuristic.
+                                                    getRaw ()),
                                           mapTagReplacements);
               nodePoolNode->addAttribute ("exploredCell",
                                           intToStr (curNode->exploredCell),
@@ -2099,8 +2536,21 @@ namespace
                 {
                   curNode->prev = NULL;
                 }
-              curNode->heuristic =
-                nodePoolNode->getAttribute ("heuristic")->getFloatValue ();
+              if (nodePoolNode->hasAttribute ("heuristicRaw") == true)
+                {
+                  curNode->heuristic =
+                    Fixed::fromRaw (nodePoolNode->
+                                    getAttribute ("heuristicRaw")->
+                                    getIntValue ());
+                }
+              else
+                {
+                  // saved before heuristics were fixed point
+                  curNode->heuristic =
+                    Fixed::fromFloat (nodePoolNode->
+                                      getAttribute ("heuristic")->
+                                      getFloatValue ());
+                }
               curNode->exploredCell =
                 nodePoolNode->getAttribute ("exploredCell")->getIntValue () !=
                 0;
@@ -18,12 +18,15 @@
 #   endif
 
 #   include "vec.h"
+#   include "fixed_point.h"
 #   include <vector>
 #   include <map>
+#   include <set>
 #   include "game_constants.h"
 #   include "skill_type.h"
 #   include "map.h"
 #   include "unit.h"
+#   include "flow_field.h"
 //#include "randomc.h"
 #   include "leak_dumper.h"
 
@@ -31,6 +34,10 @@ using
   std::vector;
 using
   Shared::Graphics::Vec2i;
+using
+  Shared::Graphics::Fixed;
+using
+  Shared::Graphics::Vec2x;
 
 namespace
   Glest
@@ -39,6 +46,9 @@ namespace
     Game
   {
 
+    class
+      World;
+
 // =====================================================
 //      class PathFinder
 //
@@ -111,7 +121,7 @@ namespace
           pos.y = 0;
           next = NULL;
           prev = NULL;
-          heuristic = 0.0;
+          heuristic = Fixed ();
           exploredCell = false;
         }
         Vec2i
@@ -120,7 +130,7 @@ namespace
           next;
         Node *
           prev;
-        float
+        Fixed
           heuristic;
         bool
           exploredCell;
@@ -140,7 +150,7 @@ namespace
         explicit
         FactionState (int factionIndex):
           //factionMutexPrecache(new Mutex) {
-        factionMutexPrecache (NULL)
+        factionMutexPrecache (NULL), flowFields (maxFlowFieldsPerFaction)
         {                       //, random(factionIndex) {
 
           openPosList.clear ();
@@ -175,10 +185,10 @@ namespace
         }
 
         std::map < Vec2i, bool > openPosList;
-        std::map < float,
+        std::map < Fixed,
           Nodes >
           openNodesList;
-        std::map < float,
+        std::map < Fixed,
           Nodes >
           closedNodesList;
         std::vector < Node > nodePool;
@@ -200,6 +210,9 @@ namespace
           std::vector <
         Vec2i > >
           precachedPath;
+
+        FlowFieldCache
+          flowFields;
       };
 
       class
@@ -270,6 +283,15 @@ namespace
       static const int
         pathFindExtendRefreshNodeCountMax;
 
+      static const int
+        flowFieldMinDistance;
+      static const int
+        flowFieldArriveCost;
+      static const int
+        flowFieldMargin;
+      static const int
+        maxFlowFieldsPerFaction;
+
     private:
 
       static int
@@ -284,6 +306,11 @@ namespace
         map;
       bool
         minorDebugPathfinder;
+      int
+        processedObstacleChanges;
+      // teams that could see each building last frame, one bit per team
+      std::map < int, int >
+        staticUnitVisibility;
 
     public:
       PathFinder ();
@@ -315,6 +342,13 @@ namespace
       removeUnitPrecache (Unit * unit);
       void
       clearCaches ();
+      void
+      updateFlowFields (const World * world);
+      int
+      getProcessedObstacleChanges () const
+      {
+        return processedObstacleChanges;
+      }
 
       //bool unitCannotMove(Unit *unit);
 
@@ -354,10 +388,28 @@ namespace
       Vec2i
       computeNearestFreePos (const Unit * unit, const Vec2i & targetPos);
 
-      inline static float
+      TravelState
+      followFlowField (Unit * unit, const Vec2i & finalPos);
+      FlowField *
+      getFlowField (Unit * unit, const Vec2i & finalPos, int groupId);
+      void
+      buildFlowField (FlowField * flowField, Unit * unit,
+                      const Vec2i & finalPos, int groupId);
+      bool
+      isFlowFieldCellFree (const Vec2i & pos, Field field,
+                           int teamIndex) const;
+      void
+      processObstacleChanges ();
+      void
+      markFlowFieldsDirty (const Vec2i & pos, int size, int teamIndex);
+      static bool
+      isFlowFieldCommand (const Command * command);
+
+      // Fixed point keeps the node order the same on every platform
+      inline static Fixed
       heuristic (const Vec2i & pos, const Vec2i & finalPos)
       {
-        return pos.dist (finalPos);
+        return Vec2x (pos).dist (Vec2x (finalPos));
       }
 
       inline static bool
@@ -496,7 +548,7 @@ namespace
       void
       processNearestFreePos (const Vec2i & finalPos, int i, int j, int size,
                              Field field, int teamIndex, Vec2i unitPos,
-                             Vec2i & nearestPos, float &nearestDist);
+                             Vec2i & nearestPos, Fixed & nearestDist);
       int
       getPathFindExtendRefreshNodeCount (FactionState & faction);
 
@@ -400,7 +400,7 @@ bool GraphicLabel::mouseMove(int x, int y) {
 
 	int useWidth = w;
 	if(text.length() > 0 && font3D != NULL) {
-		float lineWidth = (font3D->getTextHandler()->Advance(text.c_str()) * Shared::Graphics::Font::scaleFontValue);
+		float lineWidth = font3D->getMetrics()->getTextWidth(text);
 		useWidth = (int)lineWidth;
 	}
 
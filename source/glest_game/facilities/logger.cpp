@@ -84,7 +84,8 @@ void Logger::add(const string str,  bool renderScreen, const string statusText)
 	this->current= str;
 	this->statusText = statusText;
 
-	if(renderScreen == true && GlobalStaticFlags::getIsNonGraphicalModeEnabled() == false) {
+	if(renderScreen == true && GlobalStaticFlags::getIsNonGraphicalModeEnabled() == false &&
+		GlobalStaticFlags::isFlagSet(gsft_no_window) == false) {
 		renderLoadingScreen();
 	}
 }
@@ -28,6 +28,7 @@
 #include "commander.h"
 #include "battle_end.h"
 #include "sound_renderer.h"
+#include "sound_sample_cache.h"
 #include "profiler.h"
 #include "core_data.h"
 #include "metrics.h"
@@ -1596,6 +1597,9 @@ namespace Glest
       Config & config = Config::getInstance ();
       Logger & logger = Logger::getInstance ();
 
+      // model textures decode in the background until the end of the load
+      Renderer::getInstance ().beginTextureDecodeBatch (rsGame);
+
       string mapName = gameSettings.getMap ();
       string tilesetName = gameSettings.getTileset ();
       string techName = gameSettings.getTech ();
@@ -1906,6 +1910,17 @@ namespace Glest
         perfList.push_back (perfBuf);
       }
 
+      Renderer::getInstance ().endTextureDecodeBatch (rsGame);
+      if (SystemFlags::
+          getSystemSettingType (SystemFlags::debugPerformance).enabled)
+        SystemFlags::OutputDebug (SystemFlags::debugPerformance,
+                                  "In [%s::%s Line: %d] sound samples %s\n",
+                                  extractFileFromDirectoryPath
+                                  (__FILE__).c_str (), __FUNCTION__,
+                                  __LINE__,
+                                  ::Shared::Sound::SoundSampleCache::
+                                  getInstance ()->getStats ().c_str ());
+
       // give CPU time to update other things to avoid apperance of hanging
       sleep (0);
       SDL_PumpEvents ();
@@ -8407,6 +8422,23 @@ namespace Glest
         str +=
           "Log buffer count: " +
           intToStr (SystemFlags::getLogEntryBufferCount ()) + "\n";
+        str +=
+          "Log entries dropped: " +
+          intToStr (SystemFlags::getLogEntryDroppedCount ()) + "\n";
+      }
+
+      NetworkManager & networkManager = NetworkManager::getInstance ();
+      if (networkManager.getNetworkRole () == nrClient)
+      {
+        ClientInterface *clientInterface =
+          dynamic_cast <
+          ClientInterface * >(networkManager.getClientInterface ());
+        if (clientInterface != NULL)
+        {
+          str +=
+            "Network frame wait: " +
+            clientInterface->getFrameWaitHistogramReport () + "\n";
+        }
       }
 
       str +=
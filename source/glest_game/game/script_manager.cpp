@@ -286,6 +286,8 @@ namespace
       ScriptManager::messageWrapCount = 35;
     const int
       ScriptManager::displayTextWrapCount = 64;
+    const int
+      ScriptManager::eventBatchReserve = 256;
 
     ScriptManager::ScriptManager ()
     {
@@ -313,11 +315,32 @@ namespace
 
       lastUnitTriggerEventUnitId = -1;
       lastUnitTriggerEventType = utet_None;
+      batchEvents = false;
     }
 
     ScriptManager::~ScriptManager ()
     {
-
+      if (SystemFlags::getSystemSettingType (SystemFlags::debugPerformance).
+          enabled)
+        {
+          std::map < string, LuaFunctionStats > stats =
+            luaScript.getFunctionStats ();
+          for (std::map < string, LuaFunctionStats >::iterator iterMap =
+               stats.begin (); iterMap != stats.end (); ++iterMap)
+            {
+              SystemFlags::OutputDebug (SystemFlags::debugPerformance,
+                                        "Lua function [%s] calls: "
+                                        MG_I64_SPECIFIER " total usecs: "
+                                        MG_I64_SPECIFIER " max usecs: "
+                                        MG_I64_SPECIFIER " over budget: "
+                                        MG_I64_SPECIFIER "\n",
+                                        iterMap->first.c_str (),
+                                        iterMap->second.callCount,
+                                        iterMap->second.totalMicros,
+                                        iterMap->second.maxMicros,
+                                        iterMap->second.overBudgetCount);
+            }
+        }
     }
 
     void
@@ -578,6 +601,17 @@ namespace
                               script->getName ());
         }
 
+      //scenarios with a batchedEvents script get the unit, timer and cell
+      //events of a frame in the scriptEvents table with one call instead
+      //of one call per event
+      batchEvents = luaScript.hasFunction ("batchedEvents");
+      pendingEvents.clear ();
+      pendingEvents.reserve (eventBatchReserve);
+      deliveredEvents.clear ();
+      deliveredEvents.reserve (eventBatchReserve);
+      luaScript.setCallBudgetMillis (Config::getInstance ().
+                                     getInt ("LuaCallBudgetMillis", "0"));
+
 
       //!!!
 //      string data_path= getGameReadWritePath(GameConstants::path_data_CacheLookupKey);
@@ -751,6 +785,11 @@ namespace
 
       if (this->rootNode == NULL)
         {
+          if (batchEvents == true)
+            {
+              pendingEvents.push_back (LuaEvent ("resourceHarvested"));
+              return;
+            }
           luaScript.beginCall ("resourceHarvested");
           luaScript.endCall ();
         }
@@ -769,6 +808,19 @@ namespace
         {
           lastCreatedUnitName = unit->getType ()->getName (false);
           lastCreatedUnitId = unit->getId ();
+          if (batchEvents == true)
+            {
+              LuaEvent event ("unitCreated");
+              event.addField ("unitId", unit->getId ());
+              pendingEvents.push_back (event);
+
+              // the batch only carries ids, the type specific handler is
+              // still called right away and reads lastCreatedUnit as before
+              luaScript.beginCall ("unitCreatedOfType_" +
+                                   unit->getType ()->getName ());
+              luaScript.endCall ();
+              return;
+            }
           luaScript.beginCall ("unitCreated");
           luaScript.endCall ();
           luaScript.beginCall ("unitCreatedOfType_" +
@@ -816,6 +868,17 @@ namespace
           lastDeadUnitId = unit->getId ();
           lastDeadUnitCauseOfDeath = unit->getCauseOfDeath ();
 
+          if (batchEvents == true)
+            {
+              LuaEvent event ("unitDied");
+              event.addField ("unitId", unit->getId ());
+              event.addField ("killerId",
+                              (unit->getLastAttackerUnitId () >= 0 ?
+                               lastDeadUnitKillerId : -1));
+              event.addField ("causeOfDeath", lastDeadUnitCauseOfDeath);
+              pendingEvents.push_back (event);
+              return;
+            }
           luaScript.beginCall ("unitDied");
           luaScript.endCall ();
         }
@@ -834,6 +897,13 @@ namespace
         {
           lastAttackedUnitName = unit->getType ()->getName (false);
           lastAttackedUnitId = unit->getId ();
+          if (batchEvents == true)
+            {
+              LuaEvent event ("unitAttacked");
+              event.addField ("unitId", unit->getId ());
+              pendingEvents.push_back (event);
+              return;
+            }
           luaScript.beginCall ("unitAttacked");
           luaScript.endCall ();
         }
@@ -852,6 +922,13 @@ namespace
         {
           lastAttackingUnitName = unit->getType ()->getName (false);
           lastAttackingUnitId = unit->getId ();
+          if (batchEvents == true)
+            {
+              LuaEvent event ("unitAttacking");
+              event.addField ("unitId", unit->getId ());
+              pendingEvents.push_back (event);
+              return;
+            }
           luaScript.beginCall ("unitAttacking");
           luaScript.endCall ();
         }
@@ -930,8 +1007,17 @@ namespace
                     }
                 }
               currentTimerTriggeredEventId = iterMap->first;
-              luaScript.beginCall ("timerTriggerEvent");
-              luaScript.endCall ();
+              if (batchEvents == true)
+                {
+                  LuaEvent batchEvent ("timerTriggerEvent");
+                  batchEvent.addField ("timerId", iterMap->first);
+                  pendingEvents.push_back (batchEvent);
+                }
+              else
+                {
+                  luaScript.beginCall ("timerTriggerEvent");
+                  luaScript.endCall ();
+                }
 
               if (event.triggerSecondsElapsed > 0)
                 {
@@ -1568,8 +1654,23 @@ namespace
                   currentCellTriggeredEventId = iterMap->first;
                   event.triggerCount++;
 
-                  luaScript.beginCall ("cellTriggerEvent");
-                  luaScript.endCall ();
+                  if (batchEvents == true)
+                    {
+                      LuaEvent batchEvent ("cellTriggerEvent");
+                      batchEvent.addField ("eventId", iterMap->first);
+                      batchEvent.addField ("unitId",
+                                           currentCellTriggeredEventUnitId);
+                      batchEvent.addField ("areaEntryUnitId",
+                                           currentCellTriggeredEventAreaEntryUnitId);
+                      batchEvent.addField ("areaExitUnitId",
+                                           currentCellTriggeredEventAreaExitUnitId);
+                      pendingEvents.push_back (batchEvent);
+                    }
+                  else
+                    {
+                      luaScript.beginCall ("cellTriggerEvent");
+                      luaScript.endCall ();
+                    }
                 }
 
 //                      ScenarioInfo scenarioInfoEnd = world->getScenario()->getInfo();
@@ -3426,6 +3527,27 @@ namespace
       //printf("File: %s line: %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__LINE__);
     }
 
+    void
+    ScriptManager::deliverBatchedEvents ()
+    {
+      if (batchEvents == false || pendingEvents.empty () == true
+          || this->rootNode != NULL)
+        {
+          return;
+        }
+      if (SystemFlags::getSystemSettingType (SystemFlags::debugLUA).enabled)
+        SystemFlags::OutputDebug (SystemFlags::debugLUA,
+                                  "In [%s::%s Line: %d] pendingEvents.size() = %d\n",
+                                  extractFileFromDirectoryPath (__FILE__).
+                                  c_str (), __FUNCTION__, __LINE__,
+                                  (int) pendingEvents.size ());
+
+      // events raised while the handler runs are delivered next frame
+      deliveredEvents.clear ();
+      deliveredEvents.swap (pendingEvents);
+      luaScript.callEvents ("batchedEvents", "scriptEvents", deliveredEvents);
+    }
+
     void
     ScriptManager::registerDayNightEvent ()
     {
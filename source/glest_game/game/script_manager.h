@@ -36,6 +36,10 @@ using
   Shared::Graphics::Vec2i;
 using
   Shared::Lua::LuaScript;
+using
+  Shared::Lua::LuaEvent;
+using
+  Shared::Lua::LuaFunctionStats;
 using
   Shared::Lua::LuaHandle;
 using
@@ -393,6 +397,16 @@ namespace
         string >
         luaSavedGameData;
 
+      //batched events
+      bool
+        batchEvents;
+      std::vector <
+        LuaEvent >
+        pendingEvents;
+      std::vector <
+        LuaEvent >
+        deliveredEvents;
+
     private:
       static ScriptManager *
         thisScriptManager;
@@ -402,6 +416,8 @@ namespace
         messageWrapCount;
       static const int
         displayTextWrapCount;
+      static const int
+        eventBatchReserve;
 
     public:
 
@@ -463,6 +479,8 @@ namespace
       onDayNightTriggerEvent ();
       void
       onUnitTriggerEvent (const Unit * unit, UnitTriggerEventType event);
+      void
+      deliverBatchedEvents ();
 
       bool
       getGameWon () const;
@@ -484,6 +484,8 @@ void Renderer::initGame(const Game *game, GameCamera *gameCamera) {
 	VisibleQuadContainerCache::enableFrustumCalcs = Config::getInstance().getBool("EnableFrustrumCalcs","true");
 	quadCache = VisibleQuadContainerCache();
 	quadCache.clearFrustumData();
+	unitDrawList.clear();
+	unitDrawList.setThreadCount(Config::getInstance().getInt("RenderPrepThreads","2"));
 
 	SurfaceData::nextUniqueId = 1;
 	mapSurfaceData.clear();
@@ -691,6 +693,7 @@ void Renderer::reset3dMenu() {
 void Renderer::end() {
 	quadCache = VisibleQuadContainerCache();
 	quadCache.clearFrustumData();
+	unitDrawList.clear();
 
 	if(Renderer::rendererEnded == true) {
 		return;
@@ -731,6 +734,7 @@ void Renderer::endScenario() {
 	this->gameCamera = NULL;
 	quadCache = VisibleQuadContainerCache();
 	quadCache.clearFrustumData();
+	unitDrawList.clear();
 
 	if(GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
 		return;
@@ -766,6 +770,7 @@ void Renderer::endGame(bool isFinalEnd) {
 	try {
 		quadCache = VisibleQuadContainerCache();
 		quadCache.clearFrustumData();
+		unitDrawList.clear();
 	}
 	catch(const exception &e) {
 		char szBuf[8096]="";
@@ -922,6 +927,26 @@ void Renderer::endLastModel(ResourceScope rs, bool mustExistInList) {
 	modelManager[rs]->endLastModel(mustExistInList);
 }
 
+//model textures loaded between begin and end are decoded on worker threads,
+//end blocks until they are all uploaded
+void Renderer::beginTextureDecodeBatch(ResourceScope rs) {
+	if(GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
+		return;
+	}
+
+	textureManager[rs]->setDeferredLoadEnabled(true);
+}
+
+void Renderer::endTextureDecodeBatch(ResourceScope rs) {
+	if(GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
+		return;
+	}
+
+	textureManager[rs]->setDeferredLoadEnabled(false);
+
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled) SystemFlags::OutputDebug(SystemFlags::debugPerformance,"In [%s::%s Line: %d] rs = %d %s, %s\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,rs,textureManager[rs]->getLookupStats().c_str(),modelManager[rs]->getLookupStats().c_str());
+}
+
 Texture2D *Renderer::newTexture2D(ResourceScope rs){
 	if(GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
 		return NULL;
@@ -5327,15 +5352,16 @@ void Renderer::renderUnits(bool airUnits, const int renderFps) {
 
 	VisibleQuadContainerCache &qCache = getQuadCache();
 	if(qCache.visibleQuadUnitList.empty() == false) {
+		const UnitDrawList &drawList = getUnitDrawList();
 		bool modelRenderStarted = false;
-		for(int visibleUnitIndex = 0;
-				visibleUnitIndex < (int)qCache.visibleQuadUnitList.size(); ++visibleUnitIndex) {
-			Unit *unit = qCache.visibleQuadUnitList[visibleUnitIndex];
+		for(int drawIndex = 0; drawIndex < drawList.getItemCount(); ++drawIndex) {
+			const UnitDrawItem &item = drawList.getItem(drawIndex);
+			Unit *unit = item.unit;
 
-			if(( airUnits==false && unit->getType()->getField()==fAir) || ( airUnits==true && unit->getType()->getField()!=fAir)){
+			if(item.airUnit != airUnits) {
 				continue;
 			}
-			meshCallbackTeamColor.setTeamTexture(unit->getFaction()->getTexture());
+			meshCallbackTeamColor.setTeamTexture(item.teamTexture);
 
 			if(modelRenderStarted == false) {
 				modelRenderStarted = true;
@@ -5362,27 +5388,14 @@ void Renderer::renderUnits(bool airUnits, const int renderFps) {
 			glMatrixMode(GL_MODELVIEW);
 			glPushMatrix();
 
-			//translate
-			Vec3f currVec= unit->getCurrVectorFlat();
-			glTranslatef(currVec.x, currVec.y, currVec.z);
-
-			//rotate
-			float zrot=unit->getRotationZ();
-			float xrot=unit->getRotationX();
-			if(zrot!=.0f){
-				glRotatef(zrot, 0.f, 0.f, 1.f);
-			}
-			if(xrot!=.0f){
-				glRotatef(xrot, 1.f, 0.f, 0.f);
-			}
-			glRotatef(unit->getRotation(), 0.f, 1.f, 0.f);
+			//translate and rotate
+			const Vec3f &currVec= item.currVec;
+			glMultMatrixf(item.worldMatrix.ptr());
 
 			//dead alpha
-			const SkillType *st= unit->getCurrSkill();
-			if(st->getClass() == scDie && static_cast<const DieSkillType*>(st)->getFade()) {
-				float alpha= 1.0f - unit->getAnimProgressAsFloat();
+			if(item.fadeAlpha >= 0.f) {
 				glDisable(GL_COLOR_MATERIAL);
-				glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, Vec4f(1.0f, 1.0f, 1.0f, alpha).ptr());
+				glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, Vec4f(1.0f, 1.0f, 1.0f, item.fadeAlpha).ptr());
 			}
 			else {
 				glEnable(GL_COLOR_MATERIAL);
@@ -5390,12 +5403,12 @@ void Renderer::renderUnits(bool airUnits, const int renderFps) {
 				glAlphaFunc(GL_GREATER, 0.02f);
 			}
 
-			//render
-			Model *model= unit->getCurrentModelPtr();
+			//render, the list is sorted so units sharing a pose only interpolate it once
+			Model *model= item.model;
 			//printf("Rendering model [%d - %s]\n[%s]\nCamera [%s]\nDistance: %f\n",unit->getId(),unit->getType()->getName().c_str(),unit->getCurrVector().getString().c_str(),this->gameCamera->getPos().getString().c_str(),this->gameCamera->getPos().dist(unit->getCurrVector()));
 
 			//if(this->gameCamera->getPos().dist(unit->getCurrVector()) <= SKIP_INTERPOLATION_DISTANCE) {
-				model->updateInterpolationData(unit->getAnimProgressAsFloat(), unit->isAlive() && !unit->isAnimProgressBound());
+				model->updateInterpolationData(item.animProgress, item.animCycle);
 			//}
 
 			modelRenderer->render(model);
@@ -7803,6 +7816,8 @@ vector<Unit *> Renderer::renderUnitsFast(bool renderingShadows, bool colorPickin
 			unitsList.reserve(qCache.visibleQuadUnitList.size());
 		}
 
+		const UnitDrawList &drawList = getUnitDrawList();
+
 		bool modelRenderStarted = false;
 		bool renderOnlyBuildings=true;
 		for(int k=0; k<2 ;k++) {
@@ -7818,20 +7833,20 @@ vector<Unit *> Renderer::renderUnitsFast(bool renderingShadows, bool colorPickin
 				//glEnable(GL_DEPTH_TEST);
 				renderOnlyBuildings=false;
 			}
-			for(int visibleUnitIndex = 0;
-					visibleUnitIndex < (int)qCache.visibleQuadUnitList.size(); ++visibleUnitIndex) {
-				Unit *unit = qCache.visibleQuadUnitList[visibleUnitIndex];
+			for(int drawIndex = 0; drawIndex < drawList.getItemCount(); ++drawIndex) {
+				const UnitDrawItem &item = drawList.getItem(drawIndex);
+				Unit *unit = item.unit;
 
-				if(renderingShadows==false && unit->isAlive()==false){
+				if(renderingShadows==false && item.alive==false){
 					// no need to render dead units for selection
 					continue;
 				}
 
-				if(renderOnlyBuildings==true && unit->getType()->hasSkillClass(scMove)){
+				if(renderOnlyBuildings==true && item.mobile){
 					continue;
 				}
 
-				if(renderOnlyBuildings==false && !unit->getType()->hasSkillClass(scMove)){
+				if(renderOnlyBuildings==false && !item.mobile){
 					continue;
 				}
 
@@ -7872,7 +7887,7 @@ vector<Unit *> Renderer::renderUnitsFast(bool renderingShadows, bool colorPickin
 				}
 
 				if(colorPickingSelection == false) {
-					glPushName(visibleUnitIndex);
+					glPushName(item.visibleIndex);
 				}
 
 				//assertGl();
@@ -7881,19 +7896,15 @@ vector<Unit *> Renderer::renderUnitsFast(bool renderingShadows, bool colorPickin
 				//debuxar modelo
 				glPushMatrix();
 
-				//translate
-				Vec3f currVec= unit->getCurrVectorFlat();
-				glTranslatef(currVec.x, currVec.y, currVec.z);
-
-				//rotate
-				glRotatef(unit->getRotation(), 0.f, 1.f, 0.f);
+				//translate and rotate
+				glMultMatrixf(item.headingMatrix.ptr());
 
 				//render
-				Model *model= unit->getCurrentModelPtr();
+				Model *model= item.model;
 				//if(this->gameCamera->getPos().dist(unit->getCurrVector()) <= SKIP_INTERPOLATION_DISTANCE) {
 
 					// ***MV don't think this is needed below 2013/01/11
-					model->updateInterpolationVertices(unit->getAnimProgressAsFloat(), unit->isAlive() && !unit->isAnimProgressBound());
+					model->updateInterpolationVertices(item.animProgress, item.animCycle);
 
 				//}
 
@@ -9142,6 +9153,15 @@ void Renderer::removeUnitFromQuadCache(const Unit *unit) {
 	}
 }
 
+//visible units prepared once per quad cache for every unit pass
+const UnitDrawList & Renderer::getUnitDrawList() {
+	VisibleQuadContainerCache &qCache = getQuadCache();
+	if(unitDrawList.isCurrent(qCache.visibleQuadUnitList, qCache.cacheFrame, qCache.lastVisibleQuad) == false) {
+		unitDrawList.prepare(qCache.visibleQuadUnitList, qCache.cacheFrame, qCache.lastVisibleQuad);
+	}
+	return unitDrawList;
+}
+
 VisibleQuadContainerCache & Renderer::getQuadCache(	bool updateOnDirtyFrame,
 													bool forceNew) {
 	//forceNew = true;
@@ -38,6 +38,7 @@
 #include "base_renderer.h"
 #include "simple_threads.h"
 #include "video_player.h"
+#include "unit_draw_list.h"
 
 #ifdef DEBUG_RENDERING_ENABLED
 #	define IF_DEBUG_EDITION(x) x
@@ -277,6 +278,7 @@ private:
 	Vec4f nearestLightPos;
 	VisibleQuadContainerCache quadCache;
 	VisibleQuadContainerCache quadCacheSelection;
+	UnitDrawList unitDrawList;
 
 	//renderers
 	ModelRenderer *modelRenderer;
@@ -475,6 +477,9 @@ public:
 	void endModel(ResourceScope rs, Model *model, bool mustExistInList=false);
 	void endLastModel(ResourceScope rs, bool mustExistInList=false);
 
+	void beginTextureDecodeBatch(ResourceScope rs);
+	void endTextureDecodeBatch(ResourceScope rs);
+
 	Texture2D *newTexture2D(ResourceScope rs);
 	Texture3D *newTexture3D(ResourceScope rs);
 	Font2D *newFont(ResourceScope rs);
@@ -629,6 +634,7 @@ public:
 	inline int getLastRenderFps() const { return lastRenderFps;}
 
 	VisibleQuadContainerCache & getQuadCache(bool updateOnDirtyFrame=true,bool forceNew=false);
+	const UnitDrawList & getUnitDrawList();
 	std::pair<bool,Vec3f> posInCellQuadCache(Vec2i pos);
 	//Vec3f getMarkedCellScreenPosQuadCache(Vec2i pos);
 	void updateMarkedCellScreenPosQuadCache(Vec2i pos);
@@ -0,0 +1,304 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martiño Figueroa
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "unit_draw_list.h"
+
+#include <algorithm>
+#include <cmath>
+#include "unit.h"
+#include "unit_type.h"
+#include "skill_type.h"
+#include "faction.h"
+#include "util.h"
+#include "platform_util.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Util;
+
+namespace Glest{ namespace Game{
+
+// =====================================================
+// 	class UnitDrawListThread
+// =====================================================
+
+UnitDrawListThread::UnitDrawListThread(UnitDrawList *drawList) : BaseThread() {
+	this->drawList= drawList;
+	this->masterController= NULL;
+	uniqueID= "UnitDrawListThread";
+}
+
+void UnitDrawListThread::setQuitStatus(bool value) {
+	BaseThread::setQuitStatus(value);
+	if(value == true) {
+		semTaskSignalled.signal();
+	}
+}
+
+void UnitDrawListThread::execute() {
+	RunningStatusSafeWrapper runningStatus(this);
+	try {
+		for(;this->drawList != NULL;) {
+			if(getQuitStatus() == true) {
+				break;
+			}
+
+			semTaskSignalled.waitTillSignalled();
+
+			static string masterSlaveOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			MasterSlaveThreadControllerSafeWrapper safeMasterController(masterController,20000,masterSlaveOwnerId);
+
+			if(getQuitStatus() == true) {
+				break;
+			}
+
+			while(drawList->computeNextTransforms() == true) {
+			}
+		}
+	}
+	catch(const exception &ex) {
+		SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s]\n",__FILE__,__FUNCTION__,__LINE__,ex.what());
+		throw megaglest_runtime_error(ex.what());
+	}
+	catch(...) {
+		char szBuf[8096]="";
+		snprintf(szBuf,8096,"In [%s::%s %d] UNKNOWN error\n",__FILE__,__FUNCTION__,__LINE__);
+		SystemFlags::OutputDebug(SystemFlags::debugError,szBuf);
+		throw megaglest_runtime_error(szBuf);
+	}
+}
+
+// =====================================================
+// 	class UnitDrawList
+// =====================================================
+
+UnitDrawList::UnitDrawList() {
+	valid= false;
+	frame= -1;
+	threadCount= 0;
+	mutex= new Mutex(CODE_AT_LINE);
+	nextItem= 0;
+	activeJobs= 0;
+	gatherMicros= 0;
+	transformMicros= 0;
+	sortMicros= 0;
+	prepareCount= 0;
+}
+
+UnitDrawList::~UnitDrawList() {
+	stopThreads();
+
+	delete mutex;
+	mutex= NULL;
+}
+
+void UnitDrawList::setThreadCount(int value) {
+	value= max(value, 0);
+	if(value != threadCount) {
+		stopThreads();
+		threadCount= value;
+	}
+}
+
+void UnitDrawList::startThreads() {
+	std::vector<SlaveThreadControllerInterface *> slaveThreadList;
+	for(int i = 0; i < threadCount; ++i) {
+		UnitDrawListThread *thread= new UnitDrawListThread(this);
+		thread->setUniqueID(string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__));
+		thread->start();
+
+		threads.push_back(thread);
+		slaveThreadList.push_back(thread);
+	}
+	masterController.setSlaves(slaveThreadList);
+}
+
+void UnitDrawList::stopThreads() {
+	//detach the slaves first so the quitting ones do not trigger the master
+	masterController.clearSlaves(false);
+
+	for(unsigned int i = 0; i < threads.size(); ++i) {
+		UnitDrawListThread *thread= threads[i];
+		thread->signalQuit();
+		if(thread->shutdownAndWait() == true) {
+			delete thread;
+		}
+	}
+	threads.clear();
+}
+
+void UnitDrawList::clear() {
+	items.clear();
+	sortedItems.clear();
+	valid= false;
+	frame= -1;
+}
+
+bool UnitDrawList::isCurrent(const vector<Unit *> &units, int frame, const Quad2i &visibleQuad) const {
+	if(valid == false || this->frame != frame || this->visibleQuad != visibleQuad ||
+		items.size() != units.size()) {
+		return false;
+	}
+	for(unsigned int i = 0; i < units.size(); ++i) {
+		if(items[i].unit != units[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void UnitDrawList::prepare(const vector<Unit *> &units, int frame, const Quad2i &visibleQuad) {
+	Chrono chrono;
+	chrono.start();
+
+	//animations pick their model with the global random generator and
+	//remember it in the unit so this part stays on the calling thread
+	gatherItems(units);
+	int64 gatherEnd= chrono.getMicros();
+
+	//only start helper threads when there is enough work to share
+	int workers= min(threadCount, (int)items.size() / minItemsPerThread);
+	if(workers > 0 && threads.empty() == true) {
+		startThreads();
+	}
+
+	static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+	MutexSafeWrapper safeMutex(mutex,mutexOwnerId);
+	nextItem= 0;
+	transformError= "";
+	safeMutex.ReleaseLock();
+
+	if(workers > 0) {
+		masterController.signalSlaves(NULL);
+	}
+	while(computeNextTransforms() == true) {
+	}
+	if(workers > 0 && masterController.waitTillSlavesTrigger(20000) == false) {
+		SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] draw list threads did not finish in time\n",__FILE__,__FUNCTION__,__LINE__);
+	}
+
+	//every job is claimed by now, the items can only be sorted once the
+	//ones a late helper thread picked up are done
+	safeMutex.Lock();
+	while(activeJobs > 0) {
+		safeMutex.ReleaseLock();
+		sleep(0);
+		safeMutex.Lock();
+	}
+	int64 transformEnd= chrono.getMicros();
+
+	string error= transformError;
+	safeMutex.ReleaseLock();
+	if(error != "") {
+		clear();
+		throw megaglest_runtime_error(error);
+	}
+
+	sortItems();
+	int64 sortEnd= chrono.getMicros();
+
+	this->valid= true;
+	this->frame= frame;
+	this->visibleQuad= visibleQuad;
+
+	gatherMicros+= gatherEnd;
+	transformMicros+= transformEnd - gatherEnd;
+	sortMicros+= sortEnd - transformEnd;
+	prepareCount++;
+
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled && prepareCount >= 100) {
+		SystemFlags::OutputDebug(SystemFlags::debugPerformance,"In [%s::%s Line: %d] %s\n",__FILE__,__FUNCTION__,__LINE__,getStats().c_str());
+		gatherMicros= 0;
+		transformMicros= 0;
+		sortMicros= 0;
+		prepareCount= 0;
+	}
+}
+
+void UnitDrawList::gatherItems(const vector<Unit *> &units) {
+	items.resize(units.size());
+	for(int i = 0; i < (int)units.size(); ++i) {
+		Unit *unit= units[i];
+		UnitDrawItem &item= items[i];
+
+		item.unit= unit;
+		item.visibleIndex= i;
+		item.model= unit->getCurrentModelPtr();
+		item.teamTexture= unit->getFaction()->getTexture();
+		item.animProgress= unit->getAnimProgressAsFloat();
+		item.alive= unit->isAlive();
+		item.animCycle= item.alive && !unit->isAnimProgressBound();
+		item.airUnit= (unit->getType()->getField() == fAir);
+		item.mobile= unit->getType()->hasSkillClass(scMove);
+
+		//dead alpha
+		item.fadeAlpha= -1.f;
+		const SkillType *st= unit->getCurrSkill();
+		if(st->getClass() == scDie && static_cast<const DieSkillType*>(st)->getFade()) {
+			item.fadeAlpha= 1.0f - item.animProgress;
+		}
+	}
+}
+
+bool UnitDrawList::computeNextTransforms() {
+	static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+	MutexSafeWrapper safeMutex(mutex,mutexOwnerId);
+	int first= nextItem;
+	int last= min(first + itemsPerJob, (int)items.size());
+	if(first >= last) {
+		return false;
+	}
+	nextItem= last;
+	activeJobs++;
+	safeMutex.ReleaseLock();
+
+	try {
+		for(int i = first; i < last; ++i) {
+			computeTransforms(items[i]);
+		}
+	}
+	catch(const exception &ex) {
+		safeMutex.Lock();
+		if(transformError == "") {
+			transformError= ex.what();
+		}
+		safeMutex.ReleaseLock();
+	}
+
+	safeMutex.Lock();
+	activeJobs--;
+	return true;
+}
+
+void UnitDrawList::computeTransforms(UnitDrawItem &item) {
+	Unit *unit= item.unit;
+	item.currVec= unit->getCurrVectorFlat();
+	computeMatrices(item.currVec, unit->getRotationZ(), unit->getRotationX(), unit->getRotation(),
+					item.worldMatrix, item.headingMatrix);
+}
+
+void UnitDrawList::sortItems() {
+	sortedItems.resize(items.size());
+	for(int i = 0; i < (int)items.size(); ++i) {
+		sortedItems[i]= i;
+	}
+	std::sort(sortedItems.begin(), sortedItems.end(), UnitDrawItemCompare(&items));
+}
+
+string UnitDrawList::getStats() const {
+	int count= max(prepareCount, 1);
+	char szBuf[8096]="";
+	snprintf(szBuf,8096,"Unit draw list: %d prepares, last %d units, gather %d us, transform %d us, sort %d us, threads %d",
+			prepareCount, (int)items.size(), (int)(gatherMicros / count),
+			(int)(transformMicros / count), (int)(sortMicros / count), (int)threads.size());
+	return szBuf;
+}
+
+}}//end namespace
@@ -0,0 +1,243 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martiño Figueroa
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _GLEST_GAME_UNITDRAWLIST_H_
+#define _GLEST_GAME_UNITDRAWLIST_H_
+
+#ifdef WIN32
+    #include <winsock2.h>
+    #include <winsock.h>
+#endif
+
+#include <vector>
+#include <string>
+#include <cmath>
+#include "vec.h"
+#include "matrix.h"
+#include "math_util.h"
+#include "model.h"
+#include "texture.h"
+#include "base_thread.h"
+#include "leak_dumper.h"
+
+using std::vector;
+using std::string;
+
+namespace Glest{ namespace Game{
+
+using ::Shared::Graphics::Vec3f;
+using ::Shared::Graphics::Matrix4f;
+using ::Shared::Graphics::Quad2i;
+using ::Shared::Graphics::Model;
+using ::Shared::Graphics::Texture;
+using ::Shared::PlatformCommon::BaseThread;
+using ::Shared::Platform::Mutex;
+using ::Shared::Platform::Semaphore;
+using ::Shared::Platform::SlaveThreadControllerInterface;
+using ::Shared::Platform::MasterSlaveThreadController;
+
+class Unit;
+class UnitDrawList;
+
+// ===========================================================
+//	class UnitDrawItem
+//
+///	One visible unit with everything the unit passes need to draw it
+// ===========================================================
+
+class UnitDrawItem {
+public:
+	Unit *unit;
+	int visibleIndex;
+	Model *model;
+	const Texture *teamTexture;
+	float animProgress;
+	bool animCycle;
+	bool airUnit;
+	bool mobile;
+	bool alive;
+	float fadeAlpha;			//below zero when the unit is not fading out
+
+	Vec3f currVec;
+	Matrix4f worldMatrix;		//position, ground tilt and heading, for glMultMatrixf
+	Matrix4f headingMatrix;		//position and heading only, for shadows and selection
+};
+
+// ===========================================================
+//	class UnitDrawItemCompare
+//
+///	Orders item indexes so units sharing render state, model and pose are
+///	drawn one after another, fading units go last as they are blended
+// ===========================================================
+
+class UnitDrawItemCompare {
+private:
+	const vector<UnitDrawItem> *items;
+
+public:
+	UnitDrawItemCompare(const vector<UnitDrawItem> *items) : items(items) {}
+
+	bool operator()(int index1, int index2) const {
+		const UnitDrawItem &item1= (*items)[index1];
+		const UnitDrawItem &item2= (*items)[index2];
+
+		bool fading1= (item1.fadeAlpha >= 0.f);
+		bool fading2= (item2.fadeAlpha >= 0.f);
+		if(fading1 != fading2) {
+			return fading2;
+		}
+		if(item1.model != item2.model) {
+			return item1.model < item2.model;
+		}
+		if(item1.animProgress != item2.animProgress) {
+			return item1.animProgress < item2.animProgress;
+		}
+		if(item1.animCycle != item2.animCycle) {
+			return item2.animCycle;
+		}
+		if(item1.teamTexture != item2.teamTexture) {
+			return item1.teamTexture < item2.teamTexture;
+		}
+		return item1.visibleIndex < item2.visibleIndex;
+	}
+};
+
+// ===========================================================
+//	class UnitDrawListThread
+// ===========================================================
+
+class UnitDrawListThread : public BaseThread, public SlaveThreadControllerInterface {
+protected:
+	UnitDrawList *drawList;
+	Semaphore semTaskSignalled;
+	MasterSlaveThreadController *masterController;
+
+	virtual void setQuitStatus(bool value);
+
+public:
+	UnitDrawListThread(UnitDrawList *drawList);
+	virtual void execute();
+
+	virtual void setMasterController(MasterSlaveThreadController *master)	{masterController= master;}
+	virtual void signalSlave(void *userdata)								{semTaskSignalled.signal();}
+};
+
+// ===========================================================
+//	class UnitDrawList
+//
+///	Prepares the visible units once per world frame and view: models and
+///	team textures are picked on the calling thread, the transforms are
+///	computed by worker threads and the result is sorted by state, model,
+///	animation and team texture. The shadow, main and selection passes all
+///	draw from it, consecutive units sharing a model pose then only
+///	interpolate it once. Nothing here touches OpenGL.
+// ===========================================================
+
+class UnitDrawList {
+private:
+	static const int minItemsPerThread= 32;
+	static const int itemsPerJob= 16;
+
+	vector<UnitDrawItem> items;
+	vector<int> sortedItems;
+
+	bool valid;
+	int frame;
+	Quad2i visibleQuad;
+
+	int threadCount;
+	vector<UnitDrawListThread *> threads;
+	MasterSlaveThreadController masterController;
+	Mutex *mutex;
+	int nextItem;
+	int activeJobs;
+	string transformError;
+
+	int64 gatherMicros;
+	int64 transformMicros;
+	int64 sortMicros;
+	int prepareCount;
+
+	void startThreads();
+	void stopThreads();
+	void gatherItems(const vector<Unit *> &units);
+	void computeTransforms(UnitDrawItem &item);
+	void sortItems();
+
+public:
+	UnitDrawList();
+	~UnitDrawList();
+
+	void setThreadCount(int value);
+	void clear();
+
+	bool isCurrent(const vector<Unit *> &units, int frame, const Quad2i &visibleQuad) const;
+	void prepare(const vector<Unit *> &units, int frame, const Quad2i &visibleQuad);
+	bool computeNextTransforms();
+
+	int getItemCount() const						{return (int)sortedItems.size();}
+	const UnitDrawItem &getItem(int index) const	{return items[sortedItems[index]];}
+
+	string getStats() const;
+
+	static void computeMatrices(const Vec3f &pos, float rotationZ, float rotationX, float rotationY,
+								Matrix4f &worldMatrix, Matrix4f &headingMatrix);
+};
+
+//same transforms the unit passes did with glTranslatef and glRotatef on
+//angles in degrees, stored column major for glMultMatrixf
+inline void UnitDrawList::computeMatrices(const Vec3f &pos, float rotationZ, float rotationX, float rotationY,
+										Matrix4f &worldMatrix, Matrix4f &headingMatrix) {
+	Matrix4f translation;
+	for(int i = 0; i < 16; ++i) {
+		translation[i]= (i % 5 == 0) ? 1.f : 0.f;
+	}
+	Matrix4f matrixZ= translation;
+	Matrix4f matrixX= translation;
+	Matrix4f matrixY= translation;
+
+	translation(0, 3)= pos.x;
+	translation(1, 3)= pos.y;
+	translation(2, 3)= pos.z;
+
+	float zrot= ::Shared::Graphics::degToRad(rotationZ);
+	float xrot= ::Shared::Graphics::degToRad(rotationX);
+	float yrot= ::Shared::Graphics::degToRad(rotationY);
+
+	matrixZ(0, 0)= std::cos(zrot);
+	matrixZ(0, 1)= -std::sin(zrot);
+	matrixZ(1, 0)= std::sin(zrot);
+	matrixZ(1, 1)= std::cos(zrot);
+
+	matrixX(1, 1)= std::cos(xrot);
+	matrixX(1, 2)= -std::sin(xrot);
+	matrixX(2, 1)= std::sin(xrot);
+	matrixX(2, 2)= std::cos(xrot);
+
+	matrixY(0, 0)= std::cos(yrot);
+	matrixY(0, 2)= std::sin(yrot);
+	matrixY(2, 0)= -std::sin(yrot);
+	matrixY(2, 2)= std::cos(yrot);
+
+	Matrix4f heading= translation * matrixY;
+	Matrix4f world= translation * matrixZ * matrixX * matrixY;
+
+	for(int i = 0; i < 4; ++i) {
+		for(int j = 0; j < 4; ++j) {
+			headingMatrix[j * 4 + i]= heading[i * 4 + j];
+			worldMatrix[j * 4 + i]= world[i * 4 + j];
+		}
+	}
+}
+
+}}//end namespace
+
+#endif
@@ -47,6 +47,8 @@
 #include "checksum.h"
 #include <algorithm>
 #include "sound_renderer.h"
+#include "sound_sample_cache.h"
+#include "map_info_index.h"
 #include "font_gl.h"
 #include "FileReader.h"
 #include "cache_manager.h"
@@ -74,6 +76,9 @@
 
 #ifndef WIN32
 #   include <poll.h>
+#   include <sys/wait.h>
+#   include <unistd.h>
+#   include <errno.h>
 
 #   define stricmp strcasecmp
 #   define strnicmp strncasecmp
@@ -314,6 +319,15 @@ namespace
         printf ("#4 IRCCLient Cache SHUTDOWN\n");
 
       cleanupCRCThread ();
+      MapInfoIndex::getInstance ()->stopBackgroundIndex ();
+      if (SystemFlags::getSystemSettingType (SystemFlags::debugPerformance).
+          enabled)
+        SystemFlags::OutputDebug (SystemFlags::debugPerformance,
+                                  "In [%s::%s Line: %d] sound samples %s\n",
+                                  __FILE__, __FUNCTION__, __LINE__,
+                                  ::Shared::Sound::SoundSampleCache::
+                                  getInstance ()->getStats ().c_str ());
+      ::Shared::Sound::SoundSampleCache::getInstance ()->stopDecodeThread ();
       if (SystemFlags::VERBOSE_MODE_ENABLED)
         printf ("In [%s::%s Line: %d]\n", __FILE__, __FUNCTION__, __LINE__);
 
@@ -3213,13 +3227,561 @@ namespace
         ("----------------------------------------------------------------");
     }
 
+    // results of validating one techtree, written as JSON when
+    // --validation-report is given. Everything except the timings is
+    // sorted so reports of unchanged data diff clean.
+    class TechValidationReport
+    {
+    public:
+      TechValidationReport ()
+      {
+        crc = -1;
+      }
+
+      string techPath;
+      string techName;
+      int64 crc;
+      set < string > factions;
+      vector < string > errors;
+      vector < string > unusedFiles;
+      std::map < uint32, vector < string > > duplicateFiles;
+      vector < pair < string, int64 > > phaseMillis;
+    };
+
+    string
+    escapeJSONString (const string & value)
+    {
+      string
+        result = "";
+      for (unsigned int index = 0; index < value.size (); ++index)
+      {
+        unsigned char
+          c = value[index];
+        if (c == '"' || c == '\\')
+        {
+          result += '\\';
+          result += c;
+        }
+        else if (c < 0x20)
+        {
+          char
+            szBuf[8] = "";
+          snprintf (szBuf, 8, "\\u%04x", c);
+          result += szBuf;
+        }
+        else
+        {
+          result += c;
+        }
+      }
+      return "\"" + result + "\"";
+    }
+
+    string
+    getJSONStringList (const vector < string > &values, string indent)
+    {
+      if (values.empty () == true)
+      {
+        return "[]";
+      }
+      string
+        result = "[\n";
+      for (unsigned int index = 0; index < values.size (); ++index)
+      {
+        result += indent + "  " + escapeJSONString (values[index]);
+        result += (index + 1 < values.size ()? ",\n" : "\n");
+      }
+      return result + indent + "]";
+    }
+
+    bool
+    writeTechValidationReport (const string & reportFile,
+                               const vector < TechValidationReport > &reports,
+                               int64 totalMillis, int jobs = 0)
+    {
+      string
+        json = "{\n  \"techtrees\": [";
+      for (unsigned int index = 0; index < reports.size (); ++index)
+      {
+        const TechValidationReport & report = reports[index];
+        json += (index > 0 ? ",\n" : "\n");
+        json += "    {\n";
+        json += "      \"name\": " + escapeJSONString (report.techName) + ",\n";
+        json += "      \"path\": " + escapeJSONString (report.techPath) + ",\n";
+        if (report.crc >= 0)
+        {
+          json += "      \"crc\": " + intToStr (report.crc) + ",\n";
+        }
+        json += "      \"factions\": " +
+          getJSONStringList (vector < string >
+                             (report.factions.begin (),
+                              report.factions.end ()), "      ") + ",\n";
+        json += "      \"errors\": " +
+          getJSONStringList (report.errors, "      ") + ",\n";
+        json += "      \"unused_files\": " +
+          getJSONStringList (report.unusedFiles, "      ") + ",\n";
+
+        json += "      \"duplicate_files\": [";
+        for (std::map < uint32, vector < string > >::const_iterator iterMap =
+             report.duplicateFiles.begin ();
+             iterMap != report.duplicateFiles.end (); ++iterMap)
+        {
+          json += (iterMap != report.duplicateFiles.begin ()? ",\n" : "\n");
+          json += "        { \"crc\": " + uIntToStr (iterMap->first) +
+            ", \"files\": " + getJSONStringList (iterMap->second,
+                                                 "        ") + " }";
+        }
+        json += (report.duplicateFiles.empty () == true ? "],\n" : "\n      ],\n");
+
+        json += "      \"phase_milliseconds\": {";
+        for (unsigned int phase = 0; phase < report.phaseMillis.size ();
+             ++phase)
+        {
+          json += (phase > 0 ? ", " : " ");
+          json += escapeJSONString (report.phaseMillis[phase].first) + ": " +
+            intToStr (report.phaseMillis[phase].second);
+        }
+        json += " }\n    }";
+      }
+      json += (reports.empty () == true ? "],\n" : "\n  ],\n");
+      if (jobs > 0)
+      {
+        json += "  \"jobs\": " + intToStr (jobs) + ",\n";
+      }
+      json += "  \"total_milliseconds\": " + intToStr (totalMillis) + "\n}\n";
+
+#if defined(WIN32) && !defined(__MINGW32__)
+      FILE *
+        fp = _wfopen (utf8_decode (reportFile).c_str (), L"w");
+      std::ofstream jsonFile (fp);
+#else
+      std::ofstream jsonFile;
+      jsonFile.open (reportFile.c_str (), ios_base::out | ios_base::trunc);
+#endif
+      bool
+        result = jsonFile.is_open ();
+      if (result == true)
+      {
+        jsonFile << json;
+        jsonFile.close ();
+      }
+#if defined(WIN32) && !defined(__MINGW32__)
+      if (fp)
+      {
+        fclose (fp);
+      }
+#endif
+
+      if (result == true)
+      {
+        printf ("\nValidation report written to [%s]\n", reportFile.c_str ());
+      }
+      else
+      {
+        printf ("\nCould not write validation report [%s]\n",
+                reportFile.c_str ());
+      }
+      return result;
+    }
+
+    // returns the file given with --validation-report or an empty string
+    string
+    getValidationReportFile (int argc, char **argv)
+    {
+      string
+        reportFile = "";
+      int
+        foundParamIndIndex = -1;
+      if (hasCommandArgument
+          (argc, argv,
+           string (GAME_ARGS[GAME_ARG_VALIDATION_REPORT]) + string ("="),
+           &foundParamIndIndex) == true)
+      {
+        string
+          paramValue = argv[foundParamIndIndex];
+        reportFile =
+          paramValue.substr (string (GAME_ARGS[GAME_ARG_VALIDATION_REPORT]).
+                             length () + 1);
+      }
+      return reportFile;
+    }
+
+    // returns the number given with --validation-jobs, the number of
+    // processors by default. Windows can't fork so it always uses 1.
+    int
+    getValidationJobs (int argc, char **argv)
+    {
+#if defined(WIN32)
+      return 1;
+#else
+      int
+        jobs = (int) sysconf (_SC_NPROCESSORS_ONLN);
+      int
+        foundParamIndIndex = -1;
+      if (hasCommandArgument
+          (argc, argv,
+           string (GAME_ARGS[GAME_ARG_VALIDATION_JOBS]) + string ("="),
+           &foundParamIndIndex) == true)
+      {
+        string
+          paramValue = argv[foundParamIndIndex];
+        jobs =
+          strToInt (paramValue.
+                    substr (string (GAME_ARGS[GAME_ARG_VALIDATION_JOBS]).
+                            length () + 1));
+      }
+      return max (jobs, 1);
+#endif
+    }
+
+#if !defined(WIN32)
+    // what a worker process found while loading and validating one
+    // faction
+    class FactionValidationResult
+    {
+    public:
+      string output;
+      string loadError;
+      vector < string > factionErrors;
+      vector < string > resourceErrors;
+      set < string > usedResourceTypes;
+      std::map < string, vector < pair < string, string > > > loadedFileList;
+    };
+
+    // the results go back to the main process as length prefixed fields
+    void
+    appendValidationField (string & data, const string & value)
+    {
+      data += intToStr ((int) value.size ()) + ":" + value;
+    }
+
+    string
+    readValidationField (const string & data, size_t & pos)
+    {
+      size_t
+        separator = data.find (':', pos);
+      if (separator == string::npos)
+      {
+        throw megaglest_runtime_error ("Invalid faction validation result");
+      }
+      int
+        size = strToInt (data.substr (pos, separator - pos));
+      if (size < 0 || (size_t) size > data.size () - separator - 1)
+      {
+        throw megaglest_runtime_error ("Invalid faction validation result");
+      }
+      pos = separator + 1 + size;
+      return data.substr (separator + 1, size);
+    }
+
+    void
+    appendValidationList (string & data, const vector < string > &values)
+    {
+      appendValidationField (data, intToStr ((int) values.size ()));
+      for (unsigned int index = 0; index < values.size (); ++index)
+      {
+        appendValidationField (data, values[index]);
+      }
+    }
+
+    vector < string > readValidationList (const string & data, size_t & pos)
+    {
+      int
+        count = strToInt (readValidationField (data, pos));
+      vector < string > values;
+      for (int index = 0; index < count; ++index)
+      {
+        values.push_back (readValidationField (data, pos));
+      }
+      return values;
+    }
+
+    string
+    encodeFactionValidationResult (const FactionValidationResult & result)
+    {
+      string
+        data = "";
+      appendValidationField (data, result.loadError);
+      appendValidationList (data, result.factionErrors);
+      appendValidationList (data, result.resourceErrors);
+      appendValidationList (data,
+                            vector < string >
+                            (result.usedResourceTypes.begin (),
+                             result.usedResourceTypes.end ()));
+
+      appendValidationField (data,
+                             intToStr ((int) result.loadedFileList.size ()));
+      for (std::map < string, vector < pair < string,
+           string > > >::const_iterator iterMap =
+           result.loadedFileList.begin ();
+           iterMap != result.loadedFileList.end (); ++iterMap)
+      {
+        appendValidationField (data, iterMap->first);
+        vector < string > loaders;
+        for (unsigned int index = 0; index < iterMap->second.size (); ++index)
+        {
+          loaders.push_back (iterMap->second[index].first);
+          loaders.push_back (iterMap->second[index].second);
+        }
+        appendValidationList (data, loaders);
+      }
+      return data;
+    }
+
+    void
+    decodeFactionValidationResult (const string & data,
+                                   FactionValidationResult & result)
+    {
+      size_t
+        pos = 0;
+      result.loadError = readValidationField (data, pos);
+      result.factionErrors = readValidationList (data, pos);
+      result.resourceErrors = readValidationList (data, pos);
+      vector < string > usedResourceTypes = readValidationList (data, pos);
+      result.usedResourceTypes.insert (usedResourceTypes.begin (),
+                                       usedResourceTypes.end ());
+
+      int
+        fileCount = strToInt (readValidationField (data, pos));
+      for (int fileIndex = 0; fileIndex < fileCount; ++fileIndex)
+      {
+        string
+          file = readValidationField (data, pos);
+        vector < string > loaders = readValidationList (data, pos);
+        vector < pair < string, string > > &fileLoaders =
+          result.loadedFileList[file];
+        for (unsigned int index = 0; index + 1 < loaders.size (); index += 2)
+        {
+          fileLoaders.push_back (make_pair (loaders[index],
+                                            loaders[index + 1]));
+        }
+      }
+    }
+
+    string
+    readWholeFile (FILE * file)
+    {
+      string
+        data = "";
+      fflush (file);
+      if (fseek (file, 0, SEEK_SET) == 0)
+      {
+        char
+          buffer[8096];
+        size_t
+          readBytes = 0;
+        while ((readBytes = fread (buffer, 1, sizeof (buffer), file)) > 0)
+        {
+          data.append (buffer, readBytes);
+        }
+      }
+      return data;
+    }
+
+    // runs in a forked copy of this process, which shares the techtree
+    // data loaded before the fork. The worker loads and validates one
+    // faction, writes what it prints to outputFile and its results to
+    // resultFile, then exits without running destructors: those would
+    // tear down the window it shares with the main process.
+    void
+    runFactionValidationWorker (World & world, const string & factionName,
+                                FILE * outputFile, FILE * resultFile)
+    {
+      GlobalStaticFlags::setFlag (gsft_no_window);
+      dup2 (fileno (outputFile), STDOUT_FILENO);
+
+      FactionValidationResult result;
+      try
+      {
+        Checksum
+          checksum;
+        set < string > factions;
+        factions.insert (factionName);
+        world.loadFactionTypes (factions, &checksum, result.loadedFileList,
+                                true);
+        result.factionErrors = world.validateFactionTypes ();
+        result.resourceErrors =
+          world.validateFactionResourceTypes (result.usedResourceTypes);
+      }
+      catch (const exception & ex)
+      {
+        result.loadError = ex.what ();
+      }
+
+      string
+        data = encodeFactionValidationResult (result);
+      int
+        exitCode = (fwrite (data.data (), 1, data.size (), resultFile) ==
+                    data.size () && fflush (resultFile) == 0 ? 0 : 1);
+      fflush (stdout);
+      _exit (exitCode);
+    }
+
+    // loads and validates the factions of the techtree loaded into world
+    // with up to jobs worker processes at a time. What the workers print
+    // and find is used in faction order, so the output is the same as
+    // when the factions are loaded one after another.
+    void
+    validateFactionsInWorkers (World & world, const set < string > &factions,
+                               int jobs,
+                               std::map < string, vector < pair < string,
+                               string > > >&loadedFileList,
+                               vector < string > &factionErrors,
+                               vector < string > &resourceErrors)
+    {
+      vector < string > factionNames (factions.begin (), factions.end ());
+      vector < FactionValidationResult > results (factionNames.size ());
+      vector < FILE * >outputFiles (factionNames.size (), (FILE *) NULL);
+      vector < FILE * >resultFiles (factionNames.size (), (FILE *) NULL);
+      std::map < pid_t, int >workers;
+
+      unsigned int
+        nextFaction = 0;
+      while (nextFaction < factionNames.size () || workers.empty () == false)
+      {
+        if (nextFaction < factionNames.size () && (int) workers.size () < jobs)
+        {
+          int
+            index = nextFaction++;
+          outputFiles[index] = tmpfile ();
+          resultFiles[index] = tmpfile ();
+          pid_t
+            pid = -1;
+          if (outputFiles[index] != NULL && resultFiles[index] != NULL)
+          {
+            fflush (stdout);
+            pid = fork ();
+            if (pid == 0)
+            {
+              runFactionValidationWorker (world, factionNames[index],
+                                          outputFiles[index],
+                                          resultFiles[index]);
+            }
+          }
+          if (pid > 0)
+          {
+            workers[pid] = index;
+          }
+          else
+          {
+            results[index].loadError =
+              "Could not start the validation of faction [" +
+              factionNames[index] + "]";
+          }
+          continue;
+        }
+
+        int
+          status = 0;
+        pid_t
+          pid = waitpid (-1, &status, 0);
+        if (pid < 0)
+        {
+          if (errno == EINTR)
+          {
+            continue;
+          }
+          // the workers can't be waited for, report them as failed
+          for (std::map < pid_t, int >::iterator iterMap = workers.begin ();
+               iterMap != workers.end (); ++iterMap)
+          {
+            results[iterMap->second].loadError =
+              "Lost the validation of faction [" +
+              factionNames[iterMap->second] + "]";
+          }
+          workers.clear ();
+          continue;
+        }
+
+        std::map < pid_t, int >::iterator iterFind = workers.find (pid);
+        if (iterFind == workers.end ())
+        {
+          continue;
+        }
+        int
+          index = iterFind->second;
+        workers.erase (iterFind);
+
+        FactionValidationResult & result = results[index];
+        result.output = readWholeFile (outputFiles[index]);
+        if (WIFEXITED (status) && WEXITSTATUS (status) == 0)
+        {
+          try
+          {
+            decodeFactionValidationResult (readWholeFile
+                                           (resultFiles[index]), result);
+          }
+          catch (const megaglest_runtime_error & ex)
+          {
+            result.loadError = ex.what ();
+          }
+        }
+        else
+        {
+          result.loadError =
+            "The validation of faction [" + factionNames[index] +
+            "] stopped unexpectedly";
+        }
+      }
+
+      for (unsigned int index = 0; index < factionNames.size (); ++index)
+      {
+        if (outputFiles[index] != NULL)
+        {
+          fclose (outputFiles[index]);
+        }
+        if (resultFiles[index] != NULL)
+        {
+          fclose (resultFiles[index]);
+        }
+      }
+
+      // a sequential load stops at the first faction that fails
+      set < string > usedResourceTypes;
+      for (unsigned int index = 0; index < results.size (); ++index)
+      {
+        FactionValidationResult & result = results[index];
+        printf ("%s", result.output.c_str ());
+        if (result.loadError != "")
+        {
+          throw megaglest_runtime_error (result.loadError, true);
+        }
+
+        for (std::map < string, vector < pair < string,
+             string > > >::iterator iterMap = result.loadedFileList.begin ();
+             iterMap != result.loadedFileList.end (); ++iterMap)
+        {
+          vector < pair < string, string > > &fileLoaders =
+            loadedFileList[iterMap->first];
+          fileLoaders.insert (fileLoaders.end (), iterMap->second.begin (),
+                              iterMap->second.end ());
+        }
+        factionErrors.insert (factionErrors.end (),
+                              result.factionErrors.begin (),
+                              result.factionErrors.end ());
+        resourceErrors.insert (resourceErrors.end (),
+                               result.resourceErrors.begin (),
+                               result.resourceErrors.end ());
+        usedResourceTypes.insert (result.usedResourceTypes.begin (),
+                                  result.usedResourceTypes.end ());
+      }
+
+      vector < string > unusedErrors =
+        world.validateResourceTypesUsed (usedResourceTypes);
+      resourceErrors.insert (resourceErrors.end (), unusedErrors.begin (),
+                             unusedErrors.end ());
+    }
+#endif
+
     void
     runTechValidationForPath (string techPath, string techName,
                               const std::vector < string >
                               &filteredFactionList, World & world,
                               bool purgeUnusedFiles, bool purgeDuplicateFiles,
                               bool showDuplicateFiles, bool gitPurgeFiles,
-                              double &purgedMegaBytes)
+                              double &purgedMegaBytes,
+                              vector < TechValidationReport > *reports,
+                              int validationJobs)
     {
 
       string
@@ -3266,6 +3828,19 @@ namespace
           bool
             techtree_errors = false;
 
+          TechValidationReport *
+            report = NULL;
+          if (reports != NULL)
+          {
+            reports->push_back (TechValidationReport ());
+            report = &reports->back ();
+            report->techPath = techPath;
+            report->techName = techName;
+            report->factions = factions;
+          }
+          Chrono
+            phaseChrono (true);
+
           std::map < string, vector < pair < string,
             string > > >loadedFileList;
           vector < string > pathList;
@@ -3278,8 +3853,36 @@ namespace
 
           try
           {
-            world.loadTech (pathList, techName, factions, &checksum,
-                            loadedFileList, true);
+// Load the techtree once and let worker processes load the factions
+            bool
+              usedWorkers = false;
+            vector < string > workerFactionErrors;
+            vector < string > workerResourceErrors;
+#if !defined(WIN32)
+            if (validationJobs > 1 && factions.size () > 1)
+            {
+              set < string > noFactions;
+              world.loadTech (pathList, techName, noFactions, &checksum,
+                              loadedFileList, true);
+              validateFactionsInWorkers (world, factions, validationJobs,
+                                         loadedFileList, workerFactionErrors,
+                                         workerResourceErrors);
+              usedWorkers = true;
+            }
+#endif
+            if (usedWorkers == false)
+            {
+              world.loadTech (pathList, techName, factions, &checksum,
+                              loadedFileList, true);
+            }
+
+            if (report != NULL)
+            {
+              report->phaseMillis.push_back (make_pair ("load",
+                                                        phaseChrono.
+                                                        getMillis ()));
+              phaseChrono.reset ();
+            }
 
 // Fixup paths with ..
             {
@@ -3335,10 +3938,17 @@ namespace
 
 // Validate the faction setup to ensure we don't have any bad associations
             std::vector < std::string > resultErrors =
-              world.validateFactionTypes ();
+              (usedWorkers == true ? workerFactionErrors :
+               world.validateFactionTypes ());
             if (resultErrors.empty () == false)
             {
               techtree_errors = true;
+              if (report != NULL)
+              {
+                report->errors.insert (report->errors.end (),
+                                       resultErrors.begin (),
+                                       resultErrors.end ());
+              }
 // Display the validation errors
               string
                 errorText =
@@ -3367,10 +3977,18 @@ namespace
                       c_str ());
             }
 
-            resultErrors = world.validateResourceTypes ();
+            resultErrors =
+              (usedWorkers == true ? workerResourceErrors :
+               world.validateResourceTypes ());
             if (resultErrors.empty () == false)
             {
               techtree_errors = true;
+              if (report != NULL)
+              {
+                report->errors.insert (report->errors.end (),
+                                       resultErrors.begin (),
+                                       resultErrors.end ());
+              }
 // Display the validation errors
               string
                 errorText =
@@ -3387,6 +4005,14 @@ namespace
               printf ("%s", errorText.c_str ());
             }
 
+            if (report != NULL)
+            {
+              report->phaseMillis.push_back (make_pair ("validate",
+                                                        phaseChrono.
+                                                        getMillis ()));
+              phaseChrono.reset ();
+            }
+
 // Now check for unused files in the techtree
             std::map < string, vector < pair < string,
               string > > >foundFileList;
@@ -3487,6 +4113,10 @@ namespace
                 foundUnusedFile = true;
 
                 printf ("[%s]\n", foundFile.c_str ());
+                if (report != NULL)
+                {
+                  report->unusedFiles.push_back (foundFile);
+                }
 
                 string
                   fileName = extractFileFromDirectoryPath (foundFile);
@@ -3537,9 +4167,30 @@ namespace
                  __LINE__);
             }
 
+            if (report != NULL)
+            {
+              report->phaseMillis.push_back (make_pair ("unused_files",
+                                                        phaseChrono.
+                                                        getMillis ()));
+              phaseChrono.reset ();
+            }
+
             if (showDuplicateFiles == true)
             {
               std::map < uint32, vector < string > >mapDuplicateFiles;
+// Hash all files at once so they are spread over the hash threads,
+// the per file checksums below then come from the cache
+              {
+                Checksum
+                  allFilesChecksum;
+                for (std::map < string, vector < pair < string,
+                     string > > >::iterator iterMap = loadedFileList.begin ();
+                     iterMap != loadedFileList.end (); ++iterMap)
+                {
+                  allFilesChecksum.addFile (iterMap->first);
+                }
+                allFilesChecksum.getSum ();
+              }
 // Now check for duplicate data content
               for (std::map < string, vector < pair < string,
                    string > > >::iterator iterMap = loadedFileList.begin ();
@@ -3584,6 +4235,10 @@ namespace
                 vector < string > &fileList = iterMap->second;
                 if (fileList.size () > 1)
                 {
+                  if (report != NULL)
+                  {
+                    report->duplicateFiles[iterMap->first] = fileList;
+                  }
                   if (foundDuplicates == false)
                   {
                     foundDuplicates = true;
@@ -4029,11 +4684,22 @@ namespace
 
                 printf ("\nWarning, duplicate files were detected - END:\n");
               }
+
+              if (report != NULL)
+              {
+                report->phaseMillis.push_back (make_pair ("duplicate_files",
+                                                          phaseChrono.
+                                                          getMillis ()));
+              }
             }
           }
           catch (const megaglest_runtime_error & ex)
           {
             techtree_errors = true;
+            if (report != NULL)
+            {
+              report->errors.push_back (ex.what ());
+            }
             printf
               ("\n\n****ERROR**** detected while validating the techName: %s\nMESSAGE: %s\n",
                techName.c_str (), ex.what ());
@@ -4409,6 +5075,14 @@ namespace
         purgedMegaBytes = 0;
       Config & config = Config::getInstance ();
 
+      string
+        reportFile = getValidationReportFile (argc, argv);
+      vector < TechValidationReport > reports;
+      int
+        validationJobs = getValidationJobs (argc, argv);
+      Chrono
+        reportChrono (true);
+
 // Did the user pass a specific scenario to validate?
       if (hasCommandArgument
           (argc, argv,
@@ -4506,7 +5180,10 @@ namespace
                                               filteredFactionList, world,
                                               purgeUnusedFiles,
                                               showDuplicateFiles, false,
-                                              false, purgedMegaBytes);
+                                              false, purgedMegaBytes,
+                                              (reportFile !=
+                                               "" ? &reports : NULL),
+                                              validationJobs);
                   }
                   else
                   {
@@ -4527,7 +5204,10 @@ namespace
                                                   filteredFactionList, world,
                                                   purgeUnusedFiles,
                                                   showDuplicateFiles, false,
-                                                  false, purgedMegaBytes);
+                                                  false, purgedMegaBytes,
+                                                  (reportFile !=
+                                                   "" ? &reports : NULL),
+                                                  validationJobs);
 
                         break;
                       }
@@ -4542,6 +5222,12 @@ namespace
               printf ("\nWARNING, the scenario [%s] was NOT FOUND!\n",
                       validateScenarioName.c_str ());
             }
+            if (reportFile != "")
+            {
+              writeTechValidationReport (reportFile, reports,
+                                         reportChrono.getMillis (),
+                                         validationJobs);
+            }
             printf ("\n====== Finished Validation ======\n");
           }
           return;
@@ -4742,11 +5428,20 @@ namespace
                                         filteredFactionList, world,
                                         purgeUnusedFiles, purgeDuplicateFiles,
                                         showDuplicateFiles, gitPurgeFiles,
-                                        purgedMegaBytes);
+                                        purgedMegaBytes,
+                                        (reportFile !=
+                                         "" ? &reports : NULL),
+                                        validationJobs);
             }
           }
         }
 
+        if (reportFile != "")
+        {
+          writeTechValidationReport (reportFile, reports,
+                                     reportChrono.getMillis (),
+                                     validationJobs);
+        }
         printf ("\n====== Finished Validation ======\n");
       }
 
@@ -5875,6 +6570,8 @@ namespace
             itemName = paramPartTokens[1];
 
           Config & config = Config::getInstance ();
+          Chrono
+            crcChrono (true);
           uint32
             crcValue =
             getFolderTreeContentsCheckSumRecursively
@@ -5885,6 +6582,22 @@ namespace
             printf ("CRC value for techtree [%s] is [%u]\n",
                     itemName.c_str (), crcValue);
 
+            string
+              reportFile = getValidationReportFile (argc, argv);
+            if (reportFile != "")
+            {
+              vector < TechValidationReport > reports;
+              reports.push_back (TechValidationReport ());
+              reports.back ().techName = itemName;
+              reports.back ().crc = crcValue;
+              reports.back ().phaseMillis.push_back (make_pair ("crc",
+                                                                crcChrono.
+                                                                getMillis
+                                                                ()));
+              writeTechValidationReport (reportFile, reports,
+                                         crcChrono.getMillis ());
+            }
+
             return_value = 0;
           }
           else
@@ -7160,6 +7873,25 @@ namespace
           config.getInt ("ShutdownFadeSoundMilliseconds",
                          intToStr (shutdownFadeSoundMilliseconds).c_str ());
 
+        // worker threads decoding model textures while a game loads,
+        // 0 loads them on the main thread
+        TextureManager::setDecodeThreadCount (config.getInt
+                                              ("TextureDecodeThreads",
+                                               "2"));
+
+        // threads hashing files for techtree, map and scenario CRCs,
+        // 1 hashes them on the calling thread
+        Checksum::setFileHashThreadCount (config.getInt
+                                          ("FileHashThreads", "4"));
+
+        // decode skill sounds on first play instead of while loading and
+        // optionally cap the decoded sample memory, 0 is unlimited
+        ::Shared::Sound::SoundSampleCache::getInstance ()->
+          setLazyDecode (config.getBool ("LazySoundDecode", "false"));
+        ::Shared::Sound::SoundSampleCache::getInstance ()->
+          setMemoryBudget ((int64) config.getInt ("SoundSampleCacheMegabytes",
+                                                  "0") * 1024 * 1024);
+
         string
           userData = config.getString ("UserData_Root", "");
         if (getGameReadWritePath (GameConstants::path_logs_CacheLookupKey) !=
@@ -7205,6 +7937,18 @@ namespace
         }
         setCRCCacheFilePath (crcCachePath);
 
+        // decoded png/jpg textures kept on disk to skip decoding next run
+        if (config.getBool ("TextureCache", "false") == true)
+        {
+          string
+            pixmapCachePath = crcCachePath + "textures/";
+          if (isdir (pixmapCachePath.c_str ()) == false)
+          {
+            createDirectoryPaths (pixmapCachePath);
+          }
+          Pixmap2DCache::setCachePath (pixmapCachePath);
+        }
+
         string
           savedGamePath = userData + "saved/";
         if (isdir (savedGamePath.c_str ()) == false)
@@ -7637,6 +8381,11 @@ namespace
 // Set some statics based on ini entries
         SystemFlags::ENABLE_THREADED_LOGGING =
           config.getBool ("ThreadedLogging", "true");
+        LogFileThread::setRingBufferCapacity (config.getInt
+                                              ("ThreadedLoggingMaxEntriesPerThread",
+                                               intToStr (LogFileThread::
+                                                         getRingBufferCapacity
+                                                         ()).c_str ()));
         FontGl::setDefault_fontType (config.getString ("DefaultFont",
                                                        FontGl::
                                                        getDefault_fontType ().
@@ -7804,6 +8553,13 @@ namespace
             printf ("**INFO** Disabling Interpolation\n");
         }
 
+        if (config.getBool ("QuantizeModelKeyframes", "false") == true)
+        {
+          Mesh::setQuantizeKeyframes (true);
+          if (SystemFlags::VERBOSE_MODE_ENABLED)
+            printf ("**INFO** Quantizing model keyframes\n");
+        }
+
 
         if (config.getBool ("EnableVSynch", "false") == true)
         {
@@ -8625,6 +9381,9 @@ namespace
                       keepsmallest);
             }
 
+            // converted models are written back, keep their float keyframes
+            Mesh::setQuantizeKeyframes (false);
+
             showCursor (true);
 
             const
@@ -8712,6 +9471,10 @@ namespace
                         "]\n", file.c_str (), i, models.size ());
                 Model *
                   model = renderer.newModel (rsGlobal, file);
+                string
+                  optimizeReport = model->optimizeMeshes ();
+                printf ("Optimized model [%s] %s\n", file.c_str (),
+                        optimizeReport.c_str ());
                 printf ("About to save converted model [%s]\n",
                         file.c_str ());
                 model->save (file, textureFormat, keepsmallest);
@@ -8839,6 +9602,16 @@ namespace
           preCacheThread->start ();
         }
 
+        // map sizes, player counts and CRCs kept between runs so the lobby
+        // map lists don't have to open every map file
+        MapInfoIndex::getInstance ()->load (getCRCCacheFilePath () +
+                                            "mapinfo.idx");
+        if (config.getBool ("PreCacheMapInfoThread", "true") == true)
+        {
+          MapInfoIndex::getInstance ()->
+            startBackgroundIndex (config.getPathListForType (ptMaps, ""));
+        }
+
         auto_ptr < NavtiveLanguageNameListCacheGenerator > lngCacheGen;
         auto_ptr < SimpleTaskThread > languageCacheGen;
 
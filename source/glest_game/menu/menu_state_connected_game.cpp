@@ -39,6 +39,7 @@
 #include "cache_manager.h"
 #include "string_utils.h"
 #include "map_preview.h"
+#include "map_info_index.h"
 #include <iterator>
 #include "compression_utils.h"
 
@@ -3804,12 +3805,11 @@ namespace Glest
         {
           if (lastCheckedCRCMapName != gameSettings->getMap ())
           {
-            Checksum checksum;
             string
               file = Config::getMapPath (gameSettings->getMap (), "", false);
 //console.addLine("Checking map CRC [" + file + "]");
-            checksum.addFile (file);
-            lastCheckedCRCMapValue = checksum.getSum ();
+            lastCheckedCRCMapValue =
+              MapInfoIndex::getInstance ()->getMapCRC (file);
             lastCheckedCRCMapName = gameSettings->getMap ();
           }
           gameSettings->setMapCRC (lastCheckedCRCMapValue);
@@ -5036,14 +5036,12 @@ namespace Glest
             if (lastCheckedCRCMapName != displayedGamesettings.getMap () &&
                 displayedGamesettings.getMap () != "")
             {
-              Checksum checksum;
               string
                 file =
                 Config::getMapPath (displayedGamesettings.getMap (), "",
                                     false);
 //console.addLine("Checking map CRC [" + file + "]");
-              checksum.addFile (file);
-              mapCRC = checksum.getSum ();
+              mapCRC = MapInfoIndex::getInstance ()->getMapCRC (file);
 // Test data synch
 //mapCRC++;
 
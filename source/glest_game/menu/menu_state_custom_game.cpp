@@ -44,6 +44,7 @@
 #include "cache_manager.h"
 #include <iterator>
 #include "map_preview.h"
+#include "map_info_index.h"
 #include "gen_uuid.h"
 #include "leak_dumper.h"
 
@@ -5111,12 +5112,11 @@ namespace Glest
 
         if (lastCheckedCRCMapName != gameSettings->getMap ())
         {
-          Checksum checksum;
           string file =
             Config::getMapPath (gameSettings->getMap (), "", false);
 //console.addLine("Checking map CRC [" + file + "]");
-          checksum.addFile (file);
-          lastCheckedCRCMapValue = checksum.getSum ();
+          lastCheckedCRCMapValue =
+            MapInfoIndex::getInstance ()->getMapCRC (file);
           lastCheckedCRCMapName = gameSettings->getMap ();
         }
         gameSettings->setMapCRC (lastCheckedCRCMapValue);
@@ -53,6 +53,8 @@ const bool debugClientInterfacePerf = false;
 const int ClientInterface::messageWaitTimeout					= 10000;	//10 seconds
 const int ClientInterface::waitSleepTime						= 10;
 const int ClientInterface::maxNetworkCommandListSendTimeWait 	= 5;
+const int ClientInterface::networkCommandListWaitTimeout		= 250;
+const int ClientInterface::messageWaitSliceMicroseconds		= 20000;	//20 milliseconds
 
 // =====================================================
 //	class ClientInterfaceThread
@@ -195,6 +197,7 @@ ClientInterface::ClientInterface() : GameNetworkInterface() {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] constructor for %p\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,this);
 
 	networkCommandListThreadAccessor 	= new Mutex(CODE_AT_LINE);
+	networkCommandListTrigger 			= new Trigger(networkCommandListThreadAccessor);
 	networkCommandListThread 			= NULL;
 	cachedPendingCommandsIndex 			= 0;
 	cachedLastPendingFrameCount 		= 0;
@@ -341,6 +344,11 @@ ClientInterface::~ClientInterface() {
 
 	//printf("C === Client destructor\n");
 
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled) SystemFlags::OutputDebug(SystemFlags::debugPerformance,"In [%s::%s Line: %d] frame wait %s\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,frameWaitHistogram.toString().c_str());
+
+	delete networkCommandListTrigger;
+	networkCommandListTrigger = NULL;
+
 	networkCommandListThreadAccessor = NULL;
 	safeMutex.ReleaseLock(false,true);
 
@@ -364,6 +372,11 @@ bool ClientInterface::getQuitThread() {
 void ClientInterface::setQuitThread(bool value) {
 	MutexSafeWrapper safeMutex(quitThreadAccessor,CODE_AT_LINE);
 	this->quitThread = value;
+	safeMutex.ReleaseLock();
+
+	if(value == true) {
+		signalNetworkCommandListWaiters();
+	}
 }
 
 bool ClientInterface::getQuit() {
@@ -373,6 +386,18 @@ bool ClientInterface::getQuit() {
 void ClientInterface::setQuit(bool value) {
 	MutexSafeWrapper safeMutex(quitThreadAccessor,CODE_AT_LINE);
 	this->quit = value;
+	safeMutex.ReleaseLock();
+
+	if(value == true) {
+		signalNetworkCommandListWaiters();
+	}
+}
+
+// Wakes the game thread if it is blocked in getNetworkCommand
+void ClientInterface::signalNetworkCommandListWaiters() {
+	if(networkCommandListTrigger != NULL) {
+		networkCommandListTrigger->signal(true);
+	}
 }
 
 bool ClientInterface::getJoinGameInProgress() {
@@ -1208,6 +1233,8 @@ void ClientInterface::updateFrame(int *checkFrame) {
 							}
 						}
 					}
+					// Wake the game thread waiting for this frame
+					networkCommandListTrigger->signal(true);
 					safeMutex.ReleaseLock();
 
 					done = true;
@@ -1413,6 +1440,11 @@ int64 ClientInterface::getTimeClientWaitedForLastMessage() {
 	return result;
 }
 
+string ClientInterface::getFrameWaitHistogramReport() {
+	MutexSafeWrapper safeMutex(networkCommandListThreadAccessor,CODE_AT_LINE);
+	return frameWaitHistogram.toString();
+}
+
 bool ClientInterface::getNetworkCommand(int frameCount, int currentCachedPendingCommandsIndex) {
 	bool result 							= false;
 	bool waitForData 						= false;
@@ -1477,26 +1509,28 @@ bool ClientInterface::getNetworkCommand(int frameCount, int currentCachedPending
 					timeClientWaitedForLastMessage = chrono.getMillis();
 					chrono.stop();
 				}
+				frameWaitHistogram.addSample(timeClientWaitedForLastMessage);
 				safeMutex.ReleaseLock(true);
 
 				result = true;
 				break;
 			}
 			else {
-				safeMutex.ReleaseLock(true);
 				// No data for this frame
 				if(waitForData == false) {
 					if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Client waiting for packet for frame: %d, copyCachedLastPendingFrameCount = %lld\n",frameCount,(long long int)copyCachedLastPendingFrameCount);
 					chrono.start();
 				}
 				if(copyCachedLastPendingFrameCount > frameCountAsUInt64) {
+					safeMutex.ReleaseLock(true);
 					break;
 				}
+				waitForData = true;
 
-				if(waitForData == false) {
-					waitForData = true;
-					sleep(0);
-				}
+				// Block until the network thread has cached a new command
+				// list, the timeout only lets us re-check the quit flags
+				networkCommandListTrigger->waitTillSignalled(networkCommandListThreadAccessor,networkCommandListWaitTimeout);
+				safeMutex.ReleaseLock(true);
 
 				waitCount++;
 				//printf("Client waiting for packet for frame: %d, currentCachedPendingCommandsIndex = %d, cachedPendingCommandsIndex = %lld\n",frameCount,currentCachedPendingCommandsIndex,(long long int)cachedPendingCommandsIndex);
@@ -1793,8 +1827,14 @@ void ClientInterface::waitUntilReady(Checksum* checksum) {
 			}
 
 			Shared::Platform::Window::handleEvent();
-			// sleep a bit
-			sleep(waitSleepTime);
+			// wait a bit, returning early as soon as the server sends data
+			Socket *socket = getSocket(false);
+			if(socket != NULL) {
+				Socket::hasDataToReadWithWait(socket->getSocketId(),waitSleepTime * 1000);
+			}
+			else {
+				sleep(waitSleepTime);
+			}
 		}
 	}
 
@@ -1983,12 +2023,14 @@ NetworkMessageType ClientInterface::waitForMessage(int waitMicroseconds)
 	chrono.start();
 
 	NetworkMessageType msg = nmtInvalid;
+	bool socketSignalled = false;
 	while(	msg == nmtInvalid &&
 			getQuitThread() == false) {
 
 		msg = getNextMessageType(waitMicroseconds);
 		if(msg == nmtInvalid) {
-			if(getSocket() == NULL || (chrono.getMillis() % 250 == 0 && isConnected() == false)) {
+			// A readable socket with no message means the peer went away
+			if(getSocket() == NULL || ((socketSignalled == true || chrono.getMillis() % 250 == 0) && isConnected() == false)) {
 				if(getQuit() == false) {
 					//throw megaglest_runtime_error("Disconnected");
 					//sendTextMessage("Server has Disconnected.",-1);
@@ -2022,12 +2064,13 @@ NetworkMessageType ClientInterface::waitForMessage(int waitMicroseconds)
 				close();
 				return msg;
 			}
-			// Sleep every x milli-seconds we wait to let other threads work
-			else if(chrono.getMillis() % 2 == 0) {
-				sleep(1);
-			}
+			// Block on the socket until data arrives rather than sleep
+			// polling, waking up regularly for the quit and timeout checks
 			else {
-				sleep(0);
+				Socket *socket = getSocket(false);
+				if(socket != NULL) {
+					socketSignalled = Socket::hasDataToReadWithWait(socket->getSocketId(),messageWaitSliceMicroseconds);
+				}
 			}
 		}
 
@@ -68,6 +68,8 @@ private:
 	static const int messageWaitTimeout;
 	static const int waitSleepTime;
 	static const int maxNetworkCommandListSendTimeWait;
+	static const int networkCommandListWaitTimeout;
+	static const int messageWaitSliceMicroseconds;
 
 private:
 	ClientSocket *clientSocket;
@@ -98,6 +100,8 @@ private:
 	ClientInterfaceThread *networkCommandListThread;
 
 	Mutex *networkCommandListThreadAccessor;
+	Trigger *networkCommandListTrigger;
+	NetworkLatencyHistogram frameWaitHistogram;
 	std::map<int,Commands> cachedPendingCommands;	//commands ready to be given
 	std::map<int,vector<uint32> > cachedPendingCommandCRCs;	//commands ready to be given
 	uint64 cachedPendingCommandsIndex;
@@ -136,6 +140,7 @@ public:
 
 	uint64 getCachedLastPendingFrameCount();
 	int64 getTimeClientWaitedForLastMessage();
+	string getFrameWaitHistogramReport();
 
 	//message processing
 	virtual void update();
@@ -207,6 +212,7 @@ protected:
 
 	void updateFrame(int *checkFrame);
 	void shutdownNetworkCommandListThread(MutexSafeWrapper &safeMutexWrapper);
+	void signalNetworkCommandListWaiters();
 	bool getNetworkCommand(int frameCount, int currentCachedPendingCommandsIndex);
 
 	void close(bool lockMutex);
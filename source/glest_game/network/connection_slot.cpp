@@ -104,6 +104,11 @@ void ConnectionSlotThread::setTaskCompleted(int eventId) {
                 break;
 		    }
 		}
+		safeMutex.ReleaseLock();
+
+		if(this->slotInterface != NULL) {
+			this->slotInterface->slotTaskCompleted(slotIndex);
+		}
 	}
 }
 
@@ -120,6 +125,11 @@ void ConnectionSlotThread::setAllEventsCompleted() {
             slotEvent.eventCompleted = true;
         }
     }
+    safeMutex.ReleaseLock();
+
+    if(this->slotInterface != NULL) {
+    	this->slotInterface->slotTaskCompleted(slotIndex);
+    }
 }
 
 void ConnectionSlotThread::purgeCompletedEvents() {
@@ -386,6 +396,9 @@ ConnectionSlot::ConnectionSlot(ServerInterface* serverInterface, int playerIndex
 	this->receivedNetworkGameStatus 		= false;
 
 	this->autoPauseGameCountForLag			= 0;
+	this->sendQueueOffset					= 0;
+	this->sendQueueBytes					= 0;
+	this->maxSendQueueBytes					= Config::getInstance().getInt("MaxClientSendQueueBytes","4194304");
 	this->skipLagCheck 						= false;
 	this->joinGameInProgress 				= false;
 	this->canAcceptConnections 				= true;
@@ -458,6 +471,7 @@ ConnectionSlot::~ConnectionSlot() {
 	//printf("#4 Ending client SLOT: %d\n",playerIndex);
 	slotThreadWorker = NULL;
 
+	clearSendQueue();
 	delete socketSynchAccessor;
 	socketSynchAccessor = NULL;
 
@@ -510,6 +524,12 @@ void ConnectionSlot::setReady()	{
 }
 
 void ConnectionSlot::updateSlot(ConnectionSlotEvent *event) {
+	// Drain whatever the socket would not take when it was queued
+	if(flushSendQueue() == false) {
+		SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Closing slot %d, socket error while sending queued data\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,playerIndex);
+		close();
+	}
+
 	if(event != NULL) {
 		bool &socketTriggered = event->socketTriggered;
 		bool checkForNewClients =
@@ -1518,7 +1538,12 @@ void ConnectionSlot::close() {
 
 	//printf("ConnectionSlot::close() #3 this->getSocket() = %p updateServerListener = %d\n",this->getSocket(),updateServerListener);
 
+	// Give anything still queued (like a quit message) one last chance to go out
+	MutexSafeWrapper safeMutexSendQueue(socketSynchAccessor,CODE_AT_LINE);
+	flushSendQueue(true);
+	clearSendQueue();
 	this->deleteSocket();
+	safeMutexSendQueue.ReleaseLock();
 	safeMutex.ReleaseLock();
 
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s LINE: %d]\n",__FILE__,__FUNCTION__,__LINE__);
@@ -1552,19 +1577,92 @@ bool ConnectionSlot::updateCompleted(ConnectionSlotEvent *event) {
 }
 
 void ConnectionSlot::sendMessage(NetworkMessage* networkMessage) {
-	MutexSafeWrapper safeMutex(socketSynchAccessor,CODE_AT_LINE);
+	NetworkMessageBuffer *buffer = NetworkMessageBuffer::encode(networkMessage);
+	queueMessage(buffer);
+	NetworkMessageBuffer::release(buffer);
+}
 
+void ConnectionSlot::queueMessage(NetworkMessageBuffer *buffer) {
 	// Skip text messages not intended for the players preferred language
-	NetworkMessageText *textMsg = dynamic_cast<NetworkMessageText *>(networkMessage);
-	if(textMsg != NULL) {
-		//printf("\n\n\n~~~ SERVER HAS NetworkMessageText target [%s] player [%s] msg[%s]\n\n\n",textMsg->getTargetLanguage().c_str(),this->getNetworkPlayerLanguage().c_str(), textMsg->getText().c_str());
-		if(textMsg->getTargetLanguage() != "" &&
-			textMsg->getTargetLanguage() != this->getNetworkPlayerLanguage()) {
-			return;
+	if(buffer->getTargetLanguage() != "" &&
+		buffer->getTargetLanguage() != this->getNetworkPlayerLanguage()) {
+		return;
+	}
+
+	MutexSafeWrapper safeMutex(socketSynchAccessor,CODE_AT_LINE);
+	buffer->addRef();
+	sendQueue.push_back(make_pair(buffer,time(NULL)));
+	sendQueueBytes += buffer->getDataSize();
+
+	bool sendFailed = (flushSendQueue(true) == false);
+
+	bool sendQueueFull = (maxSendQueueBytes > 0 && sendQueueBytes > maxSendQueueBytes);
+	int64 queuedBytes = sendQueueBytes;
+	safeMutex.ReleaseLock();
+
+	if(sendFailed == true) {
+		SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Closing slot %d, socket error while sending queued data\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,playerIndex);
+		close();
+	}
+	else if(sendQueueFull == true) {
+		// The client stopped reading, dropping messages would desync it so drop the client
+		SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Closing slot %d, send queue has %lld bytes pending [max %lld]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,playerIndex,(long long int)queuedBytes,(long long int)maxSendQueueBytes);
+		close();
+	}
+}
+
+bool ConnectionSlot::flushSendQueue(bool sendQueueAlreadyLocked) {
+	MutexSafeWrapper safeMutex((sendQueueAlreadyLocked == false ? socketSynchAccessor : NULL),CODE_AT_LINE);
+
+	Socket *slotSocket = getSocket();
+	if(slotSocket == NULL) {
+		// Nothing to write to, close() drops whatever was still queued
+		return true;
+	}
+
+	while(sendQueue.empty() == false) {
+		NetworkMessageBuffer *buffer = sendQueue.front().first;
+		int remainingBytes = buffer->getDataSize() - sendQueueOffset;
+		if(remainingBytes > 0) {
+			int bytesSent = slotSocket->sendWithoutWait(buffer->getData() + sendQueueOffset, remainingBytes);
+			if(bytesSent < 0) {
+				return false;
+			}
+			sendQueueOffset += bytesSent;
+			sendQueueBytes -= bytesSent;
+			if(bytesSent < remainingBytes) {
+				// Socket buffer is full, the rest goes out on a later flush
+				break;
+			}
 		}
+
+		sendQueue.pop_front();
+		NetworkMessageBuffer::release(buffer);
+		sendQueueOffset = 0;
 	}
+	return true;
+}
 
-	NetworkInterface::sendMessage(networkMessage);
+void ConnectionSlot::clearSendQueue() {
+	for(unsigned int index = 0; index < sendQueue.size(); ++index) {
+		NetworkMessageBuffer::release(sendQueue[index].first);
+	}
+	sendQueue.clear();
+	sendQueueOffset = 0;
+	sendQueueBytes = 0;
+}
+
+int64 ConnectionSlot::getSendQueueBytes() {
+	MutexSafeWrapper safeMutex(socketSynchAccessor,CODE_AT_LINE);
+	return sendQueueBytes;
+}
+
+double ConnectionSlot::getSendQueueLagTime() {
+	MutexSafeWrapper safeMutex(socketSynchAccessor,CODE_AT_LINE);
+	if(sendQueue.empty() == true) {
+		return 0;
+	}
+	return difftime((long int)time(NULL),sendQueue.front().second);
 }
 
 string ConnectionSlot::getHumanPlayerName(int index) {
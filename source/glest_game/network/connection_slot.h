@@ -26,6 +26,7 @@
 #include "base_thread.h"
 #include <time.h>
 #include <vector>
+#include <deque>
 
 #include "leak_dumper.h"
 
@@ -82,6 +83,7 @@ public:
 	virtual Mutex *getSlotMutex(int index) = 0;
 
 	virtual void slotUpdateTask(ConnectionSlotEvent *event) = 0;
+	virtual void slotTaskCompleted(int index) = 0;
 	virtual ~ConnectionSlotCallbackInterface() {}
 };
 
@@ -175,6 +177,15 @@ private:
 
 	int autoPauseGameCountForLag;
 
+	// Encoded messages waiting for the socket, guarded by socketSynchAccessor
+	std::deque<std::pair<NetworkMessageBuffer *,time_t> > sendQueue;
+	int sendQueueOffset;
+	int64 sendQueueBytes;
+	int64 maxSendQueueBytes;
+
+	bool flushSendQueue(bool sendQueueAlreadyLocked);
+	void clearSendQueue();
+
 public:
 	ConnectionSlot(ServerInterface* serverInterface, int playerIndex);
 	~ConnectionSlot();
@@ -241,6 +252,10 @@ public:
 	bool updateCompleted(ConnectionSlotEvent *event);
 
 	virtual void sendMessage(NetworkMessage* networkMessage);
+	void queueMessage(NetworkMessageBuffer *buffer);
+	bool flushSendQueue() { return flushSendQueue(false); }
+	int64 getSendQueueBytes();
+	double getSendQueueLagTime();
 	int getCurrentFrameCount() const { return currentFrameCount; }
 
 	int getCurrentLagCount() const { return currentLagCount; }
@@ -0,0 +1,74 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martiño Figueroa
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "network_latency_histogram.h"
+#include <cstdio>
+#include "leak_dumper.h"
+
+namespace Glest{ namespace Game{
+
+// =====================================================
+//	class NetworkLatencyHistogram
+// =====================================================
+
+void NetworkLatencyHistogram::reset() {
+	for(int index = 0; index < bucketCount; ++index) {
+		buckets[index] = 0;
+	}
+	sampleCount	= 0;
+	totalMillis	= 0;
+	maxMillis	= 0;
+}
+
+void NetworkLatencyHistogram::addSample(int64 millis) {
+	if(millis < 0) {
+		millis = 0;
+	}
+
+	// bucket 0 is < 1 ms, bucket n is [2^(n-1), 2^n) ms and the last
+	// bucket takes everything above
+	int bucket = 0;
+	for(int64 limit = 1; bucket < bucketCount - 1 && millis >= limit; limit <<= 1) {
+		bucket++;
+	}
+	buckets[bucket]++;
+
+	sampleCount++;
+	totalMillis += millis;
+	if(millis > maxMillis) {
+		maxMillis = millis;
+	}
+}
+
+string NetworkLatencyHistogram::toString() const {
+	char szBuf[8096]="";
+	snprintf(szBuf,8096,"samples: %llu avg: %.2f ms max: %lld ms",
+			(long long unsigned int)sampleCount,
+			(sampleCount > 0 ? (double)totalMillis / (double)sampleCount : 0.0),
+			(long long int)maxMillis);
+	string result = szBuf;
+
+	for(int index = 0; index < bucketCount; ++index) {
+		if(index == 0) {
+			snprintf(szBuf,8096," [<1: %llu]",(long long unsigned int)buckets[index]);
+		}
+		else if(index == bucketCount - 1) {
+			snprintf(szBuf,8096," [>=%d: %llu]",(1 << (index - 1)),(long long unsigned int)buckets[index]);
+		}
+		else {
+			snprintf(szBuf,8096," [%d-%d: %llu]",(1 << (index - 1)),(1 << index),(long long unsigned int)buckets[index]);
+		}
+		result += szBuf;
+	}
+	return result;
+}
+
+}}//end namespace
@@ -0,0 +1,54 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martiño Figueroa
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _GLEST_GAME_NETWORKLATENCYHISTOGRAM_H_
+#define _GLEST_GAME_NETWORKLATENCYHISTOGRAM_H_
+
+#include <string>
+#include "data_types.h"
+#include "leak_dumper.h"
+
+using std::string;
+using Shared::Platform::int64;
+using Shared::Platform::uint64;
+
+namespace Glest{ namespace Game{
+
+// =====================================================
+//	class NetworkLatencyHistogram
+//
+/// Counts network wait times in power of two millisecond buckets
+// =====================================================
+
+class NetworkLatencyHistogram {
+public:
+	static const int bucketCount = 12;
+
+private:
+	uint64 buckets[bucketCount];
+	uint64 sampleCount;
+	int64 totalMillis;
+	int64 maxMillis;
+
+public:
+	NetworkLatencyHistogram() { reset(); }
+
+	void reset();
+	void addSample(int64 millis);
+
+	uint64 getSampleCount() const	{ return sampleCount; }
+	int64 getMaxMillis() const		{ return maxMillis; }
+	string toString() const;
+};
+
+}}//end namespace
+
+#endif
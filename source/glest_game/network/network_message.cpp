@@ -84,7 +84,11 @@ bool NetworkMessage::receive(Socket* socket, void* data, int dataSize, bool tryR
 void NetworkMessage::send(Socket* socket, const void* data, int dataSize) {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] socket = %p, data = %p, dataSize = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,socket,data,dataSize);
 
-	if(socket != NULL) {
+	if(sendCaptureBuffer != NULL) {
+		const char *bytes = static_cast<const char *>(data);
+		sendCaptureBuffer->insert(sendCaptureBuffer->end(),bytes,bytes + dataSize);
+	}
+	else if(socket != NULL) {
 		dump_packet("\nOUTGOING PACKET:\n",data, dataSize, true);
 		int sendResult = socket->send(data, dataSize);
 		if(sendResult != dataSize) {
@@ -103,7 +107,12 @@ void NetworkMessage::send(Socket* socket, const void* data, int dataSize) {
 void NetworkMessage::send(Socket* socket, const void* data, int dataSize, int8 messageType) {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] socket = %p, data = %p, dataSize = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,socket,data,dataSize);
 
-	if(socket != NULL) {
+	if(sendCaptureBuffer != NULL) {
+		const char *bytes = static_cast<const char *>(data);
+		sendCaptureBuffer->insert(sendCaptureBuffer->end(),(const char *)&messageType,(const char *)&messageType + sizeof(messageType));
+		sendCaptureBuffer->insert(sendCaptureBuffer->end(),bytes,bytes + dataSize);
+	}
+	else if(socket != NULL) {
 		int msgTypeSize = sizeof(messageType);
 		int fullMsgSize = msgTypeSize + dataSize;
 
@@ -133,7 +142,13 @@ void NetworkMessage::send(Socket* socket, const void* data, int dataSize, int8 m
 void NetworkMessage::send(Socket* socket, const void* data, int dataSize, int8 messageType, uint32 compressedLength) {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] socket = %p, data = %p, dataSize = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,socket,data,dataSize);
 
-	if(socket != NULL) {
+	if(sendCaptureBuffer != NULL) {
+		const char *bytes = static_cast<const char *>(data);
+		sendCaptureBuffer->insert(sendCaptureBuffer->end(),(const char *)&messageType,(const char *)&messageType + sizeof(messageType));
+		sendCaptureBuffer->insert(sendCaptureBuffer->end(),(const char *)&compressedLength,(const char *)&compressedLength + sizeof(compressedLength));
+		sendCaptureBuffer->insert(sendCaptureBuffer->end(),bytes,bytes + dataSize);
+	}
+	else if(socket != NULL) {
 		int msgTypeSize = sizeof(messageType);
 		int compressedSize = sizeof(compressedLength);
 		int fullMsgSize = msgTypeSize + compressedSize + dataSize;
@@ -162,6 +177,56 @@ void NetworkMessage::send(Socket* socket, const void* data, int dataSize, int8 m
 	}
 }
 
+void NetworkMessage::encode(vector<char> &buffer) {
+	sendCaptureBuffer = &buffer;
+	try {
+		send(NULL);
+	}
+	catch(...) {
+		sendCaptureBuffer = NULL;
+		throw;
+	}
+	sendCaptureBuffer = NULL;
+
+	if(buffer.empty() == false) {
+		dump_packet("\nOUTGOING PACKET:\n",&buffer[0], (int)buffer.size(), true);
+	}
+}
+
+// =====================================================
+//	class NetworkMessageBuffer
+// =====================================================
+
+NetworkMessageBuffer::NetworkMessageBuffer() {
+	messageType = nmtInvalid;
+	targetLanguage = "";
+	SDL_AtomicSet(&refCount,1);
+}
+
+NetworkMessageBuffer * NetworkMessageBuffer::encode(NetworkMessage *networkMessage) {
+	NetworkMessageBuffer *buffer = new NetworkMessageBuffer();
+	try {
+		networkMessage->encode(buffer->data);
+	}
+	catch(...) {
+		delete buffer;
+		throw;
+	}
+	buffer->messageType = networkMessage->getNetworkMessageType();
+
+	NetworkMessageText *textMsg = dynamic_cast<NetworkMessageText *>(networkMessage);
+	if(textMsg != NULL) {
+		buffer->targetLanguage = textMsg->getTargetLanguage();
+	}
+	return buffer;
+}
+
+void NetworkMessageBuffer::release(NetworkMessageBuffer *buffer) {
+	if(buffer != NULL && SDL_AtomicDecRef(&buffer->refCount) == SDL_TRUE) {
+		delete buffer;
+	}
+}
+
 void NetworkMessage::resetNetworkPacketStats() {
 	NetworkMessage::statsTimer.stop();
 	NetworkMessage::lastSend.stop();
@@ -353,55 +418,19 @@ NetworkMessageIntro::NetworkMessageIntro(int32 sessionId,const string &versionSt
 	data.platform		= platform;
 }
 
-const char * NetworkMessageIntro::getPackedMessageFormat() const {
-	return "cl128s32shcLL60sc60s60s";
-}
-
 unsigned int NetworkMessageIntro::getPackedSize() {
 	static unsigned int result = 0;
 	if(result == 0) {
-		Data packedData;
-		packedData.externalIp = 0;
-		packedData.ftpPort = 0;
-		packedData.gameInProgress = 0;
-		packedData.gameState = 0;
-		messageType = nmtIntro;
-		packedData.playerIndex = 0;
-		packedData.sessionId = 0;
-
-		unsigned char *buf = new unsigned char[sizeof(packedData)*3];
-		result = pack(buf, getPackedMessageFormat(),
-				messageType,
-				packedData.sessionId,
-				packedData.versionString.getBuffer(),
-				packedData.name.getBuffer(),
-				packedData.playerIndex,
-				packedData.gameState,
-				packedData.externalIp,
-				packedData.ftpPort,
-				packedData.language.getBuffer(),
-				data.gameInProgress,
-				packedData.playerUUID.getBuffer(),
-				packedData.platform.getBuffer());
-		delete [] buf;
+		NetworkPackedSize archive;
+		serialize(archive, messageType, data);
+		result = archive.getSize();
 	}
 	return result;
 }
 void NetworkMessageIntro::unpackMessage(unsigned char *buf) {
 	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("\nIn [%s] about to unpack...\n",__FUNCTION__);
-	unpack(buf, getPackedMessageFormat(),
-			&messageType,
-			&data.sessionId,
-			data.versionString.getBuffer(),
-			data.name.getBuffer(),
-			&data.playerIndex,
-			&data.gameState,
-			&data.externalIp,
-			&data.ftpPort,
-			data.language.getBuffer(),
-			&data.gameInProgress,
-			data.playerUUID.getBuffer(),
-			data.platform.getBuffer());
+	NetworkUnpacker archive(buf, getPackedSize());
+	serialize(archive, messageType, data);
 	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s] unpacked data:\n%s\n",__FUNCTION__,this->toString().c_str());
 }
 
@@ -409,19 +438,8 @@ unsigned char * NetworkMessageIntro::packMessage() {
 	unsigned char *buf = new unsigned char[getPackedSize()+1];
 
 	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("\nIn [%s] about to pack...\n",__FUNCTION__);
-	pack(buf, getPackedMessageFormat(),
-			messageType,
-			data.sessionId,
-			data.versionString.getBuffer(),
-			data.name.getBuffer(),
-			data.playerIndex,
-			data.gameState,
-			data.externalIp,
-			data.ftpPort,
-			data.language.getBuffer(),
-			data.gameInProgress,
-			data.playerUUID.getBuffer(),
-			data.platform.getBuffer());
+	NetworkPacker archive(buf, getPackedSize());
+	serialize(archive, messageType, data);
 	return buf;
 }
 
@@ -532,39 +550,24 @@ NetworkMessagePing::NetworkMessagePing(int32 pingFrequency, int64 pingTime){
 	pingReceivedLocalTime=0;
 }
 
-const char * NetworkMessagePing::getPackedMessageFormat() const {
-	return "clq";
-}
-
 unsigned int NetworkMessagePing::getPackedSize() {
 	static unsigned int result = 0;
 	if(result == 0) {
-		Data packedData;
-		messageType = 0;
-		packedData.pingFrequency = 0;
-		packedData.pingTime = 0;
-		unsigned char *buf = new unsigned char[sizeof(packedData)*3];
-		result = pack(buf, getPackedMessageFormat(),
-				messageType,
-				packedData.pingFrequency,
-				packedData.pingTime);
-		delete [] buf;
+		NetworkPackedSize archive;
+		serialize(archive, messageType, data);
+		result = archive.getSize();
 	}
 	return result;
 }
 void NetworkMessagePing::unpackMessage(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormat(),
-			&messageType,
-			&data.pingFrequency,
-			&data.pingTime);
+	NetworkUnpacker archive(buf, getPackedSize());
+	serialize(archive, messageType, data);
 }
 
 unsigned char * NetworkMessagePing::packMessage() {
 	unsigned char *buf = new unsigned char[getPackedSize()+1];
-	pack(buf, getPackedMessageFormat(),
-			messageType,
-			data.pingFrequency,
-			data.pingTime);
+	NetworkPacker archive(buf, getPackedSize());
+	serialize(archive, messageType, data);
 	return buf;
 }
 
@@ -638,35 +641,24 @@ NetworkMessageReady::NetworkMessageReady(uint32 checksum) {
 	data.checksum= checksum;
 }
 
-const char * NetworkMessageReady::getPackedMessageFormat() const {
-	return "cL";
-}
-
 unsigned int NetworkMessageReady::getPackedSize() {
 	static unsigned int result = 0;
 	if(result == 0) {
-		Data packedData;
-		packedData.checksum = 0;
-		messageType = 0;
-		unsigned char *buf = new unsigned char[sizeof(packedData)*3];
-		result = pack(buf, getPackedMessageFormat(),
-				messageType,
-				packedData.checksum);
-		delete [] buf;
+		NetworkPackedSize archive;
+		serialize(archive, messageType, data);
+		result = archive.getSize();
 	}
 	return result;
 }
 void NetworkMessageReady::unpackMessage(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormat(),
-			&messageType,
-			&data.checksum);
+	NetworkUnpacker archive(buf, getPackedSize());
+	serialize(archive, messageType, data);
 }
 
 unsigned char * NetworkMessageReady::packMessage() {
 	unsigned char *buf = new unsigned char[getPackedSize()+1];
-	pack(buf, getPackedMessageFormat(),
-			messageType,
-			data.checksum);
+	NetworkPacker archive(buf, getPackedSize());
+	serialize(archive, messageType, data);
 	return buf;
 }
 
@@ -877,511 +869,24 @@ vector<pair<string,uint32> > NetworkMessageLaunch::getFactionCRCList() const {
 	return factionCRCList;
 }
 
-const char * NetworkMessageLaunch::getPackedMessageFormat() const {
-	return "c256s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60sllllllll60s60s60s60s60s60s60s60sLLL60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60sLLLLLLLLLLLLLLLLLLLLcccccccccccccccccccccccccccccccccccccccccCccLccll256s60s60s60s60s60s60s60s60sc60s";
-}
-
 unsigned int NetworkMessageLaunch::getPackedSize() {
 	static unsigned int result = 0;
 	if(result == 0) {
-		Data packedData;
-		packedData.aiAcceptSwitchTeamPercentChance = 0;
-		packedData.allowObservers = 0;
-		packedData.cpuReplacementMultiplier = 0;
-		packedData.defaultResources = 0;
-		packedData.defaultUnits = 0;
-		packedData.defaultVictoryConditions = 0;
-		packedData.enableObserverModeAtEndGame = 0;
-		packedData.enableServerControlledAI = 0;
-		for(unsigned int index =0; index < (unsigned int)maxFactionCRCCount; ++index) {
-			packedData.factionCRCList[index] = 0;
-		}
-		for(unsigned int index =0; index < (unsigned int)GameConstants::maxPlayers; ++index) {
-			packedData.factionControls[index] = 0;
-			packedData.networkPlayerStatuses[index] = 0;
-			packedData.resourceMultiplierIndex[index] = 0;
-			packedData.startLocationIndex[index] = 0;
-			packedData.teams[index] = 0;
-		}
-		packedData.factionCount = 0;
-		packedData.flagTypes1 = 0;
-		packedData.fogOfWar = 0;
-		packedData.mapCRC = 0;
-		packedData.mapFilter = 0;
-		packedData.masterserver_admin = 0;
-		packedData.masterserver_admin_factionIndex = 0;
-		messageType = 0;
-		packedData.networkAllowNativeLanguageTechtree = 0;
-		packedData.networkFramePeriod = 0;
-		packedData.networkPauseGameForLaggedClients = 0;
-		packedData.pathFinderType = 0;
-		packedData.techCRC = 0;
-		packedData.thisFactionIndex = 0;
-		packedData.tilesetCRC = 0;
-
-		unsigned char *buf = new unsigned char[sizeof(packedData)*3];
-		result = pack(buf, getPackedMessageFormat(),
-				messageType,
-				packedData.description.getBuffer(),
-				packedData.map.getBuffer(),
-				packedData.tileset.getBuffer(),
-				packedData.tech.getBuffer(),
-				packedData.factionTypeNames[0].getBuffer(),
-				packedData.factionTypeNames[1].getBuffer(),
-				packedData.factionTypeNames[2].getBuffer(),
-				packedData.factionTypeNames[3].getBuffer(),
-				packedData.factionTypeNames[4].getBuffer(),
-				packedData.factionTypeNames[5].getBuffer(),
-				packedData.factionTypeNames[6].getBuffer(),
-				packedData.factionTypeNames[7].getBuffer(),
-				packedData.networkPlayerNames[0].getBuffer(),
-				packedData.networkPlayerNames[1].getBuffer(),
-				packedData.networkPlayerNames[2].getBuffer(),
-				packedData.networkPlayerNames[3].getBuffer(),
-				packedData.networkPlayerNames[4].getBuffer(),
-				packedData.networkPlayerNames[5].getBuffer(),
-				packedData.networkPlayerNames[6].getBuffer(),
-				packedData.networkPlayerNames[7].getBuffer(),
-				packedData.networkPlayerPlatform[0].getBuffer(),
-				packedData.networkPlayerPlatform[1].getBuffer(),
-				packedData.networkPlayerPlatform[2].getBuffer(),
-				packedData.networkPlayerPlatform[3].getBuffer(),
-				packedData.networkPlayerPlatform[4].getBuffer(),
-				packedData.networkPlayerPlatform[5].getBuffer(),
-				packedData.networkPlayerPlatform[6].getBuffer(),
-				packedData.networkPlayerPlatform[7].getBuffer(),
-				packedData.networkPlayerStatuses[0],
-				packedData.networkPlayerStatuses[1],
-				packedData.networkPlayerStatuses[2],
-				packedData.networkPlayerStatuses[3],
-				packedData.networkPlayerStatuses[4],
-				packedData.networkPlayerStatuses[5],
-				packedData.networkPlayerStatuses[6],
-				packedData.networkPlayerStatuses[7],
-				packedData.networkPlayerLanguages[0].getBuffer(),
-				packedData.networkPlayerLanguages[1].getBuffer(),
-				packedData.networkPlayerLanguages[2].getBuffer(),
-				packedData.networkPlayerLanguages[3].getBuffer(),
-				packedData.networkPlayerLanguages[4].getBuffer(),
-				packedData.networkPlayerLanguages[5].getBuffer(),
-				packedData.networkPlayerLanguages[6].getBuffer(),
-				packedData.networkPlayerLanguages[7].getBuffer(),
-				packedData.mapCRC,
-				packedData.mapFilter,
-				packedData.tilesetCRC,
-				packedData.techCRC,
-				packedData.factionNameList[0].getBuffer(),
-				packedData.factionNameList[1].getBuffer(),
-				packedData.factionNameList[2].getBuffer(),
-				packedData.factionNameList[3].getBuffer(),
-				packedData.factionNameList[4].getBuffer(),
-				packedData.factionNameList[5].getBuffer(),
-				packedData.factionNameList[6].getBuffer(),
-				packedData.factionNameList[7].getBuffer(),
-				packedData.factionNameList[8].getBuffer(),
-				packedData.factionNameList[9].getBuffer(),
-				packedData.factionNameList[10].getBuffer(),
-				packedData.factionNameList[11].getBuffer(),
-				packedData.factionNameList[12].getBuffer(),
-				packedData.factionNameList[13].getBuffer(),
-				packedData.factionNameList[14].getBuffer(),
-				packedData.factionNameList[15].getBuffer(),
-				packedData.factionNameList[16].getBuffer(),
-				packedData.factionNameList[17].getBuffer(),
-				packedData.factionNameList[18].getBuffer(),
-				packedData.factionNameList[19].getBuffer(),
-				packedData.factionCRCList[0],
-				packedData.factionCRCList[1],
-				packedData.factionCRCList[2],
-				packedData.factionCRCList[3],
-				packedData.factionCRCList[4],
-				packedData.factionCRCList[5],
-				packedData.factionCRCList[6],
-				packedData.factionCRCList[7],
-				packedData.factionCRCList[8],
-				packedData.factionCRCList[9],
-				packedData.factionCRCList[10],
-				packedData.factionCRCList[11],
-				packedData.factionCRCList[12],
-				packedData.factionCRCList[13],
-				packedData.factionCRCList[14],
-				packedData.factionCRCList[15],
-				packedData.factionCRCList[16],
-				packedData.factionCRCList[17],
-				packedData.factionCRCList[18],
-				packedData.factionCRCList[19],
-				packedData.factionControls[0],
-				packedData.factionControls[1],
-				packedData.factionControls[2],
-				packedData.factionControls[3],
-				packedData.factionControls[4],
-				packedData.factionControls[5],
-				packedData.factionControls[6],
-				packedData.factionControls[7],
-				packedData.resourceMultiplierIndex[0],
-				packedData.resourceMultiplierIndex[1],
-				packedData.resourceMultiplierIndex[2],
-				packedData.resourceMultiplierIndex[3],
-				packedData.resourceMultiplierIndex[4],
-				packedData.resourceMultiplierIndex[5],
-				packedData.resourceMultiplierIndex[6],
-				packedData.resourceMultiplierIndex[7],
-				packedData.thisFactionIndex,
-				packedData.factionCount,
-				packedData.teams[0],
-				packedData.teams[1],
-				packedData.teams[2],
-				packedData.teams[3],
-				packedData.teams[4],
-				packedData.teams[5],
-				packedData.teams[6],
-				packedData.teams[7],
-				packedData.startLocationIndex[0],
-				packedData.startLocationIndex[1],
-				packedData.startLocationIndex[2],
-				packedData.startLocationIndex[3],
-				packedData.startLocationIndex[4],
-				packedData.startLocationIndex[5],
-				packedData.startLocationIndex[6],
-				packedData.startLocationIndex[7],
-				packedData.defaultResources,
-				packedData.defaultUnits,
-				packedData.defaultVictoryConditions,
-				packedData.fogOfWar,
-				packedData.allowObservers,
-				packedData.enableObserverModeAtEndGame,
-				packedData.enableServerControlledAI,
-				packedData.networkFramePeriod,
-				packedData.networkPauseGameForLaggedClients,
-				packedData.pathFinderType,
-				packedData.flagTypes1,
-				packedData.aiAcceptSwitchTeamPercentChance,
-				packedData.cpuReplacementMultiplier,
-				packedData.masterserver_admin,
-				packedData.masterserver_admin_factionIndex,
-				packedData.scenario.getBuffer(),
-				packedData.networkPlayerUUID[0].getBuffer(),
-				packedData.networkPlayerUUID[1].getBuffer(),
-				packedData.networkPlayerUUID[2].getBuffer(),
-				packedData.networkPlayerUUID[3].getBuffer(),
-				packedData.networkPlayerUUID[4].getBuffer(),
-				packedData.networkPlayerUUID[5].getBuffer(),
-				packedData.networkPlayerUUID[6].getBuffer(),
-				packedData.networkPlayerUUID[7].getBuffer(),
-				packedData.networkAllowNativeLanguageTechtree,
-				packedData.gameUUID.getBuffer()
-		);
-		delete [] buf;
+		NetworkPackedSize archive;
+		serialize(archive, messageType, data);
+		result = archive.getSize();
 	}
 	return result;
 }
 void NetworkMessageLaunch::unpackMessage(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormat(),
-			&messageType,
-			data.description.getBuffer(),
-			data.map.getBuffer(),
-			data.tileset.getBuffer(),
-			data.tech.getBuffer(),
-			data.factionTypeNames[0].getBuffer(),
-			data.factionTypeNames[1].getBuffer(),
-			data.factionTypeNames[2].getBuffer(),
-			data.factionTypeNames[3].getBuffer(),
-			data.factionTypeNames[4].getBuffer(),
-			data.factionTypeNames[5].getBuffer(),
-			data.factionTypeNames[6].getBuffer(),
-			data.factionTypeNames[7].getBuffer(),
-			data.networkPlayerNames[0].getBuffer(),
-			data.networkPlayerNames[1].getBuffer(),
-			data.networkPlayerNames[2].getBuffer(),
-			data.networkPlayerNames[3].getBuffer(),
-			data.networkPlayerNames[4].getBuffer(),
-			data.networkPlayerNames[5].getBuffer(),
-			data.networkPlayerNames[6].getBuffer(),
-			data.networkPlayerNames[7].getBuffer(),
-			data.networkPlayerPlatform[0].getBuffer(),
-			data.networkPlayerPlatform[1].getBuffer(),
-			data.networkPlayerPlatform[2].getBuffer(),
-			data.networkPlayerPlatform[3].getBuffer(),
-			data.networkPlayerPlatform[4].getBuffer(),
-			data.networkPlayerPlatform[5].getBuffer(),
-			data.networkPlayerPlatform[6].getBuffer(),
-			data.networkPlayerPlatform[7].getBuffer(),
-			&data.networkPlayerStatuses[0],
-			&data.networkPlayerStatuses[1],
-			&data.networkPlayerStatuses[2],
-			&data.networkPlayerStatuses[3],
-			&data.networkPlayerStatuses[4],
-			&data.networkPlayerStatuses[5],
-			&data.networkPlayerStatuses[6],
-			&data.networkPlayerStatuses[7],
-			data.networkPlayerLanguages[0].getBuffer(),
-			data.networkPlayerLanguages[1].getBuffer(),
-			data.networkPlayerLanguages[2].getBuffer(),
-			data.networkPlayerLanguages[3].getBuffer(),
-			data.networkPlayerLanguages[4].getBuffer(),
-			data.networkPlayerLanguages[5].getBuffer(),
-			data.networkPlayerLanguages[6].getBuffer(),
-			data.networkPlayerLanguages[7].getBuffer(),
-			&data.mapFilter,
-			&data.mapCRC,
-			&data.tilesetCRC,
-			&data.techCRC,
-			data.factionNameList[0].getBuffer(),
-			data.factionNameList[1].getBuffer(),
-			data.factionNameList[2].getBuffer(),
-			data.factionNameList[3].getBuffer(),
-			data.factionNameList[4].getBuffer(),
-			data.factionNameList[5].getBuffer(),
-			data.factionNameList[6].getBuffer(),
-			data.factionNameList[7].getBuffer(),
-			data.factionNameList[8].getBuffer(),
-			data.factionNameList[9].getBuffer(),
-			data.factionNameList[10].getBuffer(),
-			data.factionNameList[11].getBuffer(),
-			data.factionNameList[12].getBuffer(),
-			data.factionNameList[13].getBuffer(),
-			data.factionNameList[14].getBuffer(),
-			data.factionNameList[15].getBuffer(),
-			data.factionNameList[16].getBuffer(),
-			data.factionNameList[17].getBuffer(),
-			data.factionNameList[18].getBuffer(),
-			data.factionNameList[19].getBuffer(),
-			&data.factionCRCList[0],
-			&data.factionCRCList[1],
-			&data.factionCRCList[2],
-			&data.factionCRCList[3],
-			&data.factionCRCList[4],
-			&data.factionCRCList[5],
-			&data.factionCRCList[6],
-			&data.factionCRCList[7],
-			&data.factionCRCList[8],
-			&data.factionCRCList[9],
-			&data.factionCRCList[10],
-			&data.factionCRCList[11],
-			&data.factionCRCList[12],
-			&data.factionCRCList[13],
-			&data.factionCRCList[14],
-			&data.factionCRCList[15],
-			&data.factionCRCList[16],
-			&data.factionCRCList[17],
-			&data.factionCRCList[18],
-			&data.factionCRCList[19],
-			&data.factionControls[0],
-			&data.factionControls[1],
-			&data.factionControls[2],
-			&data.factionControls[3],
-			&data.factionControls[4],
-			&data.factionControls[5],
-			&data.factionControls[6],
-			&data.factionControls[7],
-			&data.resourceMultiplierIndex[0],
-			&data.resourceMultiplierIndex[1],
-			&data.resourceMultiplierIndex[2],
-			&data.resourceMultiplierIndex[3],
-			&data.resourceMultiplierIndex[4],
-			&data.resourceMultiplierIndex[5],
-			&data.resourceMultiplierIndex[6],
-			&data.resourceMultiplierIndex[7],
-			&data.thisFactionIndex,
-			&data.factionCount,
-			&data.teams[0],
-			&data.teams[1],
-			&data.teams[2],
-			&data.teams[3],
-			&data.teams[4],
-			&data.teams[5],
-			&data.teams[6],
-			&data.teams[7],
-			&data.startLocationIndex[0],
-			&data.startLocationIndex[1],
-			&data.startLocationIndex[2],
-			&data.startLocationIndex[3],
-			&data.startLocationIndex[4],
-			&data.startLocationIndex[5],
-			&data.startLocationIndex[6],
-			&data.startLocationIndex[7],
-			&data.defaultResources,
-			&data.defaultUnits,
-			&data.defaultVictoryConditions,
-			&data.fogOfWar,
-			&data.allowObservers,
-			&data.enableObserverModeAtEndGame,
-			&data.enableServerControlledAI,
-			&data.networkFramePeriod,
-			&data.networkPauseGameForLaggedClients,
-			&data.pathFinderType,
-			&data.flagTypes1,
-			&data.aiAcceptSwitchTeamPercentChance,
-			&data.cpuReplacementMultiplier,
-			&data.masterserver_admin,
-			&data.masterserver_admin_factionIndex,
-			data.scenario.getBuffer(),
-			data.networkPlayerUUID[0].getBuffer(),
-			data.networkPlayerUUID[1].getBuffer(),
-			data.networkPlayerUUID[2].getBuffer(),
-			data.networkPlayerUUID[3].getBuffer(),
-			data.networkPlayerUUID[4].getBuffer(),
-			data.networkPlayerUUID[5].getBuffer(),
-			data.networkPlayerUUID[6].getBuffer(),
-			data.networkPlayerUUID[7].getBuffer(),
-			&data.networkAllowNativeLanguageTechtree,
-			data.gameUUID.getBuffer()
-	);
+	NetworkUnpacker archive(buf, getPackedSize());
+	serialize(archive, messageType, data);
 }
 
 unsigned char * NetworkMessageLaunch::packMessage() {
 	unsigned char *buf = new unsigned char[getPackedSize()+1];
-	pack(buf, getPackedMessageFormat(),
-			messageType,
-			data.description.getBuffer(),
-			data.map.getBuffer(),
-			data.tileset.getBuffer(),
-			data.tech.getBuffer(),
-			data.factionTypeNames[0].getBuffer(),
-			data.factionTypeNames[1].getBuffer(),
-			data.factionTypeNames[2].getBuffer(),
-			data.factionTypeNames[3].getBuffer(),
-			data.factionTypeNames[4].getBuffer(),
-			data.factionTypeNames[5].getBuffer(),
-			data.factionTypeNames[6].getBuffer(),
-			data.factionTypeNames[7].getBuffer(),
-			data.networkPlayerNames[0].getBuffer(),
-			data.networkPlayerNames[1].getBuffer(),
-			data.networkPlayerNames[2].getBuffer(),
-			data.networkPlayerNames[3].getBuffer(),
-			data.networkPlayerNames[4].getBuffer(),
-			data.networkPlayerNames[5].getBuffer(),
-			data.networkPlayerNames[6].getBuffer(),
-			data.networkPlayerNames[7].getBuffer(),
-			data.networkPlayerPlatform[0].getBuffer(),
-			data.networkPlayerPlatform[1].getBuffer(),
-			data.networkPlayerPlatform[2].getBuffer(),
-			data.networkPlayerPlatform[3].getBuffer(),
-			data.networkPlayerPlatform[4].getBuffer(),
-			data.networkPlayerPlatform[5].getBuffer(),
-			data.networkPlayerPlatform[6].getBuffer(),
-			data.networkPlayerPlatform[7].getBuffer(),
-			data.networkPlayerStatuses[0],
-			data.networkPlayerStatuses[1],
-			data.networkPlayerStatuses[2],
-			data.networkPlayerStatuses[3],
-			data.networkPlayerStatuses[4],
-			data.networkPlayerStatuses[5],
-			data.networkPlayerStatuses[6],
-			data.networkPlayerStatuses[7],
-			data.networkPlayerLanguages[0].getBuffer(),
-			data.networkPlayerLanguages[1].getBuffer(),
-			data.networkPlayerLanguages[2].getBuffer(),
-			data.networkPlayerLanguages[3].getBuffer(),
-			data.networkPlayerLanguages[4].getBuffer(),
-			data.networkPlayerLanguages[5].getBuffer(),
-			data.networkPlayerLanguages[6].getBuffer(),
-			data.networkPlayerLanguages[7].getBuffer(),
-			data.mapFilter,
-			data.mapCRC,
-			data.tilesetCRC,
-			data.techCRC,
-			data.factionNameList[0].getBuffer(),
-			data.factionNameList[1].getBuffer(),
-			data.factionNameList[2].getBuffer(),
-			data.factionNameList[3].getBuffer(),
-			data.factionNameList[4].getBuffer(),
-			data.factionNameList[5].getBuffer(),
-			data.factionNameList[6].getBuffer(),
-			data.factionNameList[7].getBuffer(),
-			data.factionNameList[8].getBuffer(),
-			data.factionNameList[9].getBuffer(),
-			data.factionNameList[10].getBuffer(),
-			data.factionNameList[11].getBuffer(),
-			data.factionNameList[12].getBuffer(),
-			data.factionNameList[13].getBuffer(),
-			data.factionNameList[14].getBuffer(),
-			data.factionNameList[15].getBuffer(),
-			data.factionNameList[16].getBuffer(),
-			data.factionNameList[17].getBuffer(),
-			data.factionNameList[18].getBuffer(),
-			data.factionNameList[19].getBuffer(),
-			data.factionCRCList[0],
-			data.factionCRCList[1],
-			data.factionCRCList[2],
-			data.factionCRCList[3],
-			data.factionCRCList[4],
-			data.factionCRCList[5],
-			data.factionCRCList[6],
-			data.factionCRCList[7],
-			data.factionCRCList[8],
-			data.factionCRCList[9],
-			data.factionCRCList[10],
-			data.factionCRCList[11],
-			data.factionCRCList[12],
-			data.factionCRCList[13],
-			data.factionCRCList[14],
-			data.factionCRCList[15],
-			data.factionCRCList[16],
-			data.factionCRCList[17],
-			data.factionCRCList[18],
-			data.factionCRCList[19],
-			data.factionControls[0],
-			data.factionControls[1],
-			data.factionControls[2],
-			data.factionControls[3],
-			data.factionControls[4],
-			data.factionControls[5],
-			data.factionControls[6],
-			data.factionControls[7],
-			data.resourceMultiplierIndex[0],
-			data.resourceMultiplierIndex[1],
-			data.resourceMultiplierIndex[2],
-			data.resourceMultiplierIndex[3],
-			data.resourceMultiplierIndex[4],
-			data.resourceMultiplierIndex[5],
-			data.resourceMultiplierIndex[6],
-			data.resourceMultiplierIndex[7],
-			data.thisFactionIndex,
-			data.factionCount,
-			data.teams[0],
-			data.teams[1],
-			data.teams[2],
-			data.teams[3],
-			data.teams[4],
-			data.teams[5],
-			data.teams[6],
-			data.teams[7],
-			data.startLocationIndex[0],
-			data.startLocationIndex[1],
-			data.startLocationIndex[2],
-			data.startLocationIndex[3],
-			data.startLocationIndex[4],
-			data.startLocationIndex[5],
-			data.startLocationIndex[6],
-			data.startLocationIndex[7],
-			data.defaultResources,
-			data.defaultUnits,
-			data.defaultVictoryConditions,
-			data.fogOfWar,
-			data.allowObservers,
-			data.enableObserverModeAtEndGame,
-			data.enableServerControlledAI,
-			data.networkFramePeriod,
-			data.networkPauseGameForLaggedClients,
-			data.pathFinderType,
-			data.flagTypes1,
-			data.aiAcceptSwitchTeamPercentChance,
-			data.cpuReplacementMultiplier,
-			data.masterserver_admin,
-			data.masterserver_admin_factionIndex,
-			data.scenario.getBuffer(),
-			data.networkPlayerUUID[0].getBuffer(),
-			data.networkPlayerUUID[1].getBuffer(),
-			data.networkPlayerUUID[2].getBuffer(),
-			data.networkPlayerUUID[3].getBuffer(),
-			data.networkPlayerUUID[4].getBuffer(),
-			data.networkPlayerUUID[5].getBuffer(),
-			data.networkPlayerUUID[6].getBuffer(),
-			data.networkPlayerUUID[7].getBuffer(),
-			data.networkAllowNativeLanguageTechtree,
-			data.gameUUID.getBuffer()
-			);
+	NetworkPacker archive(buf, getPackedSize());
+	serialize(archive, messageType, data);
 	return buf;
 }
 
@@ -1672,146 +1177,53 @@ bool NetworkMessageCommandList::addCommand(const NetworkCommand* networkCommand)
 	return true;
 }
 
-const char * NetworkMessageCommandList::getPackedMessageFormatHeader() const {
-	return "cHlLLLLLLLL";
-}
-
 unsigned int NetworkMessageCommandList::getPackedSizeHeader() {
 	static unsigned int result = 0;
 	if(result == 0) {
-		Data packedData;
-		init(packedData);
-		unsigned char *buf = new unsigned char[sizeof(packedData)*3];
-		result = pack(buf, getPackedMessageFormatHeader(),
-				packedData.messageType,
-				packedData.header.commandCount,
-				packedData.header.frameCount,
-				packedData.header.networkPlayerFactionCRC[0],
-				packedData.header.networkPlayerFactionCRC[1],
-				packedData.header.networkPlayerFactionCRC[2],
-				packedData.header.networkPlayerFactionCRC[3],
-				packedData.header.networkPlayerFactionCRC[4],
-				packedData.header.networkPlayerFactionCRC[5],
-				packedData.header.networkPlayerFactionCRC[6],
-				packedData.header.networkPlayerFactionCRC[7]);
-		delete [] buf;
+		NetworkPackedSize archive;
+		serializeHeader(archive, data);
+		result = archive.getSize();
 	}
 	return result;
 }
 void NetworkMessageCommandList::unpackMessageHeader(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormatHeader(),
-			&data.messageType,
-			&data.header.commandCount,
-			&data.header.frameCount,
-			&data.header.networkPlayerFactionCRC[0],
-			&data.header.networkPlayerFactionCRC[1],
-			&data.header.networkPlayerFactionCRC[2],
-			&data.header.networkPlayerFactionCRC[3],
-			&data.header.networkPlayerFactionCRC[4],
-			&data.header.networkPlayerFactionCRC[5],
-			&data.header.networkPlayerFactionCRC[6],
-			&data.header.networkPlayerFactionCRC[7]);
+	NetworkUnpacker archive(buf, getPackedSizeHeader());
+	serializeHeader(archive, data);
 }
 
 unsigned char * NetworkMessageCommandList::packMessageHeader() {
 	unsigned char *buf = new unsigned char[getPackedSizeHeader()+1];
-	pack(buf, getPackedMessageFormatHeader(),
-			data.messageType,
-			data.header.commandCount,
-			data.header.frameCount,
-			data.header.networkPlayerFactionCRC[0],
-			data.header.networkPlayerFactionCRC[1],
-			data.header.networkPlayerFactionCRC[2],
-			data.header.networkPlayerFactionCRC[3],
-			data.header.networkPlayerFactionCRC[4],
-			data.header.networkPlayerFactionCRC[5],
-			data.header.networkPlayerFactionCRC[6],
-			data.header.networkPlayerFactionCRC[7]);
+	NetworkPacker archive(buf, getPackedSizeHeader());
+	serializeHeader(archive, data);
 	return buf;
 }
 
-const char * NetworkMessageCommandList::getPackedMessageFormatDetail() const {
-	return "hlhhhhlccHccll";
-}
-
 unsigned int NetworkMessageCommandList::getPackedSizeDetail(int count) {
-	unsigned int result = 0;
-	//if(result == 0) {
-		for(unsigned int i = 0; i < (unsigned int)count; ++i) {
-			NetworkCommand packedData;
-			unsigned char *buf = new unsigned char[sizeof(NetworkCommand)*3];
-			result += pack(buf, getPackedMessageFormatDetail(),
-					packedData.networkCommandType,
-					packedData.unitId,
-					packedData.unitTypeId,
-					packedData.commandTypeId,
-					packedData.positionX,
-					packedData.positionY,
-					packedData.targetId,
-					packedData.wantQueue,
-					packedData.fromFactionIndex,
-					packedData.unitFactionUnitCount,
-					packedData.unitFactionIndex,
-					packedData.commandStateType,
-					packedData.commandStateValue,
-					packedData.unitCommandGroupId);
-			delete [] buf;
-		}
-	//}
-	return result;
+	static unsigned int commandSize = 0;
+	if(commandSize == 0) {
+		NetworkCommand packedData;
+		NetworkPackedSize archive;
+		packedData.serialize(archive);
+		commandSize = archive.getSize();
+	}
+	return commandSize * count;
 }
 void NetworkMessageCommandList::unpackMessageDetail(unsigned char *buf,int count) {
 	data.commands.clear();
 	data.commands.resize(count);
-	//unsigned int bytes_processed_total = 0;
-	unsigned char *bufMove = buf;
+	NetworkUnpacker archive(buf, getPackedSizeDetail(count));
 	for(unsigned int i = 0; i < (unsigned int)count; ++i) {
-		unsigned int bytes_processed = unpack(bufMove, getPackedMessageFormatDetail(),
-				&data.commands[i].networkCommandType,
-				&data.commands[i].unitId,
-				&data.commands[i].unitTypeId,
-				&data.commands[i].commandTypeId,
-				&data.commands[i].positionX,
-				&data.commands[i].positionY,
-				&data.commands[i].targetId,
-				&data.commands[i].wantQueue,
-				&data.commands[i].fromFactionIndex,
-				&data.commands[i].unitFactionUnitCount,
-				&data.commands[i].unitFactionIndex,
-				&data.commands[i].commandStateType,
-				&data.commands[i].commandStateValue,
-				&data.commands[i].unitCommandGroupId);
-		bufMove += bytes_processed;
-		//bytes_processed_total += bytes_processed;
-	}
-	//printf("\nUnPacked detail size = %u\n",bytes_processed_total);
+		data.commands[i].serialize(archive);
+	}
 }
 
 unsigned char * NetworkMessageCommandList::packMessageDetail(uint16 totalCommand) {
 	int packetSize = getPackedSizeDetail(totalCommand) +1;
 	unsigned char *buf = new unsigned char[packetSize];
-	unsigned char *bufMove = buf;
-	//unsigned int bytes_processed_total = 0;
+	NetworkPacker archive(buf, getPackedSizeDetail(totalCommand));
 	for(unsigned int i = 0; i < totalCommand; ++i) {
-		unsigned int bytes_processed = pack(bufMove, getPackedMessageFormatDetail(),
-				data.commands[i].networkCommandType,
-				data.commands[i].unitId,
-				data.commands[i].unitTypeId,
-				data.commands[i].commandTypeId,
-				data.commands[i].positionX,
-				data.commands[i].positionY,
-				data.commands[i].targetId,
-				data.commands[i].wantQueue,
-				data.commands[i].fromFactionIndex,
-				data.commands[i].unitFactionUnitCount,
-				data.commands[i].unitFactionIndex,
-				data.commands[i].commandStateType,
-				data.commands[i].commandStateValue,
-				data.commands[i].unitCommandGroupId);
-		bufMove += bytes_processed;
-		//bytes_processed_total += bytes_processed;
-	}
-	//printf("\nPacked detail size = %u, allocated = %d\n",bytes_processed_total,packetSize);
+		data.commands[i].serialize(archive);
+	}
 	return buf;
 }
 
@@ -2053,45 +1465,24 @@ NetworkMessageText * NetworkMessageText::getCopy() const {
 	return copy;
 }
 
-const char * NetworkMessageText::getPackedMessageFormat() const {
-	return "c500scc60s";
-}
-
 unsigned int NetworkMessageText::getPackedSize() {
 	static unsigned int result = 0;
 	if(result == 0) {
-		Data packedData;
-		messageType = nmtText;
-		packedData.playerIndex = 0;
-		packedData.teamIndex = 0;
-		unsigned char *buf = new unsigned char[sizeof(packedData)*3];
-		result = pack(buf, getPackedMessageFormat(),
-				messageType,
-				packedData.text.getBuffer(),
-				packedData.teamIndex,
-				packedData.playerIndex,
-				packedData.targetLanguage.getBuffer());
-		delete [] buf;
+		NetworkPackedSize archive;
+		serialize(archive, messageType, data);
+		result = archive.getSize();
 	}
 	return result;
 }
 void NetworkMessageText::unpackMessage(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormat(),
-			&messageType,
-			data.text.getBuffer(),
-			&data.teamIndex,
-			&data.playerIndex,
-			data.targetLanguage.getBuffer());
+	NetworkUnpacker archive(buf, getPackedSize());
+	serialize(archive, messageType, data);
 }
 
 unsigned char * NetworkMessageText::packMessage() {
 	unsigned char *buf = new unsigned char[getPackedSize()+1];
-	pack(buf, getPackedMessageFormat(),
-			messageType,
-			data.text.getBuffer(),
-			data.teamIndex,
-			data.playerIndex,
-			data.targetLanguage.getBuffer());
+	NetworkPacker archive(buf, getPackedSize());
+	serialize(archive, messageType, data);
 	return buf;
 }
 
@@ -2161,31 +1552,24 @@ NetworkMessageQuit::NetworkMessageQuit(){
 	messageType = nmtQuit;
 }
 
-const char * NetworkMessageQuit::getPackedMessageFormat() const {
-	return "c";
-}
-
 unsigned int NetworkMessageQuit::getPackedSize() {
 	static unsigned int result = 0;
 	if(result == 0) {
-		//Data packedData;
-		messageType = 0;
-		unsigned char *buf = new unsigned char[sizeof(messageType)*3];
-		result = pack(buf, getPackedMessageFormat(),
-				messageType);
-		delete [] buf;
+		NetworkPackedSize archive;
+		serialize(archive, messageType);
+		result = archive.getSize();
 	}
 	return result;
 }
 void NetworkMessageQuit::unpackMessage(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormat(),
-			&messageType);
+	NetworkUnpacker archive(buf, getPackedSize());
+	serialize(archive, messageType);
 }
 
 unsigned char * NetworkMessageQuit::packMessage() {
 	unsigned char *buf = new unsigned char[getPackedSize()+1];
-	pack(buf, getPackedMessageFormat(),
-			messageType);
+	NetworkPacker archive(buf, getPackedSize());
+	serialize(archive, messageType);
 	return buf;
 }
 
@@ -2352,111 +1736,48 @@ string NetworkMessageSynchNetworkGameData::getTechCRCFileMismatchReport(vector<s
 	return result;
 }
 
-const char * NetworkMessageSynchNetworkGameData::getPackedMessageFormatHeader() const {
-	return "c255s255s255sLLLL";
-}
-
 unsigned int NetworkMessageSynchNetworkGameData::getPackedSizeHeader() {
 	static unsigned int result = 0;
 	if(result == 0) {
-		Data packedData;
-		packedData.messageType=0;
-		unsigned char *buf = new unsigned char[sizeof(packedData)*3];
-		result = pack(buf, getPackedMessageFormatHeader(),
-				packedData.messageType,
-				packedData.header.map.getBuffer(),
-				packedData.header.tileset.getBuffer(),
-				packedData.header.tech.getBuffer(),
-				packedData.header.mapCRC,
-				packedData.header.tilesetCRC,
-				packedData.header.techCRC,
-				packedData.header.techCRCFileCount);
-		delete [] buf;
+		NetworkPackedSize archive;
+		serializeHeader(archive, data);
+		result = archive.getSize();
 	}
 	return result;
 }
 void NetworkMessageSynchNetworkGameData::unpackMessageHeader(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormatHeader(),
-			&data.messageType,
-			data.header.map.getBuffer(),
-			data.header.tileset.getBuffer(),
-			data.header.tech.getBuffer(),
-			&data.header.mapCRC,
-			&data.header.tilesetCRC,
-			&data.header.techCRC,
-			&data.header.techCRCFileCount);
+	NetworkUnpacker archive(buf, getPackedSizeHeader());
+	serializeHeader(archive, data);
 }
 
 unsigned char * NetworkMessageSynchNetworkGameData::packMessageHeader() {
 	unsigned char *buf = new unsigned char[getPackedSizeHeader()+1];
-	pack(buf, getPackedMessageFormatHeader(),
-			data.messageType,
-			data.header.map.getBuffer(),
-			data.header.tileset.getBuffer(),
-			data.header.tech.getBuffer(),
-			data.header.mapCRC,
-			data.header.tilesetCRC,
-			data.header.techCRC,
-			data.header.techCRCFileCount);
-
+	NetworkPacker archive(buf, getPackedSizeHeader());
+	serializeHeader(archive, data);
 	return buf;
 }
 
 unsigned int NetworkMessageSynchNetworkGameData::getPackedSizeDetail() {
 	static unsigned int result = 0;
 	if(result == 0) {
-		DataDetail packedData;
-		for(unsigned int index = 0; index < (unsigned int)maxFileCRCCount; ++index) {
-			packedData.techCRCFileCRCList[index] = 0;
-		}
-		unsigned char *buf = new unsigned char[sizeof(DataDetail)*3];
-
-		for(unsigned int i = 0; i < (unsigned int)maxFileCRCCount; ++i) {
-			result += pack(buf, "255s",
-					packedData.techCRCFileList[i].getBuffer());
-			buf += result;
-		}
-		for(unsigned int i = 0; i < (unsigned int)maxFileCRCCount; ++i) {
-			result += pack(buf, "L",
-					packedData.techCRCFileCRCList[i]);
-			buf += result;
-		}
-
-		delete [] buf;
+		NetworkPackedSize archive;
+		serializeDetail(archive, data.detail);
+		result = archive.getSize();
 	}
 	return result;
 }
 void NetworkMessageSynchNetworkGameData::unpackMessageDetail(unsigned char *buf) {
-	for(unsigned int i = 0; i < (unsigned int)maxFileCRCCount; ++i) {
-		unsigned int bytes_processed = unpack(buf, "255s",
-				data.detail.techCRCFileList[i].getBuffer());
-		buf += bytes_processed;
-	}
-	for(unsigned int i = 0; i < (unsigned int)maxFileCRCCount; ++i) {
-		unsigned int bytes_processed = unpack(buf, "L",
-				&data.detail.techCRCFileCRCList[i]);
-		buf += bytes_processed;
-	}
+	NetworkUnpacker archive(buf, getPackedSizeDetail());
+	serializeDetail(archive, data.detail);
 }
 
 unsigned char * NetworkMessageSynchNetworkGameData::packMessageDetail() {
-	unsigned char *buf = new unsigned char[sizeof(DataDetail)*3 +1];
-	unsigned char *bufMove = buf;
-	for(unsigned int i = 0; i < (unsigned int)maxFileCRCCount; ++i) {
-		unsigned int bytes_processed = pack(bufMove, "255s",
-				data.detail.techCRCFileList[i].getBuffer());
-		bufMove += bytes_processed;
-	}
-	for(unsigned int i = 0; i < (unsigned int)maxFileCRCCount; ++i) {
-		unsigned int bytes_processed = pack(bufMove, "L",
-				data.detail.techCRCFileCRCList[i]);
-		bufMove += bytes_processed;
-	}
-
+	unsigned char *buf = new unsigned char[getPackedSizeDetail()+1];
+	NetworkPacker archive(buf, getPackedSizeDetail());
+	serializeDetail(archive, data.detail);
 	return buf;
 }
 
-
 bool NetworkMessageSynchNetworkGameData::receive(Socket* socket) {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] about to get nmtSynchNetworkGameData\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
@@ -2797,47 +2118,24 @@ NetworkMessageSynchNetworkGameDataFileCRCCheck::NetworkMessageSynchNetworkGameDa
     data.fileName       = fileName;
 }
 
-const char * NetworkMessageSynchNetworkGameDataFileCRCCheck::getPackedMessageFormat() const {
-	return "cLLL256s";
-}
-
 unsigned int NetworkMessageSynchNetworkGameDataFileCRCCheck::getPackedSize() {
 	static unsigned int result = 0;
 	if(result == 0) {
-		Data packedData;
-		packedData.fileCRC = 0;
-		packedData.fileIndex = 0;
-		messageType = nmtSynchNetworkGameDataFileCRCCheck;
-		packedData.totalFileCount = 0;
-
-		unsigned char *buf = new unsigned char[sizeof(packedData)*3];
-		result = pack(buf, getPackedMessageFormat(),
-				messageType,
-				packedData.totalFileCount,
-				packedData.fileIndex,
-				packedData.fileCRC,
-				packedData.fileName.getBuffer());
-		delete [] buf;
+		NetworkPackedSize archive;
+		serialize(archive, messageType, data);
+		result = archive.getSize();
 	}
 	return result;
 }
 void NetworkMessageSynchNetworkGameDataFileCRCCheck::unpackMessage(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormat(),
-			&messageType,
-			&data.totalFileCount,
-			&data.fileIndex,
-			&data.fileCRC,
-			data.fileName.getBuffer());
+	NetworkUnpacker archive(buf, getPackedSize());
+	serialize(archive, messageType, data);
 }
 
 unsigned char * NetworkMessageSynchNetworkGameDataFileCRCCheck::packMessage() {
 	unsigned char *buf = new unsigned char[getPackedSize()+1];
-	pack(buf, getPackedMessageFormat(),
-			messageType,
-			data.totalFileCount,
-			data.fileIndex,
-			data.fileCRC,
-			data.fileName.getBuffer());
+	NetworkPacker archive(buf, getPackedSize());
+	serialize(archive, messageType, data);
 	return buf;
 }
 
@@ -2907,34 +2205,24 @@ NetworkMessageSynchNetworkGameDataFileGet::NetworkMessageSynchNetworkGameDataFil
     data.fileName       = fileName;
 }
 
-const char * NetworkMessageSynchNetworkGameDataFileGet::getPackedMessageFormat() const {
-	return "c256s";
-}
-
 unsigned int NetworkMessageSynchNetworkGameDataFileGet::getPackedSize() {
 	static unsigned int result = 0;
 	if(result == 0) {
-		Data packedData;
-		messageType = nmtSynchNetworkGameDataFileGet;
-		unsigned char *buf = new unsigned char[sizeof(packedData)*3];
-		result = pack(buf, getPackedMessageFormat(),
-				messageType,
-				packedData.fileName.getBuffer());
-		delete [] buf;
+		NetworkPackedSize archive;
+		serialize(archive, messageType, data);
+		result = archive.getSize();
 	}
 	return result;
 }
 void NetworkMessageSynchNetworkGameDataFileGet::unpackMessage(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormat(),
-			&messageType,
-			data.fileName.getBuffer());
+	NetworkUnpacker archive(buf, getPackedSize());
+	serialize(archive, messageType, data);
 }
 
 unsigned char * NetworkMessageSynchNetworkGameDataFileGet::packMessage() {
 	unsigned char *buf = new unsigned char[getPackedSize()+1];
-	pack(buf, getPackedMessageFormat(),
-			messageType,
-			data.fileName.getBuffer());
+	NetworkPacker archive(buf, getPackedSize());
+	serialize(archive, messageType, data);
 	return buf;
 }
 
@@ -3018,61 +2306,24 @@ SwitchSetupRequest::SwitchSetupRequest(string selectedFactionName, int8 currentF
     data.language = language;
 }
 
-const char * SwitchSetupRequest::getPackedMessageFormat() const {
-	return "c256sccc80scc60s";
-}
-
 unsigned int SwitchSetupRequest::getPackedSize() {
 	static unsigned int result = 0;
 	if(result == 0) {
-		Data packedData;
-		packedData.currentSlotIndex = 0;
-		messageType = nmtSwitchSetupRequest;
-		packedData.networkPlayerStatus = 0;
-		packedData.switchFlags = 0;
-		packedData.toSlotIndex = 0;
-		packedData.toTeam = 0;
-
-		unsigned char *buf = new unsigned char[sizeof(Data)*3];
-		result = pack(buf, getPackedMessageFormat(),
-				messageType,
-				packedData.selectedFactionName.getBuffer(),
-				packedData.currentSlotIndex,
-				packedData.toSlotIndex,
-				packedData.toTeam,
-				packedData.networkPlayerName.getBuffer(),
-				packedData.networkPlayerStatus,
-				packedData.switchFlags,
-				packedData.language.getBuffer());
-		delete [] buf;
+		NetworkPackedSize archive;
+		serialize(archive, messageType, data);
+		result = archive.getSize();
 	}
 	return result;
 }
 void SwitchSetupRequest::unpackMessage(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormat(),
-			&messageType,
-			data.selectedFactionName.getBuffer(),
-			&data.currentSlotIndex,
-			&data.toSlotIndex,
-			&data.toTeam,
-			data.networkPlayerName.getBuffer(),
-			&data.networkPlayerStatus,
-			&data.switchFlags,
-			data.language.getBuffer());
+	NetworkUnpacker archive(buf, getPackedSize());
+	serialize(archive, messageType, data);
 }
 
 unsigned char * SwitchSetupRequest::packMessage() {
 	unsigned char *buf = new unsigned char[getPackedSize()+1];
-	pack(buf, getPackedMessageFormat(),
-			messageType,
-			data.selectedFactionName.getBuffer(),
-			data.currentSlotIndex,
-			data.toSlotIndex,
-			data.toTeam,
-			data.networkPlayerName.getBuffer(),
-			data.networkPlayerStatus,
-			data.switchFlags,
-			data.language.getBuffer());
+	NetworkPacker archive(buf, getPackedSize());
+	serialize(archive, messageType, data);
 	return buf;
 }
 
@@ -3154,35 +2405,24 @@ PlayerIndexMessage::PlayerIndexMessage(int16 playerIndex) {
 	data.playerIndex=playerIndex;
 }
 
-const char * PlayerIndexMessage::getPackedMessageFormat() const {
-	return "ch";
-}
-
 unsigned int PlayerIndexMessage::getPackedSize() {
 	static unsigned int result = 0;
 	if(result == 0) {
-		Data packedData;
-		messageType = 0;
-		packedData.playerIndex = 0;
-		unsigned char *buf = new unsigned char[sizeof(packedData)*3];
-		result = pack(buf, getPackedMessageFormat(),
-				messageType,
-				packedData.playerIndex);
-		delete [] buf;
+		NetworkPackedSize archive;
+		serialize(archive, messageType, data);
+		result = archive.getSize();
 	}
 	return result;
 }
 void PlayerIndexMessage::unpackMessage(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormat(),
-			&messageType,
-			&data.playerIndex);
+	NetworkUnpacker archive(buf, getPackedSize());
+	serialize(archive, messageType, data);
 }
 
 unsigned char * PlayerIndexMessage::packMessage() {
 	unsigned char *buf = new unsigned char[getPackedSize()+1];
-	pack(buf, getPackedMessageFormat(),
-			messageType,
-			data.playerIndex);
+	NetworkPacker archive(buf, getPackedSize());
+	serialize(archive, messageType, data);
 	return buf;
 }
 
@@ -3249,35 +2489,24 @@ NetworkMessageLoadingStatus::NetworkMessageLoadingStatus(uint32 status)
 	data.status=status;
 }
 
-const char * NetworkMessageLoadingStatus::getPackedMessageFormat() const {
-	return "cL";
-}
-
 unsigned int NetworkMessageLoadingStatus::getPackedSize() {
 	static unsigned int result = 0;
 	if(result == 0) {
-		Data packedData;
-		messageType = 0;
-		packedData.status = 0;
-		unsigned char *buf = new unsigned char[sizeof(packedData)*3];
-		result = pack(buf, getPackedMessageFormat(),
-				messageType,
-				packedData.status);
-		delete [] buf;
+		NetworkPackedSize archive;
+		serialize(archive, messageType, data);
+		result = archive.getSize();
 	}
 	return result;
 }
 void NetworkMessageLoadingStatus::unpackMessage(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormat(),
-			&messageType,
-			&data.status);
+	NetworkUnpacker archive(buf, getPackedSize());
+	serialize(archive, messageType, data);
 }
 
 unsigned char * NetworkMessageLoadingStatus::packMessage() {
 	unsigned char *buf = new unsigned char[getPackedSize()+1];
-	pack(buf, getPackedMessageFormat(),
-			messageType,
-			data.status);
+	NetworkPacker archive(buf, getPackedSize());
+	serialize(archive, messageType, data);
 	return buf;
 }
 
@@ -3359,53 +2588,24 @@ NetworkMessageMarkCell * NetworkMessageMarkCell::getCopy() const {
 	return copy;
 }
 
-const char * NetworkMessageMarkCell::getPackedMessageFormat() const {
-	return "chhcc500s";
-}
-
 unsigned int NetworkMessageMarkCell::getPackedSize() {
 	static unsigned int result = 0;
 	if(result == 0) {
-		Data packedData;
-		packedData.factionIndex = 0;
-		messageType = nmtMarkCell;
-		packedData.playerIndex = 0;
-		packedData.targetX = 0;
-		packedData.targetY = 0;
-
-		unsigned char *buf = new unsigned char[sizeof(packedData)*3];
-		result = pack(buf, getPackedMessageFormat(),
-				messageType,
-				packedData.targetX,
-				packedData.targetY,
-				packedData.factionIndex,
-				packedData.playerIndex,
-				packedData.text.getBuffer());
-		delete [] buf;
+		NetworkPackedSize archive;
+		serialize(archive, messageType, data);
+		result = archive.getSize();
 	}
 	return result;
 }
 void NetworkMessageMarkCell::unpackMessage(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormat(),
-			&messageType,
-			&data.targetX,
-			&data.targetY,
-			&data.factionIndex,
-			&data.playerIndex,
-			data.text.getBuffer());
-
+	NetworkUnpacker archive(buf, getPackedSize());
+	serialize(archive, messageType, data);
 }
 
 unsigned char * NetworkMessageMarkCell::packMessage() {
 	unsigned char *buf = new unsigned char[getPackedSize()+1];
-	pack(buf, getPackedMessageFormat(),
-			messageType,
-			data.targetX,
-			data.targetY,
-			data.factionIndex,
-			data.playerIndex,
-			data.text.getBuffer());
-
+	NetworkPacker archive(buf, getPackedSize());
+	serialize(archive, messageType, data);
 	return buf;
 }
 
@@ -3493,45 +2693,24 @@ NetworkMessageUnMarkCell * NetworkMessageUnMarkCell::getCopy() const {
 	return copy;
 }
 
-const char * NetworkMessageUnMarkCell::getPackedMessageFormat() const {
-	return "chhc";
-}
-
 unsigned int NetworkMessageUnMarkCell::getPackedSize() {
 	static unsigned int result = 0;
 	if(result == 0) {
-		Data packedData;
-		packedData.factionIndex = 0;
-		messageType = 0;
-		packedData.targetX = 0;
-		packedData.targetY = 0;
-		unsigned char *buf = new unsigned char[sizeof(packedData)*3];
-		result = pack(buf, getPackedMessageFormat(),
-				messageType,
-				packedData.targetX,
-				packedData.targetY,
-				packedData.factionIndex);
-		delete [] buf;
+		NetworkPackedSize archive;
+		serialize(archive, messageType, data);
+		result = archive.getSize();
 	}
 	return result;
 }
 void NetworkMessageUnMarkCell::unpackMessage(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormat(),
-			&messageType,
-			&data.targetX,
-			&data.targetY,
-			&data.factionIndex);
-
+	NetworkUnpacker archive(buf, getPackedSize());
+	serialize(archive, messageType, data);
 }
 
 unsigned char * NetworkMessageUnMarkCell::packMessage() {
 	unsigned char *buf = new unsigned char[getPackedSize()+1];
-	pack(buf, getPackedMessageFormat(),
-			messageType,
-			data.targetX,
-			data.targetY,
-			data.factionIndex);
-
+	NetworkPacker archive(buf, getPackedSize());
+	serialize(archive, messageType, data);
 	return buf;
 }
 
@@ -3610,45 +2789,24 @@ NetworkMessageHighlightCell::NetworkMessageHighlightCell(Vec2i target, int facti
 	data.factionIndex 	= factionIndex;
 }
 
-const char * NetworkMessageHighlightCell::getPackedMessageFormat() const {
-	return "chhc";
-}
-
 unsigned int NetworkMessageHighlightCell::getPackedSize() {
 	static unsigned int result = 0;
 	if(result == 0) {
-		Data packedData;
-		packedData.factionIndex = 0;
-		messageType = 0;
-		packedData.targetX = 0;
-		packedData.targetY = 0;
-		unsigned char *buf = new unsigned char[sizeof(packedData)*3];
-		result = pack(buf, getPackedMessageFormat(),
-				messageType,
-				packedData.targetX,
-				packedData.targetY,
-				packedData.factionIndex);
-		delete [] buf;
+		NetworkPackedSize archive;
+		serialize(archive, messageType, data);
+		result = archive.getSize();
 	}
 	return result;
 }
 void NetworkMessageHighlightCell::unpackMessage(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormat(),
-			&messageType,
-			&data.targetX,
-			&data.targetY,
-			&data.factionIndex);
-
+	NetworkUnpacker archive(buf, getPackedSize());
+	serialize(archive, messageType, data);
 }
 
 unsigned char * NetworkMessageHighlightCell::packMessage() {
 	unsigned char *buf = new unsigned char[getPackedSize()+1];
-	pack(buf, getPackedMessageFormat(),
-			messageType,
-			data.targetX,
-			data.targetY,
-			data.factionIndex);
-
+	NetworkPacker archive(buf, getPackedSize());
+	serialize(archive, messageType, data);
 	return buf;
 }
 
@@ -28,6 +28,8 @@
 #include "network_types.h"
 #include "byte_order.h"
 #include <map>
+#include <vector>
+#include <SDL_atomic.h>
 #include "common_scoped_ptr.h"
 #include "leak_dumper.h"
 
@@ -120,6 +122,7 @@ public:
 	static string getNetworkPacketStats();
 
 	static bool useOldProtocol;
+	NetworkMessage() : sendCaptureBuffer(NULL) {}
 	virtual ~NetworkMessage(){}
 	virtual bool receive(Socket* socket)= 0;
 	virtual bool receive(Socket* socket, NetworkMessageType type) { return receive(socket); };
@@ -132,19 +135,54 @@ public:
 
 	void dump_packet(string label, const void* data, int dataSize, bool isSend);
 
+	// Runs send() against a buffer instead of a socket, producing the exact
+	// bytes that would go on the wire
+	void encode(vector<char> &buffer);
+
 protected:
+	vector<char> *sendCaptureBuffer;
+
 	//bool peek(Socket* socket, void* data, int dataSize);
 	bool receive(Socket* socket, void* data, int dataSize,bool tryReceiveUntilDataSizeMet);
 	void send(Socket* socket, const void* data, int dataSize);
 	void send(Socket* socket, const void* data, int dataSize, int8 messageType);
 	void send(Socket* socket, const void* data, int dataSize, int8 messageType, uint32 compressedLength);
 
-	virtual const char * getPackedMessageFormat() const = 0;
 	virtual unsigned int getPackedSize() = 0;
 	virtual void unpackMessage(unsigned char *buf) = 0;
 	virtual unsigned char * packMessage() = 0;
 };
 
+// =====================================================
+//	class NetworkMessageBuffer
+//
+//	A message encoded once for broadcast. It is immutable
+//	and reference counted so every connection slot can
+//	queue the same bytes.
+// =====================================================
+
+class NetworkMessageBuffer {
+private:
+	vector<char> data;
+	NetworkMessageType messageType;
+	string targetLanguage;
+	SDL_atomic_t refCount;
+
+	NetworkMessageBuffer();
+	~NetworkMessageBuffer() {}
+
+public:
+	static NetworkMessageBuffer * encode(NetworkMessage *networkMessage);
+
+	const char * getData() const { return (data.empty() == false ? &data[0] : NULL); }
+	int getDataSize() const { return (int)data.size(); }
+	NetworkMessageType getNetworkMessageType() const { return messageType; }
+	const string & getTargetLanguage() const { return targetLanguage; }
+
+	void addRef() { SDL_AtomicIncRef(&refCount); }
+	static void release(NetworkMessageBuffer *buffer);
+};
+
 // =====================================================
 //	class NetworkMessageIntro
 //
@@ -191,7 +229,22 @@ public:
 			int gameInProgress, const string &playerUUID, const string &platform);
 
 
-	virtual const char * getPackedMessageFormat() const;
+	friend class NetworkMessageTest;
+	//wire layout of the packed message
+	template<class Archive> static void serialize(Archive &archive, int8 &messageType, Data &data) {
+		archive & messageType
+				& data.sessionId
+				& data.versionString
+				& data.name
+				& data.playerIndex
+				& data.gameState
+				& data.externalIp
+				& data.ftpPort
+				& data.language
+				& data.gameInProgress
+				& data.playerUUID
+				& data.platform;
+	}
 	virtual unsigned int getPackedSize();
 	virtual void unpackMessage(unsigned char *buf);
 	virtual unsigned char * packMessage();
@@ -244,7 +297,13 @@ private:
 	int64 pingReceivedLocalTime;
 
 protected:
-	virtual const char * getPackedMessageFormat() const;
+	friend class NetworkMessageTest;
+	//wire layout of the packed message
+	template<class Archive> static void serialize(Archive &archive, int8 &messageType, Data &data) {
+		archive & messageType
+				& data.pingFrequency
+				& data.pingTime;
+	}
 	virtual unsigned int getPackedSize();
 	virtual void unpackMessage(unsigned char *buf);
 	virtual unsigned char * packMessage();
@@ -289,7 +348,12 @@ private:
 	Data data;
 
 protected:
-	virtual const char * getPackedMessageFormat() const;
+	friend class NetworkMessageTest;
+	//wire layout of the packed message
+	template<class Archive> static void serialize(Archive &archive, int8 &messageType, Data &data) {
+		archive & messageType
+				& data.checksum;
+	}
 	virtual unsigned int getPackedSize();
 	virtual void unpackMessage(unsigned char *buf);
 	virtual unsigned char * packMessage();
@@ -386,7 +450,75 @@ private:
 	Data data;
 
 protected:
-	virtual const char * getPackedMessageFormat() const;
+	friend class NetworkMessageTest;
+	//wire layout of the packed message
+	template<class Archive> static void serialize(Archive &archive, int8 &messageType, Data &data) {
+		archive & messageType
+				& data.description
+				& data.map
+				& data.tileset
+				& data.tech;
+		for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+			archive & data.factionTypeNames[i];
+		}
+		for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+			archive & data.networkPlayerNames[i];
+		}
+		for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+			archive & data.networkPlayerPlatform[i];
+		}
+		for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+			archive & data.networkPlayerStatuses[i];
+		}
+		for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+			archive & data.networkPlayerLanguages[i];
+		}
+		archive & data.mapCRC
+				& data.mapFilter
+				& data.tilesetCRC
+				& data.techCRC;
+		for(int i = 0; i < maxFactionCRCCount; ++i) {
+			archive & data.factionNameList[i];
+		}
+		for(int i = 0; i < maxFactionCRCCount; ++i) {
+			archive & data.factionCRCList[i];
+		}
+		for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+			archive & data.factionControls[i];
+		}
+		for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+			archive & data.resourceMultiplierIndex[i];
+		}
+		archive & data.thisFactionIndex
+				& data.factionCount;
+		for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+			archive & data.teams[i];
+		}
+		for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+			archive & data.startLocationIndex[i];
+		}
+		archive & data.defaultResources
+				& data.defaultUnits
+				& data.defaultVictoryConditions
+				& data.fogOfWar
+				& data.allowObservers
+				& data.enableObserverModeAtEndGame
+				& data.enableServerControlledAI
+				& data.networkFramePeriod
+				& data.networkPauseGameForLaggedClients
+				& data.pathFinderType
+				& data.flagTypes1
+				& data.aiAcceptSwitchTeamPercentChance
+				& data.cpuReplacementMultiplier
+				& data.masterserver_admin
+				& data.masterserver_admin_factionIndex
+				& data.scenario;
+		for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+			archive & data.networkPlayerUUID[i];
+		}
+		archive & data.networkAllowNativeLanguageTechtree
+				& data.gameUUID;
+	}
 	virtual unsigned int getPackedSize();
 	virtual void unpackMessage(unsigned char *buf);
 	virtual unsigned char * packMessage();
@@ -437,6 +569,10 @@ private:
 
 	static const int32 commandListHeaderSize = sizeof(DataHeader);
 
+	//the packed header has always carried the faction CRCs of the first
+	//8 players only (the old "cHlLLLLLLLL" format), the others are not sent
+	static const int packedFactionCRCCount = 8;
+
 	struct Data {
 		int8 messageType;
 		DataHeader header;
@@ -459,17 +595,24 @@ private:
 	Data data;
 
 protected:
-	virtual const char * getPackedMessageFormat() const { return NULL; }
 	virtual unsigned int getPackedSize() { return 0; }
 	virtual void unpackMessage(unsigned char *buf) { };
 	virtual unsigned char * packMessage() { return NULL; }
 
-	const char * getPackedMessageFormatHeader() const;
+	friend class NetworkMessageTest;
+	//wire layout of the packed header, the commands follow it
+	template<class Archive> static void serializeHeader(Archive &archive, Data &data) {
+		archive & data.messageType
+				& data.header.commandCount
+				& data.header.frameCount;
+		for(int i = 0; i < packedFactionCRCCount; ++i) {
+			archive & data.header.networkPlayerFactionCRC[i];
+		}
+	}
 	unsigned int getPackedSizeHeader();
 	void unpackMessageHeader(unsigned char *buf);
 	unsigned char * packMessageHeader();
 
-	const char * getPackedMessageFormatDetail() const;
 	unsigned int getPackedSizeDetail(int count);
 	void unpackMessageDetail(unsigned char *buf,int count);
 	unsigned char * packMessageDetail(uint16 totalCommand);
@@ -526,7 +669,15 @@ private:
 	Data data;
 
 protected:
-	virtual const char * getPackedMessageFormat() const;
+	friend class NetworkMessageTest;
+	//wire layout of the packed message
+	template<class Archive> static void serialize(Archive &archive, int8 &messageType, Data &data) {
+		archive & messageType
+				& data.text
+				& data.teamIndex
+				& data.playerIndex
+				& data.targetLanguage;
+	}
 	virtual unsigned int getPackedSize();
 	virtual void unpackMessage(unsigned char *buf);
 	virtual unsigned char * packMessage();
@@ -574,7 +725,11 @@ private:
 	//Data data;
 
 protected:
-	virtual const char * getPackedMessageFormat() const;
+	friend class NetworkMessageTest;
+	//wire layout of the packed message
+	template<class Archive> static void serialize(Archive &archive, int8 &messageType) {
+		archive & messageType;
+	}
 	virtual unsigned int getPackedSize();
 	virtual void unpackMessage(unsigned char *buf);
 	virtual unsigned char * packMessage();
@@ -647,12 +802,31 @@ private:
 	Data data;
 
 protected:
-	virtual const char * getPackedMessageFormat() const { return NULL; }
 	virtual unsigned int getPackedSize() { return 0; }
 	virtual void unpackMessage(unsigned char *buf) { };
 	virtual unsigned char * packMessage() { return NULL; }
 
-	const char * getPackedMessageFormatHeader() const;
+	friend class NetworkMessageTest;
+	//wire layout of the packed header
+	template<class Archive> static void serializeHeader(Archive &archive, Data &data) {
+		archive & data.messageType
+				& data.header.map
+				& data.header.tileset
+				& data.header.tech
+				& data.header.mapCRC
+				& data.header.tilesetCRC
+				& data.header.techCRC
+				& data.header.techCRCFileCount;
+	}
+	//wire layout of the packed detail, every file name then every CRC
+	template<class Archive> static void serializeDetail(Archive &archive, DataDetail &detail) {
+		for(int i = 0; i < maxFileCRCCount; ++i) {
+			archive & detail.techCRCFileList[i];
+		}
+		for(int i = 0; i < maxFileCRCCount; ++i) {
+			archive & detail.techCRCFileCRCList[i];
+		}
+	}
 	unsigned int getPackedSizeHeader();
 	void unpackMessageHeader(unsigned char *buf);
 	unsigned char * packMessageHeader();
@@ -738,7 +912,6 @@ private:
 	Data data;
 
 protected:
-	virtual const char * getPackedMessageFormat() const { return NULL; }
 	virtual unsigned int getPackedSize() { return 0; }
 	virtual void unpackMessage(unsigned char *buf) { };
 	virtual unsigned char * packMessage() { return NULL; }
@@ -799,7 +972,15 @@ private:
 	Data data;
 
 protected:
-	virtual const char * getPackedMessageFormat() const;
+	friend class NetworkMessageTest;
+	//wire layout of the packed message
+	template<class Archive> static void serialize(Archive &archive, int8 &messageType, Data &data) {
+		archive & messageType
+				& data.totalFileCount
+				& data.fileIndex
+				& data.fileCRC
+				& data.fileName;
+	}
 	virtual unsigned int getPackedSize();
 	virtual void unpackMessage(unsigned char *buf);
 	virtual unsigned char * packMessage();
@@ -851,7 +1032,12 @@ private:
 	Data data;
 
 protected:
-	virtual const char * getPackedMessageFormat() const;
+	friend class NetworkMessageTest;
+	//wire layout of the packed message
+	template<class Archive> static void serialize(Archive &archive, int8 &messageType, Data &data) {
+		archive & messageType
+				& data.fileName;
+	}
 	virtual unsigned int getPackedSize();
 	virtual void unpackMessage(unsigned char *buf);
 	virtual unsigned char * packMessage();
@@ -918,7 +1104,19 @@ private:
 	Data data;
 
 public:
-	virtual const char * getPackedMessageFormat() const;
+	friend class NetworkMessageTest;
+	//wire layout of the packed message
+	template<class Archive> static void serialize(Archive &archive, int8 &messageType, Data &data) {
+		archive & messageType
+				& data.selectedFactionName
+				& data.currentSlotIndex
+				& data.toSlotIndex
+				& data.toTeam
+				& data.networkPlayerName
+				& data.networkPlayerStatus
+				& data.switchFlags
+				& data.language;
+	}
 	virtual unsigned int getPackedSize();
 	virtual void unpackMessage(unsigned char *buf);
 	virtual unsigned char * packMessage();
@@ -977,7 +1175,12 @@ private:
 	Data data;
 
 protected:
-	virtual const char * getPackedMessageFormat() const;
+	friend class NetworkMessageTest;
+	//wire layout of the packed message
+	template<class Archive> static void serialize(Archive &archive, int8 &messageType, Data &data) {
+		archive & messageType
+				& data.playerIndex;
+	}
 	virtual unsigned int getPackedSize();
 	virtual void unpackMessage(unsigned char *buf);
 	virtual unsigned char * packMessage();
@@ -1046,7 +1249,12 @@ private:
 	Data data;
 
 protected:
-	virtual const char * getPackedMessageFormat() const;
+	friend class NetworkMessageTest;
+	//wire layout of the packed message
+	template<class Archive> static void serialize(Archive &archive, int8 &messageType, Data &data) {
+		archive & messageType
+				& data.status;
+	}
 	virtual unsigned int getPackedSize();
 	virtual void unpackMessage(unsigned char *buf);
 	virtual unsigned char * packMessage();
@@ -1099,7 +1307,16 @@ private:
 	Data data;
 
 protected:
-	virtual const char * getPackedMessageFormat() const;
+	friend class NetworkMessageTest;
+	//wire layout of the packed message
+	template<class Archive> static void serialize(Archive &archive, int8 &messageType, Data &data) {
+		archive & messageType
+				& data.targetX
+				& data.targetY
+				& data.factionIndex
+				& data.playerIndex
+				& data.text;
+	}
 	virtual unsigned int getPackedSize();
 	virtual void unpackMessage(unsigned char *buf);
 	virtual unsigned char * packMessage();
@@ -1151,7 +1368,14 @@ private:
 	Data data;
 
 protected:
-	virtual const char * getPackedMessageFormat() const;
+	friend class NetworkMessageTest;
+	//wire layout of the packed message
+	template<class Archive> static void serialize(Archive &archive, int8 &messageType, Data &data) {
+		archive & messageType
+				& data.targetX
+				& data.targetY
+				& data.factionIndex;
+	}
 	virtual unsigned int getPackedSize();
 	virtual void unpackMessage(unsigned char *buf);
 	virtual unsigned char * packMessage();
@@ -1203,7 +1427,14 @@ private:
 	Data data;
 
 protected:
-	virtual const char * getPackedMessageFormat() const;
+	friend class NetworkMessageTest;
+	//wire layout of the packed message
+	template<class Archive> static void serialize(Archive &archive, int8 &messageType, Data &data) {
+		archive & messageType
+				& data.targetX
+				& data.targetY
+				& data.factionIndex;
+	}
 	virtual unsigned int getPackedSize();
 	virtual void unpackMessage(unsigned char *buf);
 	virtual unsigned char * packMessage();
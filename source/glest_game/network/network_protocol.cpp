@@ -582,4 +582,10 @@ unsigned int unpack(unsigned char *buf, const char *format, ...) {
 
 #pragma pack(pop)
 
+void throwPackedMessageError(const char *action, unsigned int position, unsigned int size) {
+	char szBuf[8096]="";
+	snprintf(szBuf,8096,"Network message %s needs %u bytes but the buffer holds %u",action,position,size);
+	throw megaglest_runtime_error(szBuf);
+}
+
 }}
@@ -12,11 +12,177 @@
 #ifndef NETWORK_PROTOCOL_H_
 #define NETWORK_PROTOCOL_H_
 
+#include <cstring>
+#include "data_types.h"
+#include "network_types.h"
+
+using Shared::Platform::int8;
+using Shared::Platform::uint8;
+using Shared::Platform::int16;
+using Shared::Platform::uint16;
+using Shared::Platform::int32;
+using Shared::Platform::uint32;
+using Shared::Platform::int64;
+using Shared::Platform::uint64;
+
 namespace Glest{ namespace Game{
 
 unsigned int pack(unsigned char *buf, const char *format, ...);
 unsigned int unpack(unsigned char *buf, const char *format, ...);
 
+void throwPackedMessageError(const char *action, unsigned int position, unsigned int size);
+
+// =====================================================
+//	Message schemas
+//
+//	A message lists its fields once, in wire order, in a serialize()
+//	template:
+//
+//		archive & messageType & data.pingFrequency & data.pingTime;
+//
+//	The type of each field picks its encoding at compile time, the same
+//	one pack() and unpack() use for the matching format character: int8
+//	and uint8 are one byte ('c' 'C'), wider integers big endian ('h' 'H'
+//	'l' 'L' 'q' 'Q') and a NetworkString<S> is written like "Ss", a 16 bit
+//	length of S-1 followed by S-1 bytes of its buffer. Fields are taken by
+//	non const reference, so a type without a wire encoding does not
+//	compile instead of being converted.
+// =====================================================
+
+// =====================================================
+//	class NetworkPackedSize
+//
+///	Counts the bytes a schema takes on the wire
+// =====================================================
+
+class NetworkPackedSize {
+private:
+	unsigned int size;
+
+public:
+	NetworkPackedSize() : size(0) {}
+
+	unsigned int getSize() const						{ return size; }
+
+	NetworkPackedSize & operator&(int8 &value)			{ size += 1; return *this; }
+	NetworkPackedSize & operator&(uint8 &value)			{ size += 1; return *this; }
+	NetworkPackedSize & operator&(int16 &value)			{ size += 2; return *this; }
+	NetworkPackedSize & operator&(uint16 &value)		{ size += 2; return *this; }
+	NetworkPackedSize & operator&(int32 &value)			{ size += 4; return *this; }
+	NetworkPackedSize & operator&(uint32 &value)		{ size += 4; return *this; }
+	NetworkPackedSize & operator&(int64 &value)			{ size += 8; return *this; }
+	NetworkPackedSize & operator&(uint64 &value)		{ size += 8; return *this; }
+
+	template<int S>
+	NetworkPackedSize & operator&(NetworkString<S> &value) {
+		size += 2 + (S - 1);
+		return *this;
+	}
+};
+
+// =====================================================
+//	class NetworkPacker
+//
+///	Writes a schema into a buffer of a known size
+// =====================================================
+
+class NetworkPacker {
+private:
+	unsigned char *buf;
+	unsigned int capacity;
+	unsigned int size;
+
+	void reserve(unsigned int bytes) {
+		if(bytes > capacity - size) {
+			throwPackedMessageError("pack", size + bytes, capacity);
+		}
+	}
+	void putInteger(uint64 value, unsigned int bytes) {
+		reserve(bytes);
+		for(unsigned int i = 0; i < bytes; ++i) {
+			buf[size++] = (unsigned char)(value >> ((bytes - 1 - i) * 8));
+		}
+	}
+
+public:
+	NetworkPacker(unsigned char *buf, unsigned int capacity) : buf(buf), capacity(capacity), size(0) {}
+
+	unsigned int getSize() const						{ return size; }
+
+	NetworkPacker & operator&(int8 &value)				{ putInteger((uint8)value, 1); return *this; }
+	NetworkPacker & operator&(uint8 &value)				{ putInteger(value, 1); return *this; }
+	NetworkPacker & operator&(int16 &value)				{ putInteger((uint16)value, 2); return *this; }
+	NetworkPacker & operator&(uint16 &value)			{ putInteger(value, 2); return *this; }
+	NetworkPacker & operator&(int32 &value)				{ putInteger((uint32)value, 4); return *this; }
+	NetworkPacker & operator&(uint32 &value)			{ putInteger(value, 4); return *this; }
+	NetworkPacker & operator&(int64 &value)				{ putInteger((uint64)value, 8); return *this; }
+	NetworkPacker & operator&(uint64 &value)			{ putInteger(value, 8); return *this; }
+
+	template<int S>
+	NetworkPacker & operator&(NetworkString<S> &value) {
+		putInteger(S - 1, 2);
+		reserve(S - 1);
+		memcpy(buf + size, value.getBuffer(), S - 1);
+		size += S - 1;
+		return *this;
+	}
+};
+
+// =====================================================
+//	class NetworkUnpacker
+//
+///	Reads a schema back, never past the end of the buffer
+// =====================================================
+
+class NetworkUnpacker {
+private:
+	const unsigned char *buf;
+	unsigned int capacity;
+	unsigned int size;
+
+	void require(unsigned int bytes) {
+		if(bytes > capacity - size) {
+			throwPackedMessageError("unpack", size + bytes, capacity);
+		}
+	}
+	uint64 getInteger(unsigned int bytes) {
+		require(bytes);
+		uint64 value = 0;
+		for(unsigned int i = 0; i < bytes; ++i) {
+			value = (value << 8) | buf[size++];
+		}
+		return value;
+	}
+
+public:
+	NetworkUnpacker(const unsigned char *buf, unsigned int capacity) : buf(buf), capacity(capacity), size(0) {}
+
+	unsigned int getSize() const						{ return size; }
+
+	NetworkUnpacker & operator&(int8 &value)			{ value = (int8)getInteger(1); return *this; }
+	NetworkUnpacker & operator&(uint8 &value)			{ value = (uint8)getInteger(1); return *this; }
+	NetworkUnpacker & operator&(int16 &value)			{ value = (int16)(uint16)getInteger(2); return *this; }
+	NetworkUnpacker & operator&(uint16 &value)			{ value = (uint16)getInteger(2); return *this; }
+	NetworkUnpacker & operator&(int32 &value)			{ value = (int32)(uint32)getInteger(4); return *this; }
+	NetworkUnpacker & operator&(uint32 &value)			{ value = (uint32)getInteger(4); return *this; }
+	NetworkUnpacker & operator&(int64 &value)			{ value = (int64)getInteger(8); return *this; }
+	NetworkUnpacker & operator&(uint64 &value)			{ value = getInteger(8); return *this; }
+
+	//like unpack() a longer string is cut to fit, a shorter one is taken
+	//as it is
+	template<int S>
+	NetworkUnpacker & operator&(NetworkString<S> &value) {
+		unsigned int length = (unsigned int)getInteger(2);
+		require(length);
+		unsigned int count = (length < (unsigned int)S ? length : S - 1);
+		char *text = value.getBuffer();
+		memcpy(text, buf + size, count);
+		text[count] = '\0';
+		size += length;
+		return *this;
+	}
+};
+
 }};
 
 #endif /* NETWORK_PROTOCOL_H_ */
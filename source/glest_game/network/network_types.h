@@ -21,6 +21,7 @@
 #include "data_types.h"
 #include "vec.h"
 #include "command.h"
+#include "network_latency_histogram.h"
 #include "leak_dumper.h"
 
 using std::string;
@@ -30,6 +31,8 @@ using Shared::Platform::uint8;
 using Shared::Platform::int16;
 using Shared::Platform::uint16;
 using Shared::Platform::int32;
+using Shared::Platform::int64;
+using Shared::Platform::uint64;
 using Shared::Graphics::Vec2i;
 
 namespace Glest{ namespace Game{
@@ -158,6 +161,24 @@ public:
 	void toEndian();
 	void fromEndian();
 
+	//wire layout of a command inside a command list message
+	template<class Archive> void serialize(Archive &archive) {
+		archive & networkCommandType
+				& unitId
+				& unitTypeId
+				& commandTypeId
+				& positionX
+				& positionY
+				& targetId
+				& wantQueue
+				& fromFactionIndex
+				& unitFactionUnitCount
+				& unitFactionIndex
+				& commandStateType
+				& commandStateValue
+				& unitCommandGroupId;
+	}
+
 	XmlNode * saveGame(XmlNode *rootNode);
 	void loadGame(const XmlNode *rootNode);
 };
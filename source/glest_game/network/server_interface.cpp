@@ -63,6 +63,8 @@ int GRACE_LAG_CTR_LIMIT = 5;
 const int MAX_CLIENT_WAIT_SECONDS_FOR_PAUSE_MILLISECONDS	= 15000;
 const int MAX_CLIENT_PAUSE_FOR_LAG_COUNT					= 3;
 const int MAX_SLOT_THREAD_WAIT_TIME_MILLISECONDS			= 1500;
+// Slot threads that quit don't signal completion, so re-check this often
+const int MAX_SLOT_THREAD_WAIT_SLICE_MILLISECONDS			= 20;
 const int MASTERSERVER_HEARTBEAT_GAME_STATUS_SECONDS 		= 30;
 
 const int MAX_EMPTY_NETWORK_COMMAND_LIST_BROADCAST_INTERVAL_MILLISECONDS = 4000;
@@ -86,6 +88,9 @@ ServerInterface::ServerInterface(bool publishEnabled, ClientLagCallbackInterface
 	textMessageQueueThreadAccessor 		= new Mutex(CODE_AT_LINE);
 	broadcastMessageQueueThreadAccessor = new Mutex(CODE_AT_LINE);
 	inBroadcastMessageThreadAccessor 	= new Mutex(CODE_AT_LINE);
+	slotTaskCompletedAccessor 			= new Mutex(CODE_AT_LINE);
+	slotTaskCompletedTrigger 			= new Trigger(slotTaskCompletedAccessor);
+	slotTaskCompletedCount 				= 0;
 
 	serverSocketAdmin				= NULL;
 	nextEventId 					= 1;
@@ -331,6 +336,14 @@ ServerInterface::~ServerInterface() {
 	delete inBroadcastMessageThreadAccessor;
 	inBroadcastMessageThreadAccessor = NULL;
 
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled) SystemFlags::OutputDebug(SystemFlags::debugPerformance,"In [%s::%s Line: %d] slot thread wait %s\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,slotWaitHistogram.toString().c_str());
+
+	delete slotTaskCompletedTrigger;
+	slotTaskCompletedTrigger = NULL;
+
+	delete slotTaskCompletedAccessor;
+	slotTaskCompletedAccessor = NULL;
+
 	delete serverSynchAccessor;
 	serverSynchAccessor = NULL;
 
@@ -737,6 +750,12 @@ std::pair<bool,bool> ServerInterface::clientLagCheck(ConnectionSlot *connectionS
 
 				double clientLagTime 	= difftime((long int)time(NULL),connectionSlot->getLastReceiveCommandListTime());
 
+				// Data the client is not reading counts as lag too
+				double sendQueueLagTime	= connectionSlot->getSendQueueLagTime();
+				if(sendQueueLagTime > clientLagTime) {
+					clientLagTime = sendQueueLagTime;
+				}
+
 				if(this->getCurrentFrameCount() > 0) {
 					if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] playerIndex = %d, clientLag = %f, clientLagCount = %f, this->getCurrentFrameCount() = %d, connectionSlot->getCurrentFrameCount() = %d, clientLagTime = %f\n",
 																		 extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,
@@ -1030,6 +1049,7 @@ void ServerInterface::checkForCompletedClientsUsingLoop(
 	for (bool threadsDone = false; exitServer == false && threadsDone == false &&
 		 waitForThreadElapsed.getMillis() <= MAX_SLOT_THREAD_WAIT_TIME_MILLISECONDS;) {
 
+		uint64 lastSlotTaskCompletedCount = getSlotTaskCompletedCount();
 		threadsDone = true;
 		// Examine all threads for completion of delegation
 		for (int index = 0; exitServer == false && index < GameConstants::maxPlayers; ++index) {
@@ -1074,6 +1094,38 @@ void ServerInterface::checkForCompletedClientsUsingLoop(
 				}
 			}
 		}
+
+		if(threadsDone == false) {
+			waitForSlotTaskCompleted(lastSlotTaskCompletedCount,
+					MAX_SLOT_THREAD_WAIT_TIME_MILLISECONDS - waitForThreadElapsed.getMillis());
+		}
+	}
+	slotWaitHistogram.addSample(waitForThreadElapsed.getMillis());
+}
+
+uint64 ServerInterface::getSlotTaskCompletedCount() {
+	MutexSafeWrapper safeMutex(slotTaskCompletedAccessor,CODE_AT_LINE);
+	return slotTaskCompletedCount;
+}
+
+void ServerInterface::slotTaskCompleted(int index) {
+	MutexSafeWrapper safeMutex(slotTaskCompletedAccessor,CODE_AT_LINE);
+	slotTaskCompletedCount++;
+	slotTaskCompletedTrigger->signal(true);
+}
+
+// Sleeps until a slot thread finishes a task after lastCompletedCount was
+// read, instead of spinning on updateCompleted()
+void ServerInterface::waitForSlotTaskCompleted(uint64 lastCompletedCount, int64 waitMilliseconds) {
+	if(waitMilliseconds <= 0) {
+		return;
+	}
+	if(waitMilliseconds > MAX_SLOT_THREAD_WAIT_SLICE_MILLISECONDS) {
+		waitMilliseconds = MAX_SLOT_THREAD_WAIT_SLICE_MILLISECONDS;
+	}
+	MutexSafeWrapper safeMutex(slotTaskCompletedAccessor,CODE_AT_LINE);
+	if(slotTaskCompletedCount == lastCompletedCount) {
+		slotTaskCompletedTrigger->waitTillSignalled(slotTaskCompletedAccessor,(int)waitMilliseconds);
 	}
 }
 
@@ -1158,6 +1210,7 @@ void ServerInterface::checkForLaggingClients(std::map<int,bool> &mapSlotSignalle
 			exitServer == false && threadsDone == false &&
 			waitForThreadElapsed.getMillis() <= MAX_SLOT_THREAD_WAIT_TIME_MILLISECONDS;) {
 
+			uint64 lastSlotTaskCompletedCount = getSlotTaskCompletedCount();
 			threadsDone = true;
 			// Examine all threads for completion of delegation
 			for(int index = 0; exitServer == false && index < GameConstants::maxPlayers; ++index) {
@@ -1278,7 +1331,13 @@ void ServerInterface::checkForLaggingClients(std::map<int,bool> &mapSlotSignalle
 
 				//printf("#5 Check lag for i: %d\n",i);
 			}
+
+			if(threadsDone == false) {
+				waitForSlotTaskCompleted(lastSlotTaskCompletedCount,
+						MAX_SLOT_THREAD_WAIT_TIME_MILLISECONDS - waitForThreadElapsed.getMillis());
+			}
 		}
+		slotWaitHistogram.addSample(waitForThreadElapsed.getMillis());
 	}
 	if(lastGlobalLagCheckTimeUpdate == true) {
 		lastGlobalLagCheckTime = time(NULL);
@@ -2541,6 +2600,7 @@ void ServerInterface::broadcastGameSetup(GameSettings *gameSettingsBuffer, bool
 }
 
 void ServerInterface::broadcastMessage(NetworkMessage *networkMessage, int excludeSlot, int lockedSlotIndex) {
+	NetworkMessageBuffer *encodedMessage = NULL;
 	try {
 		if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
@@ -2561,6 +2621,9 @@ void ServerInterface::broadcastMessage(NetworkMessage *networkMessage, int exclu
 			safeMutexSlotBroadCastAccessor.ReleaseLock(true);
 	    }
 
+	    // Encode once, every slot queues the same bytes
+	    encodedMessage = NetworkMessageBuffer::encode(networkMessage);
+
 		for(int slotIndex = 0; exitServer == false && slotIndex < GameConstants::maxPlayers; ++slotIndex) {
 			MutexSafeWrapper safeMutexSlot(NULL,CODE_AT_LINE_X(slotIndex));
 			if(slotIndex != lockedSlotIndex) {
@@ -2574,7 +2637,7 @@ void ServerInterface::broadcastMessage(NetworkMessage *networkMessage, int exclu
 				if(connectionSlot->isConnected()) {
 					if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] before sendMessage\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
-					connectionSlot->sendMessage(networkMessage);
+					connectionSlot->queueMessage(encodedMessage);
 
 					if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] after sendMessage\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 				}
@@ -2599,6 +2662,9 @@ void ServerInterface::broadcastMessage(NetworkMessage *networkMessage, int exclu
 			}
 		}
 
+		NetworkMessageBuffer::release(encodedMessage);
+		encodedMessage = NULL;
+
 		safeMutexSlotBroadCastAccessor.Lock();
 
 	    inBroadcastMessage = false;
@@ -2609,6 +2675,8 @@ void ServerInterface::broadcastMessage(NetworkMessage *networkMessage, int exclu
 		SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,ex.what());
 		if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] ERROR [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,ex.what());
 
+		NetworkMessageBuffer::release(encodedMessage);
+
 		MutexSafeWrapper safeMutexSlotBroadCastAccessor(inBroadcastMessageThreadAccessor,CODE_AT_LINE);
 	    inBroadcastMessage = false;
 	    safeMutexSlotBroadCastAccessor.ReleaseLock();
@@ -2620,19 +2688,24 @@ void ServerInterface::broadcastMessage(NetworkMessage *networkMessage, int exclu
 
 void ServerInterface::broadcastMessageToConnectedClients(NetworkMessage *networkMessage, int excludeSlot) {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s] Line: %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
+	NetworkMessageBuffer *encodedMessage = NULL;
 	try {
+		encodedMessage = NetworkMessageBuffer::encode(networkMessage);
 		for(int slotIndex = 0; exitServer == false && slotIndex < GameConstants::maxPlayers; ++slotIndex) {
 			MutexSafeWrapper safeMutexSlot(slotAccessorMutexes[slotIndex],CODE_AT_LINE_X(slotIndex));
 			ConnectionSlot *connectionSlot= slots[slotIndex];
 
 			if(slotIndex != excludeSlot && connectionSlot != NULL) {
 				if(connectionSlot->isConnected()) {
-					connectionSlot->sendMessage(networkMessage);
+					connectionSlot->queueMessage(encodedMessage);
 				}
 			}
 		}
+		NetworkMessageBuffer::release(encodedMessage);
 	}
 	catch(const exception &ex) {
+		NetworkMessageBuffer::release(encodedMessage);
+
 		SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,ex.what());
 		if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] ERROR [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,ex.what());
 		DisplayErrorMessage(ex.what());
@@ -95,6 +95,11 @@ private:
     Mutex *inBroadcastMessageThreadAccessor;
     bool inBroadcastMessage;
 
+    Mutex *slotTaskCompletedAccessor;
+    Trigger *slotTaskCompletedTrigger;
+    uint64 slotTaskCompletedCount;
+    NetworkLatencyHistogram slotWaitHistogram;
+
     bool masterserverAdminRequestLaunch;
 
 	vector<string> mapFiles;
@@ -203,6 +208,7 @@ public:
     }
 
     virtual void slotUpdateTask(ConnectionSlotEvent *event) { };
+    virtual void slotTaskCompleted(int index);
     bool hasClientConnection();
     virtual bool isClientConnected(int index);
 
@@ -282,6 +288,8 @@ private:
 			std::map<int, bool>& mapSlotSignalledList,
 			std::vector<string>& errorMsgList,
 			std::map<int, ConnectionSlotEvent>& eventList);
+	uint64 getSlotTaskCompletedCount();
+	void waitForSlotTaskCompleted(uint64 lastCompletedCount, int64 waitMilliseconds);
 	void checkForAutoPauseForLaggingClient(int index,
 			ConnectionSlot* connectionSlot);
 	void checkForAutoResumeForLaggingClients();
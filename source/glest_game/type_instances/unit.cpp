@@ -603,6 +603,7 @@ namespace Glest
     {
       skillType = NULL;
       currentAppliedEffect = NULL;
+      lastAreaStamp = -1;
     }
 
     UnitAttackBoostEffectOriginator::~UnitAttackBoostEffectOriginator ()
@@ -625,15 +626,10 @@ namespace Glest
       if (unitAttackBoostEffectOriginatorNode->hasAttribute ("skillClass") ==
           false)
       {
-        int skillCount = unit->getType ()->getSkillTypeCount ();
-        for (int index = 0; index < skillCount; ++index)
+        const SkillType *st = unit->getType ()->findSkillType (skillTypeName);
+        if (st != NULL)
         {
-          const SkillType *st = unit->getType ()->getSkillType (index);
-          if (st->getName () == skillTypeName)
-          {
-            skillClass = st->getClass ();
-            break;
-          }
+          skillClass = st->getClass ();
         }
       }
       else
@@ -1219,7 +1215,7 @@ namespace Glest
 
           //find nearest pos to center that is free
           Vec2i centeredPos = getCenteredPos ();
-          float nearestDist = -1.f;
+          Fixed nearestDist = -1;
           Vec2i nearestPos = pos;
 
           for (int i = 0; i < type->getSize (); ++i)
@@ -1229,8 +1225,8 @@ namespace Glest
               if (type->getCellMapCell (i, j, modelFacing))
               {
                 Vec2i currPos = pos + Vec2i (i, j);
-                float dist = currPos.dist (centeredPos);
-                if (nearestDist == -1.f || dist < nearestDist)
+                Fixed dist = Vec2x (currPos).dist (Vec2x (centeredPos));
+                if (nearestDist == -1 || dist < nearestDist)
                 {
                   nearestDist = dist;
                   nearestPos = currPos;
@@ -3368,6 +3364,27 @@ namespace Glest
       return newProgress;
     }
 
+    // Returns false while no unit entered or left a cell within the boost
+    // radius since the last scan, otherwise remembers the current state
+    bool Unit::updateAttackBoostArea (const AttackBoost * attackBoost)
+    {
+      int
+        changeStamp =
+        map->getUnitCellsChangeStamp (pos, type->getSize (),
+                                      attackBoost->radius);
+      if (currentAttackBoostOriginatorEffect.lastAreaStamp >= 0
+          && currentAttackBoostOriginatorEffect.lastAreaPos == pos
+          && changeStamp <= currentAttackBoostOriginatorEffect.lastAreaStamp)
+      {
+        return false;
+      }
+
+      currentAttackBoostOriginatorEffect.lastAreaStamp =
+        map->getUnitChangeCount ();
+      currentAttackBoostOriginatorEffect.lastAreaPos = pos;
+      return true;
+    }
+
     void Unit::updateAttackBoostProgress (const Game * game)
     {
       const bool debugBoost = false;
@@ -3431,6 +3448,7 @@ namespace Glest
                   currentAttackBoostUnits.size ());
 
         currentAttackBoostOriginatorEffect.skillType = currSkill;
+        currentAttackBoostOriginatorEffect.lastAreaStamp = -1;
 
         if (currSkill->isAttackBoostEnabled () == true)
         {
@@ -3446,6 +3464,7 @@ namespace Glest
             this->game->getWorld ()->getUnitUpdater ();
 
           const AttackBoost *attackBoost = currSkill->getAttackBoost ();
+          updateAttackBoostArea (attackBoost);
           vector < Unit * >candidates = unitUpdater->findUnitsInRange (this,
                                                                        attackBoost->radius);
 
@@ -3464,6 +3483,12 @@ namespace Glest
                   currentAttackBoostUnits.push_back (affectedUnit->getId ());
                 //printf("+ #1 APPLY ATTACK BOOST to unit [%s - %d]\n",affectedUnit->getType()->getName().c_str(),affectedUnit->getId());
               }
+              else
+              {
+                // Already boosted by another unit of this type, look again
+                // next update in case that one goes away
+                currentAttackBoostOriginatorEffect.lastAreaStamp = -1;
+              }
             }
           }
 
@@ -3530,7 +3555,9 @@ namespace Glest
       }
       else
       {
-        if (currSkill->isAttackBoostEnabled () == true)
+        // Nothing entered or left the boost area, the affected units stay
+        if (currSkill->isAttackBoostEnabled () == true
+            && updateAttackBoostArea (currSkill->getAttackBoost ()) == true)
         {
           if (debugBoost)
             printf ("Line: %d affected unit size: " MG_SIZE_T_SPECIFIER "\n",
@@ -3583,6 +3610,10 @@ namespace Glest
 
                   //printf("+ #2 APPLY ATTACK BOOST to unit [%s - %d]\n",affectedUnit->getType()->getName().c_str(),affectedUnit->getId());
                 }
+                else
+                {
+                  currentAttackBoostOriginatorEffect.lastAreaStamp = -1;
+                }
               }
             }
             else
@@ -5135,6 +5166,7 @@ namespace Glest
               currentAttackBoostUnits.erase
               (currentAttackBoostOriginatorEffect.currentAttackBoostUnits.
                begin () + i);
+            currentAttackBoostOriginatorEffect.lastAreaStamp = -1;
           }
 
           //printf("- #1 DE-APPLY ATTACK BOOST from unit [%s - %d]\n",affectedUnit->getType()->getName().c_str(),affectedUnit->getId());
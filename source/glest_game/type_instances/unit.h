@@ -22,6 +22,7 @@
 #   include "skill_type.h"
 #   include "game_constants.h"
 #   include "platform_common.h"
+#   include "fixed_point.h"
 #   include <vector>
 #   include "faction.h"
 #   include "leak_dumper.h"
@@ -39,6 +40,8 @@ namespace Glest
     using Shared::Graphics::Vec2f;
     using Shared::Graphics::Vec3f;
     using Shared::Graphics::Vec2i;
+    using Shared::Graphics::Fixed;
+    using Shared::Graphics::Vec2x;
     using Shared::Graphics::Model;
     using Shared::PlatformCommon::Chrono;
     using Shared::PlatformCommon::ValueCheckerVault;
@@ -458,6 +461,12 @@ namespace Glest
         std::vector < int >currentAttackBoostUnits;
       UnitAttackBoostEffect *currentAppliedEffect;
 
+      // Map unit change count and position at the last range scan, the
+      // affected units are only looked up again once either is outdated.
+      // Not saved, -1 forces a scan.
+      int lastAreaStamp;
+      Vec2i lastAreaPos;
+
       virtual void saveGame (XmlNode * rootNode);
       virtual void loadGame (const XmlNode * rootNode, Unit * unit,
                              World * world);
@@ -1255,6 +1264,7 @@ namespace Glest
       void logSynchDataCommon (string file, int line, string source =
                                "", bool threadedMode = false);
       void updateAttackBoostProgress (const Game * game);
+      bool updateAttackBoostArea (const AttackBoost * attackBoost);
 
       void setAlive (bool value);
     };
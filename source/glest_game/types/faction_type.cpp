@@ -20,6 +20,7 @@
 #include "platform_util.h"
 #include "game_util.h"
 #include "conversion.h"
+#include "window.h"
 #include "leak_dumper.h"
 
 using namespace Shared::Util;
@@ -195,7 +196,7 @@ namespace Glest
           string str = currentPath + "units/" + unitFilenames[i];
           unitTypes[i].preLoad (str);
 
-          SDL_PumpEvents ();
+          Window::pumpEvents ();
         }
 
         // a2) preload upgrades
@@ -211,7 +212,21 @@ namespace Glest
           string str = currentPath + "upgrades/" + upgradeFilenames[i];
           upgradeTypes[i].preLoad (str);
 
-          SDL_PumpEvents ();
+          Window::pumpEvents ();
+        }
+
+        // unit and upgrade types look each other up by name while loading
+        unitTypeIndexByName.clear ();
+        for (int i = 0; i < (int) unitTypes.size (); ++i)
+        {
+          unitTypeIndexByName.insert (std::make_pair
+                                      (unitTypes[i].getName (false), i));
+        }
+        upgradeTypeIndexByName.clear ();
+        for (int i = 0; i < (int) upgradeTypes.size (); ++i)
+        {
+          upgradeTypeIndexByName.insert (std::make_pair
+                                         (upgradeTypes[i].getName (), i));
         }
 
         // b1) load units
@@ -233,7 +248,7 @@ namespace Glest
                                            1.0) /
                                           (double) unitTypes.size ()) *
                                          100.0 / techTree->getTypeCount ()));
-              SDL_PumpEvents ();
+              Window::pumpEvents ();
             }
             catch (megaglest_runtime_error & ex)
             {
@@ -305,7 +320,7 @@ namespace Glest
               }
             }
 
-            SDL_PumpEvents ();
+            Window::pumpEvents ();
           }
         }
         catch (const exception & e)
@@ -374,7 +389,7 @@ namespace Glest
             }
           }
 
-          SDL_PumpEvents ();
+          Window::pumpEvents ();
         }
 
         //read starting units
@@ -389,7 +404,7 @@ namespace Glest
           startingUnits.
             push_back (PairPUnitTypeInt (getUnitType (name), amount));
 
-          SDL_PumpEvents ();
+          Window::pumpEvents ();
         }
 
         //read music
@@ -1355,12 +1370,10 @@ namespace Glest
 
     const UnitType *FactionType::getUnitType (const string & name) const
     {
-      for (int i = 0; i < (int) unitTypes.size (); i++)
+      const UnitType *unitType = findUnitType (name);
+      if (unitType != NULL)
       {
-        if (unitTypes[i].getName (false) == name)
-        {
-          return &unitTypes[i];
-        }
+        return unitType;
       }
 
       printf ("In [%s::%s Line: %d] scanning [%s] size = " MG_SIZE_T_SPECIFIER
@@ -1398,6 +1411,18 @@ namespace Glest
                                      true);
     }
 
+    //returns NULL if this faction has no unit type of that name
+    const UnitType *FactionType::findUnitType (const string & name) const
+    {
+      std::map < string, int >::const_iterator iterFind =
+        unitTypeIndexByName.find (name);
+      if (iterFind != unitTypeIndexByName.end ())
+      {
+        return &unitTypes[iterFind->second];
+      }
+      return NULL;
+    }
+
 //const UnitType *FactionType::getUnitTypeById(int id) const{
 //    for(int i=0; i < (int)unitTypes.size();i++){
 //              if(unitTypes[i].getId() == id) {
@@ -1420,12 +1445,11 @@ namespace Glest
 
     const UpgradeType *FactionType::getUpgradeType (const string & name) const
     {
-      for (int i = 0; i < (int) upgradeTypes.size (); i++)
+      std::map < string, int >::const_iterator iterFind =
+        upgradeTypeIndexByName.find (name);
+      if (iterFind != upgradeTypeIndexByName.end ())
       {
-        if (upgradeTypes[i].getName () == name)
-        {
-          return &upgradeTypes[i];
-        }
+        return &upgradeTypes[iterFind->second];
       }
 
       printf ("In [%s::%s Line: %d] scanning [%s] size = " MG_SIZE_T_SPECIFIER
@@ -97,6 +97,9 @@ namespace Glest
       string name;
       UnitTypes unitTypes;
       UpgradeTypes upgradeTypes;
+      //name lookups into unitTypes and upgradeTypes, filled after preload
+      std::map < string, int >unitTypeIndexByName;
+      std::map < string, int >upgradeTypeIndexByName;
       StartingUnits startingUnits;
       Resources startingResources;
       StrSound *music;
@@ -215,6 +218,7 @@ namespace Glest
 
 
       const UnitType *getUnitType (const string & name) const;
+      const UnitType *findUnitType (const string & name) const;
       //const UnitType *getUnitTypeById(int id) const;
       const UpgradeType *getUpgradeType (const string & name) const;
       int getStartingResourceAmount (const ResourceType * resourceType) const;
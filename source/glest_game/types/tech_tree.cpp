@@ -48,6 +48,9 @@ namespace Glest
       factionTypes.clear ();
       armorTypes.clear ();
       attackTypes.clear ();
+      resourceTypeIndexByName.clear ();
+      armorTypeIndexByName.clear ();
+      attackTypeIndexByName.clear ();
       translatedTechNames.clear ();
       translatedTechFactionNames.clear ();
       languageUsedForCache = "";
@@ -291,8 +294,10 @@ namespace Glest
           str = currentPath + "resources/" + filenames[i];
           resourceTypes[i].load (str, checksum, &checksumValue,
                                  loadedFileList, treePath);
+          resourceTypeIndexByName.insert (std::make_pair
+                                          (resourceTypes[i].getName (), i));
           Window::handleEvent ();
-          SDL_PumpEvents ();
+          Window::pumpEvents ();
         }
 
         // Cleanup pixmap memory
@@ -328,7 +333,7 @@ namespace Glest
       // give CPU time to update other things to avoid apperance of hanging
       sleep (0);
       Window::handleEvent ();
-      SDL_PumpEvents ();
+      Window::pumpEvents ();
 
       //load tech tree xml info
       try
@@ -367,9 +372,11 @@ namespace Glest
           attackTypes[i].setName (attackTypeNode->getAttribute ("name")->
                                   getRestrictedValue ());
           attackTypes[i].setId (i);
+          attackTypeIndexByName.insert (std::make_pair
+                                        (attackTypes[i].getName (false), i));
 
           Window::handleEvent ();
-          SDL_PumpEvents ();
+          Window::pumpEvents ();
         }
 
         // give CPU time to update other things to avoid apperance of hanging
@@ -387,9 +394,11 @@ namespace Glest
           armorTypes[i].setName (armorTypeNode->getAttribute ("name")->
                                  getRestrictedValue ());
           armorTypes[i].setId (i);
+          armorTypeIndexByName.insert (std::make_pair
+                                       (armorTypes[i].getName (false), i));
 
           Window::handleEvent ();
-          SDL_PumpEvents ();
+          Window::pumpEvents ();
         }
 
         //damage multipliers
@@ -414,7 +423,7 @@ namespace Glest
                                                      multiplier);
 
           Window::handleEvent ();
-          SDL_PumpEvents ();
+          Window::pumpEvents ();
         }
       }
       catch (megaglest_runtime_error & ex)
@@ -445,7 +454,31 @@ namespace Glest
       sleep (0);
       //SDL_PumpEvents();
 
-      //load factions
+      loadFactionTypes (factions, checksum, loadedFileList, validationMode);
+
+      if (techtreeChecksum != NULL)
+      {
+        *techtreeChecksum = checksumValue;
+      }
+
+      if (SystemFlags::getSystemSettingType (SystemFlags::debugSystem).
+          enabled)
+        SystemFlags::OutputDebug (SystemFlags::debugSystem,
+                                  "In [%s::%s Line: %d]\n",
+                                  extractFileFromDirectoryPath (__FILE__).
+                                  c_str (), __FUNCTION__, __LINE__);
+    }
+
+    // loads the given factions over the resources and types loaded by
+    // load(). Validation workers call it for one faction each.
+    void TechTree::loadFactionTypes (set < string > &factions,
+                                     Checksum * checksum,
+                                     std::map < string, vector < pair < string,
+                                     string > > >&loadedFileList,
+                                     bool validationMode)
+    {
+      string currentPath = treePath;
+
       try
       {
         factionTypes.resize (factions.size ());
@@ -478,7 +511,7 @@ namespace Glest
           // give CPU time to update other things to avoid apperance of hanging
           sleep (0);
           Window::handleEvent ();
-          SDL_PumpEvents ();
+          Window::pumpEvents ();
         }
       }
       catch (megaglest_runtime_error & ex)
@@ -504,18 +537,6 @@ namespace Glest
                                        currentPath + "\nMessage: " +
                                        e.what (), isValidationModeEnabled);
       }
-
-      if (techtreeChecksum != NULL)
-      {
-        *techtreeChecksum = checksumValue;
-      }
-
-      if (SystemFlags::getSystemSettingType (SystemFlags::debugSystem).
-          enabled)
-        SystemFlags::OutputDebug (SystemFlags::debugSystem,
-                                  "In [%s::%s Line: %d]\n",
-                                  extractFileFromDirectoryPath (__FILE__).
-                                  c_str (), __FUNCTION__, __LINE__);
     }
 
     TechTree::~TechTree ()
@@ -533,6 +554,9 @@ namespace Glest
       factionTypes.clear ();
       armorTypes.clear ();
       attackTypes.clear ();
+      resourceTypeIndexByName.clear ();
+      armorTypeIndexByName.clear ();
+      attackTypeIndexByName.clear ();
     }
 
     std::vector < std::string > TechTree::validateFactionTypes ()
@@ -560,14 +584,24 @@ namespace Glest
     }
 
     std::vector < std::string > TechTree::validateResourceTypes ()
+    {
+      set < string > usedResourceTypes;
+      std::vector < std::string > results =
+        validateFactionResourceTypes (usedResourceTypes);
+      std::vector < std::string > unusedResults =
+        validateResourceTypesUsed (usedResourceTypes);
+      results.insert (results.end (), unusedResults.begin (),
+                      unusedResults.end ());
+      return results;
+    }
+
+    // checks the resources of the loaded factions and adds the names of
+    // the techtree resources they use to usedResourceTypes
+    std::vector < std::string >
+      TechTree::validateFactionResourceTypes (set < string >
+                                              &usedResourceTypes)
     {
       std::vector < std::string > results;
-      ResourceTypes resourceTypesNotUsed = resourceTypes;
-      for (unsigned int i = 0; i < resourceTypesNotUsed.size (); ++i)
-      {
-        ResourceType & rt = resourceTypesNotUsed[i];
-        rt.setCleanupMemory (false);
-      }
       for (unsigned int i = 0; i < factionTypes.size (); ++i)
       {
         //printf("Validating [%d / %d] faction [%s]\n",i,(int)factionTypes.size(),factionTypes[i].getName().c_str());
@@ -581,27 +615,30 @@ namespace Glest
         }
 
         // Check if the faction uses the resources in this techtree
-        // Now lets find a matching faction resource type for the unit
-        for (int j = (int)resourceTypesNotUsed.size () - 1; j >= 0; --j)
+        for (unsigned int j = 0; j < resourceTypes.size (); ++j)
         {
-          const ResourceType & rt = resourceTypesNotUsed[j];
-          //printf("Validating [%d / %d] resourcetype [%s]\n",j,(int)resourceTypesNotUsed.size(),rt.getName().c_str());
-
-          if (factionTypes[i].factionUsesResourceType (&rt) == true)
+          const ResourceType & rt = resourceTypes[j];
+          if (usedResourceTypes.find (rt.getName ()) ==
+              usedResourceTypes.end ()
+              && factionTypes[i].factionUsesResourceType (&rt) == true)
           {
-            //printf("FOUND FACTION CONSUMER FOR RESOURCE - [%d / %d] faction [%s] resource [%d / %d] resourcetype [%s]\n",i,(int)factionTypes.size(),factionTypes[i].getName().c_str(),j,(int)resourceTypesNotUsed.size(),rt.getName().c_str());
-            resourceTypesNotUsed.erase (resourceTypesNotUsed.begin () + j);
+            usedResourceTypes.insert (rt.getName ());
           }
         }
       }
+      return results;
+    }
 
-      if (resourceTypesNotUsed.empty () == false)
+    std::vector < std::string >
+      TechTree::validateResourceTypesUsed (const set < string >
+                                           &usedResourceTypes) const
+    {
+      std::vector < std::string > results;
+      for (unsigned int i = 0; i < resourceTypes.size (); ++i)
       {
-        //printf("FOUND unused resource Types [%d]\n",(int)resourceTypesNotUsed.size());
-
-        for (unsigned int i = 0; i < resourceTypesNotUsed.size (); ++i)
+        const ResourceType & rt = resourceTypes[i];
+        if (usedResourceTypes.find (rt.getName ()) == usedResourceTypes.end ())
         {
-          const ResourceType & rt = resourceTypesNotUsed[i];
           char szBuf[8096] = "";
           snprintf (szBuf, 8096,
                     "The Resource type [%s] is not used by any units in this techtree!",
@@ -686,13 +723,11 @@ namespace Glest
 
     const ResourceType *TechTree::getResourceType (const string & name) const
     {
-
-      for (int i = 0; i < (int) resourceTypes.size (); ++i)
+      std::map < string, int >::const_iterator iterFind =
+        resourceTypeIndexByName.find (name);
+      if (iterFind != resourceTypeIndexByName.end ())
       {
-        if (resourceTypes[i].getName () == name)
-        {
-          return &resourceTypes[i];
-        }
+        return &resourceTypes[iterFind->second];
       }
 
       throw megaglest_runtime_error ("Resource Type not found: " + name,
@@ -701,12 +736,11 @@ namespace Glest
 
     const ArmorType *TechTree::getArmorType (const string & name) const
     {
-      for (int i = 0; i < (int) armorTypes.size (); ++i)
+      std::map < string, int >::const_iterator iterFind =
+        armorTypeIndexByName.find (name);
+      if (iterFind != armorTypeIndexByName.end ())
       {
-        if (armorTypes[i].getName (false) == name)
-        {
-          return &armorTypes[i];
-        }
+        return &armorTypes[iterFind->second];
       }
 
       throw megaglest_runtime_error ("Armor Type not found: " + name, true);
@@ -714,12 +748,11 @@ namespace Glest
 
     const AttackType *TechTree::getAttackType (const string & name) const
     {
-      for (int i = 0; i < (int) attackTypes.size (); ++i)
+      std::map < string, int >::const_iterator iterFind =
+        attackTypeIndexByName.find (name);
+      if (iterFind != attackTypeIndexByName.end ())
       {
-        if (attackTypes[i].getName (false) == name)
-        {
-          return &attackTypes[i];
-        }
+        return &attackTypes[iterFind->second];
       }
 
       throw megaglest_runtime_error ("Attack Type not found: " + name, true);
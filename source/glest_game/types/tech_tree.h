@@ -54,6 +54,10 @@ namespace Glest
       FactionTypes factionTypes;
       ArmorTypes armorTypes;
       AttackTypes attackTypes;
+      //name lookups into the type vectors above, filled as they load
+      std::map < string, int >resourceTypeIndexByName;
+      std::map < string, int >armorTypeIndexByName;
+      std::map < string, int >attackTypeIndexByName;
       DamageMultiplierTable damageMultiplierTable;
       Checksum checksumValue;
 
@@ -73,6 +77,10 @@ namespace Glest
                  Checksum * checksum, Checksum * techtreeChecksum,
                  std::map < string, vector < pair < string,
                  string > > >&loadedFileList, bool validationMode = false);
+      void loadFactionTypes (set < string > &factions, Checksum * checksum,
+                             std::map < string, vector < pair < string,
+                             string > > >&loadedFileList,
+                             bool validationMode = false);
       string findPath (const string & techName) const;
 
       static string findPath (const string & techName,
@@ -152,6 +160,10 @@ namespace Glest
                                   const ArmorType * art) const;
         std::vector < std::string > validateFactionTypes ();
         std::vector < std::string > validateResourceTypes ();
+        std::vector < std::string >
+        validateFactionResourceTypes (set < string > &usedResourceTypes);
+        std::vector < std::string >
+        validateResourceTypesUsed (const set < string > &usedResourceTypes) const;
 
       void saveGame (XmlNode * rootNode);
 
@@ -1243,6 +1243,9 @@ namespace Glest
           }
         }
 
+        //commands look up their skills by name
+        computeSkillTypeIndex ();
+
         //commands
         const XmlNode *commandsNode = unitNode->getChild ("commands");
         commandTypes.resize (commandsNode->getChildCount ());
@@ -1587,26 +1590,36 @@ namespace Glest
     const SkillType *UnitType::getSkillType (const string & skillName,
                                              SkillClass skillClass) const
     {
-      for (int i = 0; i < (int) skillTypes.size (); ++i)
+      const SkillType *skillType = findSkillType (skillName);
+      if (skillType != NULL)
       {
-        if (skillTypes[i]->getName () == skillName)
+        if (skillType->getClass () == skillClass)
         {
-          if (skillTypes[i]->getClass () == skillClass)
-          {
-            return skillTypes[i];
-          }
-          else
-          {
-            throw megaglest_runtime_error ("Skill \"" + skillName +
-                                           "\" is not of class \"" +
-                                           SkillType::
-                                           skillClassToStr (skillClass));
-          }
+          return skillType;
+        }
+        else
+        {
+          throw megaglest_runtime_error ("Skill \"" + skillName +
+                                         "\" is not of class \"" +
+                                         SkillType::
+                                         skillClassToStr (skillClass));
         }
       }
       throw megaglest_runtime_error ("No skill named \"" + skillName + "\"");
     }
 
+    //returns NULL if the unit has no skill of that name
+    const SkillType *UnitType::findSkillType (const string & skillName) const
+    {
+      std::map < string, int >::const_iterator iterFind =
+        skillTypeIndexByName.find (skillName);
+      if (iterFind != skillTypeIndexByName.end ())
+      {
+        return skillTypes[iterFind->second];
+      }
+      return NULL;
+    }
+
 // ==================== totals ====================
 
     int UnitType::getTotalMaxHp (const TotalUpgrade * totalUpgrade) const
@@ -1733,6 +1746,19 @@ namespace Glest
       }
     }
 
+    void UnitType::computeSkillTypeIndex ()
+    {
+      skillTypeIndexByName.clear ();
+      for (int i = 0; i < (int) skillTypes.size (); ++i)
+      {
+        if (skillTypes[i] != NULL)
+        {
+          skillTypeIndexByName.insert (std::make_pair
+                                       (skillTypes[i]->getName (), i));
+        }
+      }
+    }
+
     void UnitType::computeFirstCtOfClass ()
     {
       for (int j = 0; j < ccCount; ++j)
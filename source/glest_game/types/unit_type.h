@@ -287,6 +287,8 @@ namespace Glest
       //OPTIMIZATION: store first command type and skill type of each class
       const CommandType *firstCommandTypeOfClass[ccCount];
       const SkillType *firstSkillTypeOfClass[scCount];
+      //OPTIMIZATION: skill lookups by name
+      std::map < string, int >skillTypeIndexByName;
 
       UnitCountsInVictoryConditions countInVictoryConditions;
 
@@ -535,6 +537,7 @@ namespace Glest
       int getStore (const ResourceType * rt) const;
       const SkillType *getSkillType (const string & skillName,
                                      SkillClass skillClass) const;
+      const SkillType *findSkillType (const string & skillName) const;
       const SkillType *getFirstStOfClass (SkillClass skillClass) const;
       const CommandType *getFirstCtOfClass (CommandClass commandClass) const;
       const HarvestCommandType *getFirstHarvestCommand (const ResourceType *
@@ -600,6 +603,7 @@ namespace Glest
 
     private:
       void computeFirstStOfClass ();
+      void computeSkillTypeIndex ();
       void computeFirstCtOfClass ();
     };
 
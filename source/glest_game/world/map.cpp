@@ -347,6 +347,7 @@ void SurfaceCell::loadGame(const XmlNode *rootNode, int index, World *world) {
 
 const int Map::cellScale= 2;
 const int Map::mapScale= 2;
+const int Map::unitSectorSize= 8;
 
 Map::Map() {
 	cells= NULL;
@@ -365,6 +366,9 @@ Map::Map() {
 	surfaceSize=(surfaceW * surfaceH);
 	maxPlayers=0;
 	maxMapHeight=0;
+	unitSectorW=0;
+	unitChangeCount=0;
+	obstacleChangesTrimmed=0;
 }
 
 Map::~Map() {
@@ -411,23 +415,18 @@ Vec2i Map::getStartLocation(int locationIndex) const {
 Checksum Map::load(const string &path, TechTree *techTree, Tileset *tileset) {
     Checksum mapChecksum;
 	try{
-#ifdef WIN32
-		FILE *f= _wfopen(utf8_decode(path).c_str(), L"rb");
-#else
-		FILE *f = fopen(path.c_str(), "rb");
-#endif
-		if(f != NULL) {
+		Chrono chrono;
+		if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled) chrono.start();
+
+		MapFileReader reader;
+		if(reader.load(path) == true) {
 			mapFile = path;
 
 		    mapChecksum.addFile(path);
 		    checksumValue.addFile(path);
 			//read header
-			MapFileHeader header;
-			size_t readBytes = fread(&header, sizeof(MapFileHeader), 1, f);
-			if(readBytes != 1) {
-				throw megaglest_runtime_error("Invalid map header detected for file: " + path);
-			}
-			fromEndianMapFileHeader(header);
+			const MapFileHeader &header = reader.getHeader();
+			int64 readMillis = (SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled ? chrono.getMillis() : 0);
 
 			if(next2Power(header.width) != header.width){
 				throw megaglest_runtime_error("Map width is not a power of 2");
@@ -475,60 +474,24 @@ Checksum Map::load(const string &path, TechTree *techTree, Tileset *tileset) {
 			//start locations
 			startLocations= new Vec2i[maxPlayers];
 			for(int i=0; i < hardMaxPlayers; ++i) {
-				int x=0, y=0;
-				readBytes = fread(&x, sizeof(int32), 1, f);
-				if(readBytes != 1) {
-					char szBuf[8096]="";
-					snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",readBytes,__LINE__);
-					throw megaglest_runtime_error(szBuf);
-				}
-				x = ::Shared::PlatformByteOrder::fromCommonEndian(x);
-
-				readBytes = fread(&y, sizeof(int32), 1, f);
-				if(readBytes != 1) {
-					char szBuf[8096]="";
-					snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",readBytes,__LINE__);
-					throw megaglest_runtime_error(szBuf);
-				}
-				y = ::Shared::PlatformByteOrder::fromCommonEndian(y);
-
-				startLocations[i]= Vec2i(x, y)*cellScale;
+				startLocations[i]= reader.getStartLocation(i)*cellScale;
 			}
 
 			//cells
 			cells= new Cell[getCellArraySize()];
 			surfaceCells= new SurfaceCell[getSurfaceCellArraySize()];
 
-			//read heightmap
-			for(int j = 0; j < surfaceH; ++j) {
-				for(int i = 0; i < surfaceW; ++i) {
-					float32 alt=0;
-					readBytes = fread(&alt, sizeof(float32), 1, f);
-					if(readBytes != 1) {
-						char szBuf[8096]="";
-						snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",readBytes,__LINE__);
-						throw megaglest_runtime_error(szBuf);
-					}
-					alt = ::Shared::PlatformByteOrder::fromCommonEndian(alt);
+			unitSectorW= (w + unitSectorSize - 1) / unitSectorSize;
+			unitSectorStamps.clear();
+			unitSectorStamps.resize(unitSectorW * ((h + unitSectorSize - 1) / unitSectorSize), 0);
+			unitChangeCount= 0;
 
-					SurfaceCell *sc= getSurfaceCell(i, j);
-					sc->setVertex(Vec3f(i*mapScale, alt / heightFactor, j*mapScale));
-				}
-			}
-
-			//read surfaces
+			//heightmap and surfaces
 			for(int j = 0; j < surfaceH; ++j) {
 				for(int i = 0; i < surfaceW; ++i) {
-					int8 surf=0;
-					readBytes = fread(&surf, sizeof(int8), 1, f);
-					if(readBytes != 1) {
-						char szBuf[8096]="";
-						snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",readBytes,__LINE__);
-						throw megaglest_runtime_error(szBuf);
-					}
-					surf = ::Shared::PlatformByteOrder::fromCommonEndian(surf);
-
-					getSurfaceCell(i, j)->setSurfaceType(surf-1);
+					SurfaceCell *sc= getSurfaceCell(i, j);
+					sc->setVertex(Vec3f(i*mapScale, reader.getHeight(i, j) / heightFactor, j*mapScale));
+					sc->setSurfaceType(reader.getSurface(i, j)-1);
 				}
 			}
 
@@ -536,14 +499,7 @@ Checksum Map::load(const string &path, TechTree *techTree, Tileset *tileset) {
 			for(int j = 0; j < h; j += cellScale) {
 				for(int i = 0; i < w; i += cellScale) {
 
-					int8 objNumber=0;
-					readBytes = fread(&objNumber, sizeof(int8), 1, f);
-					if(readBytes != 1) {
-						char szBuf[8096]="";
-						snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",readBytes,__LINE__);
-						throw megaglest_runtime_error(szBuf);
-					}
-					objNumber = ::Shared::PlatformByteOrder::fromCommonEndian(objNumber);
+					int8 objNumber= reader.getObject(i / cellScale, j / cellScale);
 
 					SurfaceCell *sc= getSurfaceCell(toSurfCoords(Vec2i(i, j)));
 					if(objNumber <= 0) {
@@ -567,7 +523,8 @@ Checksum Map::load(const string &path, TechTree *techTree, Tileset *tileset) {
 					}
 				}
 			}
-			if(f) fclose(f);
+
+			if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled) SystemFlags::OutputDebug(SystemFlags::debugPerformance,"In [%s::%s Line: %d] map [%s] %d x %d read in " MG_I64_SPECIFIER " ms, cells built in " MG_I64_SPECIFIER " ms\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,path.c_str(),surfaceW,surfaceH,readMillis,chrono.getMillis() - readMillis);
 		}
 		else {
 			throw megaglest_runtime_error("Can't open file");
@@ -1466,6 +1423,10 @@ void Map::putUnitCellsPrivate(Unit *unit, const Vec2i &pos, const UnitType *ut,
 	if(canPutInCell == true) {
         unit->setPos(pos, false, threaded);
 	}
+	addUnitCellsChange(pos, ut->getSize());
+	if(ut->isMobile() == false) {
+		addObstacleChange(pos, ut->getSize());
+	}
 }
 
 //removes a unit from cells
@@ -1531,6 +1492,61 @@ void Map::clearUnitCells(Unit *unit, const Vec2i &pos, bool ignoreSkill) {
 			}
 		}
 	}
+	addUnitCellsChange(pos, ut->getSize());
+	if(ut->isMobile() == false) {
+		addObstacleChange(pos, ut->getSize());
+	}
+}
+
+void Map::addObstacleChange(const Vec2i &pos, int size, int teamIndex) {
+	obstacleChanges.push_back(ObstacleChange(pos, size, teamIndex));
+}
+
+//drops the changes every flow field has already seen
+void Map::trimObstacleChanges(int processedCount) {
+	int trimCount = min(processedCount - obstacleChangesTrimmed, (int)obstacleChanges.size());
+	if(trimCount > 0) {
+		obstacleChanges.erase(obstacleChanges.begin(), obstacleChanges.begin() + trimCount);
+		obstacleChangesTrimmed += trimCount;
+	}
+}
+
+//stamps the sectors under a unit footprint that a unit entered or left
+void Map::addUnitCellsChange(const Vec2i &pos, int size) {
+	if(unitSectorStamps.empty() == true) {
+		return;
+	}
+	unitChangeCount++;
+
+	int minX= clamp(pos.x, 0, w - 1) / unitSectorSize;
+	int minY= clamp(pos.y, 0, h - 1) / unitSectorSize;
+	int maxX= clamp(pos.x + size - 1, 0, w - 1) / unitSectorSize;
+	int maxY= clamp(pos.y + size - 1, 0, h - 1) / unitSectorSize;
+	for(int j = minY; j <= maxY; ++j) {
+		for(int i = minX; i <= maxX; ++i) {
+			unitSectorStamps[j * unitSectorW + i]= unitChangeCount;
+		}
+	}
+}
+
+//latest change count of the sectors within radius of a unit footprint, if it
+//is not newer than a previous look the units in that area are still the same
+int Map::getUnitCellsChangeStamp(const Vec2i &pos, int size, int radius) const {
+	if(unitSectorStamps.empty() == true) {
+		return unitChangeCount;
+	}
+
+	int minX= clamp(pos.x - radius, 0, w - 1) / unitSectorSize;
+	int minY= clamp(pos.y - radius, 0, h - 1) / unitSectorSize;
+	int maxX= clamp(pos.x + size + radius - 1, 0, w - 1) / unitSectorSize;
+	int maxY= clamp(pos.y + size + radius - 1, 0, h - 1) / unitSectorSize;
+	int result= 0;
+	for(int j = minY; j <= maxY; ++j) {
+		for(int i = minX; i <= maxX; ++i) {
+			result= max(result, unitSectorStamps[j * unitSectorW + i]);
+		}
+	}
+	return result;
 }
 
 // ==================== misc ====================
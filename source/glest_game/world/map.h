@@ -204,6 +204,21 @@ public:
 };
 
 
+// =====================================================
+// 	class ObstacleChange
+//
+///	An area where what blocks the flow fields of one team (or all) changed
+// =====================================================
+
+class ObstacleChange {
+public:
+	ObstacleChange(const Vec2i &pos, int size, int teamIndex) : pos(pos), size(size), teamIndex(teamIndex) {}
+
+	Vec2i pos;
+	int size;
+	int teamIndex;	//-1 for every team
+};
+
 // =====================================================
 // 	class Map
 //
@@ -223,6 +238,7 @@ class Map {
 public:
 	static const int cellScale;	//number of cells per surfaceCell
 	static const int mapScale;	//horizontal scale of surface
+	static const int unitSectorSize;	//cells per side of a unit change sector
 
 private:
 	string title;
@@ -244,6 +260,17 @@ private:
 	Checksum checksumValue;
 	float maxMapHeight;
 	string mapFile;
+	//areas where buildings appeared or vanished, resources ran out or a team
+	//explored new cells, the path finder refreshes the flow fields covering
+	//them. Changes the path finder processed are trimmed each frame, indexes
+	//keep counting from obstacleChangesTrimmed.
+	std::vector<ObstacleChange> obstacleChanges;
+	int obstacleChangesTrimmed;
+	//per sector of unitSectorSize x unitSectorSize cells, the change count at
+	//which a unit last entered or left one of its cells
+	std::vector<int> unitSectorStamps;
+	int unitSectorW;
+	int unitChangeCount;
 
 private:
 	Map(Map&);
@@ -304,6 +331,10 @@ public:
 	inline SurfaceCell *getSurfaceCell(const Vec2i &sPos) const {
 		return getSurfaceCell(sPos.x, sPos.y);
 	}
+	inline Vec2i getSurfaceCellPos(const SurfaceCell *sc) const {
+		int arrayIndex = (int)(sc - surfaceCells);
+		return Vec2i(arrayIndex % surfaceW, arrayIndex / surfaceW);
+	}
 
 	inline int getW() const											{return w;}
 	inline int getH() const											{return h;}
@@ -351,6 +382,13 @@ public:
 	bool canMove(const Unit *unit, const Vec2i &pos1, const Vec2i &pos2,std::map<Vec2i, std::map<Vec2i, std::map<int, std::map<Field,bool> > > > *lookupCache=NULL) const;
     void putUnitCells(Unit *unit, const Vec2i &pos,bool ignoreSkill = false, bool threaded = false);
 	void clearUnitCells(Unit *unit, const Vec2i &pos,bool ignoreSkill = false);
+	void addObstacleChange(const Vec2i &pos, int size, int teamIndex=-1);
+	void trimObstacleChanges(int processedCount);
+	inline int getObstacleChangeCount() const							{return obstacleChangesTrimmed + (int)obstacleChanges.size();}
+	inline const ObstacleChange &getObstacleChange(int index) const		{return obstacleChanges[index - obstacleChangesTrimmed];}
+	void addUnitCellsChange(const Vec2i &pos, int size);
+	int getUnitCellsChangeStamp(const Vec2i &pos, int size, int radius) const;
+	inline int getUnitChangeCount() const								{return unitChangeCount;}
 
 	Vec2i computeRefPos(const Selection *selection) const;
 	Vec2i computeDestPos(	const Vec2i &refUnitPos, const Vec2i &unitPos,
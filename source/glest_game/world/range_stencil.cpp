@@ -0,0 +1,51 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martiño Figueroa
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "range_stencil.h"
+
+#include "leak_dumper.h"
+
+namespace Glest{ namespace Game{
+
+// =====================================================
+//	class RangeStencilCache
+// =====================================================
+
+//whether the cell at offset from a unit position is one whose distance to the
+//unit center floors to at most radius+1. Both center and cells sit on a half
+//cell grid, so in doubled coordinates this is exact integer math.
+bool RangeStencilCache::isInRangeCell(int offsetX, int offsetY, int radius, int size) {
+	int dx = 2 * offsetX + 1 - size;
+	int dy = 2 * offsetY + 1 - size;
+	int maxDistance = 2 * (radius + 2);
+	return dx * dx + dy * dy < maxDistance * maxDistance;
+}
+
+//the in range cells of isInRangeCell() in scan order
+const vector<Vec2i> &RangeStencilCache::getStencil(int radius, int size) {
+	std::pair<int,int> key(radius, size);
+	std::map<std::pair<int,int>, vector<Vec2i> >::iterator iterFind = stencils.find(key);
+	if(iterFind != stencils.end()) {
+		return iterFind->second;
+	}
+
+	vector<Vec2i> &stencil = stencils[key];
+	for(int i = -radius; i < radius + size; ++i) {
+		for(int j = -radius; j < radius + size; ++j) {
+			if(isInRangeCell(i, j, radius, size)) {
+				stencil.push_back(Vec2i(i, j));
+			}
+		}
+	}
+	return stencil;
+}
+
+}}//end namespace
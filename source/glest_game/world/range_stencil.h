@@ -0,0 +1,45 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martiño Figueroa
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _GLEST_GAME_RANGESTENCIL_H_
+#define _GLEST_GAME_RANGESTENCIL_H_
+
+#include <vector>
+#include <map>
+#include "vec.h"
+#include "leak_dumper.h"
+
+using std::vector;
+using Shared::Graphics::Vec2i;
+
+namespace Glest{ namespace Game{
+
+// =====================================================
+//	class RangeStencilCache
+//
+/// Cell offsets from a unit position that are in range of the unit, by
+/// radius and unit size
+// =====================================================
+
+class RangeStencilCache {
+private:
+	std::map<std::pair<int,int>, vector<Vec2i> > stencils;
+
+public:
+	static bool isInRangeCell(int offsetX, int offsetY, int radius, int size);
+
+	const vector<Vec2i> &getStencil(int radius, int size);
+	void clear()		{stencils.clear();}
+};
+
+}}//end namespace
+
+#endif
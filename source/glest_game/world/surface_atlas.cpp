@@ -17,14 +17,20 @@
 #include "renderer.h"
 #include "util.h"
 #include "math_util.h"
+#include "base_thread.h"
+#include "platform_util.h"
 #include "leak_dumper.h"
 
 using namespace std;
 using namespace Shared::Util;
 using namespace Shared::Graphics;
+using namespace Shared::PlatformCommon;
 
 namespace Glest{ namespace Game{
 
+//below this many splats per thread making them serially is faster
+static const int MIN_SPLATS_PER_THREAD = 8;
+
 // =====================================================
 //	class PixmapInfo
 // =====================================================
@@ -58,6 +64,117 @@ bool SurfaceInfo::operator==(const SurfaceInfo &si) const {
 		this->rightUp == si.getRightUp();
 }
 
+bool SurfaceInfo::operator<(const SurfaceInfo &si) const {
+	if(this->center != si.getCenter()) {
+		return this->center < si.getCenter();
+	}
+	if(this->leftUp != si.getLeftUp()) {
+		return this->leftUp < si.getLeftUp();
+	}
+	if(this->rightUp != si.getRightUp()) {
+		return this->rightUp < si.getRightUp();
+	}
+	if(this->leftDown != si.getLeftDown()) {
+		return this->leftDown < si.getLeftDown();
+	}
+	return this->rightDown < si.getRightDown();
+}
+
+// =====================================================
+//	class SurfaceSplatJobs
+// =====================================================
+
+//splats shared out to the splat threads and the calling thread, each one
+//writes only its own texture pixmap
+class SurfaceSplatJobs {
+private:
+	Mutex mutex;
+	Trigger *workerDoneTrigger;
+	int nextIndex;
+	int runningWorkers;
+	const SurfaceAtlas *atlas;
+	const vector<pair<Pixmap2D *, int> > *splats;
+	string error;
+
+public:
+	SurfaceSplatJobs(const SurfaceAtlas *atlas, const vector<pair<Pixmap2D *, int> > *splats,
+					int workerCount) : mutex(CODE_AT_LINE) {
+		workerDoneTrigger = new Trigger(&mutex);
+		nextIndex = 0;
+		runningWorkers = workerCount;
+		this->atlas = atlas;
+		this->splats = splats;
+	}
+	~SurfaceSplatJobs() {
+		delete workerDoneTrigger;
+		workerDoneTrigger = NULL;
+	}
+
+	bool splatNext() {
+		MutexSafeWrapper safeMutex(&mutex,CODE_AT_LINE);
+		if(nextIndex >= (int)splats->size() || error != "") {
+			return false;
+		}
+		int index = nextIndex++;
+		safeMutex.ReleaseLock();
+
+		try {
+			Pixmap2D *pixmap = (*splats)[index].first;
+			const SurfaceInfo &si = atlas->getSurfaceInfo((*splats)[index].second);
+			pixmap->splat(si.getLeftUp(), si.getRightUp(), si.getLeftDown(), si.getRightDown(),
+						atlas->getSplatWeights());
+		}
+		catch(const exception &ex) {
+			safeMutex.Lock();
+			if(error == "") {
+				error = ex.what();
+			}
+			safeMutex.ReleaseLock();
+		}
+		return true;
+	}
+
+	void workerDone() {
+		MutexSafeWrapper safeMutex(&mutex,CODE_AT_LINE);
+		runningWorkers--;
+		workerDoneTrigger->signal(true);
+	}
+
+	void waitForWorkers() {
+		MutexSafeWrapper safeMutex(&mutex,CODE_AT_LINE);
+		for(;runningWorkers > 0;) {
+			workerDoneTrigger->waitTillSignalled(&mutex,100);
+		}
+	}
+
+	string getError() {
+		MutexSafeWrapper safeMutex(&mutex,CODE_AT_LINE);
+		return error;
+	}
+};
+
+// =====================================================
+//	class SurfaceSplatThread
+// =====================================================
+
+class SurfaceSplatThread : public BaseThread {
+protected:
+	SurfaceSplatJobs *jobs;
+
+public:
+	SurfaceSplatThread(SurfaceSplatJobs *jobs) : BaseThread() {
+		this->jobs = jobs;
+		uniqueID = "SurfaceSplatThread";
+	}
+
+	virtual void execute() {
+		RunningStatusSafeWrapper runningStatus(this);
+		for(;getQuitStatus() == false && jobs->splatNext() == true;) {
+		}
+		jobs->workerDone();
+	}
+};
+
 // ===============================
 // 	class SurfaceAtlas
 // ===============================
@@ -83,8 +200,8 @@ void SurfaceAtlas::addSurface(SurfaceInfo *si) {
 	}
 
 	//add info
-	SurfaceInfos::iterator it = find(surfaceInfos.begin(), surfaceInfos.end(), *si);
-	if(it == surfaceInfos.end()) {
+	SurfaceInfoIndex::iterator it = surfaceInfoIndex.find(*si);
+	if(it == surfaceInfoIndex.end()) {
 		//add new texture
 		Texture2D *t= Renderer::getInstance().newTexture2D(rsGame);
 		if(t) {
@@ -97,6 +214,7 @@ void SurfaceAtlas::addSurface(SurfaceInfo *si) {
 		
 		si->setCoord(Vec2f(0.f, 0.f));
 		si->setTexture(t);
+		surfaceInfoIndex[*si] = (int)surfaceInfos.size();
 		surfaceInfos.push_back(*si);
 		
 		//copy texture to pixmap
@@ -107,16 +225,64 @@ void SurfaceAtlas::addSurface(SurfaceInfo *si) {
 		}
 		else {
 			if(t) {
-				t->getPixmap()->splat(si->getLeftUp(), si->getRightUp(), si->getLeftDown(), si->getRightDown());
+				pendingSplats.push_back(make_pair(t->getPixmap(), (int)surfaceInfos.size() - 1));
 			}
 		}
 	}
 	else{
-		si->setCoord(it->getCoord());
-		si->setTexture(it->getTexture());
+		const SurfaceInfo &found = surfaceInfos[it->second];
+		si->setCoord(found.getCoord());
+		si->setTexture(found.getTexture());
 	}
 }
 
+//makes the splatted textures added since the last call, the textures must
+//not be used before
+void SurfaceAtlas::generateSplats(int threadCount) {
+	if(pendingSplats.empty() == true) {
+		return;
+	}
+
+	Chrono chrono;
+	chrono.start();
+
+	if(splatWeights.getW() != surfaceSize || splatWeights.getH() != surfaceSize) {
+		splatWeights.init(surfaceSize, surfaceSize);
+	}
+
+	threadCount = min(threadCount, (int)pendingSplats.size() / MIN_SPLATS_PER_THREAD);
+	threadCount = max(threadCount, 1);
+
+	//the calling thread is one of the splat threads
+	SurfaceSplatJobs jobs(this, &pendingSplats, threadCount - 1);
+	vector<SurfaceSplatThread *> workers;
+	for(int index = 0; index < threadCount - 1; ++index) {
+		SurfaceSplatThread *worker = new SurfaceSplatThread(&jobs);
+		workers.push_back(worker);
+		worker->start();
+	}
+	for(;jobs.splatNext() == true;) {
+	}
+	jobs.waitForWorkers();
+
+	for(unsigned int index = 0; index < workers.size(); ++index) {
+		if(workers[index]->shutdownAndWait() == true) {
+			delete workers[index];
+		}
+	}
+	workers.clear();
+
+	int splatCount = (int)pendingSplats.size();
+	pendingSplats.clear();
+
+	string error = jobs.getError();
+	if(error != "") {
+		throw megaglest_runtime_error(error);
+	}
+
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled) SystemFlags::OutputDebug(SystemFlags::debugPerformance,"In [%s::%s Line: %d] made %d splatted surfaces of %d unique surfaces on %d threads in " MG_I64_SPECIFIER " ms\n",__FILE__,__FUNCTION__,__LINE__,splatCount,(int)surfaceInfos.size(),threadCount,chrono.getMillis());
+}
+
 float SurfaceAtlas::getCoordStep() const {
 	return 1.f;
 }
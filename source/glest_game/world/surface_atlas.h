@@ -19,13 +19,18 @@
 
 #include <vector>
 #include <set>
+#include <map>
 #include "texture.h"
+#include "pixmap.h"
 #include "vec.h"
 #include "leak_dumper.h"
 
 using std::vector;
 using std::set;
+using std::map;
+using std::pair;
 using Shared::Graphics::Pixmap2D;
+using Shared::Graphics::SplatWeights;
 using Shared::Graphics::Texture2D;
 using Shared::Graphics::Vec2i;
 using Shared::Graphics::Vec2f;
@@ -50,6 +55,7 @@ public:
 	explicit SurfaceInfo(const Pixmap2D *center);
 	SurfaceInfo(const Pixmap2D *lu, const Pixmap2D *ru, const Pixmap2D *ld, const Pixmap2D *rd);
 	bool operator==(const SurfaceInfo &si) const;
+	bool operator<(const SurfaceInfo &si) const;
 
 	inline const Pixmap2D *getCenter() const		{return center;}
 	inline const Pixmap2D *getLeftUp() const		{return leftUp;}
@@ -72,17 +78,28 @@ public:
 class SurfaceAtlas{
 private:
 	typedef vector<SurfaceInfo> SurfaceInfos;
+	typedef map<SurfaceInfo, int> SurfaceInfoIndex;
 
 private:
 	SurfaceInfos surfaceInfos;
+	SurfaceInfoIndex surfaceInfoIndex;
 	int surfaceSize;
 
+	//target pixmap and surface info index of each splat not made yet
+	vector<pair<Pixmap2D *, int> > pendingSplats;
+	SplatWeights splatWeights;
+
 public:
 	SurfaceAtlas();
 
 	void addSurface(SurfaceInfo *si);
+	void generateSplats(int threadCount);
 	float getCoordStep() const;
 
+	int getPendingSplatCount() const				{return (int)pendingSplats.size();}
+	const SurfaceInfo &getSurfaceInfo(int index) const	{return surfaceInfos[index];}
+	const SplatWeights &getSplatWeights() const		{return splatWeights;}
+
 private:
 	void checkDimensions(const Pixmap2D *p);
 };
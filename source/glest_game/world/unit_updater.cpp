@@ -105,6 +105,15 @@ void UnitUpdater::removeUnitPrecache(Unit *unit) {
 	}
 }
 
+//once per frame after the fog of war update, marks the flow fields the
+//frame's obstacle and sight changes touch and drops the processed changes
+void UnitUpdater::updateFlowFields() {
+	if(pathFinder != NULL) {
+		pathFinder->updateFlowFields(world);
+		map->trimObstacleChanges(pathFinder->getProcessedObstacleChanges());
+	}
+}
+
 UnitUpdater::~UnitUpdater() {
 	//UnitRangeCellsLookupItemCache.clear();
 
@@ -1843,6 +1852,7 @@ void UnitUpdater::updateHarvest(Unit *unit, int frameIndex) {
 								//const ResourceType *rt = r->getType();
 								sc->deleteResource();
 								world->removeResourceTargetFromCache(unitTargetPos);
+								map->addObstacleChange(Map::toUnitCoords(Map::toSurfCoords(unitTargetPos)), Map::cellScale);
 
 								switch(this->game->getGameSettings()->getPathFinderType()) {
 									case pfBasic:
@@ -2626,8 +2636,7 @@ void UnitUpdater::hit(Unit *attacker, const AttackSkillType* ast, const Vec2i &t
 					attacker->setLastAttackedUnitId(attacked->getId());
 					scriptManager->onUnitAttacking(attacker);
 
-					float distance = pci.getPos().dist(targetPos);
-					distance = truncateDecimal<float>(distance,6);
+					Fixed distance = Vec2x(pci.getPos()).dist(Vec2x(targetPos));
 					damage(attacker, ast, attacked, distance,damagePercent);
 			  	}
 			}
@@ -2641,12 +2650,12 @@ void UnitUpdater::hit(Unit *attacker, const AttackSkillType* ast, const Vec2i &t
 		attacker->addNetworkCRCDecHp(szBuf);
 
 		if(attacked != NULL) {
-			damage(attacker, ast, attacked, 0.f,damagePercent);
+			damage(attacker, ast, attacked, Fixed(),damagePercent);
 		}
 	}
 }
 
-void UnitUpdater::damage(Unit *attacker, const AttackSkillType* ast, Unit *attacked, float distance, int damagePercent) {
+void UnitUpdater::damage(Unit *attacker, const AttackSkillType* ast, Unit *attacked, Fixed distance, int damagePercent) {
 	if(attacker == NULL) {
 		throw megaglest_runtime_error("attacker == NULL");
 	}
@@ -2657,26 +2666,24 @@ void UnitUpdater::damage(Unit *attacker, const AttackSkillType* ast, Unit *attac
 		throw megaglest_runtime_error("attacked == NULL");
 	}
 
-	//get vars
-	float damage			= ast->getTotalAttackStrength(attacker->getTotalUpgrade());
+	//get vars, in fixed point so every platform computes the same damage
+	Fixed damage			= ast->getTotalAttackStrength(attacker->getTotalUpgrade());
 	int var					= ast->getAttackVar();
 	int armor				= attacked->getType()->getTotalArmor(attacked->getTotalUpgrade());
-	float damageMultiplier	= world->getTechTree()->getDamageMultiplier(ast->getAttackType(), attacked->getType()->getArmorType());
-	damageMultiplier = truncateDecimal<float>(damageMultiplier,6);
+	Fixed damageMultiplier	= Fixed::fromFloat(truncateDecimal<double>(world->getTechTree()->getDamageMultiplier(ast->getAttackType(), attacked->getType()->getArmorType()),6));
 
 	//compute damage
 	//damage += random.randRange(-var, var);
 	damage += attacker->getRandom()->randRange(-var, var, extractFileFromDirectoryPath(__FILE__) + intToStr(__LINE__));
-	damage /= distance+1;
+	damage /= distance + 1;
 	damage -= armor;
 	damage *= damageMultiplier;
-	damage = truncateDecimal<float>(damage,6);
 
-	damage = (damage*damagePercent)/100;
+	damage = damage.mulDiv(damagePercent, 100);
 	if(damage < 1) {
 		damage= 1;
 	}
-	int damageVal = static_cast<int>(damage);
+	int damageVal = damage.floorToInt();
 
 	attacked->setLastAttackerUnitId(attacker->getId());
 
@@ -2959,7 +2966,6 @@ bool UnitUpdater::unitOnRange(Unit *unit, int range, Unit **rangedPtr,
 	//aux vars
 	int size 			= unit->getType()->getSize();
 	Vec2i center 		= unit->getPos();
-	Vec2f floatCenter	= unit->getFloatCenteredPos();
 
 	//bool foundInCache = true;
 	if(findCachedCellsEnemies(center,range,size,enemies,ast,
@@ -2971,11 +2977,7 @@ bool UnitUpdater::unitOnRange(Unit *unit, int range, Unit **rangedPtr,
 		for(int i = center.x - range; i < center.x + range + size; ++i) {
 			for(int j = center.y - range; j < center.y + range + size; ++j) {
 				//cells inside map and in range
-#ifdef USE_STREFLOP
-				if(map->isInside(i, j) && streflop::floor(static_cast<streflop::Simple>(floatCenter.dist(Vec2f((float)i, (float)j)))) <= (range+1)){
-#else
-				if(map->isInside(i, j) && floor(floatCenter.dist(Vec2f((float)i, (float)j))) <= (range+1)){
-#endif
+				if(map->isInside(i, j) && RangeStencilCache::isInRangeCell(i - center.x, j - center.y, range, size)) {
 					Cell *cell = map->getCell(i,j);
 					findEnemiesForCell(ast,cell,unit,commandTarget,enemies);
 
@@ -3196,7 +3198,6 @@ vector<Unit*> UnitUpdater::enemyUnitsOnRange(const Unit *unit,const AttackSkillT
 	//aux vars
 	int size 			= unit->getType()->getSize();
 	Vec2i center 		= unit->getPosNotThreadSafe();
-	Vec2f floatCenter	= unit->getFloatCenteredPos();
 
 	//bool foundInCache = true;
 	if(findCachedCellsEnemies(center,range,size,enemies,ast,
@@ -3208,11 +3209,7 @@ vector<Unit*> UnitUpdater::enemyUnitsOnRange(const Unit *unit,const AttackSkillT
 		for(int i = center.x - range; i < center.x + range + size; ++i) {
 			for(int j = center.y - range; j < center.y + range + size; ++j) {
 				//cells inside map and in range
-#ifdef USE_STREFLOP
-				if(map->isInside(i, j) && streflop::floor(static_cast<streflop::Simple>(floatCenter.dist(Vec2f((float)i, (float)j)))) <= (range+1)){
-#else
-				if(map->isInside(i, j) && floor(floatCenter.dist(Vec2f((float)i, (float)j))) <= (range+1)){
-#endif
+				if(map->isInside(i, j) && RangeStencilCache::isInRangeCell(i - center.x, j - center.y, range, size)) {
 					Cell *cell = map->getCell(i,j);
 					findEnemiesForCell(ast,cell,unit,commandTarget,enemies);
 
@@ -3280,27 +3277,20 @@ void UnitUpdater::findUnitsForCell(Cell *cell, vector<Unit*> &units) {
 }
 
 vector<Unit*> UnitUpdater::findUnitsInRange(const Unit *unit, int radius) {
-	int range = radius;
 	vector<Unit*> units;
 
 	//aux vars
 	int size 			= unit->getType()->getSize();
 	Vec2i center 		= unit->getPosNotThreadSafe();
-	Vec2f floatCenter	= unit->getFloatCenteredPos();
 
 	//nearby cells
-	//UnitRangeCellsLookupItem cacheItem;
-	for(int i = center.x - range; i < center.x + range + size; ++i) {
-		for(int j = center.y - range; j < center.y + range + size; ++j) {
-			//cells inside map and in range
-#ifdef USE_STREFLOP
-			if(map->isInside(i, j) && streflop::floor(static_cast<streflop::Simple>(floatCenter.dist(Vec2f((float)i, (float)j)))) <= (range+1)){
-#else
-			if(map->isInside(i, j) && floor(floatCenter.dist(Vec2f((float)i, (float)j))) <= (range+1)){
-#endif
-				Cell *cell = map->getCell(i,j);
-				findUnitsForCell(cell,units);
-			}
+	const vector<Vec2i> &stencil = rangeStencils.getStencil(radius, size);
+	for(unsigned int i = 0; i < stencil.size(); ++i) {
+		Vec2i cellPos = center + stencil[i];
+		//cells inside map and in range
+		if(map->isInside(cellPos)) {
+			Cell *cell = map->getCell(cellPos);
+			findUnitsForCell(cell,units);
 		}
 	}
 
@@ -33,10 +33,14 @@
 #include "particle.h"
 #include "randomgen.h"
 #include "command.h"
+#include "fixed_point.h"
+#include "range_stencil.h"
 #include "leak_dumper.h"
 
 using Shared::Graphics::ParticleObserver;
 using Shared::Util::RandomGen;
+using Shared::Graphics::Fixed;
+using Shared::Graphics::Vec2x;
 
 namespace Glest{ namespace Game{
 
@@ -101,6 +105,9 @@ private:
 	//std::map<int,ExploredCellsLookupKey> ExploredCellsLookupItemCacheTimer;
 	//int UnitRangeCellsLookupItemCacheTimerCount;
 
+	//cell offsets from a unit position that findUnitsInRange() visits
+	RangeStencilCache rangeStencils;
+
 	bool findCachedCellsEnemies(Vec2i center, int range,
 								int size, vector<Unit*> &enemies,
 								const AttackSkillType *ast, const Unit *unit,
@@ -133,6 +140,7 @@ public:
 
 	void clearUnitPrecache(Unit *unit);
 	void removeUnitPrecache(Unit *unit);
+	void updateFlowFields();
 
 	inline unsigned int getAttackWarningCount() const { return (unsigned int)attackWarnings.size(); }
 	std::pair<bool,Unit *> unitBeingAttacked(const Unit *unit);
@@ -153,7 +161,7 @@ private:
     //attack
     void hit(Unit *attacker);
 	void hit(Unit *attacker, const AttackSkillType* ast, const Vec2i &targetPos, Field targetField, int damagePercent);
-	void damage(Unit *attacker, const AttackSkillType* ast, Unit *attacked, float distance, int damagePercent);
+	void damage(Unit *attacker, const AttackSkillType* ast, Unit *attacked, Fixed distance, int damagePercent);
 	void startAttackParticleSystem(Unit *unit, float lastAnimProgress, float animProgress);
 
 	//misc
@@ -485,6 +485,13 @@ Checksum World::loadTech(const vector<string> pathList, const string &techName,
 	return techtreeChecksum;
 }
 
+//loads more factions into the techtree of loadTech()
+void World::loadFactionTypes(set<string> &factions, Checksum *checksum,
+		std::map<string,vector<pair<string, string> > > &loadedFileList,
+		bool validationMode) {
+	techTree->loadFactionTypes(factions, checksum, loadedFileList, validationMode);
+}
+
 std::vector<std::string> World::validateFactionTypes() {
 	return techTree->validateFactionTypes();
 }
@@ -493,6 +500,14 @@ std::vector<std::string> World::validateResourceTypes() {
 	return techTree->validateResourceTypes();
 }
 
+std::vector<std::string> World::validateFactionResourceTypes(set<string> &usedResourceTypes) {
+	return techTree->validateFactionResourceTypes(usedResourceTypes);
+}
+
+std::vector<std::string> World::validateResourceTypesUsed(const set<string> &usedResourceTypes) {
+	return techTree->validateResourceTypesUsed(usedResourceTypes);
+}
+
 //load map
 Checksum World::loadMap(const string &path, Checksum *checksum) {
     Checksum mapChecksum;
@@ -887,6 +902,8 @@ void World::update() {
 
 		if(this->game) this->game->addPerformanceCount("updateAllFactionUnits",chronoGamePerformanceCounts.getMillis());
 
+		if(scriptManager) scriptManager->deliverBatchedEvents();
+
 		if(showPerfStats) {
 			sprintf(perfBuf,"In [%s::%s] Line: %d took msecs: " MG_I64_SPECIFIER "\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,chronoPerf.getMillis());
 			perfList.push_back(perfBuf);
@@ -993,6 +1010,8 @@ void World::tick() {
 
 	if(this->game) this->game->addPerformanceCount("world->computeFow",chronoGamePerformanceCounts.getMillis());
 
+	unitUpdater.updateFlowFields();
+
 	if(showPerfStats) {
 		sprintf(perfBuf,"In [%s::%s] Line: %d took msecs: " MG_I64_SPECIFIER " fogOfWar: %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,chronoPerf.getMillis(),fogOfWar);
 		perfList.push_back(perfBuf);
@@ -1124,15 +1143,7 @@ const UnitType * World::findUnitTypeByName(const string factionName, const strin
 	for(int index = 0; unitTypeResult == NULL && index < getFactionCount(); ++index) {
 		const Faction *faction = getFaction(index);
 		if(factionName == "" || factionName == faction->getType()->getName(false)) {
-			for(int unitIndex = 0;
-				unitTypeResult == NULL && unitIndex < faction->getType()->getUnitTypeCount(); ++unitIndex) {
-
-				const UnitType *unitType = faction->getType()->getUnitType(unitIndex);
-				if(unitType != NULL && unitType->getName(false) == unitTypeName) {
-					unitTypeResult = unitType;
-					break;
-				}
-			}
+			unitTypeResult = faction->getType()->findUnitType(unitTypeName);
 		}
 	}
 	return unitTypeResult;
@@ -2031,6 +2042,7 @@ void World::initSplattedTextures() {
 			sc00->setSurfaceTexture(texture);
 		}
 	}
+	tileset.generateSurfTex(Config::getInstance().getInt("SurfaceSplatThreads","2"));
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d]\n",__FILE__,__FUNCTION__,__LINE__);
 }
 
@@ -2355,6 +2367,9 @@ void World::exploreCells(int teamIndex, ExploredCellsLookupItem &exploredCellsCa
 	std::vector<SurfaceCell*> &cellList = exploredCellsCache.exploredCellList;
 	for (int idx2 = 0; idx2 < (int)cellList.size(); ++idx2) {
 		SurfaceCell* sc = cellList[idx2];
+		if(sc->isExplored(teamIndex) == false) {
+			map.addObstacleChange(Map::toUnitCoords(map.getSurfaceCellPos(sc)), Map::cellScale, teamIndex);
+		}
 		sc->setExplored(teamIndex, true);
 	}
 	cellList = exploredCellsCache.visibleCellList;
@@ -2463,6 +2478,10 @@ ExploredCellsLookupItem World::exploreCells(const Vec2i &newPos, int sightRange,
 				}
 
 				if(updateExplored) {
+					// flow fields treat unexplored cells as free
+					if(sc->isExplored(teamIndex) == false) {
+						map.addObstacleChange(Map::toUnitCoords(currPos), Map::cellScale, teamIndex);
+					}
                     sc->setExplored(teamIndex, true);
                     exploredCellsCache.exploredCellList.push_back(sc);
 				}
@@ -214,6 +214,9 @@ public:
 			set<string> &factions, Checksum* checksum,
 			std::map<string,vector<pair<string, string> > > &loadedFileList,
 			bool validationMode=false);
+	void loadFactionTypes(set<string> &factions, Checksum* checksum,
+			std::map<string,vector<pair<string, string> > > &loadedFileList,
+			bool validationMode=false);
 	Checksum loadMap(const string &path, Checksum* checksum);
 	Checksum loadScenario(const string &path, Checksum* checksum,bool resetCurrentScenario=false,const XmlNode *rootNode=NULL);
 	void setQueuedScenario(string scenarioName,bool keepFactions);
@@ -296,6 +299,8 @@ public:
 
 	std::vector<std::string> validateFactionTypes();
 	std::vector<std::string> validateResourceTypes();
+	std::vector<std::string> validateFactionResourceTypes(set<string> &usedResourceTypes);
+	std::vector<std::string> validateResourceTypesUsed(const set<string> &usedResourceTypes);
 
 	void setFogOfWar(bool value);
 	bool getFogOfWar() const { return fogOfWar; }
@@ -13,129 +13,202 @@
 #include "program.h"
 #include "util.h"
 #include <iostream>
+#include <cstring>
+#include <algorithm>
 #include "platform_util.h"
 
 using namespace Shared::Util;
 
 namespace MapEditor {
 
+////////////////////////////
+// class UndoChunk
+////////////////////////////
+bool UndoChunk::sameCells(const UndoChunk &other) const {
+	return memcmp(height, other.height, sizeof(height)) == 0 &&
+		memcmp(surface, other.surface, sizeof(surface)) == 0 &&
+		memcmp(object, other.object, sizeof(object)) == 0 &&
+		memcmp(resource, other.resource, sizeof(resource)) == 0;
+}
+
 ////////////////////////////
 // class UndoPoint
 ////////////////////////////
+vector<UndoChunk *> UndoPoint::currentChunks;
+vector<bool> UndoPoint::dirtyChunks;
 int UndoPoint::w = 0;
 int UndoPoint::h = 0;
 
 UndoPoint::UndoPoint()
-		: change(ctNone)
-		, surface(0)
-		, object(0)
-		, resource(0)
-		, height(0) {
-	w = Program::map->getW();
-	h = Program::map->getH();
-}
-/*
-UndoPoint::UndoPoint(ChangeType change) {
-	w = Program::map->getW();
-	h = Program::map->getH();
-
-	init(change);
-}*/
+		: change(ctNone) {
+}
 
-void UndoPoint::init(ChangeType change) {
-	this->change = change;
-	switch (change) {
-		// Back up everything
-		case ctAll:
-		// Back up heights
-		case ctHeight:
-		case ctGradient:
-			// Build an array of heights from the map
-			//std::cout << "Building an array of heights to use for our UndoPoint" << std::endl;
-			height = new float[w * h];
-			for (int i = 0; i < w; ++i) {
-				for (int j = 0; j < h; ++j) {
-					 height[j * w + i] = Program::map->getHeight(i, j);
-				}
+UndoPoint::UndoPoint(const UndoPoint &obj)
+		: change(obj.change)
+		, chunks(obj.chunks) {
+	for (unsigned int i = 0; i < chunks.size(); ++i) {
+		chunks[i]->referenceCount++;
+	}
+}
+
+UndoPoint &UndoPoint::operator=(const UndoPoint &obj) {
+	if (this != &obj) {
+		releaseChunks(chunks);
+		change = obj.change;
+		chunks = obj.chunks;
+		for (unsigned int i = 0; i < chunks.size(); ++i) {
+			chunks[i]->referenceCount++;
+		}
+	}
+	return *this;
+}
+
+UndoPoint::~UndoPoint() {
+	releaseChunks(chunks);
+}
+
+void UndoPoint::releaseChunks(vector<UndoChunk *> &chunkList) {
+	for (unsigned int i = 0; i < chunkList.size(); ++i) {
+		if (--chunkList[i]->referenceCount == 0) {
+			delete chunkList[i];
+		}
+	}
+	chunkList.clear();
+}
+
+void UndoPoint::readChunk(int chunkX, int chunkY, UndoChunk *chunk) {
+	const MapPreview *map = Program::map;
+	for (int j = 0; j < UndoChunk::size; ++j) {
+		for (int i = 0; i < UndoChunk::size; ++i) {
+			int x = chunkX * UndoChunk::size + i;
+			int y = chunkY * UndoChunk::size + j;
+			int index = j * UndoChunk::size + i;
+			if (x < map->getW() && y < map->getH()) {
+				chunk->height[index] = map->getHeight(x, y);
+				chunk->surface[index] = map->getSurface(x, y);
+				chunk->object[index] = map->getObject(x, y);
+				chunk->resource[index] = map->getResource(x, y);
 			}
-			//std::cout << "Built the array" << std::endl;
-			if (change != ctAll) break;
-		// Back up surfaces
-		case ctSurface:
-			surface = new int[w * h];
-			for (int i = 0; i < w; ++i) {
-				for (int j = 0; j < h; ++j) {
-					 surface[j * w + i] = Program::map->getSurface(i, j);
-				}
+			else {
+				chunk->height[index] = 0;
+				chunk->surface[index] = 0;
+				chunk->object[index] = 0;
+				chunk->resource[index] = 0;
 			}
-			if (change != ctAll) break;
-		// Back up both objects and resources if either changes
-		case ctObject:
-		case ctResource:
-			object = new int[w * h];
-			for (int i = 0; i < w; ++i) {
-				for (int j = 0; j < h; ++j) {
-					 object[j * w + i] = Program::map->getObject(i, j);
-				}
+		}
+	}
+}
+
+void UndoPoint::writeChunk(int chunkX, int chunkY, const UndoChunk *chunk) {
+	MapPreview *map = Program::map;
+	for (int j = 0; j < UndoChunk::size; ++j) {
+		for (int i = 0; i < UndoChunk::size; ++i) {
+			int x = chunkX * UndoChunk::size + i;
+			int y = chunkY * UndoChunk::size + j;
+			if (x < map->getW() && y < map->getH()) {
+				int index = j * UndoChunk::size + i;
+				map->setHeight(x, y, chunk->height[index]);
+				map->setSurface(x, y, static_cast<MapSurfaceType>(chunk->surface[index]));
+				map->setObject(x, y, chunk->object[index]);
+				map->setResource(x, y, chunk->resource[index]);
+			}
+		}
+	}
+}
+
+// Brings the dirty chunks up to date, chunks whose cells did not change
+// keep being shared with the older undo points
+void UndoPoint::updateCurrentChunks() {
+	int mapW = (Program::map->getW() + UndoChunk::size - 1) / UndoChunk::size;
+	int mapH = (Program::map->getH() + UndoChunk::size - 1) / UndoChunk::size;
+	if (mapW != w || mapH != h || currentChunks.empty()) {
+		releaseChunks(currentChunks);
+		w = mapW;
+		h = mapH;
+		currentChunks.resize(w * h, NULL);
+		dirtyChunks.assign(w * h, true);
+	}
+
+	UndoChunk *chunk = NULL;
+	for (int j = 0; j < h; ++j) {
+		for (int i = 0; i < w; ++i) {
+			int index = j * w + i;
+			if (dirtyChunks[index] == false) {
+				continue;
+			}
+			if (chunk == NULL) {
+				chunk = new UndoChunk();
 			}
-			resource = new int[w * h];
-			for (int i = 0; i < w; ++i) {
-				for (int j = 0; j < h; ++j) {
-					 resource[j * w + i] = Program::map->getResource(i, j);
+			readChunk(i, j, chunk);
+			if (currentChunks[index] == NULL || currentChunks[index]->sameCells(*chunk) == false) {
+				if (currentChunks[index] != NULL && --currentChunks[index]->referenceCount == 0) {
+					delete currentChunks[index];
 				}
+				currentChunks[index] = chunk;
+				chunk = NULL;
 			}
-			break;
+			dirtyChunks[index] = false;
+		}
 	}
+	delete chunk;
 }
 
-UndoPoint::~UndoPoint() {
-	delete [] height;
-	delete [] resource;
-	delete [] object;
-	delete [] surface;
+void UndoPoint::markDirty(int x, int y, int radius) {
+	if (dirtyChunks.empty()) {
+		return;
+	}
+	int minX = std::max(0, (x - radius) / UndoChunk::size);
+	int minY = std::max(0, (y - radius) / UndoChunk::size);
+	int maxX = std::min(w - 1, (x + radius) / UndoChunk::size);
+	int maxY = std::min(h - 1, (y + radius) / UndoChunk::size);
+	for (int j = minY; j <= maxY; ++j) {
+		for (int i = minX; i <= maxX; ++i) {
+			dirtyChunks[j * w + i] = true;
+		}
+	}
+}
+
+void UndoPoint::markAllDirty() {
+	dirtyChunks.assign(dirtyChunks.size(), true);
+}
+
+void UndoPoint::clearCurrentChunks() {
+	releaseChunks(currentChunks);
+	dirtyChunks.clear();
+	w = 0;
+	h = 0;
+}
+
+void UndoPoint::init(ChangeType change) {
+	this->change = change;
+	updateCurrentChunks();
+
+	releaseChunks(chunks);
+	chunks = currentChunks;
+	for (unsigned int i = 0; i < chunks.size(); ++i) {
+		chunks[i]->referenceCount++;
+	}
 }
 
 void UndoPoint::revert() {
-	//std::cout << "attempting to revert last changes to " << undoID << std::endl;
-	switch (change) {
-		// Revert Everything
-		case ctAll:
-		// Revert Heights
-		case ctHeight:
-		case ctGradient:
-			// Restore the array of heights to the map
-			//std::cout << "attempting to restore the height array" << std::endl;
-			for (int i = 0; i < w; i++) {
-				for (int j = 0; j < h; j++) {
-					 Program::map->setHeight(i, j, height[j * w + i]);
-				}
-			}
-			if (change != ctAll) break;
-		// Revert surfaces
-		case ctSurface:
-			//std::cout << "attempting to restore the surface array" << std::endl;
-			for (int i = 0; i < w; i++) {
-				for (int j = 0; j < h; j++) {
-					 Program::map->setSurface(i, j, static_cast<MapSurfaceType>(surface[j * w + i]));
-				}
-			}
-			if (change != ctAll) break;
-		// Revert objects and resources
-		case ctObject:
-		case ctResource:
-			for (int i = 0; i < w; i++) {
-				for (int j = 0; j < h; j++) {
-					 Program::map->setObject(i, j, object[j * w + i]);
-				}
+	// the map was resized since this undo point was set
+	if (chunks.size() != currentChunks.size()) {
+		return;
+	}
+	for (int j = 0; j < h; ++j) {
+		for (int i = 0; i < w; ++i) {
+			int index = j * w + i;
+			if (chunks[index] == currentChunks[index]) {
+				continue;
 			}
-			for (int i = 0; i < w; i++) {
-				for (int j = 0; j < h; j++) {
-					 Program::map->setResource(i, j, resource[j * w + i]);
-				}
+			writeChunk(i, j, chunks[index]);
+			chunks[index]->referenceCount++;
+			if (--currentChunks[index]->referenceCount == 0) {
+				delete currentChunks[index];
 			}
-			break;
+			currentChunks[index] = chunks[index];
+		}
 	}
-	//std::cout << "reverted changes (we hope)" << std::endl;
 }
 
 // ===============================================
@@ -171,6 +244,9 @@ void Program::init() {
 }
 
 Program::~Program() {
+	undoStack.clear();
+	redoStack.clear();
+	UndoPoint::clearCurrentChunks();
 	delete map;
 	map = NULL;
 }
@@ -206,23 +282,38 @@ int Program::getResource(int x, int y) {
 }
 
 void Program::glestChangeMapHeight(int x, int y, int Height, int radius) {
-	if(map) map->glestChangeHeight((x - ofsetX) / cellSize, (y + ofsetY) / cellSize, Height, radius);
+	if(map) {
+		map->glestChangeHeight((x - ofsetX) / cellSize, (y + ofsetY) / cellSize, Height, radius);
+		UndoPoint::markDirty((x - ofsetX) / cellSize, (y + ofsetY) / cellSize, radius);
+	}
 }
 
 void Program::pirateChangeMapHeight(int x, int y, int Height, int radius) {
-	if(map) map->pirateChangeHeight((x - ofsetX) / cellSize, (y + ofsetY) / cellSize, Height, radius);
+	if(map) {
+		map->pirateChangeHeight((x - ofsetX) / cellSize, (y + ofsetY) / cellSize, Height, radius);
+		UndoPoint::markDirty((x - ofsetX) / cellSize, (y + ofsetY) / cellSize, radius);
+	}
 }
 
 void Program::changeMapSurface(int x, int y, int surface, int radius) {
-	if(map) map->changeSurface((x - ofsetX) / cellSize, (y + ofsetY) / cellSize, static_cast<MapSurfaceType>(surface), radius);
+	if(map) {
+		map->changeSurface((x - ofsetX) / cellSize, (y + ofsetY) / cellSize, static_cast<MapSurfaceType>(surface), radius);
+		UndoPoint::markDirty((x - ofsetX) / cellSize, (y + ofsetY) / cellSize, radius);
+	}
 }
 
 void Program::changeMapObject(int x, int y, int object, int radius) {
-	if(map) map->changeObject((x - ofsetX) / cellSize, (y + ofsetY) / cellSize, object, radius);
+	if(map) {
+		map->changeObject((x - ofsetX) / cellSize, (y + ofsetY) / cellSize, object, radius);
+		UndoPoint::markDirty((x - ofsetX) / cellSize, (y + ofsetY) / cellSize, radius);
+	}
 }
 
 void Program::changeMapResource(int x, int y, int resource, int radius) {
-	if(map) map->changeResource((x - ofsetX) / cellSize, (y + ofsetY) / cellSize, resource, radius);
+	if(map) {
+		map->changeResource((x - ofsetX) / cellSize, (y + ofsetY) / cellSize, resource, radius);
+		UndoPoint::markDirty((x - ofsetX) / cellSize, (y + ofsetY) / cellSize, radius);
+	}
 }
 
 void Program::changeStartLocation(int x, int y, int player) {
@@ -274,14 +365,17 @@ void Program::setRefAlt(int x, int y) {
 }
 
 void Program::flipX() {
+	UndoPoint::markAllDirty();
 	if(map) map->flipX();
 }
 
 void Program::flipY() {
+	UndoPoint::markAllDirty();
 	if(map) map->flipY();
 }
 
 void Program::mirrorX() { // copy left to right
+	UndoPoint::markAllDirty();
 	if(map) {
 		int w=map->getW();
 		int h=map->getH();
@@ -306,6 +400,7 @@ void Program::mirrorX() { // copy left to right
 }
 
 void Program::mirrorY() { // copy top to bottom
+	UndoPoint::markAllDirty();
 	if(map) {
 		int w=map->getW();
 		int h=map->getH();
@@ -330,6 +425,7 @@ void Program::mirrorY() { // copy top to bottom
 }
 
 void Program::mirrorXY() { // copy leftbottom to topright, can handle non-sqaure maps
+	UndoPoint::markAllDirty();
 	if(map) {
 		int w=map->getW();
 		int h=map->getH();
@@ -373,6 +469,7 @@ void Program::mirrorXY() { // copy leftbottom to topright, can handle non-sqaure
 }
 
 void Program::rotatecopyX() {
+	UndoPoint::markAllDirty();
 	if(map) {
 		int w=map->getW();
 		int h=map->getH();
@@ -397,6 +494,7 @@ void Program::rotatecopyX() {
 }
 
 void Program::rotatecopyY() {
+	UndoPoint::markAllDirty();
 	if(map) {
 		int w=map->getW();
 		int h=map->getH();
@@ -421,6 +519,7 @@ void Program::rotatecopyY() {
 }
 
 void Program::rotatecopyXY() {
+	UndoPoint::markAllDirty();
 	if(map) {
 		int w=map->getW();
 		int h=map->getH();
@@ -454,6 +553,7 @@ void Program::rotatecopyXY() {
 }
 
 void Program::rotatecopyCorner() { // rotate top left 1/4 to top right 1/4
+	UndoPoint::markAllDirty();
 	if(map) {
 		int w=map->getW();
 		int h=map->getH();
@@ -498,6 +598,7 @@ void Program::rotatecopyCorner() { // rotate top left 1/4 to top right 1/4
 
 
 void Program::shiftLeft() {
+	UndoPoint::markAllDirty();
 	if(map) {
 		int w=map->getW()-1;
 		int h=map->getH();
@@ -510,6 +611,7 @@ void Program::shiftLeft() {
 }
 
 void Program::flipDiagonal() {
+	UndoPoint::markAllDirty();
 	if(map) {
 		int w=map->getW();
 		int h=map->getH();
@@ -525,6 +627,7 @@ void Program::flipDiagonal() {
 
 
 void Program::shiftRight() {
+	UndoPoint::markAllDirty();
 	if(map) {
 		int w=map->getW()-1;
 		int h=map->getH();
@@ -537,6 +640,7 @@ void Program::shiftRight() {
 	}
 }
 void Program::shiftUp() {
+	UndoPoint::markAllDirty();
 	if(map) {
 		int w=map->getW();
 		int h=map->getH()-1;
@@ -548,6 +652,7 @@ void Program::shiftUp() {
 	}
 }
 void Program::shiftDown() {
+	UndoPoint::markAllDirty();
 	if(map) {
 		int w=map->getW();
 		int h=map->getH()-1;
@@ -562,6 +667,7 @@ void Program::shiftDown() {
 
 
 void Program::randomizeMapHeights(bool withReset,int minimumHeight, int maximumHeight, int chanceDivider, int smoothRecursions) {
+	UndoPoint::markAllDirty();
 	if(map) map->randomizeHeights(withReset, minimumHeight,  maximumHeight,  chanceDivider,  smoothRecursions);
 }
 
@@ -570,16 +676,21 @@ void Program::randomizeFactions() {
 }
 
 void Program::switchMapSurfaces(int surf1, int surf2) {
+	UndoPoint::markAllDirty();
 	if(map) map->switchSurfaces(static_cast<MapSurfaceType>(surf1), static_cast<MapSurfaceType>(surf2));
 }
 
 void Program::reset(int w, int h, int alt, int surf) {
 	undoStack.clear();
 	redoStack.clear();
+	UndoPoint::clearCurrentChunks();
 	if(map) map->reset(w, h, (float) alt, static_cast<MapSurfaceType>(surf));
 }
 
 void Program::resize(int w, int h, int alt, int surf) {
+	undoStack.clear();
+	redoStack.clear();
+	UndoPoint::clearCurrentChunks();
 	if(map) map->resize(w, h, (float) alt, static_cast<MapSurfaceType>(surf));
 }
 
@@ -662,6 +773,7 @@ void Program::setMapAdvanced(int altFactor, int waterLevel, int cliffLevel , int
 void Program::loadMap(const string &path) {
 	undoStack.clear();
 	redoStack.clear();
+	UndoPoint::clearCurrentChunks();
 
 	std::string encodedPath = path;
 	map->loadFromFile(encodedPath);
@@ -18,8 +18,10 @@
 #include "base_renderer.h"
 
 #include <stack>
+#include <vector>
 
 using std::stack;
+using std::vector;
 using namespace Shared::Map;
 using namespace Shared::Graphics;
 
@@ -38,43 +40,70 @@ enum ChangeType {
 	ctAll
 };
 
+// =============================================
+// class UndoChunk
+// A square block of map cells as they were when an undo point was set.
+// Blocks that did not change between undo points are shared by them.
+// =============================================
+class UndoChunk {
+	public:
+		static const int size = 16;
+		static const int cellCount = size * size;
+
+		float height[cellCount];
+		int surface[cellCount];
+		int object[cellCount];
+		int resource[cellCount];
+
+		int referenceCount;
+
+		UndoChunk() : referenceCount(1) { }
+		bool sameCells(const UndoChunk &other) const;
+};
+
 // =============================================
 // class Undo Point
-// A linked list class that is more of an extension / modification on
-// the already existing Cell struct in map.h
-// Provides the ability to only specify a certain property of the map to change
+// Holds one chunk per block of the map. Setting an undo point only copies
+// the blocks changed since the previous one, reverting only writes back
+// the blocks that differ from the current map.
 // =============================================
 class UndoPoint {
 	private:
-		// Only keep a certain number of undo points in memory otherwise
-		// Big projects could hog a lot of memory
-		const static int MAX_UNDO_LIST_SIZE = 100;
-		static int undoCount;
-
 		ChangeType change;
+		vector<UndoChunk *> chunks;
 
-		// Pointers to arrays of each property
-		int *surface;
-		int *object;
-		int *resource;
-		float *height;
+		// Chunks matching the current map, the dirty ones may be stale
+		static vector<UndoChunk *> currentChunks;
+		static vector<bool> dirtyChunks;
 
-		// Map width and height
+		// Map width and height in chunks
 		static int w;
 		static int h;
 
+		static void readChunk(int chunkX, int chunkY, UndoChunk *chunk);
+		static void writeChunk(int chunkX, int chunkY, const UndoChunk *chunk);
+		static void updateCurrentChunks();
+		static void releaseChunks(vector<UndoChunk *> &chunkList);
+
 	public:
 		UndoPoint();
+		UndoPoint(const UndoPoint &obj);
+		UndoPoint &operator=(const UndoPoint &obj);
 		~UndoPoint();
 		void init(ChangeType change);
 		void revert();
 
 		inline ChangeType getChange() const 	{ return change; }
+
+		// Map cells changed since the last undo point
+		static void markDirty(int x, int y, int radius);
+		static void markAllDirty();
+		static void clearCurrentChunks();
 };
 
 class ChangeStack : public std::stack<UndoPoint> {
 public:
-	static const unsigned int maxSize = 100;
+	static const unsigned int maxSize = 1000;
 
 	ChangeStack() : std::stack<UndoPoint>() { }
 	void clear() { c.clear(); }
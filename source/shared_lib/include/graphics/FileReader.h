@@ -242,7 +242,13 @@ static inline T* readFromFileReaders(vector<FileReader<T> const *>* readers, con
 template <typename T>
 T* FileReader<T>::readPath(const string& filepath) {
 	const string& extension = extractExtension(filepath);
-	vector<FileReader<T> const * >* possibleReaders = (getFileReadersMap())[extension];
+	//use find() rather than [] so unknown extensions never insert into the map
+	//(texture decode threads may call this concurrently)
+	vector<FileReader<T> const * >* possibleReaders = NULL;
+	typename map<string, vector<FileReader<T> const * >* >::const_iterator iterFind = getFileReadersMap().find(extension);
+	if(iterFind != getFileReadersMap().end()) {
+		possibleReaders = iterFind->second;
+	}
 	if (possibleReaders != NULL) {
 		//Search in these possible readers
 		T* ret = readFromFileReaders(possibleReaders, filepath);
@@ -265,7 +271,11 @@ T* FileReader<T>::readPath(const string& filepath) {
 template <typename T>
 T* FileReader<T>::readPath(const string& filepath, T* object) {
 	const string& extension = extractExtension(filepath);
-	vector<FileReader<T> const * >* possibleReaders = (getFileReadersMap())[extension];
+	vector<FileReader<T> const * >* possibleReaders = NULL;
+	typename map<string, vector<FileReader<T> const * >* >::const_iterator iterFind = getFileReadersMap().find(extension);
+	if(iterFind != getFileReadersMap().end()) {
+		possibleReaders = iterFind->second;
+	}
 	if (possibleReaders != NULL) {
 		//Search in these possible readers
 		T* ret = readFromFileReaders(possibleReaders, filepath, object);
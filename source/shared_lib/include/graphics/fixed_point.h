@@ -0,0 +1,195 @@
+// ==============================================================
+//	This file is part of Glest Shared Library (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martiño Figueroa
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_GRAPHICS_FIXEDPOINT_H_
+#define _SHARED_GRAPHICS_FIXEDPOINT_H_
+
+#include "vec.h"
+#include "data_types.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Platform;
+
+namespace Shared{ namespace Graphics{
+
+// =====================================================
+//	class Fixed
+//
+///	Signed fixed point number with 16 fraction bits for simulation math.
+///	Only integer operations are used so every platform and compiler gets
+///	the same bits without depending on the FPU mode. Products and quotients
+///	must stay below 2^31.
+// =====================================================
+
+class Fixed {
+public:
+	static const int fractionBits= 16;
+	static const int64 one= (int64)1 << fractionBits;
+
+private:
+	int64 raw;
+
+public:
+	Fixed() : raw(0) {}
+	Fixed(int value) : raw((int64)value * one) {}
+
+	static Fixed fromRaw(int64 raw) {
+		Fixed result;
+		result.raw= raw;
+		return result;
+	}
+
+	//only for values read from data files, rounds to the nearest step.
+	//Saved games store getRaw() since a float does not round-trip.
+	static Fixed fromFloat(double value) {
+		return fromRaw(static_cast<int64>(value * one + (value < 0 ? -0.5 : 0.5)));
+	}
+
+	//value / 2^bits rounded towards minus infinity, >> on a negative number
+	//is implementation defined so it only ever sees non negative ones
+	static int64 floorShift(int64 value, int bits) {
+		return value >= 0 ? value >> bits : ~((~value) >> bits);
+	}
+
+	//integer square root, rounded down
+	static uint64 isqrt(uint64 value) {
+		uint64 result= 0;
+		uint64 bit= (uint64)1 << 62;
+		while(bit > value) {
+			bit >>= 2;
+		}
+		while(bit != 0) {
+			if(value >= result + bit) {
+				value -= result + bit;
+				result= (result >> 1) + bit;
+			}
+			else {
+				result >>= 1;
+			}
+			bit >>= 2;
+		}
+		return result;
+	}
+
+	inline int64 getRaw() const				{return raw;}
+	inline float toFloat() const			{return static_cast<float>(raw) / one;}
+	inline int floorToInt() const			{return static_cast<int>(floorShift(raw, fractionBits));}
+	inline int ceilToInt() const			{return static_cast<int>(floorShift(raw + one - 1, fractionBits));}
+	inline int roundToInt() const			{return static_cast<int>(floorShift(raw + one / 2, fractionBits));}
+
+	inline Fixed sqrt() const {
+		return fromRaw(raw <= 0 ? 0 : static_cast<int64>(isqrt(static_cast<uint64>(raw) << fractionBits)));
+	}
+	inline Fixed abs() const				{return fromRaw(raw < 0 ? -raw : raw);}
+
+	//this * mul / div with a wide intermediate, for percentages
+	inline Fixed mulDiv(int mul, int div) const {
+		return fromRaw(raw * mul / div);
+	}
+
+	inline Fixed operator-() const						{return fromRaw(-raw);}
+	inline Fixed operator+(const Fixed &v) const		{return fromRaw(raw + v.raw);}
+	inline Fixed operator-(const Fixed &v) const		{return fromRaw(raw - v.raw);}
+	inline Fixed operator*(const Fixed &v) const		{return fromRaw(floorShift(raw * v.raw, fractionBits));}
+	inline Fixed operator/(const Fixed &v) const		{return fromRaw((raw * one) / v.raw);}
+	inline Fixed operator*(int v) const					{return fromRaw(raw * v);}
+	inline Fixed operator/(int v) const					{return fromRaw(raw / v);}
+
+	inline Fixed &operator+=(const Fixed &v)			{raw += v.raw; return *this;}
+	inline Fixed &operator-=(const Fixed &v)			{raw -= v.raw; return *this;}
+	inline Fixed &operator*=(const Fixed &v)			{*this= *this * v; return *this;}
+	inline Fixed &operator/=(const Fixed &v)			{*this= *this / v; return *this;}
+
+	inline bool operator==(const Fixed &v) const		{return raw == v.raw;}
+	inline bool operator!=(const Fixed &v) const		{return raw != v.raw;}
+	inline bool operator<(const Fixed &v) const			{return raw < v.raw;}
+	inline bool operator<=(const Fixed &v) const		{return raw <= v.raw;}
+	inline bool operator>(const Fixed &v) const			{return raw > v.raw;}
+	inline bool operator>=(const Fixed &v) const		{return raw >= v.raw;}
+};
+
+// =====================================================
+//	class Vec2x
+//
+///	2d vector of Fixed, lengths must stay below 2^15
+// =====================================================
+
+class Vec2x {
+public:
+	Fixed x;
+	Fixed y;
+
+public:
+	Vec2x() {}
+	Vec2x(const Fixed &x, const Fixed &y) : x(x), y(y) {}
+	explicit Vec2x(const Vec2i &v) : x(v.x), y(v.y) {}
+
+	inline Vec2x operator+(const Vec2x &v) const		{return Vec2x(x + v.x, y + v.y);}
+	inline Vec2x operator-(const Vec2x &v) const		{return Vec2x(x - v.x, y - v.y);}
+	inline Vec2x operator*(const Fixed &s) const		{return Vec2x(x * s, y * s);}
+	inline Vec2x operator/(const Fixed &s) const		{return Vec2x(x / s, y / s);}
+	inline bool operator==(const Vec2x &v) const		{return x == v.x && y == v.y;}
+	inline bool operator!=(const Vec2x &v) const		{return x != v.x || y != v.y;}
+
+	inline Fixed dot(const Vec2x &v) const				{return x * v.x + y * v.y;}
+
+	//exact up to the last fraction bit, the squares keep all 32 fraction
+	//bits until the square root
+	inline Fixed length() const {
+		int64 rx= x.getRaw();
+		int64 ry= y.getRaw();
+		return Fixed::fromRaw(static_cast<int64>(Fixed::isqrt(static_cast<uint64>(rx * rx) + static_cast<uint64>(ry * ry))));
+	}
+	inline Fixed dist(const Vec2x &v) const				{return (v - *this).length();}
+
+	inline Vec2f toVec2f() const						{return Vec2f(x.toFloat(), y.toFloat());}
+};
+
+// =====================================================
+//	class Vec3x
+//
+///	3d vector of Fixed, lengths must stay below 2^15
+// =====================================================
+
+class Vec3x {
+public:
+	Fixed x;
+	Fixed y;
+	Fixed z;
+
+public:
+	Vec3x() {}
+	Vec3x(const Fixed &x, const Fixed &y, const Fixed &z) : x(x), y(y), z(z) {}
+	explicit Vec3x(const Vec3i &v) : x(v.x), y(v.y), z(v.z) {}
+
+	inline Vec3x operator+(const Vec3x &v) const		{return Vec3x(x + v.x, y + v.y, z + v.z);}
+	inline Vec3x operator-(const Vec3x &v) const		{return Vec3x(x - v.x, y - v.y, z - v.z);}
+	inline Vec3x operator*(const Fixed &s) const		{return Vec3x(x * s, y * s, z * s);}
+	inline Vec3x operator/(const Fixed &s) const		{return Vec3x(x / s, y / s, z / s);}
+	inline bool operator==(const Vec3x &v) const		{return x == v.x && y == v.y && z == v.z;}
+	inline bool operator!=(const Vec3x &v) const		{return !(*this == v);}
+
+	inline Fixed dot(const Vec3x &v) const				{return x * v.x + y * v.y + z * v.z;}
+
+	inline Fixed length() const {
+		int64 rx= x.getRaw();
+		int64 ry= y.getRaw();
+		int64 rz= z.getRaw();
+		return Fixed::fromRaw(static_cast<int64>(Fixed::isqrt(static_cast<uint64>(rx * rx) + static_cast<uint64>(ry * ry) + static_cast<uint64>(rz * rz))));
+	}
+	inline Fixed dist(const Vec3x &v) const				{return (v - *this).length();}
+
+	inline Vec3f toVec3f() const						{return Vec3f(x.toFloat(), y.toFloat(), z.toFloat());}
+};
+
+}}//end namespace
+
+#endif
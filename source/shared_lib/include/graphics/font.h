@@ -14,6 +14,8 @@
 
 #include <string>
 #include <vector>
+#include <map>
+#include <list>
 #include "font_text.h"
 #include "leak_dumper.h"
 
@@ -27,6 +29,13 @@ namespace Shared { namespace Graphics {
 //	class FontMetrics
 // =====================================================
 
+//advance of the longest line of a string, kept in FontMetrics' text cache
+class FontMetricsTextLayout {
+public:
+	float advance;
+	std::list<string>::iterator lruPosition;
+};
+
 class FontMetrics {
 
 private:
@@ -36,6 +45,16 @@ private:
 	//float yOffsetFactor;
 	Text *textHandler;
 
+	//the UI asks for the same label widths every frame, so FTGL advances
+	//are kept for the most recently used strings of this font and size
+	static const unsigned int maxCachedTextLayouts = 512;
+	std::map<string,FontMetricsTextLayout> textLayouts;
+	std::list<string> textLayoutUseOrder;
+	mutable float cachedLineHeight;
+	mutable bool cachedLineHeightValid;
+	int textLayoutHits;
+	int textLayoutMisses;
+
 public:
 	//static float DEFAULT_Y_OFFSET_FACTOR;
 
@@ -54,6 +73,11 @@ public:
 	float getTextWidth(const string &str);
 	float getHeight(const string &str) const;
 
+	void clearTextLayoutCache();
+	int getTextLayoutCacheSize() const	{return (int)textLayouts.size();}
+	int getTextLayoutHits() const		{return textLayoutHits;}
+	int getTextLayoutMisses() const		{return textLayoutMisses;}
+
 	string wordWrapText(string text, int maxWidth);
 
 };
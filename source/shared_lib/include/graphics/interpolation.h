@@ -35,6 +35,9 @@ private:
 	static bool enableInterpolation;
 	
 	void update(const Vec3f* src, Vec3f* &dest, float t, bool cycle);
+	bool getFrames(float t, bool cycle, uint32 &prevFrame, uint32 &nextFrame, float &localT) const;
+	void updateQuantizedVertices(float t, bool cycle);
+	void updateQuantizedNormals(float t, bool cycle);
 
 public:
 	InterpolationData(const Mesh *mesh);
@@ -42,8 +45,9 @@ public:
 
 	static void setEnableInterpolation(bool enabled) { enableInterpolation = enabled; }
 
-	const Vec3f *getVertices() const	{return !vertices || !enableInterpolation? mesh->getVertices()+raw_frame_ofs: vertices;}
-	const Vec3f *getNormals() const		{return !normals || !enableInterpolation? mesh->getNormals()+raw_frame_ofs: normals;}
+	//quantized meshes have no float frames, they are always decoded into vertices and normals
+	const Vec3f *getVertices() const	{return !vertices || (!enableInterpolation && mesh->getVertices())? mesh->getVertices()+raw_frame_ofs: vertices;}
+	const Vec3f *getNormals() const		{return !normals || (!enableInterpolation && mesh->getNormals())? mesh->getNormals()+raw_frame_ofs: normals;}
 	
 	void update(float t, bool cycle);
 	void updateVertices(float t, bool cycle);
@@ -63,6 +63,14 @@ private:
 	Vec3f *tangents;
 	uint32 *indices;
 
+	//quantized keyframes, replace vertices and normals of animated meshes
+	uint16 *quantizedVertices;
+	int16 *quantizedNormals;
+	Vec3f quantizeOffset;
+	Vec3f quantizeScale;
+
+	static bool quantizeKeyframes;
+
 	//material data
 	Vec3f diffuseColor;
 	Vec3f specularColor;
@@ -104,6 +112,7 @@ public:
 	uint32 getVertexCount() const			{return vertexCount;}
 	uint32 getIndexCount() const			{return indexCount;}
 	uint32 getTriangleCount() const;
+	uint32 getDataSize() const;
 
 	uint32	getVBOVertices() const  { return m_nVBOVertices;}
 	uint32	getVBOTexCoords() const { return m_nVBOTexCoords;}
@@ -120,6 +129,11 @@ public:
 	const Vec3f *getTangents() const	{return tangents;}
 	const uint32 *getIndices() const 	{return indices;}
 
+	const uint16 *getQuantizedVertices() const	{return quantizedVertices;}
+	const int16 *getQuantizedNormals() const	{return quantizedNormals;}
+	const Vec3f &getQuantizeOffset() const		{return quantizeOffset;}
+	const Vec3f &getQuantizeScale() const		{return quantizeScale;}
+
 	void setVertices(Vec3f *data, uint32 count);
 	void setNormals(Vec3f *data, uint32 count);
 	void setTexCoords(Vec2f *data, uint32 count);
@@ -166,6 +180,13 @@ public:
 			bool keepsmallest,string modelFile);
 
 	void deletePixels();
+	void optimize();
+
+	static void setQuantizeKeyframes(bool value)	{quantizeKeyframes= value;}
+	static bool getQuantizeKeyframes()				{return quantizeKeyframes;}
+	void quantizeFrames();
+	static void encodeOctahedral(const Vec3f &normal, int16 &x, int16 &y);
+	static Vec3f decodeOctahedral(int16 x, int16 y);
 
 	void toEndian();
 	void fromEndian();
@@ -227,6 +248,7 @@ public:
 	//io
 	void save(const string &path, string convertTextureToFormat,bool keepsmallest);
 	void saveG3d(const string &path, string convertTextureToFormat,bool keepsmallest);
+	string optimizeMeshes();
 
 	void setTextureManager(TextureManager *textureManager)	{this->textureManager= textureManager;}
 	void deletePixels();
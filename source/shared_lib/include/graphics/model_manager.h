@@ -34,6 +34,16 @@ protected:
 	ModelContainer models;
 	TextureManager *textureManager;
 
+	//loaded models by path, the flag is the deletePixMapAfterLoad they were
+	//loaded with. Repeat requests share the model and take a reference.
+	map<string,pair<Model *,bool> > modelIndex;
+	map<Model *,int> modelReferences;
+	int lookupCount;
+	int lookupHitCount;
+
+	bool releaseModelReference(Model *model);
+	void unindexModel(Model *model);
+
 public:
 	ModelManager();
 	virtual ~ModelManager();
@@ -46,6 +56,7 @@ public:
 	void endLastModel(bool mustExistInList=false);
 
 	void setTextureManager(TextureManager *textureManager)	{this->textureManager= textureManager;}
+	string getLookupStats() const;
 };
 
 }}//end namespace
@@ -16,6 +16,7 @@
 #include "vec.h"
 #include "data_types.h"
 #include <map>
+#include <vector>
 #include "checksum.h"
 #include "leak_dumper.h"
 
@@ -31,6 +32,8 @@ using Shared::Util::Checksum;
 
 namespace Shared{ namespace Graphics{
 
+class SplatWeights;
+
 /**
  * @brief Next power of 2
  * @param x The number to be rounded
@@ -289,10 +292,12 @@ public:
 
 	//operations
 	void splat(const Pixmap2D *leftUp, const Pixmap2D *rightUp, const Pixmap2D *leftDown, const Pixmap2D *rightDown); 
+	void splat(const Pixmap2D *leftUp, const Pixmap2D *rightUp, const Pixmap2D *leftDown, const Pixmap2D *rightDown, const SplatWeights &weights);
 	void lerp(float t, const Pixmap2D *pixmap1, const Pixmap2D *pixmap2);
 	void copy(const Pixmap2D *sourcePixmap);
 	void subCopy(int x, int y, const Pixmap2D *sourcePixmap);
 	void copyImagePart(int x, int y, const Pixmap2D *sourcePixmap);
+	void swap(Pixmap2D *otherPixmap);
 	string getPath() const		{ return path;}
 	std::size_t getPixelByteCount() const;
 
@@ -302,6 +307,56 @@ private:
 	bool doDimensionsAgree(const Pixmap2D *pixmap);
 };
 
+// =====================================================
+//	class SplatWeights
+// =====================================================
+
+//blend weights of the four corner pixmaps for each pixel of a splat, already
+//divided by their sum. The random variation always starts from the same
+//seed so every splat of one size uses the same weights, they are worked out
+//once and can be shared by threads splatting at the same time.
+class SplatWeights {
+private:
+	int w;
+	int h;
+	std::vector<float> leftUp;
+	std::vector<float> rightUp;
+	std::vector<float> leftDown;
+	std::vector<float> rightDown;
+
+public:
+	SplatWeights();
+	void init(int w, int h);
+
+	int getW() const						{return w;}
+	int getH() const						{return h;}
+	const float *getLeftUp() const			{return &leftUp[0];}
+	const float *getRightUp() const			{return &rightUp[0];}
+	const float *getLeftDown() const		{return &leftDown[0];}
+	const float *getRightDown() const		{return &rightDown[0];}
+};
+
+// =====================================================
+//	class Pixmap2DCache
+// =====================================================
+
+//raw copies of decoded png/jpg pixmaps on disk, so later runs skip the image
+//decode. Entries are keyed by source path and requested components and are
+//rebuilt when the source file's size or modification time changes.
+class Pixmap2DCache {
+private:
+	static string cachePath;
+
+public:
+	static void setCachePath(const string &path)	{cachePath= path;}
+	static string getCachePath()					{return cachePath;}
+	static bool isCacheable(const string &path);
+	static string getCacheFileName(const string &path, int components);
+
+	static bool load(const string &path, Pixmap2D *pixmap);
+	static bool save(const string &path, const Pixmap2D *pixmap, int requestedComponents);
+};
+
 // =====================================================
 //	class Pixmap3D
 // =====================================================
@@ -27,6 +27,19 @@ namespace Shared{ namespace Graphics{
 class TextureParams;
 
 
+class Texture;
+
+// =====================================================
+//	class TexturePathListener
+// =====================================================
+
+//told when a texture is loaded from a file, so owners can index it by path
+class TexturePathListener {
+public:
+	virtual void texturePathChanged(Texture *texture, const string &oldPath) = 0;
+	virtual ~TexturePathListener() {}
+};
+
 // =====================================================
 //	class Texture
 // =====================================================
@@ -67,6 +80,10 @@ protected:
 	bool forceCompressionDisabled;
 	int textureSystemId;
 
+	TexturePathListener *pathListener;
+
+	void notifyPathChanged(const string &oldPath);
+
 public:
 	Texture();
 	virtual ~Texture(){};
@@ -84,6 +101,7 @@ public:
 	void setWrapMode(WrapMode wrapMode)	{this->wrapMode= wrapMode;}
 	void setPixmapInit(bool pixmapInit)	{this->pixmapInit= pixmapInit;}
 	void setFormat(Format format)		{this->format= format;}
+	void setPathListener(TexturePathListener *pathListener)	{this->pathListener= pathListener;}
 
 	virtual void init(Filter filter= fBilinear, int maxAnisotropy= 1)=0;
 	virtual void end(bool deletePixelBuffer=true)=0;
@@ -130,9 +148,15 @@ public:
 class Texture2D: public Texture {
 protected:
 	Pixmap2D pixmap;
+	string loadError;
 
 public:
 	void load(const string &path);
+	void setLoadPath(const string &path);
+
+	//set when a deferred decode failed, init() reports it
+	void setLoadError(const string &error)	{this->loadError= error;}
+	const string &getLoadError() const		{return loadError;}
 
 	Pixmap2D *getPixmap()			{return &pixmap;}
 	const Pixmap2D *getPixmapConst() const	{return &pixmap;}
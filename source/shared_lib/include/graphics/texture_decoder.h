@@ -0,0 +1,112 @@
+// ==============================================================
+//	This file is part of Glest Shared Library (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martiño Figueroa
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_GRAPHICS_TEXTUREDECODER_H_
+#define _SHARED_GRAPHICS_TEXTUREDECODER_H_
+
+#include <deque>
+#include <vector>
+#include <string>
+#include "base_thread.h"
+#include "pixmap.h"
+#include "leak_dumper.h"
+
+using std::deque;
+using std::vector;
+using std::string;
+using Shared::PlatformCommon::BaseThread;
+using Shared::Platform::Mutex;
+using Shared::Platform::Trigger;
+using Shared::Platform::int64;
+
+namespace Shared{ namespace Graphics{
+
+class TextureDecoder;
+
+// =====================================================
+//	class TextureDecodeJob
+// =====================================================
+
+//one image file to decode, the pixmap belongs to whoever receives the
+//job from TextureDecoder::getDecoded()
+class TextureDecodeJob {
+public:
+	TextureDecodeJob();
+
+	string path;
+	Pixmap2D *pixmap;
+	void *userData;
+	string error;
+	int64 decodeMillis;
+};
+
+// =====================================================
+//	class TextureDecodeThread
+// =====================================================
+
+class TextureDecodeThread : public BaseThread {
+protected:
+	TextureDecoder *decoder;
+
+	virtual void setQuitStatus(bool value);
+
+public:
+	TextureDecodeThread(TextureDecoder *decoder);
+	virtual void execute();
+};
+
+// =====================================================
+//	class TextureDecoder
+// =====================================================
+
+//reads and decodes image files on a pool of worker threads. No GL calls are
+//made here: the owner collects finished pixmaps with getDecoded() on the GL
+//thread and uploads them itself, so decoding also works without a context.
+//At most maxDecodedJobs finished pixmaps are held, workers wait beyond that.
+class TextureDecoder {
+private:
+	Mutex *mutex;
+	Trigger *jobQueuedTrigger;
+	Trigger *jobDecodedTrigger;
+	Trigger *jobTakenTrigger;
+
+	deque<TextureDecodeJob> pendingJobs;
+	deque<TextureDecodeJob> decodedJobs;
+	int outstandingJobs;
+	int maxDecodedJobs;
+	bool quit;
+
+	vector<TextureDecodeThread *> workers;
+
+	int decodedCount;
+	int64 decodeMillis;
+
+	friend class TextureDecodeThread;
+	bool getNextJob(TextureDecodeJob &job, BaseThread *worker);
+	void jobDecoded(const TextureDecodeJob &job, BaseThread *worker);
+	void wakeAll();
+
+public:
+	TextureDecoder(int threadCount, int maxDecodedJobs=32);
+	~TextureDecoder();
+
+	void queueDecode(const string &path, int components, void *userData);
+	bool getDecoded(TextureDecodeJob &job, int waitMilliseconds=0);
+
+	int getOutstandingCount();
+	int getThreadCount() const	{return (int)workers.size();}
+	int getDecodedCount();
+	int64 getDecodeMillis();
+};
+
+}}//end namespace
+
+#endif
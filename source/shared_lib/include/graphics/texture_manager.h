@@ -13,10 +13,13 @@
 #define _SHARED_GRAPHICS_TEXTUREMANAGER_H_
 
 #include <vector>
+#include <map>
 #include "texture.h"
+#include "texture_decoder.h"
 #include "leak_dumper.h"
 
 using std::vector;
+using std::map;
 
 namespace Shared{ namespace Graphics{
 
@@ -26,20 +29,49 @@ namespace Shared{ namespace Graphics{
 typedef vector<Texture*> TextureContainer;
 
 //manages textures, creation on request and deletion on destruction
-class TextureManager{
+class TextureManager : public TexturePathListener {
 	
 protected:
 	TextureContainer textures;
+
+	//path lookups, textures get their path after creation and tell us
+	//through texturePathChanged() when they do
+	map<string,Texture *> textureIndex;
+	map<Texture *,int> textureReferences;
+	int lookupCount;
+	int lookupHitCount;
 	
 	Texture::Filter textureFilter;
 	int maxAnisotropy;
 
+	static int decodeThreadCount;
+	bool deferredLoadEnabled;
+	TextureDecoder *decoder;
+	map<Texture2D *,bool> pendingTexture2DLoads;
+	int uploadedCount;
+	int64 uploadMillis;
+
+	void uploadDecodedTexture(TextureDecodeJob &job);
+	void setTextureLoadError(Texture2D *texture, const string &error);
+	void waitForPendingLoad(Texture *texture);
+
+	void addNewTexture(Texture *texture);
+	void unindexTexture(Texture *texture, const string &path);
+	bool releaseTextureReference(Texture *texture);
+
 public:
 	TextureManager();
 	~TextureManager();
 	void init(bool forceInit=false);
 	void end();
 
+	static void setDecodeThreadCount(int value)	{decodeThreadCount= value;}
+	static int getDecodeThreadCount()		{return decodeThreadCount;}
+	void setDeferredLoadEnabled(bool value);
+	bool getDeferredLoadEnabled() const		{return deferredLoadEnabled == true && decodeThreadCount > 0;}
+	void queueTexture2DLoad(Texture2D *texture, const string &path, bool deletePixMapAfterLoad);
+	void uploadDecodedTextures(bool waitForAll);
+
 	void setFilter(Texture::Filter textureFilter);
 	void setMaxAnisotropy(int maxAnisotropy);
 	void initTexture(Texture *texture);
@@ -47,10 +79,14 @@ public:
 	void endLastTexture(bool mustExistInList=false);
 	void reinitTextures();
 
+	virtual void texturePathChanged(Texture *texture, const string &oldPath);
+
 	Texture::Filter getTextureFilter() const {return textureFilter;}
 	int getMaxAnisotropy() const {return maxAnisotropy;}
 
 	Texture *getTexture(const string &path);
+	void addTextureReference(Texture *texture);
+	string getLookupStats() const;
 	Texture1D *newTexture1D();
 	Texture2D *newTexture2D();
 	Texture3D *newTexture3D();
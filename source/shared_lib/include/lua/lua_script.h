@@ -13,12 +13,16 @@
 #define _SHARED_LUA_LUASCRIPT_H_
 
 #include <string>
+#include <vector>
+#include <map>
 #include <lua.hpp>
 #include "vec.h"
+#include "data_types.h"
 #include "xml_parser.h"
 #include "leak_dumper.h"
 
 using std::string;
+using std::vector;
 
 using Shared::Graphics::Vec2i;
 using Shared::Graphics::Vec4i;
@@ -27,18 +31,87 @@ using Shared::Graphics::Vec3f;
 using Shared::Graphics::Vec4f;
 
 using Shared::Xml::XmlNode;
+using Shared::Platform::int64;
+using Shared::Platform::uint64;
 
 namespace Shared { namespace Lua {
 
 typedef lua_State LuaHandle;
 typedef int(*LuaFunction)(LuaHandle*);
 
+// =====================================================
+//	class LuaEvent
+//
+///	One event of a batch, names are string literals so queuing an event
+///	does not allocate
+// =====================================================
+
+class LuaEvent {
+public:
+	static const int maxFields= 4;
+
+	const char *type;
+	int fieldCount;
+	const char *fieldNames[maxFields];
+	int fieldValues[maxFields];
+
+	LuaEvent(const char *type) : type(type), fieldCount(0) {}
+
+	void addField(const char *name, int value) {
+		if(fieldCount < maxFields) {
+			fieldNames[fieldCount]= name;
+			fieldValues[fieldCount]= value;
+			fieldCount++;
+		}
+	}
+};
+
+// =====================================================
+//	class LuaFunctionStats
+// =====================================================
+
+class LuaFunctionStats {
+public:
+	int64 callCount;
+	int64 totalMicros;
+	int64 maxMicros;
+	int64 overBudgetCount;
+
+	LuaFunctionStats() : callCount(0), totalMicros(0), maxMicros(0), overBudgetCount(0) {}
+};
+
 // =====================================================
 //	class LuaScript
 // =====================================================
 
 class LuaScript {
 private:
+	//global functions are looked up once and then called through a
+	//registry reference, assigning the global drops the reference
+	class FunctionEntry {
+	public:
+		bool resolved;
+		int ref;
+		LuaFunctionStats stats;
+
+		FunctionEntry() : resolved(false), ref(LUA_NOREF) {}
+	};
+
+	//a global table the scripts track changes of with trackSaveChanges().
+	//Its saved bytes are reused until markSaveChanged() bumps its stamp.
+	class SavedGlobal {
+	public:
+		int64 changeStamp;
+		int64 savedStamp;
+		int tableRef;
+		string data;
+		vector<const void *> tables;
+
+		SavedGlobal() : changeStamp(0), savedStamp(-1), tableRef(LUA_NOREF) {}
+	};
+
+	static const int eventTableSize= 64;
+
 	LuaHandle *luaState;
 	int argumentCount;
 	string currentLuaFunction;
@@ -46,10 +119,30 @@ private:
 	string sandboxWrapperFunctionName;
 	string sandboxCode;
 
+	std::map<string, FunctionEntry> functions;
+	FunctionEntry *currentFunction;
+	int cachedFunctionsRef;
+	int64 callBudgetMillis;
+
+	int eventTableRef;
+	int eventPoolRef;
+	int lastEventCount;
+
+	std::map<string, SavedGlobal> savedGlobals;
+
 	static bool disableSandbox;
 	static bool debugModeEnabled;
 
 	void DumpGlobals();
+	void hookGlobals();
+	static int globalAssigned(LuaHandle *L);
+	FunctionEntry *getFunction(const string &functionName);
+	void clearFunctionRef(FunctionEntry &entry);
+	void clearFunctionRefs();
+	void updateFunctionStats(int64 micros);
+	static int trackSaveChanges(LuaHandle *L);
+	static int markSaveChanged(LuaHandle *L);
+	void loadState(const XmlNode *node);
 
 public:
 	LuaScript();
@@ -65,6 +158,13 @@ public:
 	void beginCall(string functionName);
 	void endCall();
 
+	bool hasFunction(const string &functionName);
+	void callEvents(const string &functionName, const string &tableName, const vector<LuaEvent> &events);
+
+	void setCallBudgetMillis(int64 value)	{ callBudgetMillis = value; }
+	int64 getCallBudgetMillis() const		{ return callBudgetMillis; }
+	std::map<string, LuaFunctionStats> getFunctionStats() const;
+
 	int runCode(const string code);
 	void setSandboxWrapperFunctionName(string name);
 	void setSandboxCode(string code);
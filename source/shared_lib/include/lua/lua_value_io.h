@@ -0,0 +1,143 @@
+// ==============================================================
+//	This file is part of Glest Shared Library (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martiño Figueroa
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_LUA_LUAVALUEIO_H_
+#define _SHARED_LUA_LUAVALUEIO_H_
+
+#include <string>
+#include <map>
+#include <vector>
+#include <lua.hpp>
+#include "data_types.h"
+#include "leak_dumper.h"
+
+using std::string;
+using std::vector;
+
+using Shared::Platform::int64;
+using Shared::Platform::uint64;
+
+namespace Shared { namespace Lua {
+
+// =====================================================
+//	Binary save format
+//
+//	The LuaState node of a save game holds the globals as base64 text.
+//	Each global is its name and the length of its value followed by the
+//	value: a tag byte and its data, tables list their key and value
+//	pairs up to lstEnd. Every table of the save gets the next id so
+//	tables referenced twice or cycles are written once with lstTableRef.
+//	The reference stores how many tables were written since, so the bytes
+//	of a global that only refers to its own tables stay valid when it is
+//	saved after a different number of tables.
+//
+//	Version 1 saves count the ids per global from 0 and store them as is.
+// =====================================================
+
+const int luaSaveFormatVersion= 2;
+
+enum LuaSaveTag {
+	lstEnd,
+	lstFalse,
+	lstTrue,
+	lstNumber,
+	lstInteger,
+	lstString,
+	lstTable,
+	lstTableRef
+};
+
+// =====================================================
+//	class LuaValueWriter
+//
+///	Appends one value with all tables below it to a string
+// =====================================================
+
+class LuaValueWriter {
+public:
+	static const int maxDepth= 128;
+
+private:
+	lua_State *L;
+	string *out;
+	std::map<const void *, uint64> tableIds;
+	vector<const void *> tables;
+	size_t segmentSize;
+	size_t segmentTableCount;
+	bool segmentIsSelfContained;
+
+	void writeByte(unsigned char value);
+	void writeVarint(uint64 value);
+	void writeInteger(int64 value);
+	void writeNumber(lua_Number value);
+	bool writeTable(int index, int depth);
+
+public:
+	LuaValueWriter(lua_State *L, string *out);
+
+	// returns false for functions, userdata and threads
+	bool writeValue(int index, int depth= 0);
+
+	// a segment is the values written since beginSegment(), usually one
+	// global. A failed global is removed with its table ids by
+	// rollbackSegment(), a self contained one can be saved again later
+	// with appendSegment() as long as its tables did not change.
+	void beginSegment();
+	void rollbackSegment();
+	bool isSegmentSelfContained() const	{ return segmentIsSelfContained; }
+	void getSegmentTables(vector<const void *> &segmentTables) const;
+	// false when one of the tables was written already, the values must
+	// be written again then
+	bool appendSegment(const string &data, const vector<const void *> &segmentTables);
+};
+
+// =====================================================
+//	class LuaValueReader
+//
+///	Pushes the values written by LuaValueWriter, throws on bad data
+// =====================================================
+
+class LuaValueReader {
+private:
+	lua_State *L;
+	const string &data;
+	int version;
+	size_t pos;
+	int idsRef;
+	int idsIndex;
+	int tableCount;
+
+	LuaValueReader(const LuaValueReader &);
+	LuaValueReader &operator=(const LuaValueReader &);
+
+	void throwError(const string &message) const;
+	unsigned char readByte();
+	uint64 readVarint();
+	size_t readSize();
+	void readValue(int depth);
+
+public:
+	LuaValueReader(lua_State *L, const string &data, int version= luaSaveFormatVersion);
+	~LuaValueReader();
+
+	bool atEnd() const { return pos >= data.size(); }
+
+	// pushes the next value, tables shared with it or with the values
+	// read before are restored as the same table
+	void readValue();
+
+	// pushes the value of the next global and returns its name
+	string readGlobal();
+};
+
+}}//end namespace
+
+#endif
@@ -0,0 +1,110 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martiño Figueroa
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _MAPPREVIEW_MAPINFOINDEX_H_
+#define _MAPPREVIEW_MAPINFOINDEX_H_
+
+#include <map>
+#include <vector>
+#include <string>
+#include "base_thread.h"
+#include "data_types.h"
+#include "vec.h"
+#include "leak_dumper.h"
+
+using std::map;
+using std::vector;
+using std::string;
+using Shared::PlatformCommon::BaseThread;
+using Shared::Platform::Mutex;
+using Shared::Platform::int64;
+using Shared::Platform::uint32;
+using Shared::Graphics::Vec2i;
+
+namespace Shared { namespace Map {
+
+// ===============================================
+//	class MapInfoIndexEntry
+// ===============================================
+
+//header values of one map file, stale once the file's time or size changes
+class MapInfoIndexEntry {
+public:
+	MapInfoIndexEntry();
+
+	string path;
+	int64 modTime;
+	int64 fileSize;
+	bool valid;
+	Vec2i size;
+	int players;
+	string title;
+	bool crcValid;
+	uint32 crc;
+};
+
+// ===============================================
+//	class MapInfoIndexThread
+// ===============================================
+
+class MapInfoIndexThread : public BaseThread {
+protected:
+	vector<string> pathList;
+
+public:
+	MapInfoIndexThread(const vector<string> &pathList);
+	virtual void execute();
+};
+
+// ===============================================
+//	class MapInfoIndex
+// ===============================================
+
+//remembers map headers and CRCs between runs so map lists don't have to
+//open every map file. MapPreview::loadMapInfo() answers from here while the
+//entry is fresh and stores what it reads otherwise. A background thread
+//fills the index for all map folders and saves it when done.
+class MapInfoIndex {
+private:
+	Mutex *mutex;
+	string indexFile;
+	map<string,MapInfoIndexEntry> entries;
+	bool dirty;
+	MapInfoIndexThread *indexThread;
+
+	int hitCount;
+	int missCount;
+
+	MapInfoIndex();
+
+	static bool getFileStamp(const string &path, int64 &modTime, int64 &fileSize);
+
+public:
+	~MapInfoIndex();
+	static MapInfoIndex *getInstance();
+
+	void load(const string &indexFile);
+	void save();
+
+	void startBackgroundIndex(const vector<string> &pathList);
+	void stopBackgroundIndex();
+	void indexMapFile(const string &path, BaseThread *worker);
+
+	bool findMapInfo(const string &path, MapInfoIndexEntry &entry);
+	void storeMapInfo(const string &path, bool valid, const Vec2i &size, int players, const string &title);
+	uint32 getMapCRC(const string &path);
+
+	string getStats();
+};
+
+}}// end namespace
+
+#endif
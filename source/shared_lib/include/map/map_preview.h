@@ -94,6 +94,34 @@ struct MapFileHeader {
 void toEndianMapFileHeader(MapFileHeader &header);
 void fromEndianMapFileHeader(MapFileHeader &header);
 
+// ===============================================
+//	class MapFileReader
+// ===============================================
+
+//reads a whole map file with a single read, checks the header against the
+//file size and splits the body into its planes. The planes are stored row
+//by row, index them with y * width + x.
+class MapFileReader {
+private:
+	MapFileHeader header;
+	std::vector<Vec2i> startLocations;
+	std::vector<float32> heights;
+	std::vector<int8> surfaces;
+	std::vector<int8> objects;
+
+public:
+	MapFileReader();
+
+	bool load(const string &path);
+
+	const MapFileHeader &getHeader() const		{return header;}
+	int getStartLocationCount() const			{return (int)startLocations.size();}
+	const Vec2i &getStartLocation(int index) const	{return startLocations[index];}
+	float32 getHeight(int x, int y) const		{return heights[y * header.width + x];}
+	int8 getSurface(int x, int y) const			{return surfaces[y * header.width + x];}
+	int8 getObject(int x, int y) const			{return objects[y * header.width + x];}
+};
+
 class MapInfo {
 public:
 
@@ -120,13 +148,6 @@ public:
 	static const int minHeight = 0;
 
 private:
-	struct Cell {
-		int surface;
-		int object;
-		int resource;
-		float height;
-	};
-
 	struct StartLocation {
 		int x;
 		int y;
@@ -144,8 +165,11 @@ private:
 	int waterLevel;
 	int cliffLevel;
 	int cameraHeight;
-	//Cell **cells;
-	std::vector<std::vector<Cell> > cells;
+	//cell planes, indexed by cellIndex()
+	std::vector<float> heights;
+	std::vector<int> surfaces;
+	std::vector<int> objects;
+	std::vector<int> resources;
 
 	int maxFactions;
 	//StartLocation *startLocations;
@@ -156,6 +180,8 @@ private:
 	string mapFileLoaded;
 	bool hasChanged;
 
+	inline int cellIndex(int x, int y) const	{return y * w + x;}
+
 public:
 	MapPreview();
 	~MapPreview();
@@ -12,6 +12,7 @@
 #define _SHARED_PLATFORMCOMMON_SIMPLETHREAD_H_
 
 #include "base_thread.h"
+#include <SDL_atomic.h>
 #include <vector>
 #include <string>
 #include "util.h"
@@ -147,25 +148,72 @@ public:
     SystemFlags::DebugType type;
     string entry;
     time_t entryDateTime;
+    unsigned long threadId;
+    int sequence;
+};
+
+// Single producer / single consumer ring of log entries. Each thread that
+// logs owns exactly one ring, so producers never contend with each other and
+// never take a lock. The LogFileThread is the only consumer.
+class LogFileRingBuffer {
+protected:
+	vector<LogFileEntry> slots;
+	SDL_atomic_t head;			// next slot to write, only advanced by the producer
+	SDL_atomic_t tail;			// next slot to read, only advanced by the consumer
+	SDL_atomic_t droppedCount;
+	SDL_atomic_t refCount;		// owning thread + LogFileThread
+	SDL_atomic_t released;		// set once the owning thread has exited
+	unsigned long threadId;
+
+public:
+	LogFileRingBuffer(unsigned int capacity, unsigned long threadId);
+
+	bool addLogEntry(SystemFlags::DebugType type, const char *logEntry, time_t entryDateTime, int sequence);
+	void drain(vector<LogFileEntry> &batch);
+	std::size_t getLogEntryBufferCount();
+	int getDroppedCount() { return SDL_AtomicGet(&droppedCount); }
+	unsigned long getThreadId() const { return threadId; }
+
+	void setReleased() { SDL_AtomicSet(&released,1); }
+	bool getReleased() { return (SDL_AtomicGet(&released) != 0); }
+
+	static void releaseRef(LogFileRingBuffer *ring);
+	static void threadExitCallback(void *ring);
 };
 
 class LogFileThread : public BaseThread
 {
 protected:
 
-    Mutex *mutexLogList;
+	static unsigned int ringBufferCapacity;
+
+	// Only guards registration of new rings, producers never take it
+	Mutex *mutexLogList;
+	vector<LogFileRingBuffer *> ringList;
+	SDL_TLSID ringTLSId;
+	SDL_atomic_t sequence;
+
+	SDL_atomic_t writtenCount;
+	SDL_atomic_t droppedCountReleased;
+
+	// Batch drained from the rings, only touched by the writer thread
 	vector<LogFileEntry> logList;
-	time_t lastSaveToDisk;
 
-    void saveToDisk(bool forceSaveAll,bool logListAlreadyLocked);
-    bool checkSaveCurrentLogBufferToDisk();
+	LogFileRingBuffer * getThreadRingBuffer();
+    void saveToDisk();
 
 public:
 	LogFileThread();
 	virtual ~LogFileThread();
+
+	static void setRingBufferCapacity(unsigned int value) { ringBufferCapacity = value; }
+	static unsigned int getRingBufferCapacity() { return ringBufferCapacity; }
+
     virtual void execute();
-    void addLogEntry(SystemFlags::DebugType type, string logEntry);
+    void addLogEntry(SystemFlags::DebugType type, const char *logEntry);
     std::size_t getLogEntryBufferCount();
+    std::size_t getLogEntryDroppedCount();
+    std::size_t getLogEntryWrittenCount() { return (unsigned int)SDL_AtomicGet(&writtenCount); }
     virtual bool canShutdown(bool deleteSelfIfShutdownDelayed=false);
 };
 
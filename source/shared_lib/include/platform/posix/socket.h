@@ -187,6 +187,7 @@ public:
 
 	int getDataToRead(bool wantImmediateReply=false);
 	int send(const void *data, int dataSize);
+	int sendWithoutWait(const void *data, int dataSize);
 	int receive(void *data, int dataSize, bool tryReceiveUntilDataSizeMet);
 	int peek(void *data, int dataSize, bool mustGetData=true,int *pLastSocketError=NULL);
 
@@ -51,6 +51,8 @@ const char  *GAME_ARGS[] = {
 	"--validate-factions",
 	"--validate-scenario",
 	"--validate-tileset",
+	"--validation-report",
+	"--validation-jobs",
 
 	"--translate-techtrees",
 
@@ -135,6 +137,8 @@ enum GAME_ARG_TYPE {
 	GAME_ARG_VALIDATE_FACTIONS,
 	GAME_ARG_VALIDATE_SCENARIO,
 	GAME_ARG_VALIDATE_TILESET,
+	GAME_ARG_VALIDATION_REPORT,
+	GAME_ARG_VALIDATION_JOBS,
 
 	GAME_ARG_TRANSLATE_TECHTREES,
 
@@ -326,6 +330,23 @@ void printParameterHelp(const char *argv0, bool foundInvalidArgs) {
 	printf("\n\n                     \t    are not used.");
 	printf("\n\n                     \texample: %s %s=desert2",extractFileFromDirectoryPath(argv0).c_str(),GAME_ARGS[GAME_ARG_VALIDATE_TILESET]);
 
+	printf("\n\n%s=x  ",GAME_ARGS[GAME_ARG_VALIDATION_REPORT]);
+	printf("\n\n                     \tWrites the results of %s, %s, %s",GAME_ARGS[GAME_ARG_VALIDATE_TECHTREES],GAME_ARGS[GAME_ARG_VALIDATE_FACTIONS],GAME_ARGS[GAME_ARG_VALIDATE_SCENARIO]);
+	printf("\n\n                     \t    or %s as JSON, including the time taken by",GAME_ARGS[GAME_ARG_SHOW_TECHTREE_CRC]);
+	printf("\n\n                     \t    each validation phase. Entries are sorted so reports of");
+	printf("\n\n                     \t    the same data can be compared with diff.");
+	printf("\n\n                     \tWhere x is the path of the report file to write.");
+	printf("\n\n                     \texample: %s %s %s=megapack.json",extractFileFromDirectoryPath(argv0).c_str(),GAME_ARGS[GAME_ARG_VALIDATE_TECHTREES],GAME_ARGS[GAME_ARG_VALIDATION_REPORT]);
+
+	printf("\n\n%s=x  ",GAME_ARGS[GAME_ARG_VALIDATION_JOBS]);
+	printf("\n\n                     \tThe number of factions %s, %s and %s",GAME_ARGS[GAME_ARG_VALIDATE_TECHTREES],GAME_ARGS[GAME_ARG_VALIDATE_FACTIONS],GAME_ARGS[GAME_ARG_VALIDATE_SCENARIO]);
+	printf("\n\n                     \t    load and validate at the same time, each in its own");
+	printf("\n\n                     \t    process after the techtree data is loaded once. The");
+	printf("\n\n                     \t    default is the number of processors, 1 loads them one");
+	printf("\n\n                     \t    after another. Windows always uses 1.");
+	printf("\n\n                     \tWhere x is the number of jobs.");
+	printf("\n\n                     \texample: %s %s %s=1",extractFileFromDirectoryPath(argv0).c_str(),GAME_ARGS[GAME_ARG_VALIDATE_TECHTREES],GAME_ARGS[GAME_ARG_VALIDATION_JOBS]);
+
 	printf("\n\n%s=x  ",GAME_ARGS[GAME_ARG_TRANSLATE_TECHTREES]);
 	printf("\n\n                     \tProduces a default lng file for the specified techtree to");
 	printf("\n\n                     \t    prepare for translation into other languages.");
@@ -372,7 +393,8 @@ void printParameterHelp(const char *argv0, bool foundInvalidArgs) {
 
 	printf("\n\n%s=x=textureformat=keepsmallest  ",GAME_ARGS[GAME_ARG_CONVERT_MODELS]);
 	printf("\n\n                     \tConvert a model file or folder to the current g3d version");
-	printf("\n\n                     \t    format.");
+	printf("\n\n                     \t    format. Duplicate vertices and degenerate triangles are");
+	printf("\n\n                     \t    removed and triangles reordered for the vertex cache.");
 	printf("\n\n                     \tWhere x is a filename or folder containing the g3d model(s).");
 	printf("\n\n                     \tWhere 'textureformat' is an optional supported texture");
 	printf("\n\n                     \t    format to convert to (tga,bmp,jpg,png).");
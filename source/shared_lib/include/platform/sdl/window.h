@@ -134,6 +134,7 @@ protected:
 public:
 	static SDL_Window *getSDLWindow();
 	static bool handleEvent();
+	static void pumpEvents();
 	static void revertMousePos();
 	static Vec2i getOldMousePos();
 	static bool isKeyDown() { return isKeyPressedDown; }
@@ -80,15 +80,17 @@ public:
 //	class StaticSound
 // =====================================================
 
+class SoundSample;
+
 class StaticSound: public Sound{
 private:
-	int8 * samples;
+	SoundSample *sample;
 
 public:
 	StaticSound();
 	virtual ~StaticSound();
 
-	int8 *getSamples() const		{return samples;}
+	int8 *getSamples() const;
 	
 	void load(const string &path);
 	void close();
@@ -0,0 +1,132 @@
+// ==============================================================
+//	This file is part of Glest Shared Library (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martiño Figueroa
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_SOUND_SOUNDSAMPLECACHE_H_
+#define _SHARED_SOUND_SOUNDSAMPLECACHE_H_
+
+#include <map>
+#include <deque>
+#include <string>
+#include "sound.h"
+#include "base_thread.h"
+#include "leak_dumper.h"
+
+using std::map;
+using std::deque;
+using std::string;
+using Shared::PlatformCommon::BaseThread;
+
+namespace Shared{ namespace Sound{
+
+// =====================================================
+//	class SoundSample
+// =====================================================
+
+//decoded data of one sound file, shared by every StaticSound loading it
+class SoundSample {
+private:
+	friend class SoundSampleCache;
+
+	string path;
+	SoundInfo info;
+	int8 *samples;
+	bool decodeQueued;
+	bool decodeFailed;
+	int referenceCount;
+	int64 lastUsedMillis;
+
+public:
+	SoundSample(const string &path);
+	~SoundSample();
+
+	const string &getPath() const	{return path;}
+	const SoundInfo *getInfo() const	{return &info;}
+};
+
+// =====================================================
+//	class SoundSampleDecodeThread
+// =====================================================
+
+class SoundSampleCache;
+
+class SoundSampleDecodeThread : public BaseThread {
+protected:
+	SoundSampleCache *cache;
+
+	virtual void setQuitStatus(bool value);
+
+public:
+	SoundSampleDecodeThread(SoundSampleCache *cache);
+	virtual void execute();
+};
+
+// =====================================================
+//	class SoundSampleCache
+// =====================================================
+
+//loads each sound file once no matter how many StaticSounds use it. In lazy
+//mode only the header is read at load time and the first play queues the
+//decode on a background thread (that play is skipped), a sample that fails to
+//decode stays silent instead of being queued again. With a memory budget
+//the least recently played samples are dropped and decoded again on demand.
+class SoundSampleCache {
+private:
+	static bool instanceValid;
+
+	Mutex *mutex;
+	Trigger *decodeQueuedTrigger;
+	map<string,SoundSample *> samplesByPath;
+	deque<SoundSample *> decodeQueue;
+	SoundSampleDecodeThread *decodeThread;
+
+	bool lazyDecode;
+	int64 memoryBudget;
+	int64 decodedBytes;
+
+	int shareCount;
+	int decodeCount;
+	int64 decodeMillis;
+	int evictionCount;
+	int failedCount;
+
+	SoundSampleCache();
+
+	static int8 *decodeFile(const string &path, SoundInfo *info);
+	static void readInfo(const string &path, SoundInfo *info);
+
+	void storeDecoded(SoundSample *sample, int8 *samples, int64 millis);
+	void evictLeastRecentlyUsed(SoundSample *keep);
+	void deleteSample(SoundSample *sample);
+	void markDecodeFailed(SoundSample *sample, const string &error);
+
+	friend class SoundSampleDecodeThread;
+	bool decodeNextQueued(BaseThread *worker);
+	void wakeDecodeThread();
+
+public:
+	~SoundSampleCache();
+	static SoundSampleCache *getInstance();
+
+	void setLazyDecode(bool value)			{lazyDecode= value;}
+	bool getLazyDecode() const				{return lazyDecode;}
+	void setMemoryBudget(int64 bytes)		{memoryBudget= bytes;}
+
+	SoundSample *acquire(const string &path);
+	static void release(SoundSample *sample);
+	int8 *getSamples(SoundSample *sample);
+
+	void stopDecodeThread();
+	string getStats();
+};
+
+}}//end namespace
+
+#endif
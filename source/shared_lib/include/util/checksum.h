@@ -23,6 +23,8 @@ using namespace Shared::Platform;
 
 namespace Shared{ namespace Util{
 
+class ChecksumFileHashJobs;
+
 // =====================================================
 //	class Checksum
 // =====================================================
@@ -37,9 +39,14 @@ private:
 
 	static Mutex fileListCacheSynchAccessor;
 	static std::map<string,uint32> fileListCache;
+	static int fileHashThreadCount;
 
 	void addSum(uint32 value);
 	bool addFileToSum(const string &path);
+	void addUncachedFilesToCache();
+
+	friend class ChecksumFileHashJobs;
+	static uint32 getFileSum(const string &path);
 
 public:
 	Checksum();
@@ -59,6 +66,9 @@ public:
 
 	static void removeFileFromCache(const string file);
 	static void clearFileCache();
+
+	static void setFileHashThreadCount(int value)	{fileHashThreadCount= value;}
+	static int getFileHashThreadCount()			{return fileHashThreadCount;}
 };
 
 }}//end namespace
@@ -43,6 +43,9 @@ bool IsNumeric(const char *p, bool  allowNegative=true);
 
 string formatNumber(uint64 f);
 
+string base64Encode(const string &data);
+bool base64Decode(const string &text, string &data);
+
 double getTimeDuationMinutes(int frames, int updateFps);
 string getTimeDuationString(int frames, int updateFps);
 
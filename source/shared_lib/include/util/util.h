@@ -33,7 +33,9 @@ namespace Shared { namespace Util {
 enum GlobalStaticFlagTypes {
     gsft_none               = 0x00,
     gsft_lan_mode  			= 0x01,
-    //gsft_xx  = 0x02
+    // a worker process sharing the window of its parent, it must not
+    // render or read window events
+    gsft_no_window			= 0x02,
     //gsft__xx                  = 0x04,
     //gsft__xx                  = 0x08,
     //gsft__xx                  = 0x10,
@@ -187,10 +189,12 @@ public:
 
     static bool getThreadedLoggerRunning();
     static std::size_t getLogEntryBufferCount();
+    static std::size_t getLogEntryDroppedCount();
 
 	// Let the macro call into this when require.. NEVER call it automatically.
 	static void handleDebug(DebugType type, const char *fmt, ...);
-	static void logDebugEntry(DebugType type, string debugEntry, time_t debugTime);
+	static void logDebugEntry(DebugType type, const string &debugEntry, time_t debugTime, unsigned long threadId=0, bool flushStream=true);
+	static void flushDebugLogs();
 
 // If logging is enabled then define the logging method
 #ifndef UNDEF_DEBUG
@@ -156,22 +156,73 @@ public:
 	XmlNode *getRootNode() const	{return rootNode;}
 };
 
+// =====================================================
+//	class XmlDocumentData
+// =====================================================
+
+//shared by all nodes of one tree: element names are interned to ids so
+//child lookups compare ints, and the tag replacement values are kept once
+//per tree and applied to a value the first time it is read
+class XmlDocumentData {
+private:
+	std::map<string,int> nameIds;
+	vector<const string *> names;
+	std::map<string,string> tagValues;
+
+private:
+	XmlDocumentData(XmlDocumentData&);
+	void operator =(XmlDocumentData&);
+
+public:
+	XmlDocumentData();
+	XmlDocumentData(const std::map<string,string> &tagValues);
+
+	int internName(const string &name);
+	int findNameId(const string &name) const;
+	const string &getName(int nameId) const						{return *names[nameId];}
+	const std::map<string,string> *getTagValues() const		{return &tagValues;}
+};
+
 // =====================================================
 //	class XmlNode
 // =====================================================
 
 class XmlNode {
 private:
-	string name;
-	string text;
+	//nodes with more children than this get a lookup index by name
+	static const unsigned int childIndexThreshold = 16;
+
+	XmlDocumentData *document;
+	bool ownsDocument;
+	int nameId;
+	mutable string text;
+	mutable bool textTagsPending;
+	bool skipUpdatePathClimbingParts;
 	vector<XmlNode*> children;
+	vector<int> childNameIds;
 	vector<XmlAttribute*> attributes;
+	mutable std::map<int, vector<XmlNode*> > *childIndex;
 	mutable const XmlNode* superNode;
 
 private:
 	XmlNode(XmlNode&);
 	void operator =(XmlNode&);
 
+#if defined(WANT_XERCES)
+
+	XmlNode(XERCES_CPP_NAMESPACE::DOMNode *node, XmlDocumentData *document);
+	void loadDOMNode(XERCES_CPP_NAMESPACE::DOMNode *node);
+
+#endif
+
+	XmlNode(xml_node<> *node, XmlDocumentData *document, bool skipUpdatePathClimbingParts);
+	XmlNode(const string &name, XmlDocumentData *document);
+	void init(XmlDocumentData *document, bool ownsDocument);
+	void loadRapidNode(xml_node<> *node);
+	void addChildNode(XmlNode *node);
+	void clearChildIndex();
+	XmlNode *findChild(int childNameId, unsigned int childIndex) const;
+
 	string getTreeString() const;
 	bool hasChildNoSuper(const string& childName) const;
 
@@ -190,10 +241,10 @@ public:
 	
 	void setSuper(const XmlNode* superNode) const { this->superNode = superNode; }
 
-	const string &getName() const	{return name;}
+	const string &getName() const	{return document->getName(nameId);}
 	size_t getChildCount() const		{return children.size();}
 	size_t getAttributeCount() const	{return attributes.size();}
-	const string &getText() const	{return text;}
+	const string &getText() const;
 
 	XmlAttribute *getAttribute(unsigned int i) const;
 	XmlAttribute *getAttribute(const string &name,bool mustExist=true) const;
@@ -220,16 +271,21 @@ public:
 
 class XmlAttribute {
 private:
-	string value;
+	mutable string value;
 	string name;
-	bool skipRestrictionCheck;
+	mutable bool skipRestrictionCheck;
 	bool usesCommondata;
-	std::map<string,string> mapTagReplacementValues;
+	//set until the tags have been applied to value
+	mutable const std::map<string,string> *pendingTagValues;
 
 private:
 	XmlAttribute(XmlAttribute&);
 	void operator =(XmlAttribute&);
 
+	friend class XmlNode;
+	XmlAttribute(xml_attribute<> *attribute, const std::map<string,string> *tagValues);
+	void applyTags() const;
+
 public:
 
 #if defined(WANT_XERCES)
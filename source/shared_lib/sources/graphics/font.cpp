@@ -102,6 +102,10 @@ FontMetrics::FontMetrics(Text *textHandler) {
 	//SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] this->textHandler = [%p] Owner = [%p]\n", __FILE__, __FUNCTION__, __LINE__, this->textHandler,this);
 	this->widths		= new float[Font::charCount];
 	this->height		= 0;
+	this->cachedLineHeight		= 0;
+	this->cachedLineHeightValid	= false;
+	this->textLayoutHits		= 0;
+	this->textLayoutMisses		= 0;
 
 	for(int i=0; i < Font::charCount; ++i) {
 		widths[i]= 0;
@@ -115,6 +119,7 @@ FontMetrics::~FontMetrics() {
 
 void FontMetrics::setTextHandler(Text *textHandler) {
 	this->textHandler = textHandler;
+	clearTextLayoutCache();
 	//SystemFlags::OutputDebug(SystemFlags::debugError, "In [%s::%s Line: %d] this->textHandler = [%p] Owner = [%p]\n", __FILE__, __FUNCTION__, __LINE__, this->textHandler, this);
 }
 
@@ -122,7 +127,22 @@ Text * FontMetrics::getTextHandler() {
 	return this->textHandler;
 }
 
+void FontMetrics::clearTextLayoutCache() {
+	textLayouts.clear();
+	textLayoutUseOrder.clear();
+	cachedLineHeightValid = false;
+}
+
 float FontMetrics::getTextWidth(const string &str) {
+	if(textHandler != NULL) {
+		std::map<string,FontMetricsTextLayout>::iterator iterFind = textLayouts.find(str);
+		if(iterFind != textLayouts.end()) {
+			textLayoutUseOrder.splice(textLayoutUseOrder.begin(), textLayoutUseOrder, iterFind->second.lruPosition);
+			textLayoutHits++;
+			return iterFind->second.advance * Font::scaleFontValue;
+		}
+	}
+
 	string longestLine = "";
 	size_t found = str.find("\n");
 	if (found == string::npos) {
@@ -142,7 +162,19 @@ float FontMetrics::getTextWidth(const string &str) {
     }
 
 	if(textHandler != NULL) {
-		return (textHandler->Advance(longestLine.c_str()) * Font::scaleFontValue);
+		float advance = textHandler->Advance(longestLine.c_str());
+		textLayoutMisses++;
+
+		if(textLayouts.size() >= maxCachedTextLayouts) {
+			textLayouts.erase(textLayoutUseOrder.back());
+			textLayoutUseOrder.pop_back();
+		}
+		textLayoutUseOrder.push_front(str);
+		FontMetricsTextLayout &layout = textLayouts[str];
+		layout.advance = advance;
+		layout.lruPosition = textLayoutUseOrder.begin();
+
+		return (advance * Font::scaleFontValue);
 	}
 	else {
 		float width= 0.f;
@@ -163,9 +195,14 @@ float FontMetrics::getTextWidth(const string &str) {
 	}
 }
 
+//the FTGL line height only depends on the font and size, not on str
 float FontMetrics::getHeight(const string &str) const {
 	if(textHandler != NULL) {
-		return (textHandler->LineHeight(str.c_str()));
+		if(cachedLineHeightValid == false) {
+			cachedLineHeight = textHandler->LineHeight(str.c_str());
+			cachedLineHeightValid = true;
+		}
+		return cachedLineHeight;
 	}
 	else {
 		return height;
@@ -297,6 +334,7 @@ int Font::getSize() const	{
 }
 void Font::setSize(int size)	{
 	if(textHandler) {
+		metrics.clearTextLayoutCache();
 		return textHandler->SetFaceSize(size);
 	}
 	else {
@@ -760,6 +760,9 @@ Texture2DGl::~Texture2DGl() {
 }
 
 void Texture2DGl::init(Filter filter, int maxAnisotropy) {
+	if(loadError != "") {
+		throw megaglest_runtime_error("Error loading texture [" + getPath() + "] " + loadError);
+	}
 	assertGl();
 
 	if(inited == false) {
@@ -43,6 +43,11 @@ InterpolationData::InterpolationData(const Mesh *mesh) {
 	raw_frame_ofs = 0;
 	
 	this->mesh= mesh;
+
+	if(mesh->getQuantizedVertices() != NULL) {
+		updateQuantizedVertices(0.f, false);
+		updateQuantizedNormals(0.f, false);
+	}
 }
 
 InterpolationData::~InterpolationData(){
@@ -58,14 +63,25 @@ void InterpolationData::update(float t, bool cycle){
 }
 
 void InterpolationData::updateVertices(float t, bool cycle) {
-	update(mesh->getVertices(), vertices, t, cycle);
+	if(mesh->getQuantizedVertices() != NULL) {
+		updateQuantizedVertices(t, cycle);
+	}
+	else {
+		update(mesh->getVertices(), vertices, t, cycle);
+	}
 }
 
 void InterpolationData::updateNormals(float t, bool cycle) {
-	update(mesh->getNormals(), normals, t, cycle);
+	if(mesh->getQuantizedNormals() != NULL) {
+		updateQuantizedNormals(t, cycle);
+	}
+	else {
+		update(mesh->getNormals(), normals, t, cycle);
+	}
 }
 
-void InterpolationData::update(const Vec3f* src, Vec3f* &dest, float t, bool cycle) {
+//returns false for meshes with a single frame, which are never interpolated
+bool InterpolationData::getFrames(float t, bool cycle, uint32 &prevFrame, uint32 &nextFrame, float &localT) const {
 
 	if(t <0.0f || t>1.0f) {
 		printf("ERROR t = [%f] for cycle [%d] f [%d] v [%d]\n",t,cycle,mesh->getFrameCount(),mesh->getVertexCount());
@@ -78,33 +94,39 @@ void InterpolationData::update(const Vec3f* src, Vec3f* &dest, float t, bool cyc
 	}
 
 	uint32 frameCount= mesh->getFrameCount();
-	uint32 vertexCount= mesh->getVertexCount();
+	if(frameCount <= 1) {
+		return false;
+	}
 
-	if(frameCount > 1) {
-		//misc vars
-		uint32 prevFrame;
-		uint32 nextFrame;
-		float localT;
+	if(cycle == true) {
+		prevFrame= min<uint32>(static_cast<uint32>(t*frameCount), frameCount-1);
+		nextFrame= (prevFrame+1) % frameCount;
+		localT= t*frameCount - prevFrame;
+	}
+	else {
+		prevFrame= min<uint32> (static_cast<uint32> (t * (frameCount-1)), frameCount - 2);
+		nextFrame= min(prevFrame + 1, frameCount - 1);
+		localT= t * (frameCount-1) - prevFrame;
+		//printf(" prevFrame=%d nextFrame=%d localT=%f\n",prevFrame,nextFrame,localT);
+	}
 
-		if(cycle == true) {
-			prevFrame= min<uint32>(static_cast<uint32>(t*frameCount), frameCount-1);
-			nextFrame= (prevFrame+1) % frameCount;
-			localT= t*frameCount - prevFrame;
-		}
-		else {
-			prevFrame= min<uint32> (static_cast<uint32> (t * (frameCount-1)), frameCount - 2);
-			nextFrame= min(prevFrame + 1, frameCount - 1);
-			localT= t * (frameCount-1) - prevFrame;
-			//printf(" prevFrame=%d nextFrame=%d localT=%f\n",prevFrame,nextFrame,localT);
-		}
+	//assertions
+	assert(prevFrame<frameCount);
+	assert(nextFrame<frameCount);
+	return true;
+}
+
+void InterpolationData::update(const Vec3f* src, Vec3f* &dest, float t, bool cycle) {
+	//misc vars
+	uint32 prevFrame;
+	uint32 nextFrame;
+	float localT;
 
+	if(getFrames(t, cycle, prevFrame, nextFrame, localT) == true) {
+		uint32 vertexCount= mesh->getVertexCount();
 		uint32 prevFrameBase= prevFrame*vertexCount;
 		uint32 nextFrameBase= nextFrame*vertexCount;
 
-		//assertions
-		assert(prevFrame<frameCount);
-		assert(nextFrame<frameCount);
-		
 		if(enableInterpolation) {
 			if(!dest) { // not previously allocated
 			      dest = new Vec3f[vertexCount];
@@ -118,4 +140,54 @@ void InterpolationData::update(const Vec3f* src, Vec3f* &dest, float t, bool cyc
 	}
 }
 
+//dequantizes and interpolates in one pass, lerping the integer values first
+//so each component costs a single multiply-add to decode. Without
+//interpolation the previous frame is decoded as is.
+void InterpolationData::updateQuantizedVertices(float t, bool cycle) {
+	uint32 prevFrame= 0;
+	uint32 nextFrame= 0;
+	float localT= 0.f;
+	if(getFrames(t, cycle, prevFrame, nextFrame, localT) == false || enableInterpolation == false) {
+		nextFrame= prevFrame;
+		localT= 0.f;
+	}
+
+	uint32 vertexCount= mesh->getVertexCount();
+	if(!vertices) {
+		vertices = new Vec3f[vertexCount];
+	}
+	const uint16 *prevSrc= &mesh->getQuantizedVertices()[prevFrame*vertexCount*3];
+	const uint16 *nextSrc= &mesh->getQuantizedVertices()[nextFrame*vertexCount*3];
+	const Vec3f &offset= mesh->getQuantizeOffset();
+	const Vec3f &scale= mesh->getQuantizeScale();
+	for(uint32 j=0; j<vertexCount; ++j){
+		float x= prevSrc[j*3] + (nextSrc[j*3] - (float)prevSrc[j*3]) * localT;
+		float y= prevSrc[j*3+1] + (nextSrc[j*3+1] - (float)prevSrc[j*3+1]) * localT;
+		float z= prevSrc[j*3+2] + (nextSrc[j*3+2] - (float)prevSrc[j*3+2]) * localT;
+		vertices[j]= Vec3f(offset.x + x * scale.x, offset.y + y * scale.y, offset.z + z * scale.z);
+	}
+}
+
+void InterpolationData::updateQuantizedNormals(float t, bool cycle) {
+	uint32 prevFrame= 0;
+	uint32 nextFrame= 0;
+	float localT= 0.f;
+	if(getFrames(t, cycle, prevFrame, nextFrame, localT) == false || enableInterpolation == false) {
+		nextFrame= prevFrame;
+		localT= 0.f;
+	}
+
+	uint32 vertexCount= mesh->getVertexCount();
+	if(!normals) {
+		normals = new Vec3f[vertexCount];
+	}
+	const int16 *prevSrc= &mesh->getQuantizedNormals()[prevFrame*vertexCount*2];
+	const int16 *nextSrc= &mesh->getQuantizedNormals()[nextFrame*vertexCount*2];
+	for(uint32 j=0; j<vertexCount; ++j){
+		Vec3f prevNormal= Mesh::decodeOctahedral(prevSrc[j*2], prevSrc[j*2+1]);
+		Vec3f nextNormal= Mesh::decodeOctahedral(nextSrc[j*2], nextSrc[j*2+1]);
+		normals[j]= prevNormal.lerp(localT, nextNormal);
+	}
+}
+
 }}//end namespace 
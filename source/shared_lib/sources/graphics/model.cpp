@@ -16,6 +16,7 @@
 #include <stdexcept>
 
 #include "interpolation.h"
+#include "math_util.h"
 #include "conversion.h"
 #include "util.h"
 #include "platform_common.h"
@@ -24,6 +25,9 @@
 //#include <memory>
 #include <map>
 #include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include "leak_dumper.h"
 
 using namespace Shared::Platform;
@@ -199,6 +203,8 @@ void fromEndianMeshHeaderV2(MeshHeaderV2 &header) {
 //	class Mesh
 // =====================================================
 
+bool Mesh::quantizeKeyframes = false;
+
 // ==================== constructor & destructor ====================
 
 Mesh::Mesh() {
@@ -217,6 +223,11 @@ Mesh::Mesh() {
 	indices= NULL;
 	interpolationData= NULL;
 
+	quantizedVertices= NULL;
+	quantizedNormals= NULL;
+	quantizeOffset= Vec3f(0.f);
+	quantizeScale= Vec3f(0.f);
+
 	for(int i=0; i<meshTextureCount; ++i){
 		textures[i]= NULL;
 		texturesOwned[i]=false;
@@ -289,6 +300,10 @@ void Mesh::end() {
 	tangents=NULL;
 	delete [] indices;
 	indices=NULL;
+	delete [] quantizedVertices;
+	quantizedVertices=NULL;
+	delete [] quantizedNormals;
+	quantizedNormals=NULL;
 
 	cleanupInterpolationData();
 
@@ -495,6 +510,11 @@ void Mesh::loadV2(int meshIndex, const string &dir, FILE *f, TextureManager *tex
 				SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error v2 model is missing texture [%s] meshIndex = %d modelFile [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,texPath.c_str(),meshIndex,modelFile.c_str());
 			}
 		}
+		else {
+			//shared with another mesh, take a reference so either can end it
+			textureManager->addTextureReference(textures[mtDiffuse]);
+			texturesOwned[mtDiffuse]=true;
+		}
 	}
 
 	//read data
@@ -639,6 +659,10 @@ void Mesh::loadV3(int meshIndex, const string &dir, FILE *f,
 				SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error v3 model is missing texture [%s] meshHeader.properties = %d meshIndex = %d modelFile [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,texPath.c_str(),meshHeader.properties,meshIndex,modelFile.c_str());
 			}
 		}
+		else {
+			textureManager->addTextureReference(textures[mtDiffuse]);
+			texturesOwned[mtDiffuse]=true;
+		}
 	}
 
 	//read data
@@ -710,7 +734,11 @@ Texture2D* Mesh::loadMeshTexture(int meshIndex, int textureIndex,
 	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s] #1 load texture [%s] modelFile [%s]\n",__FUNCTION__,textureFile.c_str(),modelFile.c_str());
 
 	Texture2D* texture = dynamic_cast<Texture2D*>(textureManager->getTexture(textureFile));
-	if(texture == NULL) {
+	if(texture != NULL) {
+		textureManager->addTextureReference(texture);
+		textureOwned = true;
+	}
+	else {
 		if(fileExists(textureFile) == false) {
 			vector<string> conversionList;
 			conversionList.push_back("png");
@@ -730,17 +758,27 @@ Texture2D* Mesh::loadMeshTexture(int meshIndex, int textureIndex,
 			if(textureChannelCount != -1) {
 				texture->getPixmap()->init(textureChannelCount);
 			}
-			texture->load(textureFile);
-			if(loadedFileList) {
-				(*loadedFileList)[textureFile].push_back(make_pair(sourceLoader,sourceLoader));
+			textureOwned = true;
+
+			if(textureManager->getDeferredLoadEnabled() == true) {
+				//decoded on a worker thread, uploaded later on this one
+				textureManager->queueTexture2DLoad(texture,textureFile,deletePixMapAfterLoad);
+				if(loadedFileList) {
+					(*loadedFileList)[textureFile].push_back(make_pair(sourceLoader,sourceLoader));
+				}
 			}
+			else {
+				texture->load(textureFile);
+				if(loadedFileList) {
+					(*loadedFileList)[textureFile].push_back(make_pair(sourceLoader,sourceLoader));
+				}
 
-			//if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s] texture loaded [%s]\n",__FUNCTION__,textureFile.c_str());
+				//if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s] texture loaded [%s]\n",__FUNCTION__,textureFile.c_str());
 
-			textureOwned = true;
-			texture->init(textureManager->getTextureFilter(),textureManager->getMaxAnisotropy());
-			if(deletePixMapAfterLoad == true) {
-				texture->deletePixels();
+				texture->init(textureManager->getTextureFilter(),textureManager->getMaxAnisotropy());
+				if(deletePixMapAfterLoad == true) {
+					texture->deletePixels();
+				}
 			}
 
 			//if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s] texture inited [%s]\n",__FUNCTION__,textureFile.c_str());
@@ -879,6 +917,11 @@ void Mesh::load(int meshIndex, const string &dir, FILE *f, TextureManager *textu
 void Mesh::save(int meshIndex, const string &dir, FILE *f, TextureManager *textureManager,
 		string convertTextureToFormat, std::map<string,int> &textureDeleteList,
 		bool keepsmallest,string modelFile) {
+	//the float keyframes are gone, writing the decoded ones would be lossy
+	if(quantizedVertices != NULL) {
+		throw megaglest_runtime_error("Mesh [" + name + "] has quantized keyframes and can not be saved, load it with QuantizeModelKeyframes disabled");
+	}
+
 	MeshHeader meshHeader;
 	memset(&meshHeader, 0, sizeof(struct MeshHeader));
 
@@ -1076,6 +1119,107 @@ void Mesh::computeTangents(){
 	}
 }
 
+// ==================== quantized keyframes ====================
+
+//maps a normal onto the octahedron and unfolds it into [-1,1]^2, 16 bits per axis
+void Mesh::encodeOctahedral(const Vec3f &normal, int16 &x, int16 &y) {
+	float length = fabs(normal.x) + fabs(normal.y) + fabs(normal.z);
+	if(length <= 0.f) {
+		x = 0;
+		y = 0;
+		return;
+	}
+	float u = normal.x / length;
+	float v = normal.y / length;
+	if(normal.z < 0.f) {
+		float foldedU = (1.f - fabs(v)) * (u >= 0.f ? 1.f : -1.f);
+		v = (1.f - fabs(u)) * (v >= 0.f ? 1.f : -1.f);
+		u = foldedU;
+	}
+	x = (int16)floor(max(-1.f, min(1.f, u)) * 32767.f + 0.5f);
+	y = (int16)floor(max(-1.f, min(1.f, v)) * 32767.f + 0.5f);
+}
+
+//the result is not unit length, the model renderer enables GL_NORMALIZE
+Vec3f Mesh::decodeOctahedral(int16 x, int16 y) {
+	float u = x / 32767.f;
+	float v = y / 32767.f;
+	float w = 1.f - fabs(u) - fabs(v);
+	if(w < 0.f) {
+		float unfoldedU = (1.f - fabs(v)) * (u >= 0.f ? 1.f : -1.f);
+		v = (1.f - fabs(u)) * (v >= 0.f ? 1.f : -1.f);
+		u = unfoldedU;
+	}
+	//unit length like the float normals, so both interpolate the same way
+	Vec3f normal(u, v, w);
+	normal.normalize();
+	return normal;
+}
+
+//replaces the float keyframes of an animated mesh with 16 bit positions
+//relative to the mesh bounding box and octahedral normals, which
+//InterpolationData decodes while it interpolates
+void Mesh::quantizeFrames() {
+	if(frameCount <= 1 || vertexCount == 0 || quantizedVertices != NULL ||
+		vertices == NULL || normals == NULL) {
+		return;
+	}
+
+	uint32 count = frameCount * vertexCount;
+	Vec3f minPosition = vertices[0];
+	Vec3f maxPosition = vertices[0];
+	for(uint32 i = 1; i < count; ++i) {
+		for(int axis = 0; axis < 3; ++axis) {
+			minPosition.ptr()[axis] = min(minPosition.ptr()[axis], vertices[i].ptr()[axis]);
+			maxPosition.ptr()[axis] = max(maxPosition.ptr()[axis], vertices[i].ptr()[axis]);
+		}
+	}
+	quantizeOffset = minPosition;
+	for(int axis = 0; axis < 3; ++axis) {
+		quantizeScale.ptr()[axis] = (maxPosition.ptr()[axis] - minPosition.ptr()[axis]) / 65535.f;
+	}
+
+	quantizedVertices = new uint16[count * 3];
+	quantizedNormals = new int16[count * 2];
+	float maxPositionError = 0.f;
+	float minNormalCos = 1.f;
+	for(uint32 i = 0; i < count; ++i) {
+		for(int axis = 0; axis < 3; ++axis) {
+			float scale = quantizeScale.ptr()[axis];
+			float value = vertices[i].ptr()[axis];
+			uint16 quantized = 0;
+			if(scale > 0.f) {
+				quantized = (uint16)max(0.f, min(65535.f, floor((value - quantizeOffset.ptr()[axis]) / scale + 0.5f)));
+			}
+			quantizedVertices[i * 3 + axis] = quantized;
+			maxPositionError = max(maxPositionError, fabs(quantizeOffset.ptr()[axis] + quantized * scale - value));
+		}
+
+		encodeOctahedral(normals[i], quantizedNormals[i * 2], quantizedNormals[i * 2 + 1]);
+		Vec3f original = normals[i];
+		if(original.length() > 0.f) {
+			Vec3f decoded = decodeOctahedral(quantizedNormals[i * 2], quantizedNormals[i * 2 + 1]);
+			original.normalize();
+			decoded.normalize();
+			minNormalCos = min(minNormalCos, original.dot(decoded));
+		}
+	}
+
+	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Quantized mesh [%s] frames: %u vertices: %u bytes: %u -> %u max position error: %f max normal error: %f degrees\n",
+			name.c_str(),frameCount,vertexCount,(uint32)(count * sizeof(Vec3f) * 2),(uint32)(count * sizeof(uint16) * 5),
+			maxPositionError,radToDeg(acos(min(1.f, minNormalCos))));
+
+	delete [] vertices;
+	vertices = NULL;
+	delete [] normals;
+	normals = NULL;
+
+	if(interpolationData != NULL) {
+		cleanupInterpolationData();
+		buildInterpolationData();
+	}
+}
+
 void Mesh::deletePixels() {
 	for(int i = 0; i < meshTextureCount; ++i) {
 		if(textures[i] != NULL) {
@@ -1333,6 +1477,12 @@ void Model::loadG3d(const string &path, bool deletePixMapAfterLoad,
 		fclose(f);
 
 		autoJoinMeshFrames();
+
+		if(Mesh::getQuantizeKeyframes() == true) {
+			for(uint32 i = 0; i < meshCount; ++i) {
+				meshes[i].quantizeFrames();
+			}
+		}
     }
     catch(megaglest_runtime_error& ex) {
     	//printf("1111111 ex.wantStackTrace() = %d\n",ex.wantStackTrace());
@@ -1503,6 +1653,26 @@ void Mesh::copyInto(Mesh *dest, bool ignoreInterpolationData,
 		memcpy(&dest->normals[0],&this->normals[0],this->frameCount * this->vertexCount * sizeof(Vec3f));
 	}
 
+	if(dest->quantizedVertices != NULL) {
+		delete [] dest->quantizedVertices;
+		dest->quantizedVertices = NULL;
+	}
+	if(this->quantizedVertices != NULL) {
+		dest->quantizedVertices = new uint16[this->frameCount * this->vertexCount * 3];
+		memcpy(&dest->quantizedVertices[0],&this->quantizedVertices[0],this->frameCount * this->vertexCount * 3 * sizeof(uint16));
+	}
+
+	if(dest->quantizedNormals != NULL) {
+		delete [] dest->quantizedNormals;
+		dest->quantizedNormals = NULL;
+	}
+	if(this->quantizedNormals != NULL) {
+		dest->quantizedNormals = new int16[this->frameCount * this->vertexCount * 2];
+		memcpy(&dest->quantizedNormals[0],&this->quantizedNormals[0],this->frameCount * this->vertexCount * 2 * sizeof(int16));
+	}
+	dest->quantizeOffset = this->quantizeOffset;
+	dest->quantizeScale = this->quantizeScale;
+
 	if(dest->texCoords != NULL) {
 		delete [] dest->texCoords;
 		dest->texCoords = NULL;
@@ -1754,6 +1924,309 @@ void Model::autoJoinMeshFrames() {
 	}
 }
 
+// ==================== optimize ====================
+
+//orders vertices by their data in every frame so exact duplicates compare equal
+class MeshVertexLess {
+protected:
+	const Mesh *mesh;
+	bool compareTexCoords;
+
+public:
+	MeshVertexLess(const Mesh *mesh, bool compareTexCoords) {
+		this->mesh = mesh;
+		this->compareTexCoords = compareTexCoords;
+	}
+	bool operator()(uint32 a, uint32 b) const {
+		uint32 vertexCount = mesh->getVertexCount();
+		for(uint32 frame = 0; frame < mesh->getFrameCount(); ++frame) {
+			uint32 frameBase = frame * vertexCount;
+			int result = memcmp(&mesh->getVertices()[frameBase + a], &mesh->getVertices()[frameBase + b], sizeof(Vec3f));
+			if(result == 0) {
+				result = memcmp(&mesh->getNormals()[frameBase + a], &mesh->getNormals()[frameBase + b], sizeof(Vec3f));
+			}
+			if(result != 0) {
+				return result < 0;
+			}
+		}
+		if(compareTexCoords == true) {
+			return memcmp(&mesh->getTexCoords()[a], &mesh->getTexCoords()[b], sizeof(Vec2f)) < 0;
+		}
+		return false;
+	}
+};
+
+static const int optimizeVertexCacheSize = 32;
+
+//vertex score of the linear speed vertex cache optimizer (Forsyth)
+static float getVertexCacheScore(int cachePosition, int remainingTriangles) {
+	if(remainingTriangles <= 0) {
+		return -1.f;
+	}
+	float score = 0.f;
+	if(cachePosition >= 0) {
+		if(cachePosition < 3) {
+			//the last triangle's vertices get a fixed score so strips don't win
+			score = 0.75f;
+		}
+		else {
+			score = pow(1.f - (cachePosition - 3) / (float)(optimizeVertexCacheSize - 3), 1.5f);
+		}
+	}
+	//favour vertices with few triangles left so they can leave the cache
+	score += 2.f * pow((float)remainingTriangles, -0.5f);
+	return score;
+}
+
+//reorders the triangles of an index list for the post transform vertex cache
+static void optimizeVertexCacheOrder(uint32 *indices, uint32 indexCount, uint32 vertexCount) {
+	uint32 triangleCount = indexCount / 3;
+	if(triangleCount <= 1) {
+		return;
+	}
+
+	vector<int> remaining(vertexCount, 0);
+	for(uint32 i = 0; i < indexCount; ++i) {
+		remaining[indices[i]]++;
+	}
+
+	//triangles using each vertex, the not yet emitted ones come first
+	vector<uint32> adjacencyStart(vertexCount + 1, 0);
+	for(uint32 vertex = 0; vertex < vertexCount; ++vertex) {
+		adjacencyStart[vertex + 1] = adjacencyStart[vertex] + remaining[vertex];
+	}
+	vector<uint32> adjacency(indexCount);
+	vector<uint32> adjacencyFill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+	for(uint32 i = 0; i < indexCount; ++i) {
+		adjacency[adjacencyFill[indices[i]]++] = i / 3;
+	}
+
+	vector<int> cachePosition(vertexCount, -1);
+	vector<float> vertexScore(vertexCount);
+	for(uint32 vertex = 0; vertex < vertexCount; ++vertex) {
+		vertexScore[vertex] = getVertexCacheScore(-1, remaining[vertex]);
+	}
+	vector<float> triangleScore(triangleCount);
+	vector<bool> emitted(triangleCount, false);
+	for(uint32 triangle = 0; triangle < triangleCount; ++triangle) {
+		triangleScore[triangle] = vertexScore[indices[triangle * 3]] +
+			vertexScore[indices[triangle * 3 + 1]] + vertexScore[indices[triangle * 3 + 2]];
+	}
+
+	vector<uint32> result;
+	result.reserve(indexCount);
+	vector<uint32> cache;
+	vector<uint32> newCache;
+	uint32 scanStart = 0;
+	int bestTriangle = -1;
+
+	for(uint32 emittedCount = 0; emittedCount < triangleCount; ++emittedCount) {
+		if(bestTriangle < 0) {
+			//nothing adjacent to the cache is left, start over with the best remaining triangle
+			float bestScore = -1.f;
+			for(uint32 triangle = scanStart; triangle < triangleCount; ++triangle) {
+				if(emitted[triangle] == false && triangleScore[triangle] > bestScore) {
+					bestScore = triangleScore[triangle];
+					bestTriangle = triangle;
+				}
+			}
+			for(;scanStart < triangleCount && emitted[scanStart] == true; ++scanStart) {
+			}
+		}
+
+		emitted[bestTriangle] = true;
+		newCache.clear();
+		for(int corner = 0; corner < 3; ++corner) {
+			uint32 vertex = indices[bestTriangle * 3 + corner];
+			result.push_back(vertex);
+			newCache.push_back(vertex);
+
+			uint32 start = adjacencyStart[vertex];
+			uint32 end = start + remaining[vertex];
+			for(uint32 i = start; i < end; ++i) {
+				if(adjacency[i] == (uint32)bestTriangle) {
+					std::swap(adjacency[i], adjacency[end - 1]);
+					break;
+				}
+			}
+			remaining[vertex]--;
+		}
+		for(unsigned int i = 0; i < cache.size(); ++i) {
+			if(cache[i] != newCache[0] && cache[i] != newCache[1] && cache[i] != newCache[2]) {
+				newCache.push_back(cache[i]);
+			}
+		}
+		cache.swap(newCache);
+
+		//vertices pushed out of the cache are rescored too
+		for(unsigned int i = 0; i < cache.size(); ++i) {
+			uint32 vertex = cache[i];
+			cachePosition[vertex] = ((int)i < optimizeVertexCacheSize ? (int)i : -1);
+			vertexScore[vertex] = getVertexCacheScore(cachePosition[vertex], remaining[vertex]);
+		}
+		bestTriangle = -1;
+		float bestScore = -1.f;
+		for(unsigned int i = 0; i < cache.size(); ++i) {
+			uint32 vertex = cache[i];
+			uint32 start = adjacencyStart[vertex];
+			uint32 end = start + remaining[vertex];
+			for(uint32 j = start; j < end; ++j) {
+				uint32 triangle = adjacency[j];
+				triangleScore[triangle] = vertexScore[indices[triangle * 3]] +
+					vertexScore[indices[triangle * 3 + 1]] + vertexScore[indices[triangle * 3 + 2]];
+				if(triangleScore[triangle] > bestScore) {
+					bestScore = triangleScore[triangle];
+					bestTriangle = triangle;
+				}
+			}
+		}
+		if((int)cache.size() > optimizeVertexCacheSize) {
+			cache.resize(optimizeVertexCacheSize);
+		}
+	}
+
+	memcpy(indices, &result[0], indexCount * sizeof(uint32));
+}
+
+uint32 Mesh::getDataSize() const {
+	uint32 size = frameCount * vertexCount * sizeof(Vec3f) * 2 + indexCount * sizeof(uint32);
+	if(textureFlags != 0) {
+		size += vertexCount * sizeof(Vec2f);
+	}
+	return size;
+}
+
+//lossless cleanup for --convert-models: merges identical vertices, drops
+//degenerate triangles, reorders triangles for the vertex cache and vertices
+//by first use, and stores meshes whose frames are all equal as one frame
+void Mesh::optimize() {
+	if(vertexCount == 0 || indexCount < 3 || quantizedVertices != NULL) {
+		return;
+	}
+	for(uint32 i = 0; i < indexCount; ++i) {
+		if(indices[i] >= vertexCount) {
+			if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Mesh [%s] has an index out of range, not optimized\n",name.c_str());
+			return;
+		}
+	}
+	bool hasTexCoords = (textureFlags != 0 && texCoords != NULL);
+
+	//an unanimated mesh saved with several frames only costs interpolation time
+	if(frameCount > 1) {
+		bool framesIdentical = true;
+		for(uint32 frame = 1; frame < frameCount && framesIdentical == true; ++frame) {
+			uint32 frameBase = frame * vertexCount;
+			framesIdentical = (memcmp(&vertices[0], &vertices[frameBase], vertexCount * sizeof(Vec3f)) == 0 &&
+							   memcmp(&normals[0], &normals[frameBase], vertexCount * sizeof(Vec3f)) == 0);
+		}
+		if(framesIdentical == true) {
+			Vec3f *frameVertices = new Vec3f[vertexCount];
+			Vec3f *frameNormals = new Vec3f[vertexCount];
+			memcpy(frameVertices, vertices, vertexCount * sizeof(Vec3f));
+			memcpy(frameNormals, normals, vertexCount * sizeof(Vec3f));
+			setVertices(frameVertices, vertexCount);
+			setNormals(frameNormals, vertexCount);
+			frameCount = 1;
+		}
+	}
+
+	vector<uint32> remap(vertexCount);
+	std::map<uint32,uint32,MeshVertexLess> uniqueVertices(MeshVertexLess(this, hasTexCoords));
+	for(uint32 vertex = 0; vertex < vertexCount; ++vertex) {
+		remap[vertex] = uniqueVertices.insert(std::make_pair(vertex, vertex)).first->second;
+	}
+
+	vector<uint32> newIndices;
+	newIndices.reserve(indexCount);
+	for(uint32 i = 0; i + 2 < indexCount; i += 3) {
+		uint32 a = remap[indices[i]];
+		uint32 b = remap[indices[i + 1]];
+		uint32 c = remap[indices[i + 2]];
+		if(a != b && b != c && a != c) {
+			newIndices.push_back(a);
+			newIndices.push_back(b);
+			newIndices.push_back(c);
+		}
+	}
+	if(newIndices.empty() == true) {
+		return;
+	}
+	uint32 newIndexCount = (uint32)newIndices.size();
+	optimizeVertexCacheOrder(&newIndices[0], newIndexCount, vertexCount);
+
+	//vertices in first use order, unreferenced ones are dropped
+	vector<int> newVertexIndex(vertexCount, -1);
+	vector<uint32> vertexOrder;
+	for(uint32 i = 0; i < newIndexCount; ++i) {
+		if(newVertexIndex[newIndices[i]] < 0) {
+			newVertexIndex[newIndices[i]] = (int)vertexOrder.size();
+			vertexOrder.push_back(newIndices[i]);
+		}
+		newIndices[i] = newVertexIndex[newIndices[i]];
+	}
+	uint32 newVertexCount = (uint32)vertexOrder.size();
+
+	Vec3f *newVertices = new Vec3f[frameCount * newVertexCount];
+	Vec3f *newNormals = new Vec3f[frameCount * newVertexCount];
+	for(uint32 frame = 0; frame < frameCount; ++frame) {
+		for(uint32 vertex = 0; vertex < newVertexCount; ++vertex) {
+			newVertices[frame * newVertexCount + vertex] = vertices[frame * vertexCount + vertexOrder[vertex]];
+			newNormals[frame * newVertexCount + vertex] = normals[frame * vertexCount + vertexOrder[vertex]];
+		}
+	}
+	if(hasTexCoords == true) {
+		Vec2f *newTexCoords = new Vec2f[newVertexCount];
+		for(uint32 vertex = 0; vertex < newVertexCount; ++vertex) {
+			newTexCoords[vertex] = texCoords[vertexOrder[vertex]];
+		}
+		setTexCoords(newTexCoords, newVertexCount);
+	}
+	setVertices(newVertices, newVertexCount);
+	setNormals(newNormals, newVertexCount);
+
+	uint32 *indexData = new uint32[newIndexCount];
+	memcpy(indexData, &newIndices[0], newIndexCount * sizeof(uint32));
+	setIndices(indexData, newIndexCount);
+
+	if(tangents != NULL) {
+		computeTangents();
+	}
+	if(hasBuiltVBOs == true) {
+		ReleaseVBOs();
+	}
+	if(interpolationData != NULL) {
+		cleanupInterpolationData();
+		buildInterpolationData();
+	}
+}
+
+//runs Mesh::optimize on every mesh and returns what it saved
+string Model::optimizeMeshes() {
+	uint32 oldVertexCount = 0;
+	uint32 oldIndexCount = 0;
+	uint32 oldDataSize = 0;
+	uint32 newVertexCount = 0;
+	uint32 newIndexCount = 0;
+	uint32 newDataSize = 0;
+	for(uint32 i = 0; i < meshCount; ++i) {
+		oldVertexCount += meshes[i].getFrameCount() * meshes[i].getVertexCount();
+		oldIndexCount += meshes[i].getIndexCount();
+		oldDataSize += meshes[i].getDataSize();
+
+		meshes[i].optimize();
+
+		newVertexCount += meshes[i].getFrameCount() * meshes[i].getVertexCount();
+		newIndexCount += meshes[i].getIndexCount();
+		newDataSize += meshes[i].getDataSize();
+	}
+
+	char szBuf[8096]="";
+	snprintf(szBuf,8096,"meshes: %u vertices: %u -> %u indices: %u -> %u bytes: %u -> %u (%.1f%% saved)",
+			meshCount,oldVertexCount,newVertexCount,oldIndexCount,newIndexCount,oldDataSize,newDataSize,
+			(oldDataSize > 0 ? (oldDataSize - newDataSize) * 100.f / oldDataSize : 0.f));
+	return szBuf;
+}
+
 // ----------------------------------------------------------------------------
 
 bool PixelBufferWrapper::isPBOEnabled 	= false;
@@ -34,6 +34,8 @@ ModelManager::ModelManager(){
 	}
 
 	textureManager= NULL;
+	lookupCount= 0;
+	lookupHitCount= 0;
 }
 
 ModelManager::~ModelManager(){
@@ -41,8 +43,26 @@ ModelManager::~ModelManager(){
 }
 
 Model *ModelManager::newModel(const string &path,bool deletePixMapAfterLoad,std::map<string,vector<pair<string, string> > > *loadedFileList, string *sourceLoader){
+	lookupCount++;
+	map<string,pair<Model *,bool> >::iterator iterFind= modelIndex.find(path);
+	if(iterFind != modelIndex.end() &&
+		(iterFind->second.second == false || deletePixMapAfterLoad == true)) {
+		lookupHitCount++;
+
+		Model *model= iterFind->second.first;
+		modelReferences[model]++;
+		if(loadedFileList) {
+			string loader= (sourceLoader != NULL ? *sourceLoader : "");
+			(*loadedFileList)[path].push_back(make_pair(loader,loader));
+		}
+		return model;
+	}
+
 	Model *model= GraphicsInterface::getInstance().getFactory()->newModel(path,textureManager,deletePixMapAfterLoad,loadedFileList,sourceLoader);
 	models.push_back(model);
+	if(path != "") {
+		modelIndex[path]= make_pair(model,deletePixMapAfterLoad);
+	}
 	return model;
 }
 
@@ -63,10 +83,17 @@ void ModelManager::end(){
 		}
 	}
 	models.clear();
+	modelIndex.clear();
+	modelReferences.clear();
 }
 
 void ModelManager::endModel(Model *model,bool mustExistInList) {
 	if(model != NULL) {
+		if(releaseModelReference(model) == true) {
+			return;
+		}
+		unindexModel(model);
+
 		bool found = false;
 		for(unsigned int idx = 0; idx < models.size(); idx++) {
 			Model *curModel = models[idx];
@@ -92,6 +119,10 @@ void ModelManager::endLastModel(bool mustExistInList) {
 		found = true;
 		size_t index = models.size()-1;
 		Model *curModel = models[index];
+		if(releaseModelReference(curModel) == true) {
+			return;
+		}
+		unindexModel(curModel);
 		models.erase(models.begin() + index);
 
 		curModel->end();
@@ -102,5 +133,33 @@ void ModelManager::endLastModel(bool mustExistInList) {
 	}
 }
 
+bool ModelManager::releaseModelReference(Model *model) {
+	map<Model *,int>::iterator iterFind= modelReferences.find(model);
+	if(iterFind == modelReferences.end()) {
+		return false;
+	}
+	iterFind->second--;
+	if(iterFind->second <= 0) {
+		modelReferences.erase(iterFind);
+	}
+	return true;
+}
+
+void ModelManager::unindexModel(Model *model) {
+	for(map<string,pair<Model *,bool> >::iterator iterMap= modelIndex.begin();
+		iterMap != modelIndex.end(); ++iterMap) {
+		if(iterMap->second.first == model) {
+			modelIndex.erase(iterMap);
+			break;
+		}
+	}
+}
+
+string ModelManager::getLookupStats() const {
+	char szBuf[8096]="";
+	snprintf(szBuf,8096,"models: " MG_SIZE_T_SPECIFIER " loads requested: %d shared: %d",
+			models.size(),lookupCount,lookupHitCount);
+	return szBuf;
+}
 
 }}//end namespace
@@ -15,6 +15,7 @@
 #include <stdexcept>
 #include <cstdio>
 #include <cassert>
+#include <algorithm>
 
 #include "util.h"
 #include "math_util.h"
@@ -1011,7 +1012,11 @@ Pixmap2D* Pixmap2D::loadPath(const string& path) {
 void Pixmap2D::load(const string &path) {
 	//printf("Loading Pixmap2D [%s]\n",path.c_str());
 
-	FileReader<Pixmap2D>::readPath(path,this);
+	int requestedComponents = components;
+	if(Pixmap2DCache::load(path,this) == false) {
+		FileReader<Pixmap2D>::readPath(path,this);
+		Pixmap2DCache::save(path,this,requestedComponents);
+	}
 	CalculatePixelsCRC(pixels,getPixelByteCount(), crc);
 	this->path = path;
 }
@@ -1298,54 +1303,123 @@ float splatDist(Vec2i a, Vec2i b){
 	return (max(abs(a.x-b.x),abs(a.y- b.y)) + 3.f*a.dist(b))/4.f;
 }
 
-void Pixmap2D::splat(const Pixmap2D *leftUp, const Pixmap2D *rightUp, const Pixmap2D *leftDown, const Pixmap2D *rightDown){
+// =====================================================
+//	class SplatWeights
+// =====================================================
 
-	RandomGen random;
+SplatWeights::SplatWeights() {
+	w= 0;
+	h= 0;
+}
 
-	assert(components==3 || components==4);
+void SplatWeights::init(int w, int h) {
+	this->w= w;
+	this->h= h;
+	leftUp.assign(w*h, 0.f);
+	rightUp.assign(w*h, 0.f);
+	leftDown.assign(w*h, 0.f);
+	rightDown.assign(w*h, 0.f);
 
-	if(
-		!doDimensionsAgree(leftUp) ||
-		!doDimensionsAgree(rightUp) ||
-		!doDimensionsAgree(leftDown) ||
-		!doDimensionsAgree(rightDown))
-	{
-		throw megaglest_runtime_error("Pixmap2D::splat: pixmap dimensions don't agree");
-	}
+	//same walk and random calls splat always did
+	RandomGen random;
+
+	float avg= (w+h)/2.f;
+	avg= avg*avg;
 
 	for(int i=0; i<w; ++i){
 		for(int j=0; j<h; ++j){
-
-			float avg= (w+h)/2.f;
-
 			float distLu= splatDist(Vec2i(i, j), Vec2i(0, 0));
 			float distRu= splatDist(Vec2i(i, j), Vec2i(w, 0));
 			float distLd= splatDist(Vec2i(i, j), Vec2i(0, h));
 			float distRd= splatDist(Vec2i(i, j), Vec2i(w, h));
 
-			const float powFactor= 2.0f;
-
-			distLu	= std::pow(distLu, powFactor);
-			distRu	= std::pow(distRu, powFactor);
-			distLd	= std::pow(distLd, powFactor);
-			distRd	= std::pow(distRd, powFactor);
-			avg		= std::pow(avg, powFactor);
+			distLu= distLu*distLu;
+			distRu= distRu*distRu;
+			distLd= distLd*distLd;
+			distRd= distRd*distRd;
 
 			float lu= distLu>avg? 0: ((avg-distLu))*random.randRange(0.5f, 1.0f);
 			float ru= distRu>avg? 0: ((avg-distRu))*random.randRange(0.5f, 1.0f);
 			float ld= distLd>avg? 0: ((avg-distLd))*random.randRange(0.5f, 1.0f);
 			float rd= distRd>avg? 0: ((avg-distRd))*random.randRange(0.5f, 1.0f);
 
-			float total= lu+ru+ld+rd;
+			float scale= 1.0f/(lu+ru+ld+rd);
 
-			Vec4f pix= (leftUp->getPixel4f(i, j)*lu+
-				rightUp->getPixel4f(i, j)*ru+
-				leftDown->getPixel4f(i, j)*ld+
-				rightDown->getPixel4f(i, j)*rd)*(1.0f/total);
+			int index= j*w + i;
+			leftUp[index]= lu*scale;
+			rightUp[index]= ru*scale;
+			leftDown[index]= ld*scale;
+			rightDown[index]= rd*scale;
+		}
+	}
+}
+
+void Pixmap2D::splat(const Pixmap2D *leftUp, const Pixmap2D *rightUp, const Pixmap2D *leftDown, const Pixmap2D *rightDown){
+	SplatWeights weights;
+	weights.init(w, h);
+	splat(leftUp, rightUp, leftDown, rightDown, weights);
+}
+
+void Pixmap2D::splat(const Pixmap2D *leftUp, const Pixmap2D *rightUp, const Pixmap2D *leftDown, const Pixmap2D *rightDown, const SplatWeights &weights){
 
-			setPixel(i, j, pix);
+	assert(components==3 || components==4);
+
+	if(
+		!doDimensionsAgree(leftUp) ||
+		!doDimensionsAgree(rightUp) ||
+		!doDimensionsAgree(leftDown) ||
+		!doDimensionsAgree(rightDown))
+	{
+		throw megaglest_runtime_error("Pixmap2D::splat: pixmap dimensions don't agree");
+	}
+	if(weights.getW() != w || weights.getH() != h) {
+		throw megaglest_runtime_error("Pixmap2D::splat: weight dimensions don't agree");
+	}
+
+	const float *weightLu= weights.getLeftUp();
+	const float *weightRu= weights.getRightUp();
+	const float *weightLd= weights.getLeftDown();
+	const float *weightRd= weights.getRightDown();
+
+	if(leftUp->getComponents() == components && rightUp->getComponents() == components &&
+		leftDown->getComponents() == components && rightDown->getComponents() == components) {
+		//straight loops over the pixel arrays without per pixel checks or
+		//calls, so the compiler can vectorize them
+		const uint8 *pixelsLu= leftUp->getPixels();
+		const uint8 *pixelsRu= rightUp->getPixels();
+		const uint8 *pixelsLd= leftDown->getPixels();
+		const uint8 *pixelsRd= rightDown->getPixels();
+		const int pixelCount= w*h;
+
+		for(int i=0; i<pixelCount; ++i){
+			const float lu= weightLu[i];
+			const float ru= weightRu[i];
+			const float ld= weightLd[i];
+			const float rd= weightRd[i];
+			const int first= i*components;
+			for(int index=first; index<first+components; ++index){
+				float value= pixelsLu[index]*lu + pixelsRu[index]*ru + pixelsLd[index]*ld + pixelsRd[index]*rd;
+				pixels[index]= static_cast<uint8>(value);
+			}
+		}
+	}
+	else{
+		for(int j=0; j<h; ++j){
+			for(int i=0; i<w; ++i){
+				int index= j*w + i;
+				Vec4f pix=
+					leftUp->getPixel4f(i, j)*weightLu[index]+
+					rightUp->getPixel4f(i, j)*weightRu[index]+
+					leftDown->getPixel4f(i, j)*weightLd[index]+
+					rightDown->getPixel4f(i, j)*weightRd[index];
+
+				for(int c=0; c<components && c<4; ++c){
+					pixels[index*components + c]= static_cast<uint8>(pix.ptr()[c] * 255.f);
+				}
+			}
 		}
 	}
+	CalculatePixelsCRC(pixels,getPixelByteCount(), crc);
 }
 
 void Pixmap2D::lerp(float t, const Pixmap2D *pixmap1, const Pixmap2D *pixmap2){
@@ -1375,6 +1449,17 @@ void Pixmap2D::copy(const Pixmap2D *sourcePixmap){
 	CalculatePixelsCRC(pixels,getPixelByteCount(), crc);
 }
 
+// exchanges pixel data and metadata without copying, used to hand a pixmap
+// decoded on a worker thread over to its texture
+void Pixmap2D::swap(Pixmap2D *otherPixmap) {
+	std::swap(h, otherPixmap->h);
+	std::swap(w, otherPixmap->w);
+	std::swap(components, otherPixmap->components);
+	std::swap(pixels, otherPixmap->pixels);
+	path.swap(otherPixmap->path);
+	std::swap(crc, otherPixmap->crc);
+}
+
 void Pixmap2D::subCopy(int x, int y, const Pixmap2D *sourcePixmap){
 	assert(components==sourcePixmap->getComponents());
 
@@ -1420,6 +1505,147 @@ bool Pixmap2D::doDimensionsAgree(const Pixmap2D *pixmap){
 	return pixmap->getW() == w && pixmap->getH() == h;
 }
 
+// =====================================================
+//	class Pixmap2DCache
+// =====================================================
+
+string Pixmap2DCache::cachePath = "";
+
+static const char PIXMAP_CACHE_MAGIC[4] = { 'Z', 'G', 'P', 'C' };
+static const uint32 PIXMAP_CACHE_VERSION = 1;
+static const uint32 PIXMAP_CACHE_MAX_PATH_LENGTH = 8096;
+
+template<typename T>
+static bool readPixmapCacheValue(FILE *fp, T &value) {
+	if(fread(&value, sizeof(T), 1, fp) != 1) {
+		return false;
+	}
+	value = Shared::PlatformByteOrder::fromCommonEndian(value);
+	return true;
+}
+
+template<typename T>
+static bool writePixmapCacheValue(FILE *fp, T value) {
+	value = Shared::PlatformByteOrder::toCommonEndian(value);
+	return (fwrite(&value, sizeof(T), 1, fp) == 1);
+}
+
+bool Pixmap2DCache::isCacheable(const string &path) {
+	if(cachePath == "") {
+		return false;
+	}
+	// tga and bmp files are already raw pixels
+	string extension = toLower(extractExtension(path));
+	return (extension == "png" || extension == "jpg" || extension == "jpeg");
+}
+
+string Pixmap2DCache::getCacheFileName(const string &path, int components) {
+	Checksum checksum;
+	checksum.addString(path);
+	return cachePath + "PIXMAP_" + uIntToStr(checksum.getSum()) + "_" + intToStr(components) + ".raw";
+}
+
+bool Pixmap2DCache::load(const string &path, Pixmap2D *pixmap) {
+	if(isCacheable(path) == false) {
+		return false;
+	}
+
+	string cacheFile = getCacheFileName(path,pixmap->getComponents());
+#ifdef WIN32
+	FILE *fp = _wfopen(utf8_decode(cacheFile).c_str(), L"rb");
+#else
+	FILE *fp = fopen(cacheFile.c_str(), "rb");
+#endif
+	if(fp == NULL) {
+		return false;
+	}
+
+	bool result = false;
+	char magic[4] = { 0 };
+	uint32 version = 0;
+	int64 sourceSize = 0;
+	int64 sourceModTime = 0;
+	int32 w = 0;
+	int32 h = 0;
+	int32 components = 0;
+	uint32 pathLength = 0;
+	if(fread(&magic[0], sizeof(magic), 1, fp) == 1 &&
+		memcmp(magic, PIXMAP_CACHE_MAGIC, sizeof(magic)) == 0 &&
+		readPixmapCacheValue(fp,version) == true && version == PIXMAP_CACHE_VERSION &&
+		readPixmapCacheValue(fp,sourceSize) == true &&
+		readPixmapCacheValue(fp,sourceModTime) == true &&
+		readPixmapCacheValue(fp,w) == true &&
+		readPixmapCacheValue(fp,h) == true &&
+		readPixmapCacheValue(fp,components) == true &&
+		readPixmapCacheValue(fp,pathLength) == true &&
+		pathLength > 0 && pathLength < PIXMAP_CACHE_MAX_PATH_LENGTH) {
+
+		vector<char> cachedPath(pathLength);
+		if(fread(&cachedPath[0], pathLength, 1, fp) == 1 &&
+			string(&cachedPath[0],pathLength) == path &&
+			sourceSize == (int64)getFileSize(path) &&
+			sourceModTime == (int64)getFileModTime(path) &&
+			w > 0 && h > 0 && components > 0 && components <= 4) {
+
+			pixmap->init(w, h, components);
+			result = (fread(pixmap->getPixels(), pixmap->getPixelByteCount(), 1, fp) == 1);
+		}
+	}
+	fclose(fp);
+
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] path [%s] cache file [%s] result = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,path.c_str(),cacheFile.c_str(),result);
+	return result;
+}
+
+// written under a temporary name first so a concurrent reader never sees a
+// partial entry
+bool Pixmap2DCache::save(const string &path, const Pixmap2D *pixmap, int requestedComponents) {
+	if(isCacheable(path) == false || pixmap->getPixels() == NULL) {
+		return false;
+	}
+
+	string cacheFile = getCacheFileName(path,requestedComponents);
+	char szTempSuffix[100] = "";
+	snprintf(szTempSuffix, 100, ".%p.tmp", (const void *)pixmap);
+	string tempFile = cacheFile + szTempSuffix;
+
+#ifdef WIN32
+	FILE *fp = _wfopen(utf8_decode(tempFile).c_str(), L"wb");
+#else
+	FILE *fp = fopen(tempFile.c_str(), "wb");
+#endif
+	if(fp == NULL) {
+		return false;
+	}
+
+	bool result =
+		fwrite(&PIXMAP_CACHE_MAGIC[0], sizeof(PIXMAP_CACHE_MAGIC), 1, fp) == 1 &&
+		writePixmapCacheValue(fp,PIXMAP_CACHE_VERSION) == true &&
+		writePixmapCacheValue(fp,(int64)getFileSize(path)) == true &&
+		writePixmapCacheValue(fp,(int64)getFileModTime(path)) == true &&
+		writePixmapCacheValue(fp,(int32)pixmap->getW()) == true &&
+		writePixmapCacheValue(fp,(int32)pixmap->getH()) == true &&
+		writePixmapCacheValue(fp,(int32)pixmap->getComponents()) == true &&
+		writePixmapCacheValue(fp,(uint32)path.size()) == true &&
+		fwrite(path.c_str(), path.size(), 1, fp) == 1 &&
+		fwrite(pixmap->getPixels(), pixmap->getPixelByteCount(), 1, fp) == 1;
+	if(fclose(fp) != 0) {
+		result = false;
+	}
+
+	if(result == true && renameFile(tempFile,cacheFile) == false) {
+		// rename does not replace an existing file on windows
+		removeFile(cacheFile);
+		result = renameFile(tempFile,cacheFile);
+	}
+	if(result == false) {
+		removeFile(tempFile);
+	}
+
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] path [%s] cache file [%s] result = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,path.c_str(),cacheFile.c_str(),result);
+	return result;
+}
+
 // =====================================================
 //	class Pixmap3D
 // =====================================================
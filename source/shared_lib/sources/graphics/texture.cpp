@@ -54,6 +54,13 @@ Texture::Texture() {
 
 	inited= false;
 	forceCompressionDisabled=false;
+	pathListener= NULL;
+}
+
+void Texture::notifyPathChanged(const string &oldPath) {
+	if(pathListener != NULL && getPath() != oldPath) {
+		pathListener->texturePathChanged(this, oldPath);
+	}
 }
 
 
@@ -62,6 +69,7 @@ Texture::Texture() {
 // =====================================================
 
 void Texture1D::load(const string &path){
+	string oldPath= getPath();
 	this->path= path;
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] this->path = [%s]\n",__FILE__,__FUNCTION__,__LINE__,this->path.c_str());
 
@@ -70,6 +78,7 @@ void Texture1D::load(const string &path){
 	}
 	pixmap.load(path);
 	this->path= path;
+	notifyPathChanged(oldPath);
 }
 
 string Texture1D::getPath() const {
@@ -220,6 +229,7 @@ std::pair<SDL_Surface*,unsigned char*> Texture2D::CreateSDLSurface(bool newPixel
 }
 
 void Texture2D::load(const string &path){
+	string oldPath= getPath();
 	this->path= path;
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] this->path = [%s]\n",__FILE__,__FUNCTION__,__LINE__,this->path.c_str());
 
@@ -228,6 +238,13 @@ void Texture2D::load(const string &path){
 	}
 	pixmap.load(path);
 	this->path= path;
+	notifyPathChanged(oldPath);
+}
+
+void Texture2D::setLoadPath(const string &path) {
+	string oldPath= getPath();
+	this->path= path;
+	notifyPathChanged(oldPath);
 }
 
 string Texture2D::getPath() const {
@@ -244,6 +261,7 @@ void Texture2D::deletePixels() {
 // =====================================================
 
 void Texture3D::loadSlice(const string &path, int slice){
+	string oldPath= getPath();
 	this->path= path;
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] this->path = [%s]\n",__FILE__,__FUNCTION__,__LINE__,this->path.c_str());
 
@@ -252,6 +270,7 @@ void Texture3D::loadSlice(const string &path, int slice){
 	}
 	pixmap.loadSlice(path, slice);
 	this->path= path;
+	notifyPathChanged(oldPath);
 }
 
 string Texture3D::getPath() const {
@@ -268,6 +287,7 @@ void Texture3D::deletePixels() {
 // =====================================================
 
 void TextureCube::loadFace(const string &path, int face){
+	string oldPath= getPath();
 	this->path= path;
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] this->path = [%s]\n",__FILE__,__FUNCTION__,__LINE__,this->path.c_str());
 
@@ -276,6 +296,7 @@ void TextureCube::loadFace(const string &path, int face){
 	}
 	pixmap.loadFace(path, face);
 	this->path= path;
+	notifyPathChanged(oldPath);
 }
 
 string TextureCube::getPath() const {
@@ -0,0 +1,229 @@
+// ==============================================================
+//	This file is part of Glest Shared Library (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martiño Figueroa
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "texture_decoder.h"
+
+#include <stdexcept>
+
+#include "util.h"
+#include "platform_util.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Util;
+using namespace Shared::Platform;
+
+namespace Shared{ namespace Graphics{
+
+//how long an idle worker sleeps before re-checking its quit status
+static const int IDLE_WORKER_WAIT_MILLISECONDS = 100;
+
+// =====================================================
+//	class TextureDecodeJob
+// =====================================================
+
+TextureDecodeJob::TextureDecodeJob() {
+	pixmap = NULL;
+	userData = NULL;
+	decodeMillis = 0;
+}
+
+// =====================================================
+//	class TextureDecodeThread
+// =====================================================
+
+TextureDecodeThread::TextureDecodeThread(TextureDecoder *decoder) : BaseThread() {
+	this->decoder = decoder;
+	uniqueID = "TextureDecodeThread";
+}
+
+void TextureDecodeThread::setQuitStatus(bool value) {
+	BaseThread::setQuitStatus(value);
+	if(value == true && decoder != NULL) {
+		decoder->wakeAll();
+	}
+}
+
+void TextureDecodeThread::execute() {
+	RunningStatusSafeWrapper runningStatus(this);
+	try {
+		if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] uniqueID [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,this->getUniqueID().c_str());
+
+		for(;getQuitStatus() == false;) {
+			TextureDecodeJob job;
+			if(decoder->getNextJob(job,this) == false) {
+				continue;
+			}
+
+			ExecutingTaskSafeWrapper safeExecutingTaskMutex(this);
+			Chrono chrono;
+			chrono.start();
+			try {
+				job.pixmap->load(job.path);
+			}
+			catch(const exception &ex) {
+				job.error = ex.what();
+			}
+			job.decodeMillis = chrono.getMillis();
+
+			decoder->jobDecoded(job,this);
+		}
+
+		if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] uniqueID [%s] END\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,this->getUniqueID().c_str());
+	}
+	catch(const exception &ex) {
+		SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,ex.what());
+	}
+}
+
+// =====================================================
+//	class TextureDecoder
+// =====================================================
+
+TextureDecoder::TextureDecoder(int threadCount, int maxDecodedJobs) {
+	mutex = new Mutex(CODE_AT_LINE);
+	jobQueuedTrigger = new Trigger(mutex);
+	jobDecodedTrigger = new Trigger(mutex);
+	jobTakenTrigger = new Trigger(mutex);
+
+	outstandingJobs = 0;
+	this->maxDecodedJobs = (maxDecodedJobs > 0 ? maxDecodedJobs : 1);
+	quit = false;
+	decodedCount = 0;
+	decodeMillis = 0;
+
+	if(threadCount < 1) {
+		threadCount = 1;
+	}
+	for(int index = 0; index < threadCount; ++index) {
+		TextureDecodeThread *worker = new TextureDecodeThread(this);
+		workers.push_back(worker);
+		worker->start();
+	}
+}
+
+TextureDecoder::~TextureDecoder() {
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	quit = true;
+	safeMutex.ReleaseLock();
+	wakeAll();
+
+	for(unsigned int index = 0; index < workers.size(); ++index) {
+		TextureDecodeThread *worker = workers[index];
+		if(worker->shutdownAndWait() == true) {
+			delete worker;
+		}
+		else {
+			SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] texture decode thread %u did not stop\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,index);
+		}
+	}
+	workers.clear();
+
+	for(unsigned int index = 0; index < pendingJobs.size(); ++index) {
+		delete pendingJobs[index].pixmap;
+	}
+	pendingJobs.clear();
+	for(unsigned int index = 0; index < decodedJobs.size(); ++index) {
+		delete decodedJobs[index].pixmap;
+	}
+	decodedJobs.clear();
+
+	delete jobQueuedTrigger;
+	jobQueuedTrigger = NULL;
+	delete jobDecodedTrigger;
+	jobDecodedTrigger = NULL;
+	delete jobTakenTrigger;
+	jobTakenTrigger = NULL;
+	delete mutex;
+	mutex = NULL;
+}
+
+void TextureDecoder::wakeAll() {
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	jobQueuedTrigger->signal(true);
+	jobDecodedTrigger->signal(true);
+	jobTakenTrigger->signal(true);
+}
+
+void TextureDecoder::queueDecode(const string &path, int components, void *userData) {
+	TextureDecodeJob job;
+	job.path = path;
+	job.pixmap = new Pixmap2D(components);
+	job.userData = userData;
+
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	pendingJobs.push_back(job);
+	outstandingJobs++;
+	jobQueuedTrigger->signal();
+}
+
+bool TextureDecoder::getNextJob(TextureDecodeJob &job, BaseThread *worker) {
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	if(pendingJobs.empty() == true && quit == false && worker->getQuitStatus() == false) {
+		jobQueuedTrigger->waitTillSignalled(mutex,IDLE_WORKER_WAIT_MILLISECONDS);
+	}
+	if(pendingJobs.empty() == true || quit == true) {
+		return false;
+	}
+	job = pendingJobs.front();
+	pendingJobs.pop_front();
+	return true;
+}
+
+void TextureDecoder::jobDecoded(const TextureDecodeJob &job, BaseThread *worker) {
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	for(;(int)decodedJobs.size() >= maxDecodedJobs && quit == false &&
+		worker->getQuitStatus() == false;) {
+		jobTakenTrigger->waitTillSignalled(mutex,IDLE_WORKER_WAIT_MILLISECONDS);
+	}
+	if(quit == true || worker->getQuitStatus() == true) {
+		delete job.pixmap;
+		return;
+	}
+
+	decodedJobs.push_back(job);
+	decodedCount++;
+	decodeMillis += job.decodeMillis;
+	jobDecodedTrigger->signal(true);
+}
+
+//returns the next finished job if there is one, waiting up to
+//waitMilliseconds for one when decodes are still outstanding
+bool TextureDecoder::getDecoded(TextureDecodeJob &job, int waitMilliseconds) {
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	if(decodedJobs.empty() == true && waitMilliseconds > 0 && outstandingJobs > 0) {
+		jobDecodedTrigger->waitTillSignalled(mutex,waitMilliseconds);
+	}
+	if(decodedJobs.empty() == true) {
+		return false;
+	}
+	job = decodedJobs.front();
+	decodedJobs.pop_front();
+	outstandingJobs--;
+	jobTakenTrigger->signal(true);
+	return true;
+}
+
+int TextureDecoder::getOutstandingCount() {
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	return outstandingJobs;
+}
+
+int TextureDecoder::getDecodedCount() {
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	return decodedCount;
+}
+
+int64 TextureDecoder::getDecodeMillis() {
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	return decodeMillis;
+}
+
+}}//end namespace
@@ -30,6 +30,13 @@ namespace Shared{ namespace Graphics{
 //	class TextureManager
 // =====================================================
 
+//0 keeps texture loading on the calling thread
+int TextureManager::decodeThreadCount = 0;
+
+//finished decodes held back before decode threads wait for an upload
+static const int MAX_DECODED_TEXTURES_QUEUED = 32;
+static const int DECODE_WAIT_SLICE_MILLISECONDS = 100;
+
 TextureManager::TextureManager() {
 	if(GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
 		throw megaglest_runtime_error("Loading graphics in headless server mode not allowed!");
@@ -38,6 +45,14 @@ TextureManager::TextureManager() {
 
 	textureFilter= Texture::fBilinear;
 	maxAnisotropy= 1;
+
+	deferredLoadEnabled= false;
+	decoder= NULL;
+	uploadedCount= 0;
+	uploadMillis= 0;
+
+	lookupCount= 0;
+	lookupHitCount= 0;
 }
 
 TextureManager::~TextureManager(){
@@ -52,6 +67,12 @@ void TextureManager::initTexture(Texture *texture) {
 
 void TextureManager::endTexture(Texture *texture,bool mustExistInList) {
 	if(texture != NULL) {
+		if(releaseTextureReference(texture) == true) {
+			return;
+		}
+		waitForPendingLoad(texture);
+		unindexTexture(texture, texture->getPath());
+
 		bool found = false;
 		for(unsigned int idx = 0; idx < textures.size(); idx++) {
 			Texture *curTexture = textures[idx];
@@ -75,6 +96,11 @@ void TextureManager::endLastTexture(bool mustExistInList) {
 		found = true;
 		int index = (int)textures.size()-1;
 		Texture *curTexture = textures[index];
+		if(releaseTextureReference(curTexture) == true) {
+			return;
+		}
+		waitForPendingLoad(curTexture);
+		unindexTexture(curTexture, curTexture->getPath());
 		textures.erase(textures.begin() + index);
 
 		curTexture->end();
@@ -86,6 +112,10 @@ void TextureManager::endLastTexture(bool mustExistInList) {
 }
 
 void TextureManager::init(bool forceInit) {
+	if(decoder != NULL) {
+		uploadDecodedTextures(true);
+	}
+
 	for(unsigned int i=0; i<textures.size(); ++i){
 		Texture *texture = textures[i];
 		if(texture == NULL) {
@@ -102,6 +132,17 @@ void TextureManager::init(bool forceInit) {
 }
 
 void TextureManager::end(){
+	//drops any decodes still in flight, their textures are deleted below
+	if(decoder != NULL) {
+		delete decoder;
+		decoder= NULL;
+	}
+	pendingTexture2DLoads.clear();
+	deferredLoadEnabled= false;
+
+	textureIndex.clear();
+	textureReferences.clear();
+
 	for(unsigned int i=0; i<textures.size(); ++i){
 		if(textures[i] != NULL) {
 			textures[i]->end();
@@ -119,32 +160,193 @@ void TextureManager::setMaxAnisotropy(int maxAnisotropy){
 	this->maxAnisotropy= maxAnisotropy;
 }
 
-Texture *TextureManager::getTexture(const string &path){
-	for(unsigned int i=0; i<textures.size(); ++i){
-		if(textures[i]->getPath()==path){
-			return textures[i];
+void TextureManager::setDeferredLoadEnabled(bool value) {
+	deferredLoadEnabled= value;
+	if(value == false && decoder != NULL) {
+		uploadDecodedTextures(true);
+
+		if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled) SystemFlags::OutputDebug(SystemFlags::debugPerformance,"In [%s::%s Line: %d] decoded %d textures on %d threads, uploaded %d, decode msecs: " MG_I64_SPECIFIER " main thread wait+upload msecs: " MG_I64_SPECIFIER "\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,decoder->getDecodedCount(),decoder->getThreadCount(),uploadedCount,decoder->getDecodeMillis(),uploadMillis);
+
+		delete decoder;
+		decoder= NULL;
+		uploadedCount= 0;
+		uploadMillis= 0;
+	}
+}
+
+//the texture is given its path right away so getTexture() finds it while
+//the pixels are still being decoded; it is initialized once they arrive
+void TextureManager::queueTexture2DLoad(Texture2D *texture, const string &path, bool deletePixMapAfterLoad) {
+	if(decoder == NULL) {
+		decoder= new TextureDecoder(decodeThreadCount, MAX_DECODED_TEXTURES_QUEUED);
+	}
+
+	int components= texture->getPixmap()->getComponents();
+	if(components == -1) {
+		components= Texture::defaultComponents;
+	}
+	texture->setLoadPath(path);
+	pendingTexture2DLoads[texture]= deletePixMapAfterLoad;
+	decoder->queueDecode(path, components, texture);
+
+	//keep the decoded queue moving without stalling the caller
+	uploadDecodedTextures(false);
+}
+
+void TextureManager::uploadDecodedTextures(bool waitForAll) {
+	if(decoder == NULL) {
+		return;
+	}
+
+	Chrono chrono;
+	chrono.start();
+	for(;;) {
+		TextureDecodeJob job;
+		if(decoder->getDecoded(job, (waitForAll == true ? DECODE_WAIT_SLICE_MILLISECONDS : 0)) == false) {
+			if(waitForAll == true && decoder->getOutstandingCount() > 0) {
+				continue;
+			}
+			break;
 		}
+		uploadDecodedTexture(job);
+	}
+	uploadMillis += chrono.getMillis();
+}
+
+void TextureManager::uploadDecodedTexture(TextureDecodeJob &job) {
+	Texture2D *texture= static_cast<Texture2D *>(job.userData);
+	map<Texture2D *,bool>::iterator iterFind= pendingTexture2DLoads.find(texture);
+	if(iterFind == pendingTexture2DLoads.end()) {
+		delete job.pixmap;
+		return;
+	}
+	bool deletePixMapAfterLoad= iterFind->second;
+	pendingTexture2DLoads.erase(iterFind);
+
+	//this may run while another texture is being ended, so errors are
+	//kept on their own texture and thrown when that one is initialized
+	if(job.error != "") {
+		delete job.pixmap;
+		setTextureLoadError(texture, job.error);
+		return;
+	}
+
+	texture->getPixmap()->swap(job.pixmap);
+	delete job.pixmap;
+	job.pixmap= NULL;
+
+	try {
+		texture->init(textureFilter, maxAnisotropy);
+	}
+	catch(const std::exception &ex) {
+		setTextureLoadError(texture, ex.what());
+		return;
+	}
+	if(deletePixMapAfterLoad == true) {
+		texture->deletePixels();
+	}
+	uploadedCount++;
+}
+
+void TextureManager::setTextureLoadError(Texture2D *texture, const string &error) {
+	texture->setLoadError(error);
+	SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error loading texture [%s] %s\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,texture->getPath().c_str(),error.c_str());
+}
+
+//a texture must not be deleted while a decode thread still refers to it
+void TextureManager::waitForPendingLoad(Texture *texture) {
+	if(decoder != NULL && pendingTexture2DLoads.find(static_cast<Texture2D *>(texture)) != pendingTexture2DLoads.end()) {
+		uploadDecodedTextures(true);
+	}
+}
+
+Texture *TextureManager::getTexture(const string &path){
+	lookupCount++;
+
+	map<string,Texture *>::iterator iterFind= textureIndex.find(path);
+	if(iterFind != textureIndex.end()) {
+		lookupHitCount++;
+		return iterFind->second;
 	}
 	return NULL;
 }
 
+//callers sharing a texture found with getTexture() take a reference, each
+//endTexture() call then drops one and only the last one deletes it
+void TextureManager::addTextureReference(Texture *texture) {
+	if(texture != NULL) {
+		textureReferences[texture]++;
+	}
+}
+
+bool TextureManager::releaseTextureReference(Texture *texture) {
+	map<Texture *,int>::iterator iterFind= textureReferences.find(texture);
+	if(iterFind == textureReferences.end()) {
+		return false;
+	}
+	iterFind->second--;
+	if(iterFind->second <= 0) {
+		textureReferences.erase(iterFind);
+	}
+	return true;
+}
+
+void TextureManager::addNewTexture(Texture *texture) {
+	textures.push_back(texture);
+	texture->setPathListener(this);
+}
+
+void TextureManager::texturePathChanged(Texture *texture, const string &oldPath) {
+	if(oldPath != "") {
+		unindexTexture(texture, oldPath);
+	}
+
+	//keep the first texture loaded for a path, as the old linear search did
+	string path= texture->getPath();
+	if(path != "") {
+		textureIndex.insert(make_pair(path,texture));
+	}
+}
+
+void TextureManager::unindexTexture(Texture *texture, const string &path) {
+	map<string,Texture *>::iterator iterFind= textureIndex.find(path);
+	if(iterFind != textureIndex.end() && iterFind->second == texture) {
+		textureIndex.erase(iterFind);
+
+		//another texture may have been loaded from the same file
+		for(unsigned int i = 0; i < textures.size(); ++i) {
+			if(textures[i] != texture && textures[i]->getPath() == path) {
+				textureIndex[path]= textures[i];
+				break;
+			}
+		}
+	}
+}
+
+string TextureManager::getLookupStats() const {
+	char szBuf[8096]="";
+	snprintf(szBuf,8096,"textures: " MG_SIZE_T_SPECIFIER " indexed paths: " MG_SIZE_T_SPECIFIER " lookups: %d hits: %d",
+			textures.size(),textureIndex.size(),lookupCount,lookupHitCount);
+	return szBuf;
+}
+
 Texture1D *TextureManager::newTexture1D(){
 	Texture1D *texture1D= GraphicsInterface::getInstance().getFactory()->newTexture1D();
-	textures.push_back(texture1D);
+	addNewTexture(texture1D);
 
 	return texture1D;
 }
 
 Texture2D *TextureManager::newTexture2D(){
 	Texture2D *texture2D= GraphicsInterface::getInstance().getFactory()->newTexture2D();
-	textures.push_back(texture2D);
+	addNewTexture(texture2D);
 
 	return texture2D;
 }
 
 Texture3D *TextureManager::newTexture3D(){
 	Texture3D *texture3D= GraphicsInterface::getInstance().getFactory()->newTexture3D();
-	textures.push_back(texture3D);
+	addNewTexture(texture3D);
 
 	return texture3D;
 }
@@ -152,7 +354,7 @@ Texture3D *TextureManager::newTexture3D(){
 
 TextureCube *TextureManager::newTextureCube(){
 	TextureCube *textureCube= GraphicsInterface::getInstance().getFactory()->newTextureCube();
-	textures.push_back(textureCube);
+	addNewTexture(textureCube);
 
 	return textureCube;
 }
@@ -10,8 +10,10 @@
 // ==============================================================
 
 #include "lua_script.h"
+#include "lua_value_io.h"
 
 #include <stdexcept>
+#include <cstring>
 #include "conversion.h"
 #include "util.h"
 #include "platform_util.h"
@@ -55,6 +57,12 @@ LuaScript::LuaScript() {
 	currentLuaFunctionIsValid = false;
 	sandboxWrapperFunctionName = "";
 	sandboxCode = "";
+	currentFunction = NULL;
+	cachedFunctionsRef = LUA_NOREF;
+	callBudgetMillis = 0;
+	eventTableRef = LUA_NOREF;
+	eventPoolRef = LUA_NOREF;
+	lastEventCount = 0;
 	luaState= luaL_newstate();
 
 	luaL_openlibs(luaState);
@@ -116,6 +124,66 @@ LuaScript::LuaScript() {
 
 		lua_pop(luaState, 1);
 	}
+
+	hookGlobals();
+
+	lua_pushlightuserdata(luaState, this);
+	lua_pushcclosure(luaState, trackSaveChanges, 1);
+	lua_setglobal(luaState, "trackSaveChanges");
+	lua_pushlightuserdata(luaState, this);
+	lua_pushcclosure(luaState, markSaveChanged, 1);
+	lua_setglobal(luaState, "markSaveChanged");
+}
+
+//handler functions are moved out of the globals table into one behind its
+//metatable. Scripts still read them as globals, but assigning one now goes
+//through globalAssigned() which drops its cached reference.
+void LuaScript::hookGlobals() {
+	LuaHandle *L = luaState;
+
+	// Stack: cached
+	lua_newtable(L);
+	lua_pushvalue(L, -1);
+	cachedFunctionsRef = luaL_ref(L, LUA_REGISTRYINDEX);
+
+	// Stack: metatable, cached
+	lua_newtable(L);
+	lua_pushvalue(L, -2);
+	lua_setfield(L, -2, "__index");
+	lua_pushlightuserdata(L, this);
+	lua_pushvalue(L, -3);
+	lua_pushcclosure(L, globalAssigned, 2);
+	lua_setfield(L, -2, "__newindex");
+	// replacing the metatable would hide the moved handlers
+	lua_pushboolean(L, 0);
+	lua_setfield(L, -2, "__metatable");
+
+	// Stack: globals, metatable, cached
+#if LUA_VERSION_NUM > 501
+	lua_pushglobaltable(L);
+#else
+	lua_pushvalue(L, LUA_GLOBALSINDEX);
+#endif
+	lua_insert(L, -2);
+	lua_setmetatable(L, -2);
+	lua_pop(L, 2);
+}
+
+//__newindex of the globals table, called for every global that is not in
+//the table itself, which includes the moved handlers
+int LuaScript::globalAssigned(LuaHandle *L) {
+	// Stack: value, key, globals
+	if(lua_type(L, 2) == LUA_TSTRING) {
+		LuaScript *script = static_cast<LuaScript *>(lua_touserdata(L, lua_upvalueindex(1)));
+		std::map<string, FunctionEntry>::iterator iterFind = script->functions.find(lua_tostring(L, 2));
+		if(iterFind != script->functions.end()) {
+			script->clearFunctionRef(iterFind->second);
+			lua_rawset(L, lua_upvalueindex(2));
+			return 0;
+		}
+	}
+	lua_rawset(L, 1);
+	return 0;
 }
 
 void LuaScript::DumpGlobals()
@@ -209,226 +277,176 @@ void LuaScript::DumpGlobals()
 
 }
 
+static void appendVarint(string &data, uint64 value) {
+	while(value >= 0x80) {
+		data.push_back((char)(value | 0x80));
+		value >>= 7;
+	}
+	data.push_back((char)value);
+}
+
+//trackSaveChanges(name) opts the global table name into change tracking.
+//The script calls markSaveChanged(name) whenever something in it changes,
+//until then saveGame() reuses the bytes it wrote for the table last time.
+int LuaScript::trackSaveChanges(LuaHandle *L) {
+	LuaScript *script = static_cast<LuaScript *>(lua_touserdata(L, lua_upvalueindex(1)));
+	LuaArguments luaArguments(L);
+	script->savedGlobals[luaArguments.getString(-1)];
+	return luaArguments.getReturnCount();
+}
+
+int LuaScript::markSaveChanged(LuaHandle *L) {
+	LuaScript *script = static_cast<LuaScript *>(lua_touserdata(L, lua_upvalueindex(1)));
+	LuaArguments luaArguments(L);
+	std::map<string, SavedGlobal>::iterator iterFind = script->savedGlobals.find(luaArguments.getString(-1));
+	if(iterFind != script->savedGlobals.end()) {
+		iterFind->second.changeStamp++;
+	}
+	return luaArguments.getReturnCount();
+}
+
 void LuaScript::saveGame(XmlNode *rootNode) {
+	Lua_STREFLOP_Wrapper streflopWrapper;
+
 	std::map<string,string> mapTagReplacements;
+	string data;
+	int globalCount = 0;
+	int reusedCount = 0;
 
-	//try{
 	LuaHandle *L = luaState;
-	// push the first key (nil = beginning of table)
-#if LUA_VERSION_NUM <= 501
-	lua_pushnil(L);
-#endif
-
-	// lua_next will:
-	// 1 - pop the key
-	// 2 - push the next key
-	// 3 - push the value at that key
-	// ... so the key will be at index -2 and the value at index -1
-
 #if LUA_VERSION_NUM > 501
 	lua_pushglobaltable(L);
-	lua_pushnil(L);
-	while (lua_next(L, -2) != 0) {
 #else
-	while (lua_next(L, LUA_GLOBALSINDEX) != 0) {
+	lua_pushvalue(L, LUA_GLOBALSINDEX);
 #endif
-		// get type of key and value
+	int globalsIndex = lua_gettop(L);
+
+	// one writer for all globals so tables shared between them are saved
+	// once and load back as the same table
+	string value;
+	LuaValueWriter writer(L, &value);
+
+	for(lua_pushnil(L); lua_next(L, globalsIndex) != 0; lua_pop(L, 1)) {
 		int key_type = lua_type(L, -2);
 		int value_type = lua_type(L, -1);
 
-		if(LuaScript::debugModeEnabled == true) printf("LUA save key_type = %d, value_type = %d for var [%s]\n",key_type,value_type,lua_tostring(L, -2));
-
-		// support only string keys
-		// globals aren't likely to have a non-string key, but just to be certain ...
+		// support only string keys and number, boolean, string and table values
 		if (key_type != LUA_TSTRING) {
-			lua_pop(L, 1); // pop the value so that the top contains the key for the next iteration
 			continue;
 		}
-
-		// support only number, boolean and string values
 		if (value_type != LUA_TNUMBER &&
 			value_type != LUA_TBOOLEAN &&
 			value_type != LUA_TSTRING &&
 			value_type != LUA_TTABLE) {
-			lua_pop(L, 1); // again, pop the value before going to the next loop iteration
 			continue;
 		}
 
-		// get the key as a string
-		string key_string = lua_tostring(L, -2); // no copy required - we already know this is a string
-
-		if(LuaScript::debugModeEnabled == true) printf("key_string [%s]\n",key_string.c_str());
-		// do not support variables that start with '_'
 		// lua has some predefined values like _VERSION. They all start with underscore
-
-		if (!key_string.size()) { // this again is highly unlikely, but still ...
-			lua_pop(L, 1);
-			continue;
-		}
-		if (key_string[0] == '_') {
-			lua_pop(L, 1);
+		string key_string = lua_tostring(L, -2);
+		if (key_string.empty() == true || key_string[0] == '_') {
 			continue;
 		}
 
-		bool skipTable = false;
-		// The first pair is the tables key type,value
-		// The second pair is the tables value type,value
-		vector<pair<pair<int,string>, pair<int,string> > > tableList;
-		string value_string;
+		value.clear();
+		writer.beginSegment();
 
-		// convert the value to a string. This depends on its type
-		switch (value_type) {
-		case LUA_TSTRING:
-		case LUA_TNUMBER:
-			// numbers can be converted to strings
+		SavedGlobal *saved = NULL;
+		if(value_type == LUA_TTABLE) {
+			std::map<string, SavedGlobal>::iterator iterFind = savedGlobals.find(key_string);
+			if(iterFind != savedGlobals.end()) {
+				saved = &iterFind->second;
+			}
+		}
 
-			// get the value as a string (this requires a copy because traversing tables
-			// uses the top of the stack as an index. If conversion from a number to string
-			// happens, the top of the stack will be altered and the table index will become invalid)
-			lua_pushvalue(L, -1);
-			value_string = lua_tostring(L, -1);
+		bool reused = false;
+		if(saved != NULL && saved->savedStamp == saved->changeStamp && saved->tableRef != LUA_NOREF) {
+			lua_rawgeti(L, LUA_REGISTRYINDEX, saved->tableRef);
+			bool sameTable = (lua_rawequal(L, -1, -2) != 0);
 			lua_pop(L, 1);
-			break;
-		case LUA_TBOOLEAN:
-			value_string = lua_toboolean(L, -1) == 0 ? "false" : "true";
-			break;
-		case LUA_TTABLE:
-			{
-
-			int tableItemCount = 0;
-			if(LuaScript::debugModeEnabled == true) printf("================ LUA TABLE DETECTED - START =================\n");
-			for (lua_pushnil(L); lua_next(L, -2) ;) {
-				tableItemCount++;
-
-				if(LuaScript::debugModeEnabled == true) printf("LUA TABLE loop A\n");
-
-				int tableKeyType = lua_type(L, -2);
-				int tableValueType = lua_type(L, -1);
+			reused = (sameTable == true && writer.appendSegment(saved->data, saved->tables) == true);
+		}
 
-				if(LuaScript::debugModeEnabled == true) printf("LUA TABLE loop item type [%s] key: %d value type: %d\n",lua_typename(L, tableValueType),tableKeyType,tableValueType);
+		if(reused == true) {
+			reusedCount++;
+		}
+		else {
+			// tables holding functions, like the lua libraries, are
+			// skipped just as before
+			if(writer.writeValue(-1) == false) {
+				writer.rollbackSegment();
+				if(LuaScript::debugModeEnabled == true) printf("Skipping lua global [%s] with an unsupported embedded type\n",key_string.c_str());
+				continue;
+			}
 
-				switch (tableValueType) {
-					case LUA_TSTRING:
-					case LUA_TNUMBER:
-					case LUA_TBOOLEAN:
-						break;
-					default:
-						skipTable = true;
-						break;
+			// the registry reference keeps the table from being collected
+			// so its address can't be reused by a new table
+			if(saved != NULL) {
+				if(saved->tableRef != LUA_NOREF) {
+					luaL_unref(L, LUA_REGISTRYINDEX, saved->tableRef);
+					saved->tableRef = LUA_NOREF;
 				}
-				if(skipTable == false) {
-					// Stack: value, key, table
-					std :: string value = "";
-					if(!lua_isnil(L, -1)) {
-						if(LuaScript::debugModeEnabled == true) printf("LUA TABLE loop B\n");
-
-						lua_pushvalue(L, -1);
-
-						if(LuaScript::debugModeEnabled == true) printf("LUA TABLE loop C\n");
-
-						if(tableValueType == LUA_TBOOLEAN ) {
-							value = lua_toboolean(L, -1) == 0 ? "false" : "true";
-						}
-						else {
-							value = lua_tostring (L, -1);
-						}
-
-						if(LuaScript::debugModeEnabled == true) printf("LUA TABLE loop D\n");
-
-						lua_pop (L, 1);
-					}
-					lua_pop (L, 1);
-
-					if(LuaScript::debugModeEnabled == true) printf("LUA TABLE value [%s]\n",value.c_str());
-
-					// Stack: key, table
+				if(writer.isSegmentSelfContained() == true) {
+					saved->data = value;
+					writer.getSegmentTables(saved->tables);
 					lua_pushvalue(L, -1);
-
-					// Stack: key, key, table
-					std :: string key = lua_tostring(L, -1);
-					lua_pop(L, 1);
-
-					// Stack: key, table
-					//std :: cout << key << "" << value << "\ n";
-					if(LuaScript::debugModeEnabled == true) printf("[%s] [%s]\n",key.c_str(),value.c_str());
-
-					if(value_string != "") {
-						value_string += "|||";
-					}
-					char szBuf[8096]="";
-					snprintf(szBuf,8096,"[%s] [%s]",key.c_str(),value.c_str());
-					//value_string += szBuf;
-					//vector<pair<pair<int,string>, pair<int,string>> > tableList;
-					tableList.push_back(make_pair(make_pair(tableKeyType,key),make_pair(tableValueType,value)));
-				}
-				else {
-					if(LuaScript::debugModeEnabled == true) printf("***WARNING*** SKIPPING LUA TABLE because it has an unsupported embedded type: %d [%s]\n",tableValueType, lua_typename(L, tableValueType));
-
-					lua_pop(L, 1);
+					saved->tableRef = luaL_ref(L, LUA_REGISTRYINDEX);
+					saved->savedStamp = saved->changeStamp;
 				}
 			}
-			if(tableItemCount < 1) {
-				if(LuaScript::debugModeEnabled == true) printf("Skipping lua table tableItemCount = %d\n",tableItemCount);
-
-				skipTable = true;
-			}
-			if(LuaScript::debugModeEnabled == true) printf("---------------------------- LUA TABLE DETECTED - END ----------------------------\n");
-			}
-			break;
 		}
 
-		// enclose the value in "" if it is a string
-		//if (value_type == LUA_TSTRING) {
-			//value_string = "\"" + value_string + "\"";
-		//}
+		appendVarint(data, key_string.size());
+		data.append(key_string);
+		appendVarint(data, value.size());
+		data.append(value);
+		globalCount++;
+	}
+	lua_pop(L, 1);
 
-		if(skipTable == true) {
-			if(LuaScript::debugModeEnabled == true) printf("#2 SKIPPING TABLE\n");
-		}
-		else {
-			//vector<pair<pair<int,string>, pair<int,string>> > tableList;
-			if(tableList.empty() == false) {
-				XmlNode *luaScriptNode = rootNode->addChild("LuaScript");
-				luaScriptNode->addAttribute("variable",key_string, mapTagReplacements);
-				luaScriptNode->addAttribute("value_type",intToStr(value_type), mapTagReplacements);
-
-				for(unsigned int i = 0; i < tableList.size(); ++i) {
-					pair<pair<int,string>, pair<int,string> > &item = tableList[i];
-
-					XmlNode *luaScriptTableNode = luaScriptNode->addChild("Table");
-					luaScriptTableNode->addAttribute("key_type",intToStr(item.first.first), mapTagReplacements);
-					luaScriptTableNode->addAttribute("key",item.first.second, mapTagReplacements);
-					luaScriptTableNode->addAttribute("value",item.second.second, mapTagReplacements);
-					luaScriptTableNode->addAttribute("value_type",intToStr(item.second.first), mapTagReplacements);
-				}
-			}
-			else {
-				// resulting line. Somehow save this and when you need to restore it, just
-				// call luaL_dostring with that line.
-				//SaveLine(key_string + " = " + value_string);		// Pop the value so the index remains on top of the stack for the next iteration
-				//printf("Found global LUA var: %s = %s\n",key_string.c_str(),value_string.c_str());
-				XmlNode *luaScriptNode = rootNode->addChild("LuaScript");
-				luaScriptNode->addAttribute("variable",key_string, mapTagReplacements);
-				luaScriptNode->addAttribute("value",value_string, mapTagReplacements);
-				luaScriptNode->addAttribute("value_type",intToStr(value_type), mapTagReplacements);
-			}
-		}
-		lua_pop(L, 1);
+	XmlNode *luaStateNode = rootNode->addChild("LuaState");
+	luaStateNode->addAttribute("version",intToStr(luaSaveFormatVersion), mapTagReplacements);
+	luaStateNode->addAttribute("data",base64Encode(data), mapTagReplacements);
+
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugLUA).enabled) SystemFlags::OutputDebug(SystemFlags::debugLUA,"In [%s::%s Line: %d] saved %d globals (%d unchanged) in %d bytes\n",__FILE__,__FUNCTION__,__LINE__,globalCount,reusedCount,(int)data.size());
+}
+
+void LuaScript::loadState(const XmlNode *node) {
+	int version = node->getAttribute("version")->getIntValue();
+	if(version > luaSaveFormatVersion) {
+		throw megaglest_runtime_error("Unsupported lua save data version: " + intToStr(version));
 	}
 
-#if LUA_VERSION_NUM > 501
-		lua_pop(L, 1);
-#endif
+	string data;
+	if(base64Decode(node->getAttribute("data")->getValue(), data) == false) {
+		throw megaglest_runtime_error("Invalid lua save data encoding");
+	}
 
-	//}
-	//catch(const exception &ex) {
-	//	abort();
-	//}
+	int top = lua_gettop(luaState);
+	try {
+		for(LuaValueReader reader(luaState, data, version); reader.atEnd() == false;) {
+			string name = reader.readGlobal();
+			if(LuaScript::debugModeEnabled) printf("  lua global [%s] type [%s]\n",name.c_str(),lua_typename(luaState, lua_type(luaState, -1)));
+			lua_setglobal(luaState, name.c_str());
+		}
+	}
+	catch(const megaglest_runtime_error &) {
+		lua_settop(luaState, top);
+		throw;
+	}
 }
 
 void LuaScript::loadGame(const XmlNode *rootNode) {
+	Lua_STREFLOP_Wrapper streflopWrapper;
+
 	if(LuaScript::debugModeEnabled) printf("START [%s::%s] Line: %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
+	vector<XmlNode *> luaStateNodeList = rootNode->getChildList("LuaState");
+	for(unsigned int i = 0; i < luaStateNodeList.size(); ++i) {
+		loadState(luaStateNodeList[i]);
+	}
+
+	// saves made before the binary format
+
 	vector<XmlNode *> luaScriptNodeList = rootNode->getChildList("LuaScript");
 
 	if(LuaScript::debugModeEnabled) printf("luaScriptNodeList.size(): %d\n",(int)luaScriptNodeList.size());
@@ -561,6 +579,7 @@ void LuaScript::loadCode(string code, string name){
 
 		throw megaglest_runtime_error("Error initializing lua: " + errorToString(errorCode),true);
 	}
+	clearFunctionRefs();
 
 	//const char *errMsg = lua_tostring(luaState, -1);
 
@@ -580,6 +599,7 @@ void LuaScript::setSandboxCode(string code) {
 int LuaScript::runCode(string code) {
 	Lua_STREFLOP_Wrapper streflopWrapper;
 
+	//assigned handlers drop their own references, see globalAssigned()
 	int errorCode = luaL_dostring(luaState,code.c_str());
 	return errorCode;
 }
@@ -600,9 +620,11 @@ void LuaScript::beginCall(string functionName) {
 //		}
 //		//functionName = sandboxWrapperFunctionName;
 //	}
-	lua_getglobal(luaState, functionName.c_str());
-
-	currentLuaFunctionIsValid = lua_isfunction(luaState,lua_gettop(luaState));
+	currentFunction = getFunction(functionName);
+	currentLuaFunctionIsValid = (currentFunction->ref != LUA_NOREF);
+	if(currentLuaFunctionIsValid == true) {
+		lua_rawgeti(luaState, LUA_REGISTRYINDEX, currentFunction->ref);
+	}
 
 	//printf("currentLuaFunctionIsValid = %d functionName [%s]\n",currentLuaFunctionIsValid,functionName.c_str());
 	argumentCount= 0;
@@ -614,13 +636,22 @@ void LuaScript::endCall() {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugLUA).enabled) SystemFlags::OutputDebug(SystemFlags::debugLUA,"In [%s::%s Line: %d] currentLuaFunction [%s], currentLuaFunctionIsValid = %d\n",__FILE__,__FUNCTION__,__LINE__,currentLuaFunction.c_str(),currentLuaFunctionIsValid);
 
 	if(currentLuaFunctionIsValid == true) {
+		Chrono chrono;
+		chrono.start();
+
 		if(sandboxWrapperFunctionName != "" && sandboxCode != "") {
-			//lua_pushstring(luaState, currentLuaFunction.c_str());   // push 1st argument, the real lua function
-			//argumentCount = 1;
+			//the wrapper gets the call as code, the function and the
+			//arguments pushed for a direct call are not used
+			lua_pop(luaState, argumentCount + 1);
 
-			string safeWrapper = sandboxWrapperFunctionName + " [[" + currentLuaFunction + "()]]";
-			printf("Trying to execute [%s]\n",safeWrapper.c_str());
-			int errorCode= runCode(safeWrapper);
+			FunctionEntry *wrapper = getFunction(sandboxWrapperFunctionName);
+			if(wrapper->ref == LUA_NOREF) {
+				throw megaglest_runtime_error("Error calling lua function [" + currentLuaFunction + "] sandbox wrapper [" + sandboxWrapperFunctionName + "] not found",true);
+			}
+			lua_rawgeti(luaState, LUA_REGISTRYINDEX, wrapper->ref);
+			string safeCall = currentLuaFunction + "()";
+			lua_pushstring(luaState, safeCall.c_str());
+			int errorCode= lua_pcall(luaState, 1, 0, 0);
 			if(errorCode !=0 ) {
 				throw megaglest_runtime_error("Error calling lua function [" + currentLuaFunction + "] error: " + errorToString(errorCode),true);
 			}
@@ -641,11 +672,168 @@ void LuaScript::endCall() {
 				throw megaglest_runtime_error("Error calling lua function [" + currentLuaFunction + "] error: " + errorToString(errorCode),true);
 			}
 		}
+
+		updateFunctionStats(chrono.getMicros());
+	}
+}
+
+LuaScript::FunctionEntry *LuaScript::getFunction(const string &functionName) {
+	FunctionEntry &entry = functions[functionName];
+	if(entry.resolved == false) {
+		LuaHandle *L = luaState;
+		lua_getglobal(L, functionName.c_str());
+		if(lua_isfunction(L, -1)) {
+			// Stack: cached, function
+			lua_rawgeti(L, LUA_REGISTRYINDEX, cachedFunctionsRef);
+			lua_pushvalue(L, -2);
+			lua_setfield(L, -2, functionName.c_str());
+			lua_pop(L, 1);
+
+			// Stack: globals, function
+#if LUA_VERSION_NUM > 501
+			lua_pushglobaltable(L);
+#else
+			lua_pushvalue(L, LUA_GLOBALSINDEX);
+#endif
+			lua_pushstring(L, functionName.c_str());
+			lua_pushnil(L);
+			lua_rawset(L, -3);
+			lua_pop(L, 1);
+
+			entry.ref = luaL_ref(L, LUA_REGISTRYINDEX);
+			entry.resolved = true;
+		}
+		else {
+			// an unset global is assigned through globalAssigned() as
+			// well, other values stay where they are and are looked up on
+			// every call
+			entry.ref = LUA_NOREF;
+			entry.resolved = lua_isnil(L, -1);
+			lua_pop(L, 1);
+		}
+	}
+	return &entry;
+}
+
+//the next call looks the function up again, the timing counters are kept
+void LuaScript::clearFunctionRef(FunctionEntry &entry) {
+	if(entry.ref != LUA_NOREF) {
+		luaL_unref(luaState, LUA_REGISTRYINDEX, entry.ref);
+	}
+	entry.ref = LUA_NOREF;
+	entry.resolved = false;
+}
+
+//new code may have changed the global functions without assigning them,
+//through rawset
+void LuaScript::clearFunctionRefs() {
+	for(std::map<string, FunctionEntry>::iterator iterMap = functions.begin();
+		iterMap != functions.end(); ++iterMap) {
+		clearFunctionRef(iterMap->second);
+	}
+}
+
+//most callbacks take well under a millisecond so they are timed in microseconds
+void LuaScript::updateFunctionStats(int64 micros) {
+	if(currentFunction == NULL) {
+		return;
+	}
+	LuaFunctionStats &stats = currentFunction->stats;
+	stats.callCount++;
+	stats.totalMicros += micros;
+	if(micros > stats.maxMicros) {
+		stats.maxMicros = micros;
+	}
+
+	if(callBudgetMillis > 0 && micros > callBudgetMillis * 1000) {
+		stats.overBudgetCount++;
+
+		char szBuf[8096]="";
+		snprintf(szBuf,8096,"Lua function [%s] took " MG_I64_SPECIFIER " usecs, budget is " MG_I64_SPECIFIER " msecs, over budget " MG_I64_SPECIFIER " of " MG_I64_SPECIFIER " calls\n",
+				currentLuaFunction.c_str(),micros,callBudgetMillis,stats.overBudgetCount,stats.callCount);
+		if(stats.overBudgetCount == 1 || debugModeEnabled == true) {
+			printf("%s",szBuf);
+		}
+		if(SystemFlags::getSystemSettingType(SystemFlags::debugLUA).enabled) SystemFlags::OutputDebug(SystemFlags::debugLUA,"In [%s::%s Line: %d] %s",__FILE__,__FUNCTION__,__LINE__,szBuf);
+		if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled) SystemFlags::OutputDebug(SystemFlags::debugPerformance,"In [%s::%s Line: %d] %s",__FILE__,__FUNCTION__,__LINE__,szBuf);
+	}
+}
+
+bool LuaScript::hasFunction(const string &functionName) {
+	Lua_STREFLOP_Wrapper streflopWrapper;
+
+	return (getFunction(functionName)->ref != LUA_NOREF);
+}
+
+std::map<string, LuaFunctionStats> LuaScript::getFunctionStats() const {
+	std::map<string, LuaFunctionStats> result;
+	for(std::map<string, FunctionEntry>::const_iterator iterMap = functions.begin();
+		iterMap != functions.end(); ++iterMap) {
+		if(iterMap->second.stats.callCount > 0) {
+			result[iterMap->first] = iterMap->second.stats;
+		}
+	}
+	return result;
+}
+
+//fills the global table tableName with one record per event and calls
+//functionName once. The event table and the records are kept in the
+//registry and reused so a busy frame does not create garbage
+void LuaScript::callEvents(const string &functionName, const string &tableName, const vector<LuaEvent> &events) {
+	Lua_STREFLOP_Wrapper streflopWrapper;
+
+	if(eventTableRef == LUA_NOREF) {
+		lua_createtable(luaState, eventTableSize, 0);
+		eventTableRef = luaL_ref(luaState, LUA_REGISTRYINDEX);
+		lua_createtable(luaState, eventTableSize, 0);
+		eventPoolRef = luaL_ref(luaState, LUA_REGISTRYINDEX);
+	}
+
+	// Stack: events
+	lua_rawgeti(luaState, LUA_REGISTRYINDEX, eventTableRef);
+	// Stack: pool, events
+	lua_rawgeti(luaState, LUA_REGISTRYINDEX, eventPoolRef);
+
+	for(unsigned int i = 0; i < events.size(); ++i) {
+		const LuaEvent &event = events[i];
+
+		lua_rawgeti(luaState, -1, i + 1);
+		if(lua_istable(luaState, -1) == false) {
+			lua_pop(luaState, 1);
+			lua_createtable(luaState, 0, LuaEvent::maxFields + 1);
+			lua_pushvalue(luaState, -1);
+			lua_rawseti(luaState, -3, i + 1);
+		}
+		else {
+			// clear the fields of the event this record was used for last
+			for(lua_pushnil(luaState); lua_next(luaState, -2) != 0;) {
+				lua_pop(luaState, 1);
+				lua_pushvalue(luaState, -1);
+				lua_pushnil(luaState);
+				lua_rawset(luaState, -4);
+			}
+		}
+
+		// Stack: record, pool, events
+		lua_pushstring(luaState, event.type);
+		lua_setfield(luaState, -2, "type");
+		for(int j = 0; j < event.fieldCount; ++j) {
+			lua_pushinteger(luaState, event.fieldValues[j]);
+			lua_setfield(luaState, -2, event.fieldNames[j]);
+		}
+		lua_rawseti(luaState, -3, i + 1);
 	}
-	else
-	{
-		lua_pcall(luaState, argumentCount, 0, 0);
+	for(int i = (int)events.size(); i < lastEventCount; ++i) {
+		lua_pushnil(luaState);
+		lua_rawseti(luaState, -3, i + 1);
 	}
+	lastEventCount = (int)events.size();
+
+	lua_pop(luaState, 1);
+	lua_setglobal(luaState, tableName.c_str());
+
+	beginCall(functionName);
+	endCall();
 }
 
 void LuaScript::registerFunction(LuaFunction luaFunction, string functionName) {
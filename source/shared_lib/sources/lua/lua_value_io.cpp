@@ -0,0 +1,335 @@
+// ==============================================================
+//	This file is part of Glest Shared Library (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martiño Figueroa
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "lua_value_io.h"
+
+#include <cstring>
+#include "conversion.h"
+#include "platform_util.h"
+#include "leak_dumper.h"
+
+using namespace std;
+using namespace Shared::Util;
+
+namespace Shared { namespace Lua {
+
+// =====================================================
+//	class LuaValueWriter
+// =====================================================
+
+LuaValueWriter::LuaValueWriter(lua_State *L, string *out) {
+	this->L = L;
+	this->out = out;
+	beginSegment();
+}
+
+void LuaValueWriter::writeByte(unsigned char value) {
+	out->push_back(value);
+}
+
+void LuaValueWriter::writeVarint(uint64 value) {
+	while(value >= 0x80) {
+		writeByte((unsigned char)(value | 0x80));
+		value >>= 7;
+	}
+	writeByte((unsigned char)value);
+}
+
+void LuaValueWriter::writeInteger(int64 value) {
+	writeByte(lstInteger);
+	writeVarint(((uint64)value << 1) ^ (uint64)(value >> 63));
+}
+
+void LuaValueWriter::writeNumber(lua_Number value) {
+	double number = value;
+	uint64 bits = 0;
+	memcpy(&bits, &number, sizeof(bits));
+
+	writeByte(lstNumber);
+	for(int i = 0; i < 8; ++i) {
+		writeByte((unsigned char)(bits >> (i * 8)));
+	}
+}
+
+bool LuaValueWriter::writeTable(int index, int depth) {
+	const void *table = lua_topointer(L, index);
+	std::map<const void *, uint64>::iterator iterFind = tableIds.find(table);
+	if(iterFind != tableIds.end()) {
+		if(iterFind->second < segmentTableCount) {
+			segmentIsSelfContained = false;
+		}
+		writeByte(lstTableRef);
+		writeVarint(tables.size() - 1 - iterFind->second);
+		return true;
+	}
+	if(depth >= maxDepth || lua_checkstack(L, 3) == 0) {
+		return false;
+	}
+
+	tableIds[table] = tables.size();
+	tables.push_back(table);
+	writeByte(lstTable);
+
+	for(lua_pushnil(L); lua_next(L, index) != 0;) {
+		int top = lua_gettop(L);
+		if(writeValue(top - 1, depth + 1) == false ||
+			writeValue(top, depth + 1) == false) {
+			lua_pop(L, 2);
+			return false;
+		}
+		lua_pop(L, 1);
+	}
+	writeByte(lstEnd);
+	return true;
+}
+
+bool LuaValueWriter::writeValue(int index, int depth) {
+	if(index < 0) {
+		index = lua_gettop(L) + index + 1;
+	}
+
+	switch(lua_type(L, index)) {
+		case LUA_TBOOLEAN:
+			writeByte(lua_toboolean(L, index) != 0 ? lstTrue : lstFalse);
+			return true;
+		case LUA_TNUMBER:
+			{
+#if LUA_VERSION_NUM > 502
+			if(lua_isinteger(L, index)) {
+				writeInteger(lua_tointeger(L, index));
+				return true;
+			}
+			writeNumber(lua_tonumber(L, index));
+#else
+			// whole numbers are stored as integers, they are far smaller
+			lua_Number value = lua_tonumber(L, index);
+			if(value > -9007199254740992.0 && value < 9007199254740992.0 &&
+				value == (lua_Number)(int64)value && (value != 0 || 1.0 / value > 0)) {
+				writeInteger((int64)value);
+			}
+			else {
+				writeNumber(value);
+			}
+#endif
+			}
+			return true;
+		case LUA_TSTRING:
+			{
+			size_t size = 0;
+			const char *text = lua_tolstring(L, index, &size);
+			writeByte(lstString);
+			writeVarint(size);
+			out->append(text, size);
+			}
+			return true;
+		case LUA_TTABLE:
+			return writeTable(index, depth);
+	}
+	return false;
+}
+
+void LuaValueWriter::beginSegment() {
+	segmentSize = out->size();
+	segmentTableCount = tables.size();
+	segmentIsSelfContained = true;
+}
+
+void LuaValueWriter::rollbackSegment() {
+	out->resize(segmentSize);
+	while(tables.size() > segmentTableCount) {
+		tableIds.erase(tables.back());
+		tables.pop_back();
+	}
+	segmentIsSelfContained = true;
+}
+
+void LuaValueWriter::getSegmentTables(vector<const void *> &segmentTables) const {
+	segmentTables.assign(tables.begin() + segmentTableCount, tables.end());
+}
+
+bool LuaValueWriter::appendSegment(const string &data, const vector<const void *> &segmentTables) {
+	for(unsigned int i = 0; i < segmentTables.size(); ++i) {
+		if(tableIds.find(segmentTables[i]) != tableIds.end()) {
+			return false;
+		}
+	}
+	for(unsigned int i = 0; i < segmentTables.size(); ++i) {
+		tableIds[segmentTables[i]] = tables.size();
+		tables.push_back(segmentTables[i]);
+	}
+	out->append(data);
+	return true;
+}
+
+// =====================================================
+//	class LuaValueReader
+// =====================================================
+
+LuaValueReader::LuaValueReader(lua_State *L, const string &data, int version) : data(data) {
+	this->L = L;
+	this->version = version;
+	this->pos = 0;
+	this->idsRef = LUA_NOREF;
+	this->idsIndex = 0;
+	this->tableCount = 0;
+}
+
+LuaValueReader::~LuaValueReader() {
+	if(idsRef != LUA_NOREF) {
+		luaL_unref(L, LUA_REGISTRYINDEX, idsRef);
+	}
+}
+
+void LuaValueReader::throwError(const string &message) const {
+	throw megaglest_runtime_error("Invalid lua save data at byte " + intToStr(pos) + ": " + message);
+}
+
+unsigned char LuaValueReader::readByte() {
+	if(pos >= data.size()) {
+		throwError("unexpected end");
+	}
+	return (unsigned char)data[pos++];
+}
+
+uint64 LuaValueReader::readVarint() {
+	uint64 value = 0;
+	for(int shift = 0; ; shift += 7) {
+		if(shift > 63) {
+			throwError("bad number");
+		}
+		unsigned char byte = readByte();
+		value |= (uint64)(byte & 0x7F) << shift;
+		if((byte & 0x80) == 0) {
+			break;
+		}
+	}
+	return value;
+}
+
+size_t LuaValueReader::readSize() {
+	uint64 size = readVarint();
+	if(size > data.size() - pos) {
+		throwError("bad size");
+	}
+	return (size_t)size;
+}
+
+void LuaValueReader::readValue(int depth) {
+	if(depth >= LuaValueWriter::maxDepth || lua_checkstack(L, 3) == 0) {
+		throwError("tables nested too deep");
+	}
+
+	unsigned char tag = readByte();
+	switch(tag) {
+		case lstFalse:
+		case lstTrue:
+			lua_pushboolean(L, tag == lstTrue);
+			break;
+		case lstNumber:
+			{
+			uint64 bits = 0;
+			for(int i = 0; i < 8; ++i) {
+				bits |= (uint64)readByte() << (i * 8);
+			}
+			double number = 0;
+			memcpy(&number, &bits, sizeof(number));
+			lua_pushnumber(L, (lua_Number)number);
+			}
+			break;
+		case lstInteger:
+			{
+			uint64 value = readVarint();
+			int64 number = (int64)(value >> 1) ^ -(int64)(value & 1);
+#if LUA_VERSION_NUM > 502
+			lua_pushinteger(L, (lua_Integer)number);
+#else
+			lua_pushnumber(L, (lua_Number)number);
+#endif
+			}
+			break;
+		case lstString:
+			{
+			size_t size = readSize();
+			lua_pushlstring(L, data.data() + pos, size);
+			pos += size;
+			}
+			break;
+		case lstTable:
+			lua_newtable(L);
+			lua_pushvalue(L, -1);
+			lua_rawseti(L, idsIndex, ++tableCount);
+
+			for(;;) {
+				if(pos < data.size() && (unsigned char)data[pos] == lstEnd) {
+					pos++;
+					break;
+				}
+				readValue(depth + 1);
+				readValue(depth + 1);
+				if(lua_isnil(L, -2)) {
+					throwError("nil table key");
+				}
+				lua_rawset(L, -3);
+			}
+			break;
+		case lstTableRef:
+			{
+			uint64 id = readVarint();
+			if(id >= (uint64)tableCount) {
+				throwError("bad table reference");
+			}
+			if(version >= 2) {
+				id = tableCount - 1 - id;
+			}
+			lua_rawgeti(L, idsIndex, (int)id + 1);
+			}
+			break;
+		default:
+			throwError("unknown tag " + intToStr(tag));
+			break;
+	}
+}
+
+void LuaValueReader::readValue() {
+	// the tables of the whole save share one id space
+	if(version >= 2) {
+		if(idsRef == LUA_NOREF) {
+			lua_newtable(L);
+			idsRef = luaL_ref(L, LUA_REGISTRYINDEX);
+		}
+		lua_rawgeti(L, LUA_REGISTRYINDEX, idsRef);
+	}
+	else {
+		lua_newtable(L);
+		tableCount = 0;
+	}
+	idsIndex = lua_gettop(L);
+
+	readValue(0);
+	lua_remove(L, idsIndex);
+}
+
+string LuaValueReader::readGlobal() {
+	size_t nameSize = readSize();
+	string name = data.substr(pos, nameSize);
+	pos += nameSize;
+
+	size_t valueSize = readSize();
+	size_t valueEnd = pos + valueSize;
+
+	readValue();
+	if(pos != valueEnd) {
+		throwError("value size mismatch for [" + name + "]");
+	}
+	return name;
+}
+
+}}//end namespace
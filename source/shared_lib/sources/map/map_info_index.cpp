@@ -0,0 +1,363 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martiño Figueroa
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "map_info_index.h"
+
+#include <cstdio>
+#include <cstring>
+#include <set>
+#include <iterator>
+#include <stdexcept>
+#include "map_preview.h"
+#include "checksum.h"
+#include "conversion.h"
+#include "platform_util.h"
+#include "util.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Util;
+using namespace Shared::PlatformCommon;
+using namespace std;
+
+namespace Shared { namespace Map {
+
+static const char *MAP_INFO_INDEX_HEADER = "MAPINFOINDEX 1";
+static const int MAP_INFO_INDEX_FIELD_COUNT = 10;
+
+// ===============================================
+//	class MapInfoIndexEntry
+// ===============================================
+
+MapInfoIndexEntry::MapInfoIndexEntry() {
+	modTime = 0;
+	fileSize = 0;
+	valid = false;
+	size = Vec2i(0,0);
+	players = 0;
+	crcValid = false;
+	crc = 0;
+}
+
+// ===============================================
+//	class MapInfoIndexThread
+// ===============================================
+
+MapInfoIndexThread::MapInfoIndexThread(const vector<string> &pathList) : BaseThread() {
+	this->pathList = pathList;
+	uniqueID = "MapInfoIndexThread";
+}
+
+void MapInfoIndexThread::execute() {
+	RunningStatusSafeWrapper runningStatus(this);
+	try {
+		Chrono chrono;
+		chrono.start();
+
+		set<string> allMaps;
+		vector<string> results;
+		findAll(pathList, "*.gbm", results, false, false);
+		copy(results.begin(), results.end(), std::inserter(allMaps, allMaps.begin()));
+		results.clear();
+		findAll(pathList, "*.mgm", results, false, false);
+		copy(results.begin(), results.end(), std::inserter(allMaps, allMaps.begin()));
+
+		int mapCount = 0;
+		for(set<string>::iterator iterSet = allMaps.begin();
+			iterSet != allMaps.end() && getQuitStatus() == false; ++iterSet) {
+			string file = MapPreview::getMapPath(pathList, *iterSet, "", false);
+			if(file != "") {
+				ExecutingTaskSafeWrapper safeExecutingTaskMutex(this);
+				MapInfoIndex::getInstance()->indexMapFile(file, this);
+				mapCount++;
+			}
+		}
+		if(getQuitStatus() == false) {
+			MapInfoIndex::getInstance()->save();
+		}
+
+		if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled) SystemFlags::OutputDebug(SystemFlags::debugPerformance,"In [%s::%s Line: %d] indexed %d maps in " MG_I64_SPECIFIER " ms, %s\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,mapCount,chrono.getMillis(),MapInfoIndex::getInstance()->getStats().c_str());
+	}
+	catch(const exception &ex) {
+		SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,ex.what());
+	}
+}
+
+// ===============================================
+//	class MapInfoIndex
+// ===============================================
+
+MapInfoIndex::MapInfoIndex() {
+	mutex = new Mutex(CODE_AT_LINE);
+	dirty = false;
+	indexThread = NULL;
+	hitCount = 0;
+	missCount = 0;
+}
+
+MapInfoIndex::~MapInfoIndex() {
+	if(indexThread != NULL) {
+		indexThread->signalQuit();
+		if(indexThread->shutdownAndWait() == true) {
+			delete indexThread;
+		}
+		indexThread = NULL;
+	}
+	delete mutex;
+	mutex = NULL;
+}
+
+MapInfoIndex *MapInfoIndex::getInstance() {
+	static MapInfoIndex mapInfoIndex;
+	return &mapInfoIndex;
+}
+
+bool MapInfoIndex::getFileStamp(const string &path, int64 &modTime, int64 &fileSize) {
+	modTime = getFileModTime(path);
+	fileSize = getFileSize(path);
+	return (modTime != 0 && fileSize > 0);
+}
+
+void MapInfoIndex::load(const string &indexFile) {
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	this->indexFile = indexFile;
+	entries.clear();
+	dirty = false;
+
+#ifdef WIN32
+	FILE *fp = _wfopen(utf8_decode(indexFile).c_str(), L"rb");
+#else
+	FILE *fp = fopen(indexFile.c_str(), "rb");
+#endif
+	if(fp == NULL) {
+		return;
+	}
+
+	char szLine[8096]="";
+	bool headerOk = false;
+	for(;fgets(szLine, 8096, fp) != NULL;) {
+		string line = szLine;
+		for(;line.empty() == false && (line[line.size()-1] == '\n' || line[line.size()-1] == '\r');) {
+			line.erase(line.size()-1);
+		}
+		if(headerOk == false) {
+			headerOk = (line == MAP_INFO_INDEX_HEADER);
+			if(headerOk == false) {
+				break;
+			}
+			continue;
+		}
+
+		vector<string> tokens;
+		Tokenize(line, tokens, "\t");
+		if((int)tokens.size() != MAP_INFO_INDEX_FIELD_COUNT) {
+			continue;
+		}
+
+		MapInfoIndexEntry entry;
+		entry.path = tokens[0];
+		sscanf(tokens[1].c_str(), MG_I64_SPECIFIER, &entry.modTime);
+		sscanf(tokens[2].c_str(), MG_I64_SPECIFIER, &entry.fileSize);
+		entry.valid = strToBool(tokens[3]);
+		entry.size = Vec2i(strToInt(tokens[4]), strToInt(tokens[5]));
+		entry.players = strToInt(tokens[6]);
+		entry.crcValid = strToBool(tokens[7]);
+		entry.crc = strToUInt(tokens[8]);
+		entry.title = tokens[9];
+		entries[entry.path] = entry;
+	}
+	fclose(fp);
+
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] loaded " MG_SIZE_T_SPECIFIER " map index entries from [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,entries.size(),indexFile.c_str());
+}
+
+void MapInfoIndex::save() {
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	if(indexFile == "" || dirty == false) {
+		return;
+	}
+
+	string tempFile = indexFile + ".tmp";
+#ifdef WIN32
+	FILE *fp = _wfopen(utf8_decode(tempFile).c_str(), L"wb");
+#else
+	FILE *fp = fopen(tempFile.c_str(), "wb");
+#endif
+	if(fp == NULL) {
+		return;
+	}
+
+	fprintf(fp, "%s\n", MAP_INFO_INDEX_HEADER);
+	for(map<string,MapInfoIndexEntry>::iterator iterMap = entries.begin();
+		iterMap != entries.end(); ++iterMap) {
+		const MapInfoIndexEntry &entry = iterMap->second;
+		fprintf(fp, "%s\t" MG_I64_SPECIFIER "\t" MG_I64_SPECIFIER "\t%s\t%d\t%d\t%d\t%s\t%u\t%s\n",
+				entry.path.c_str(), entry.modTime, entry.fileSize,
+				boolToStr(entry.valid).c_str(), entry.size.x, entry.size.y,
+				entry.players, boolToStr(entry.crcValid).c_str(), entry.crc,
+				entry.title.c_str());
+	}
+	bool result = (fclose(fp) == 0);
+
+	if(result == true && renameFile(tempFile,indexFile) == false) {
+		// rename does not replace an existing file on windows
+		removeFile(indexFile);
+		result = renameFile(tempFile,indexFile);
+	}
+	if(result == false) {
+		removeFile(tempFile);
+	}
+	else {
+		dirty = false;
+	}
+}
+
+void MapInfoIndex::startBackgroundIndex(const vector<string> &pathList) {
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	if(indexThread != NULL) {
+		return;
+	}
+	indexThread = new MapInfoIndexThread(pathList);
+	indexThread->start();
+}
+
+void MapInfoIndex::stopBackgroundIndex() {
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	MapInfoIndexThread *thread = indexThread;
+	indexThread = NULL;
+	safeMutex.ReleaseLock();
+
+	if(thread != NULL) {
+		thread->signalQuit();
+		if(thread->shutdownAndWait() == true) {
+			delete thread;
+		}
+	}
+	save();
+}
+
+//brings the entry for one map file up to date, header first then its CRC
+void MapInfoIndex::indexMapFile(const string &path, BaseThread *worker) {
+	int64 modTime = 0;
+	int64 fileSize = 0;
+	if(getFileStamp(path, modTime, fileSize) == false) {
+		return;
+	}
+
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	map<string,MapInfoIndexEntry>::iterator iterFind = entries.find(path);
+	bool fresh = (iterFind != entries.end() && iterFind->second.modTime == modTime &&
+					iterFind->second.fileSize == fileSize);
+	bool needCRC = (fresh == false || iterFind->second.crcValid == false);
+	safeMutex.ReleaseLock();
+
+	if(fresh == false) {
+		try {
+			// stores the header through storeMapInfo()
+			MapInfo mapInfo;
+			MapPreview::loadMapInfo(path, &mapInfo, "", "", false);
+		}
+		catch(const exception &ex) {
+			SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,ex.what());
+			return;
+		}
+	}
+	if(needCRC == true && worker->getQuitStatus() == false) {
+		getMapCRC(path);
+	}
+}
+
+//returns true and fills entry if the index holds current values for path
+bool MapInfoIndex::findMapInfo(const string &path, MapInfoIndexEntry &entry) {
+	int64 modTime = 0;
+	int64 fileSize = 0;
+	bool stampOk = getFileStamp(path, modTime, fileSize);
+
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	map<string,MapInfoIndexEntry>::iterator iterFind = entries.find(path);
+	if(stampOk == true && iterFind != entries.end() &&
+		iterFind->second.modTime == modTime && iterFind->second.fileSize == fileSize) {
+		entry = iterFind->second;
+		hitCount++;
+		return true;
+	}
+	missCount++;
+	return false;
+}
+
+void MapInfoIndex::storeMapInfo(const string &path, bool valid, const Vec2i &size, int players, const string &title) {
+	int64 modTime = 0;
+	int64 fileSize = 0;
+	if(getFileStamp(path, modTime, fileSize) == false) {
+		return;
+	}
+
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	MapInfoIndexEntry &entry = entries[path];
+	if(entry.modTime != modTime || entry.fileSize != fileSize) {
+		entry.crcValid = false;
+		entry.crc = 0;
+	}
+	entry.path = path;
+	entry.modTime = modTime;
+	entry.fileSize = fileSize;
+	entry.valid = valid;
+	entry.size = size;
+	entry.players = players;
+	entry.title = title;
+	// tabs and line breaks would break the index file format
+	for(unsigned int i = 0; i < entry.title.size(); ++i) {
+		if(entry.title[i] == '\t' || entry.title[i] == '\n' || entry.title[i] == '\r') {
+			entry.title[i] = ' ';
+		}
+	}
+	dirty = true;
+}
+
+//same value as a Checksum holding only this file, read from the index while
+//the file is unchanged
+uint32 MapInfoIndex::getMapCRC(const string &path) {
+	int64 modTime = 0;
+	int64 fileSize = 0;
+	bool stampOk = getFileStamp(path, modTime, fileSize);
+
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	map<string,MapInfoIndexEntry>::iterator iterFind = entries.find(path);
+	if(stampOk == true && iterFind != entries.end() && iterFind->second.crcValid == true &&
+		iterFind->second.modTime == modTime && iterFind->second.fileSize == fileSize) {
+		hitCount++;
+		return iterFind->second.crc;
+	}
+	missCount++;
+	safeMutex.ReleaseLock();
+
+	Checksum checksum;
+	checksum.addFile(path);
+	uint32 crc = checksum.getSum();
+
+	safeMutex.Lock();
+	iterFind = entries.find(path);
+	if(stampOk == true && iterFind != entries.end() &&
+		iterFind->second.modTime == modTime && iterFind->second.fileSize == fileSize) {
+		iterFind->second.crc = crc;
+		iterFind->second.crcValid = true;
+		dirty = true;
+	}
+	return crc;
+}
+
+string MapInfoIndex::getStats() {
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	char szBuf[8096]="";
+	snprintf(szBuf,8096,"map index entries: " MG_SIZE_T_SPECIFIER " hits: %d misses: %d",entries.size(),hitCount,missCount);
+	return szBuf;
+}
+
+}}// end namespace
@@ -11,12 +11,15 @@
 
 
 #include "map_preview.h"
+#include "map_info_index.h"
 
 #include "math_wrapper.h"
 #include <cstdlib>
 #include <stdexcept>
 #include <set>
 #include <iterator>
+#include <algorithm>
+#include <cstring>
 #include "platform_util.h"
 #include "conversion.h"
 #include "byte_order.h"
@@ -44,7 +47,8 @@ MapPreview::MapPreview() {
 	cliffLevel = DEFAULT_CLIFF_HEIGHT;
 	cameraHeight = 0;
 	//cells = NULL;
-	cells.clear();
+	w = 0;
+	h = 0;
 	//startLocations = NULL;
 	startLocations.clear();
 	reset(DEFAULT_MAP_CELL_WIDTH, DEFAULT_MAP_CELL_LENGTH, (float)DEFAULT_MAP_CELL_HEIGHT, DEFAULT_MAP_CELL_SURFACE_TYPE);
@@ -67,11 +71,14 @@ MapPreview::~MapPreview() {
 	//}
 	//delete [] cells;
 	//cells = NULL;
-	cells.clear();
+	heights.clear();
+	surfaces.clear();
+	objects.clear();
+	resources.clear();
 }
 
 float MapPreview::getHeight(int x, int y) const {
-	return cells[x][y].height;
+	return heights[cellIndex(x, y)];
 }
 
 bool MapPreview::isCliff(int x, int y){
@@ -93,15 +100,15 @@ bool MapPreview::isCliff(int x, int y){
 }
 
 MapSurfaceType MapPreview::getSurface(int x, int y) const {
-	return static_cast<MapSurfaceType>(cells[x][y].surface);
+	return static_cast<MapSurfaceType>(surfaces[cellIndex(x, y)]);
 }
 
 int MapPreview::getObject(int x, int y) const {
-	return cells[x][y].object;
+	return objects[cellIndex(x, y)];
 }
 
 int MapPreview::getResource(int x, int y) const {
-	return cells[x][y].resource;
+	return resources[cellIndex(x, y)];
 }
 
 int MapPreview::getStartLocationX(int index) const {
@@ -129,7 +136,7 @@ void MapPreview::glestChangeHeight(int x, int y, int height, int radius) {
 			if (inside(i, j)) {
 				int dist = get_dist(i - x, j - y);
 				if (radius > dist) {
-					int oldAlt = static_cast<int>(cells[i][j].height);
+					int oldAlt = static_cast<int>(heights[cellIndex(i, j)]);
 					int altInc = height * (radius - dist - 1) / radius;
 					if (height > 0) {
 						altInc++;
@@ -140,7 +147,7 @@ void MapPreview::glestChangeHeight(int x, int y, int height, int radius) {
 					int newAlt = refAlt + altInc;
 					if ((height > 0 && newAlt > oldAlt) || (height < 0 && newAlt < oldAlt) || height == 0) {
 						if (newAlt >= 0 && newAlt <= 20) {
-							cells[i][j].height = static_cast<float>(newAlt);
+							heights[cellIndex(i, j)] = static_cast<float>(newAlt);
 							hasChanged = true;
 						}
 					}
@@ -167,7 +174,7 @@ void MapPreview::pirateChangeHeight(int x, int y, int height, int radius) {
 	// If the radius is 1 don't bother doing any calculations
 	if (radius == 1) {
 		if(inside(x, y)){
-			cells[x][y].height = (float)goalAlt;
+			heights[cellIndex(x, y)] = (float)goalAlt;
 			hasChanged = true;
 		}
 		return;
@@ -190,7 +197,7 @@ void MapPreview::pirateChangeHeight(int x, int y, int height, int radius) {
 				tj = j;
 			}
 			if (inside(ti, tj)) {
-				gradient[indexI][indexJ] = (cells[ti][tj].height - (float)goalAlt) / (float)radius;
+				gradient[indexI][indexJ] = (heights[cellIndex(ti, tj)] - (float)goalAlt) / (float)radius;
 			//} else if (dist == 0) {
 				//gradient[indexI][indexJ] = 0;
 			}
@@ -199,7 +206,7 @@ void MapPreview::pirateChangeHeight(int x, int y, int height, int radius) {
 				gradient[indexI][indexJ] = (10.0f - (float)goalAlt) / (float)radius;
 			}
 			//std::cout << "gradient[" << indexI << "][" << indexJ << "] = " << gradient[indexI][indexJ] << std::endl;
-			//std::cout << "derived from height " << cells[ti][tj].height << " at " << ti << " " << tj << std::endl;
+			//std::cout << "derived from height " << heights[cellIndex(ti, tj)] << " at " << ti << " " << tj << std::endl;
 			indexJ++;
 		}
 		indexI++;
@@ -323,10 +330,10 @@ void MapPreview::pirateChangeHeight(int x, int y, int height, int radius) {
 
 					// if the change in height and what is supposed to be the change in height
 					// are the same sign then we can change the height
-					if (	((newAlt - cells[i][j].height) > 0 && height > 0) ||
-							((newAlt - cells[i][j].height) < 0 && height < 0) ||
+					if (	((newAlt - heights[cellIndex(i, j)]) > 0 && height > 0) ||
+							((newAlt - heights[cellIndex(i, j)]) < 0 && height < 0) ||
 							height == 0) {
-						cells[i][j].height = newAlt;
+						heights[cellIndex(i, j)] = newAlt;
 						hasChanged = true;
 					}
 				}
@@ -335,84 +342,58 @@ void MapPreview::pirateChangeHeight(int x, int y, int height, int radius) {
 }
 
 void MapPreview::setHeight(int x, int y, float height) {
-	cells[x][y].height = height;
+	heights[cellIndex(x, y)] = height;
 	hasChanged = true;
 }
 
 void MapPreview::setRefAlt(int x, int y) {
 	if (inside(x, y)) {
-		refAlt = static_cast<int>(cells[x][y].height);
+		refAlt = static_cast<int>(heights[cellIndex(x, y)]);
 		hasChanged = true;
 	}
 }
 
 void MapPreview::flipX() {
-	//Cell **oldCells = cells;
-	std::vector<std::vector<Cell> > oldCells = cells;
-
-	//cells = new Cell*[w];
-	cells.clear();
-	cells.resize(w);
-	for (int i = 0; i < w; i++) {
-		//cells[i] = new Cell[h];
-		cells[i].resize(h);
-		for (int j = 0; j < h; j++) {
-			cells[i][j].height = oldCells[w-i-1][j].height;
-			cells[i][j].object = oldCells[w-i-1][j].object;
-			cells[i][j].resource = oldCells[w-i-1][j].resource;
-			cells[i][j].surface = oldCells[w-i-1][j].surface;
-		}
+	for (int j = 0; j < h; j++) {
+		int row = j * w;
+		std::reverse(heights.begin() + row, heights.begin() + row + w);
+		std::reverse(surfaces.begin() + row, surfaces.begin() + row + w);
+		std::reverse(objects.begin() + row, objects.begin() + row + w);
+		std::reverse(resources.begin() + row, resources.begin() + row + w);
 	}
 
 	for (int i = 0; i < maxFactions; ++i) {
 		startLocations[i].x = w - startLocations[i].x - 1;
 	}
 
-	//for (int i = 0; i < w; i++) {
-	//	delete [] oldCells[i];
-	//}
-	//delete [] oldCells;
-
 	hasChanged = true;
 }
 
 void MapPreview::flipY() {
-	//Cell **oldCells = cells;
-	std::vector<std::vector<Cell> > oldCells = cells;
-
-	//cells = new Cell*[w];
-	cells.clear();
-	cells.resize(w);
-
-	for (int i = 0; i < w; i++) {
-		//cells[i] = new Cell[h];
-		cells[i].resize(h);
-		for (int j = 0; j < h; j++) {
-			cells[i][j].height = oldCells[i][h-j-1].height;
-			cells[i][j].object = oldCells[i][h-j-1].object;
-			cells[i][j].resource = oldCells[i][h-j-1].resource;
-			cells[i][j].surface = oldCells[i][h-j-1].surface;
-		}
+	for (int j = 0; j < h / 2; j++) {
+		int row = j * w;
+		int mirrorRow = (h - j - 1) * w;
+		std::swap_ranges(heights.begin() + row, heights.begin() + row + w, heights.begin() + mirrorRow);
+		std::swap_ranges(surfaces.begin() + row, surfaces.begin() + row + w, surfaces.begin() + mirrorRow);
+		std::swap_ranges(objects.begin() + row, objects.begin() + row + w, objects.begin() + mirrorRow);
+		std::swap_ranges(resources.begin() + row, resources.begin() + row + w, resources.begin() + mirrorRow);
 	}
 
 	for (int i = 0; i < maxFactions; ++i) {
 		startLocations[i].y = h - startLocations[i].y - 1;
 	}
 
-	//for (int i = 0; i < w; i++) {
-	//	delete [] oldCells[i];
-	//}
-	//delete [] oldCells;
-
 	hasChanged = true;
 }
 
 // Copy a cell in the map from one cell to another, used by MirrorXY etc
 void MapPreview::copyXY(int x, int y, int sx, int sy) {
-	cells[x][y].height   = cells[sx][sy].height;
-	cells[x][y].object   = cells[sx][sy].object;
-	cells[x][y].resource = cells[sx][sy].resource;
-	cells[x][y].surface  = cells[sx][sy].surface;
+	int index = cellIndex(x, y);
+	int sourceIndex = cellIndex(sx, sy);
+	heights[index]   = heights[sourceIndex];
+	objects[index]   = objects[sourceIndex];
+	resources[index] = resources[sourceIndex];
+	surfaces[index]  = surfaces[sourceIndex];
 
 	hasChanged = true;
 }
@@ -420,21 +401,12 @@ void MapPreview::copyXY(int x, int y, int sx, int sy) {
 // swap a cell in the map with another, used by rotate etc
 void MapPreview::swapXY(int x, int y, int sx, int sy) {
 	if(inside(x, y) && inside(sx, sy)) {
-		float tmpHeight= cells[x][y].height;
-		cells[x][y].height= cells[sx][sy].height;
-		cells[sx][sy].height= tmpHeight;
-
-		int tmpObject= cells[x][y].object;
-		cells[x][y].object= cells[sx][sy].object;
-		cells[sx][sy].object= tmpObject;
-
-		int tmpResource= cells[x][y].resource;
-		cells[x][y].resource= cells[sx][sy].resource;
-		cells[sx][sy].resource= tmpResource;
-
-		int tmpSurface= cells[x][y].surface;
-		cells[x][y].surface= cells[sx][sy].surface;
-		cells[sx][sy].surface= tmpSurface;
+		int index = cellIndex(x, y);
+		int sourceIndex = cellIndex(sx, sy);
+		std::swap(heights[index], heights[sourceIndex]);
+		std::swap(objects[index], objects[sourceIndex]);
+		std::swap(resources[index], resources[sourceIndex]);
+		std::swap(surfaces[index], surfaces[sourceIndex]);
 
 		hasChanged = true;
 	}
@@ -449,7 +421,7 @@ void MapPreview::changeSurface(int x, int y, MapSurfaceType surface, int radius)
 			if (inside(i, j)) {
 				dist = get_dist(i - x, j - y);
 				if (radius > dist) {  // was >=
-					cells[i][j].surface = surface;
+					surfaces[cellIndex(i, j)] = surface;
 					hasChanged = true;
 				}
 			}
@@ -458,7 +430,7 @@ void MapPreview::changeSurface(int x, int y, MapSurfaceType surface, int radius)
 }
 
 void MapPreview::setSurface(int x, int y, MapSurfaceType surface) {
-	cells[x][y].surface = surface;
+	surfaces[cellIndex(x, y)] = surface;
 	hasChanged = true;
 }
 
@@ -471,8 +443,8 @@ void MapPreview::changeObject(int x, int y, int object, int radius) {
 			if (inside(i, j)) {
 				dist = get_dist(i - x, j - y);
 				if (radius > dist) {  // was >=
-					cells[i][j].object = object;
-					cells[i][j].resource = 0;
+					objects[cellIndex(i, j)] = object;
+					resources[cellIndex(i, j)] = 0;
 					hasChanged = true;
 				}
 			}
@@ -481,9 +453,9 @@ void MapPreview::changeObject(int x, int y, int object, int radius) {
 }
 
 void MapPreview::setObject(int x, int y, int object) {
-	cells[x][y].object = object;
+	objects[cellIndex(x, y)] = object;
 	if (object != 0) {
-		cells[x][y].resource = 0;
+		resources[cellIndex(x, y)] = 0;
 	}
 	hasChanged = true;
 }
@@ -497,8 +469,8 @@ void MapPreview::changeResource(int x, int y, int resource, int radius) {
 			if (inside(i, j)) {
 				dist = get_dist(i - x, j - y);
 				if (radius > dist) {  // was >=
-					cells[i][j].resource = resource;
-					cells[i][j].object = 0;
+					resources[cellIndex(i, j)] = resource;
+					objects[cellIndex(i, j)] = 0;
 					hasChanged = true;
 				}
 			}
@@ -507,9 +479,9 @@ void MapPreview::changeResource(int x, int y, int resource, int radius) {
 }
 
 void MapPreview::setResource(int x, int y, int resource) {
-	cells[x][y].resource = resource;
+	resources[cellIndex(x, y)] = resource;
 	if (resource != 0) {
-		cells[x][y].object = 0;
+		objects[cellIndex(x, y)] = 0;
 	}
 	hasChanged = true;
 }
@@ -552,30 +524,14 @@ void MapPreview::reset(int w, int h, float alt, MapSurfaceType surf) {
 		throw megaglest_runtime_error(szBuf);
 	}
 
-	//if (cells != NULL) {
-	//	for (int i = 0; i < this->w; i++) {
-	//		delete [] cells[i];
-	//	}
-	//	delete [] cells;
-	//}
-	cells.clear();
-
 	this->w = w;
 	this->h = h;
 	//this->maxFactions = maxFactions;
 
-	//cells = new Cell*[w];
-	cells.resize(w);
-	for (int i = 0; i < w; i++) {
-		//cells[i] = new Cell[h];
-		cells[i].resize(h);
-		for (int j = 0; j < h; j++) {
-			cells[i][j].height = alt;
-			cells[i][j].object = 0;
-			cells[i][j].resource = 0;
-			cells[i][j].surface = surf;
-		}
-	}
+	heights.assign(w * h, alt);
+	surfaces.assign(w * h, surf);
+	objects.assign(w * h, 0);
+	resources.assign(w * h, 0);
 	hasChanged = true;
 }
 
@@ -612,47 +568,32 @@ void MapPreview::resize(int w, int h, float alt, MapSurfaceType surf) {
 	//this->maxFactions = maxFactions;
 
 	//create new cells
-	//Cell **oldCells = cells;
-	std::vector<std::vector<Cell> > oldCells = cells;
-
-	//cells = new Cell*[w];
-	cells.resize(w);
-	for (int i = 0; i < w; i++) {
-		//cells[i] = new Cell[h];
-		cells[i].resize(h);
-		for (int j = 0; j < h; j++) {
-			cells[i][j].height = alt;
-			cells[i][j].object = 0;
-			cells[i][j].resource = 0;
-			cells[i][j].surface = surf;
-		}
-	}
+	std::vector<float> oldHeights(w * h, alt);
+	std::vector<int> oldSurfaces(w * h, surf);
+	std::vector<int> oldObjects(w * h, 0);
+	std::vector<int> oldResources(w * h, 0);
+	oldHeights.swap(heights);
+	oldSurfaces.swap(surfaces);
+	oldObjects.swap(objects);
+	oldResources.swap(resources);
 
 	int wOffset = w < oldW ? 0 : (w - oldW) / 2;
 	int hOffset = h < oldH ? 0 : (h - oldH) / 2;
-	//assign old values to cells
-	for (int i = 0; i < oldW; i++) {
-		for (int j = 0; j < oldH; j++) {
-			if (i + wOffset < w && j + hOffset < h) {
-				cells[i+wOffset][j+hOffset].height = oldCells[i][j].height;
-				cells[i+wOffset][j+hOffset].object = oldCells[i][j].object;
-				cells[i+wOffset][j+hOffset].resource = oldCells[i][j].resource;
-				cells[i+wOffset][j+hOffset].surface = oldCells[i][j].surface;
-			}
-		}
+	//assign old values to cells, a row at a time
+	int copyW = min(oldW, w - wOffset);
+	for (int j = 0; j < oldH && j + hOffset < h; j++) {
+		int oldRow = j * oldW;
+		int row = cellIndex(wOffset, j + hOffset);
+		std::copy(oldHeights.begin() + oldRow, oldHeights.begin() + oldRow + copyW, heights.begin() + row);
+		std::copy(oldSurfaces.begin() + oldRow, oldSurfaces.begin() + oldRow + copyW, surfaces.begin() + row);
+		std::copy(oldObjects.begin() + oldRow, oldObjects.begin() + oldRow + copyW, objects.begin() + row);
+		std::copy(oldResources.begin() + oldRow, oldResources.begin() + oldRow + copyW, resources.begin() + row);
 	}
 	for (int i = 0; i < maxFactions; ++i) {
 		startLocations[i].x += wOffset;
 		startLocations[i].y += hOffset;
 	}
 
-	//delete old cells
-	//if (oldCells != NULL) {
-	//	for (int i = 0; i < oldW; i++)
-	//		delete [] oldCells[i];
-	//	delete [] oldCells;
-	//}
-
 	hasChanged = true;
 }
 
@@ -726,51 +667,51 @@ void MapPreview::randomizeFactions() {
 }
 
 void MapPreview::smoothSurface(bool limitHeight) {
-	//float oldHeights [w*h];
-	float *oldHeights = new float[w*h]; // dumb microsoft compiler cannot handle dynamic arrays, doing it manually
-	for (int j = 0; j < h; ++j) {
-		for (int i = 0; i < w; ++i) {
-			oldHeights[w*j+i] = cells[i][j].height;
-			//printf("w=%d h=%d i=%d j=%d w*h=%d  w*j+i=%d \n",w,h,i,j,w*h,w*j+i);
+	if (w < 3 || h < 3) {
+		return;
+	}
+
+	// each height is truncated to int (and clamped) before averaging, the
+	// 3x3 sums are built from per column sums of three rows
+	std::vector<int> oldHeights(w * h);
+	for (int index = 0; index < w * h; ++index) {
+		int tmpHeight = static_cast<int>(heights[index]);
+		if(limitHeight && tmpHeight > 20) {
+			tmpHeight = 20;
+		}
+		if(limitHeight && tmpHeight < 0) {
+			tmpHeight = 0;
 		}
+		oldHeights[index] = tmpHeight;
 	}
 
+	std::vector<int> columnSums(w);
 	for (int j = 1; j < h - 1; ++j) {
+		const int *above = &oldHeights[(j - 1) * w];
+		const int *row = &oldHeights[j * w];
+		const int *below = &oldHeights[(j + 1) * w];
+		for (int i = 0; i < w; ++i) {
+			columnSums[i] = above[i] + row[i] + below[i];
+		}
+
+		float *rowHeights = &heights[j * w];
 		for (int i = 1; i < w - 1; ++i) {
-			float height = 0.f;
-			float numUsedToSmooth = 0.f;
-			for (int k = -1; k <= 1; ++k) {
-				for (int l = -1; l <= 1; ++l) {
-					int tmpHeight=oldHeights[(j + k) * w + (i + l)];
-					if(limitHeight && tmpHeight>20){
-						tmpHeight=20;
-					}
-					if(limitHeight && tmpHeight<0){
-						tmpHeight=0;
-					}
-					height += tmpHeight;
-					numUsedToSmooth++;
-				}
-			}
-			height /= numUsedToSmooth;
-			cells[i][j].height=height;
+			float height = static_cast<float>(columnSums[i - 1] + columnSums[i] + columnSums[i + 1]);
+			rowHeights[i] = height / 9.f;
 		}
 	}
-	delete[] oldHeights;
 }
 
 void MapPreview::switchSurfaces(MapSurfaceType surf1, MapSurfaceType surf2) {
 	if (surf1 >= st_Grass && surf1 <= st_Ground && surf2 >= st_Grass && surf2 <= st_Ground) {
-		for (int i = 0; i < w; ++i) {
-			for (int j = 0; j < h; ++j) {
-				if (cells[i][j].surface == surf1) {
-					cells[i][j].surface = surf2;
-					hasChanged = true;
-				}
-				else if (cells[i][j].surface == surf2) {
-					cells[i][j].surface = surf1;
-					hasChanged = true;
-				}
+		for (int index = 0; index < w * h; ++index) {
+			if (surfaces[index] == surf1) {
+				surfaces[index] = surf2;
+				hasChanged = true;
+			}
+			else if (surfaces[index] == surf2) {
+				surfaces[index] = surf1;
+				hasChanged = true;
 			}
 		}
 	}
@@ -808,29 +749,110 @@ void fromEndianMapFileHeader(MapFileHeader &header) {
 	}
 }
 
-void MapPreview::loadFromFile(const string &path) {
+// ===============================================
+//	class MapFileReader
+// ===============================================
 
-	// "Could not open file, result: 3 - 2 No such file or directory [C:\Documents and Settings\人間五\Application Data\megaglest\maps\clearings_in_the_woods.gbm]
+MapFileReader::MapFileReader() {
+	memset(&header, 0, sizeof(MapFileHeader));
+}
 
+//returns false if the file can't be opened, throws if its content is invalid
+bool MapFileReader::load(const string &path) {
 #ifdef WIN32
-	wstring wstr = utf8_decode(path);
-	FILE* f1= _wfopen(wstr.c_str(), L"rb");
-	int fileErrno = errno;
+	FILE *f= _wfopen(utf8_decode(path).c_str(), L"rb");
 #else
-	FILE *f1 = fopen(path.c_str(), "rb");
+	FILE *f= fopen(path.c_str(), "rb");
 #endif
-	if (f1 != NULL) {
+	if(f == NULL) {
+		return false;
+	}
 
-		//read header
-		MapFileHeader header;
-		size_t bytes = fread(&header, sizeof(MapFileHeader), 1, f1);
-		if(bytes != 1) {
+	std::vector<char> data;
+	fseek(f, 0, SEEK_END);
+	long fileSize = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	if(fileSize > 0) {
+		data.resize(fileSize);
+		size_t readBytes = fread(&data[0], 1, fileSize, f);
+		if(readBytes != (size_t)fileSize) {
+			fclose(f);
 			char szBuf[8096]="";
-			snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",bytes,__LINE__);
-			fclose(f1);
+			snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " expected %ld for map file [%s]",readBytes,fileSize,path.c_str());
 			throw megaglest_runtime_error(szBuf);
 		}
-		fromEndianMapFileHeader(header);
+	}
+	fclose(f);
+
+	if(data.size() < sizeof(MapFileHeader)) {
+		throw megaglest_runtime_error("Invalid map header detected for file: " + path);
+	}
+	memcpy(&header, &data[0], sizeof(MapFileHeader));
+	fromEndianMapFileHeader(header);
+
+	if(header.version < mapver_1 || header.version >= mapver_MAX) {
+		char szBuf[8096]="";
+		snprintf(szBuf,8096,"Invalid map version %d in file [%s]",header.version,path.c_str());
+		throw megaglest_runtime_error(szBuf);
+	}
+	if(header.maxFactions <= 0 || header.maxFactions > MAX_MAP_FACTIONCOUNT) {
+		char szBuf[8096]="";
+		snprintf(szBuf,8096,"Invalid map faction count %d in file [%s]",header.maxFactions,path.c_str());
+		throw megaglest_runtime_error(szBuf);
+	}
+	if(header.width <= 0 || header.height <= 0 ||
+		(size_t)header.width * header.height > data.size()) {
+		char szBuf[8096]="";
+		snprintf(szBuf,8096,"Invalid map size %d x %d in file [%s]",header.width,header.height,path.c_str());
+		throw megaglest_runtime_error(szBuf);
+	}
+
+	//start locations, then the height, surface and object planes
+	size_t cellCount = (size_t)header.width * header.height;
+	size_t startLocationBytes = header.maxFactions * 2 * sizeof(int32);
+	size_t expectedSize = sizeof(MapFileHeader) + startLocationBytes +
+			cellCount * (sizeof(float32) + sizeof(int8) + sizeof(int8));
+	if(data.size() < expectedSize) {
+		char szBuf[8096]="";
+		snprintf(szBuf,8096,"Map file [%s] is truncated, size = " MG_SIZE_T_SPECIFIER " expected " MG_SIZE_T_SPECIFIER,path.c_str(),data.size(),expectedSize);
+		throw megaglest_runtime_error(szBuf);
+	}
+
+	const char *pos = &data[sizeof(MapFileHeader)];
+	std::vector<int32> locations(header.maxFactions * 2);
+	memcpy(&locations[0], pos, startLocationBytes);
+	Shared::PlatformByteOrder::fromEndianTypeArray<int32>(&locations[0], locations.size());
+	pos += startLocationBytes;
+
+	startLocations.resize(header.maxFactions);
+	for(int i = 0; i < header.maxFactions; ++i) {
+		startLocations[i] = Vec2i(locations[i * 2], locations[i * 2 + 1]);
+	}
+
+	heights.resize(cellCount);
+	memcpy(&heights[0], pos, cellCount * sizeof(float32));
+	Shared::PlatformByteOrder::fromEndianTypeArray<float32>(&heights[0], cellCount);
+	pos += cellCount * sizeof(float32);
+
+	surfaces.assign(pos, pos + cellCount);
+	pos += cellCount;
+
+	objects.assign(pos, pos + cellCount);
+
+	return true;
+}
+
+void MapPreview::loadFromFile(const string &path) {
+
+	// "Could not open file, result: 3 - 2 No such file or directory [C:\Documents and Settings\人間五\Application Data\megaglest\maps\clearings_in_the_woods.gbm]
+
+	MapFileReader reader;
+	bool opened = reader.load(path);
+#ifdef WIN32
+	int fileErrno = errno;
+#endif
+	if (opened == true) {
+		const MapFileHeader &header = reader.getHeader();
 
 		heightFactor = header.heightFactor;
 		waterLevel = header.waterLevel;
@@ -849,73 +871,28 @@ void MapPreview::loadFromFile(const string &path) {
 		//read start locations
 		resetFactions(header.maxFactions);
 		for (int i = 0; i < maxFactions; ++i) {
-			bytes = fread(&startLocations[i].x, sizeof(int32), 1, f1);
-			if(bytes != 1) {
-				char szBuf[8096]="";
-				snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",bytes,__LINE__);
-				throw megaglest_runtime_error(szBuf);
-			}
-			startLocations[i].x = Shared::PlatformByteOrder::fromCommonEndian(startLocations[i].x);
-
-			bytes = fread(&startLocations[i].y, sizeof(int32), 1, f1);
-			if(bytes != 1) {
-				char szBuf[8096]="";
-				snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",bytes,__LINE__);
-				throw megaglest_runtime_error(szBuf);
-			}
-			startLocations[i].y = Shared::PlatformByteOrder::fromCommonEndian(startLocations[i].y);
+			startLocations[i].x = reader.getStartLocation(i).x;
+			startLocations[i].y = reader.getStartLocation(i).y;
 		}
 
-		//read Heights
+		//read heights, surfaces and objects
 		reset(header.width, header.height, (float)DEFAULT_MAP_CELL_HEIGHT, DEFAULT_MAP_CELL_SURFACE_TYPE);
 		for (int j = 0; j < h; ++j) {
 			for (int i = 0; i < w; ++i) {
-				bytes = fread(&cells[i][j].height, sizeof(float), 1, f1);
-				if(bytes != 1) {
-					char szBuf[8096]="";
-					snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",bytes,__LINE__);
-					throw megaglest_runtime_error(szBuf);
-				}
-				cells[i][j].height = Shared::PlatformByteOrder::fromCommonEndian(cells[i][j].height);
-			}
-		}
-
-		//read surfaces
-		for (int j = 0; j < h; ++j) {
-			for (int i = 0; i < w; ++i) {
-				bytes = fread(&cells[i][j].surface, sizeof(int8), 1, f1);
-				if(bytes != 1) {
-					char szBuf[8096]="";
-					snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",bytes,__LINE__);
-					throw megaglest_runtime_error(szBuf);
-				}
-				cells[i][j].surface = Shared::PlatformByteOrder::fromCommonEndian(cells[i][j].surface);
-			}
-		}
-
-		//read objects
-		for (int j = 0; j < h; ++j) {
-			for (int i = 0; i < w; ++i) {
-				int8 obj;
-				bytes = fread(&obj, sizeof(int8), 1, f1);
-				if(bytes != 1) {
-					char szBuf[8096]="";
-					snprintf(szBuf,8096,"fread returned wrong size = " MG_SIZE_T_SPECIFIER " on line: %d.",bytes,__LINE__);
-					throw megaglest_runtime_error(szBuf);
-				}
-				obj = Shared::PlatformByteOrder::fromCommonEndian(obj);
+				int index = cellIndex(i, j);
+				heights[index] = reader.getHeight(i, j);
+				surfaces[index] = reader.getSurface(i, j);
 
+				int8 obj = reader.getObject(i, j);
 				if (obj <= 10) {
-					cells[i][j].object = obj;
+					objects[index] = obj;
 				}
 				else {
-					cells[i][j].resource = obj - 10;
+					resources[index] = obj - 10;
 				}
 			}
 		}
 
-		if(f1) fclose(f1);
-
 		fileLoaded = true;
 		mapFileLoaded = path;
 		hasChanged = false;
@@ -970,30 +947,30 @@ void MapPreview::saveToFile(const string &path) {
 		}
 
 		//write Heights
-		for (int j = 0; j < h; ++j) {
-			for (int i = 0; i < w; ++i) {
-				fwrite(&cells[i][j].height, sizeof(float32), 1, f1);
-			}
+		if (w * h > 0) {
+			fwrite(&heights[0], sizeof(float32), w * h, f1);
 		}
 
 		//write surfaces
-		for (int j = 0; j < h; ++j) {
-			for (int i = 0; i < w; ++i) {
-				fwrite(&cells[i][j].surface, sizeof(int8), 1, f1);
-			}
+		std::vector<int8> plane(w * h);
+		for (int index = 0; index < w * h; ++index) {
+			plane[index] = static_cast<int8>(surfaces[index]);
+		}
+		if (w * h > 0) {
+			fwrite(&plane[0], sizeof(int8), w * h, f1);
 		}
 
 		//write objects
-		for (int j = 0; j < h; ++j) {
-			for (int i = 0; i < w; ++i) {
-				if (cells[i][j].resource == 0)
-					fwrite(&cells[i][j].object, sizeof(int8), 1, f1);
-				else {
-					int8 res = cells[i][j].resource + 10;
-					fwrite(&res, sizeof(int8), 1, f1);
-				}
+		for (int index = 0; index < w * h; ++index) {
+			if (resources[index] == 0)
+				plane[index] = static_cast<int8>(objects[index]);
+			else {
+				plane[index] = static_cast<int8>(resources[index] + 10);
 			}
 		}
+		if (w * h > 0) {
+			fwrite(&plane[0], sizeof(int8), w * h, f1);
+		}
 
 		if(f1) fclose(f1);
 
@@ -1009,12 +986,8 @@ void MapPreview::saveToFile(const string &path) {
 // ==================== PRIVATE ====================
 
 void MapPreview::resetHeights(int height) {
-	for (int i = 0; i < w; ++i) {
-		for (int j = 0; j < h; ++j) {
-			cells[i][j].height = static_cast<float>(height);
-			hasChanged = true;
-		}
-	}
+	std::fill(heights.begin(), heights.end(), static_cast<float>(height));
+	hasChanged = true;
 }
 
 void MapPreview::realRandomize(int minimumHeight, int maximumHeight, int _chanceDivider, int _smoothRecursions) {
@@ -1034,7 +1007,7 @@ void MapPreview::realRandomize(int minimumHeight, int maximumHeight, int _chance
 	for (int i = 1; i < w-1; ++i) {
 		for (int j = 1; j < h-1; ++j) {
 			if(rand()%chanceDivider==1){
-				cells[i][j].height=(rand() % moduloParam)+minimumHeight;
+				heights[cellIndex(i, j)]=(rand() % moduloParam)+minimumHeight;
 			}
 		}
 	}
@@ -1047,11 +1020,25 @@ void MapPreview::realRandomize(int minimumHeight, int maximumHeight, int _chance
 }
 
 void MapPreview::applyNewHeight(float newHeight, int x, int y, int strenght) {
-	cells[x][y].height = static_cast<float>(((cells[x][y].height * strenght) + newHeight) / (strenght + 1));
+	heights[cellIndex(x, y)] = static_cast<float>(((heights[cellIndex(x, y)] * strenght) + newHeight) / (strenght + 1));
 	hasChanged = true;
 }
 
 bool MapPreview::loadMapInfo(string file, MapInfo *mapInfo, string i18nMaxMapPlayersTitle,string i18nMapSizeTitle,bool errorOnInvalidMap) {
+	MapInfoIndexEntry entry;
+	if(MapInfoIndex::getInstance()->findMapInfo(file, entry) == true &&
+		(entry.valid == true || errorOnInvalidMap == false)) {
+		if(entry.valid == true) {
+			mapInfo->size	= entry.size;
+			mapInfo->players= entry.players;
+			mapInfo->hardMaxPlayers = mapInfo->players;
+
+			mapInfo->desc 	=  i18nMaxMapPlayersTitle 	+ ": " + intToStr(mapInfo->players) + "\n";
+			mapInfo->desc 	+= i18nMapSizeTitle 		+ ": " + intToStr(mapInfo->size.x) + " x " + intToStr(mapInfo->size.y);
+		}
+		return entry.valid;
+	}
+
 	bool validMap = false;
 	FILE *f = NULL;
 	try {
@@ -1116,6 +1103,9 @@ bool MapPreview::loadMapInfo(string file, MapInfo *mapInfo, string i18nMaxMapPla
 
 				validMap = true;
 			}
+
+			string title((const char *)header.title, strnlen((const char *)header.title, MAX_TITLE_LENGTH));
+			MapInfoIndex::getInstance()->storeMapInfo(file, validMap, Vec2i(header.width, header.height), header.maxFactions, title);
 		}
 
 		fclose(f);
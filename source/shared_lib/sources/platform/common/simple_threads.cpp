@@ -631,46 +631,157 @@ bool SimpleTaskThread::getTaskSignalled() {
 
 // -------------------------------------------------
 
+LogFileRingBuffer::LogFileRingBuffer(unsigned int capacity, unsigned long threadId) {
+	// One slot is always left empty to tell a full ring from an empty one
+	slots.resize(capacity + 1);
+	SDL_AtomicSet(&head,0);
+	SDL_AtomicSet(&tail,0);
+	SDL_AtomicSet(&droppedCount,0);
+	SDL_AtomicSet(&refCount,2);
+	SDL_AtomicSet(&released,0);
+	this->threadId = threadId;
+}
+
+bool LogFileRingBuffer::addLogEntry(SystemFlags::DebugType type, const char *logEntry, time_t entryDateTime, int sequence) {
+	int headIndex = SDL_AtomicGet(&head);
+	int nextIndex = (headIndex + 1) % (int)slots.size();
+	if(nextIndex == SDL_AtomicGet(&tail)) {
+		// The writer is falling behind, drop rather than grow or block the caller
+		SDL_AtomicAdd(&droppedCount,1);
+		return false;
+	}
+	// The consumer is done with the slot before tail moved past it
+	SDL_MemoryBarrierAcquire();
+
+	LogFileEntry &entry = slots[headIndex];
+	entry.type = type;
+	entry.entry = logEntry;
+	entry.entryDateTime = entryDateTime;
+	entry.threadId = threadId;
+	entry.sequence = sequence;
+
+	// Publishes the slot to the consumer. SDL_AtomicSet is only an acquire
+	// barrier on some compilers so the slot writes are released first
+	SDL_MemoryBarrierRelease();
+	SDL_AtomicSet(&head,nextIndex);
+	return true;
+}
+
+void LogFileRingBuffer::drain(vector<LogFileEntry> &batch) {
+	int tailIndex = SDL_AtomicGet(&tail);
+	int headIndex = SDL_AtomicGet(&head);
+	// Slots up to head are read only after head itself
+	SDL_MemoryBarrierAcquire();
+	for(; tailIndex != headIndex; tailIndex = (tailIndex + 1) % (int)slots.size()) {
+		LogFileEntry &slot = slots[tailIndex];
+
+		batch.push_back(LogFileEntry());
+		LogFileEntry &entry = batch.back();
+		entry.type = slot.type;
+		entry.entryDateTime = slot.entryDateTime;
+		entry.threadId = slot.threadId;
+		entry.sequence = slot.sequence;
+		// Swapping releases the slot's text so idle rings hold no memory
+		entry.entry.swap(slot.entry);
+	}
+	// The slots are handed back to the producer only once they were read
+	SDL_MemoryBarrierRelease();
+	SDL_AtomicSet(&tail,tailIndex);
+}
+
+std::size_t LogFileRingBuffer::getLogEntryBufferCount() {
+	int headIndex = SDL_AtomicGet(&head);
+	int tailIndex = SDL_AtomicGet(&tail);
+	int count = headIndex - tailIndex;
+	if(count < 0) {
+		count += (int)slots.size();
+	}
+	return count;
+}
+
+void LogFileRingBuffer::releaseRef(LogFileRingBuffer *ring) {
+	if(ring != NULL && SDL_AtomicDecRef(&ring->refCount) == SDL_TRUE) {
+		delete ring;
+	}
+}
+
+void LogFileRingBuffer::threadExitCallback(void *ring) {
+	LogFileRingBuffer *threadRing = static_cast<LogFileRingBuffer *>(ring);
+	if(threadRing != NULL) {
+		threadRing->setReleased();
+		releaseRef(threadRing);
+	}
+}
+
+// -------------------------------------------------
+
+unsigned int LogFileThread::ringBufferCapacity = 8192;
+
 LogFileThread::LogFileThread() : BaseThread(), mutexLogList(new Mutex(CODE_AT_LINE)) {
 	uniqueID = "LogFileThread";
     logList.clear();
-    lastSaveToDisk = time(NULL);
+    ringList.clear();
+    ringTLSId = SDL_TLSCreate();
+    SDL_AtomicSet(&sequence,0);
+    SDL_AtomicSet(&writtenCount,0);
+    SDL_AtomicSet(&droppedCountReleased,0);
     static string mutexOwnerId = CODE_AT_LINE;
     mutexLogList->setOwnerId(mutexOwnerId);
 }
 
 LogFileThread::~LogFileThread() {
 
+	// The calling thread's ring is never released by a thread exit callback
+	if(ringTLSId != 0) {
+		LogFileRingBuffer *ring = static_cast<LogFileRingBuffer *>(SDL_TLSGet(ringTLSId));
+		if(ring != NULL) {
+			SDL_TLSSet(ringTLSId,NULL,NULL);
+			LogFileRingBuffer::threadExitCallback(ring);
+		}
+	}
+	for(unsigned int i = 0; i < ringList.size(); ++i) {
+		LogFileRingBuffer::releaseRef(ringList[i]);
+	}
+	ringList.clear();
+
 	delete mutexLogList;
 	mutexLogList = NULL;
 
 	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("#1 In [%s::%s Line: %d] LogFile thread is deleting\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 }
 
-void LogFileThread::addLogEntry(SystemFlags::DebugType type, string logEntry) {
-	static string mutexOwnerId = CODE_AT_LINE;
-    MutexSafeWrapper safeMutex(mutexLogList,mutexOwnerId);
-    mutexLogList->setOwnerId(mutexOwnerId);
-	LogFileEntry entry;
-	entry.type = type;
-	entry.entry = logEntry;
-	entry.entryDateTime = time(NULL);
-	logList.push_back(entry);
-
-    //if(logList.size() >= 750000) {
-    //    saveToDisk(false,true);
-    //}
+LogFileRingBuffer * LogFileThread::getThreadRingBuffer() {
+	if(ringTLSId == 0) {
+		return NULL;
+	}
+	LogFileRingBuffer *ring = static_cast<LogFileRingBuffer *>(SDL_TLSGet(ringTLSId));
+	if(ring == NULL) {
+		ring = new LogFileRingBuffer(ringBufferCapacity,Thread::getCurrentThreadId());
+
+		static string mutexOwnerId = CODE_AT_LINE;
+		MutexSafeWrapper safeMutex(mutexLogList,mutexOwnerId);
+		mutexLogList->setOwnerId(mutexOwnerId);
+		ringList.push_back(ring);
+		safeMutex.ReleaseLock();
+
+		if(SDL_TLSSet(ringTLSId,ring,LogFileRingBuffer::threadExitCallback) != 0) {
+			// The writer still owns the ring and will drain and free it
+			ring->setReleased();
+			LogFileRingBuffer::releaseRef(ring);
+			return NULL;
+		}
+	}
+	return ring;
 }
 
-bool LogFileThread::checkSaveCurrentLogBufferToDisk() {
-    bool ret = false;
-    if(difftime(time(NULL),lastSaveToDisk) >= 5.0 ||
-		(difftime(time(NULL), lastSaveToDisk) >= 2.0 &&
-         LogFileThread::getLogEntryBufferCount() >= 1000000)) {
-        lastSaveToDisk = time(NULL);
-        ret = true;
-    }
-    return ret;
+void LogFileThread::addLogEntry(SystemFlags::DebugType type, const char *logEntry) {
+	LogFileRingBuffer *ring = getThreadRingBuffer();
+	if(ring == NULL) {
+		SystemFlags::logDebugEntry(type, logEntry, time(NULL), Thread::getCurrentThreadId());
+		return;
+	}
+	int entrySequence = SDL_AtomicAdd(&sequence,1);
+	ring->addLogEntry(type, logEntry, time(NULL), entrySequence);
 }
 
 void LogFileThread::execute() {
@@ -692,10 +803,7 @@ void LogFileThread::execute() {
         try	{
         	ExecutingTaskSafeWrapper safeExecutingTaskMutex(this);
             for(;this->getQuitStatus() == false;) {
-                while(this->getQuitStatus() == false &&
-                	  checkSaveCurrentLogBufferToDisk() == true) {
-                    saveToDisk(false,false);
-                }
+                saveToDisk();
                 if(this->getQuitStatus() == false) {
                     sleep(25);
                 }
@@ -703,7 +811,7 @@ void LogFileThread::execute() {
 
             // Ensure remaining entryies are logged to disk on shutdown
             if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
-            saveToDisk(true,false);
+            saveToDisk();
             if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
         }
         catch(const exception &ex) {
@@ -731,11 +839,26 @@ std::size_t LogFileThread::getLogEntryBufferCount() {
 	static string mutexOwnerId = CODE_AT_LINE;
     MutexSafeWrapper safeMutex(mutexLogList,mutexOwnerId);
     mutexLogList->setOwnerId(mutexOwnerId);
-    std::size_t logCount = logList.size();
+    std::size_t logCount = 0;
+    for(unsigned int i = 0; i < ringList.size(); ++i) {
+    	logCount += ringList[i]->getLogEntryBufferCount();
+    }
     safeMutex.ReleaseLock();
     return logCount;
 }
 
+std::size_t LogFileThread::getLogEntryDroppedCount() {
+	static string mutexOwnerId = CODE_AT_LINE;
+    MutexSafeWrapper safeMutex(mutexLogList,mutexOwnerId);
+    mutexLogList->setOwnerId(mutexOwnerId);
+    std::size_t droppedCount = (unsigned int)SDL_AtomicGet(&droppedCountReleased);
+    for(unsigned int i = 0; i < ringList.size(); ++i) {
+    	droppedCount += ringList[i]->getDroppedCount();
+    }
+    safeMutex.ReleaseLock();
+    return droppedCount;
+}
+
 bool LogFileThread::canShutdown(bool deleteSelfIfShutdownDelayed) {
 	bool ret = (getExecutingTask() == false);
 	if(ret == false && deleteSelfIfShutdownDelayed == true) {
@@ -747,44 +870,45 @@ bool LogFileThread::canShutdown(bool deleteSelfIfShutdownDelayed) {
 	return ret;
 }
 
-void LogFileThread::saveToDisk(bool forceSaveAll,bool logListAlreadyLocked) {
+static bool compareLogFileEntrySequence(const LogFileEntry &a, const LogFileEntry &b) {
+	// Sequence numbers may wrap, compare their distance instead of their values
+	return ((int)((unsigned int)a.sequence - (unsigned int)b.sequence) < 0);
+}
+
+void LogFileThread::saveToDisk() {
 	static string mutexOwnerId = CODE_AT_LINE;
-    MutexSafeWrapper safeMutex(NULL,mutexOwnerId);
-    if(logListAlreadyLocked == false) {
-        safeMutex.setMutex(mutexLogList);
-        mutexLogList->setOwnerId(mutexOwnerId);
+    MutexSafeWrapper safeMutex(mutexLogList,mutexOwnerId);
+    mutexLogList->setOwnerId(mutexOwnerId);
+
+    for(unsigned int i = 0; i < ringList.size();) {
+    	LogFileRingBuffer *ring = ringList[i];
+    	// Check before draining so entries written just before the thread exited are kept
+    	bool released = ring->getReleased();
+    	ring->drain(logList);
+    	if(released == true) {
+    		SDL_AtomicAdd(&droppedCountReleased,ring->getDroppedCount());
+    		ringList.erase(ringList.begin() + i);
+    		LogFileRingBuffer::releaseRef(ring);
+    	}
+    	else {
+    		++i;
+    	}
     }
+    safeMutex.ReleaseLock();
 
     std::size_t logCount = logList.size();
     if(logCount > 0) {
-        vector<LogFileEntry> tempLogList = logList;
-        safeMutex.ReleaseLock(true);
-
-        logCount = tempLogList.size();
-        //if(forceSaveAll == false) {
-        //    logCount = min(logCount,(std::size_t)2000000);
-        //}
-
-        if(logCount > 0) {
-            for(unsigned int i = 0; i < logCount; ++i) {
-                LogFileEntry &entry = tempLogList[i];
-                SystemFlags::logDebugEntry(entry.type, entry.entry, entry.entryDateTime);
-            }
+    	// Merge the per thread rings back into the order entries were logged
+    	std::stable_sort(logList.begin(),logList.end(),compareLogFileEntrySequence);
 
-            safeMutex.Lock();
-            if(logList.size() > 0) {
-				if(logList.size() < logCount) {
-					char szBuf[8096]="";
-					snprintf(szBuf,8096,"logList.size() <= logCount [%lld][%lld]",(long long int)logList.size(),(long long int)logCount);
-					throw megaglest_runtime_error(szBuf);
-				}
-				logList.erase(logList.begin(),logList.begin() + logCount);
-            }
-            safeMutex.ReleaseLock();
+        for(unsigned int i = 0; i < logCount; ++i) {
+            LogFileEntry &entry = logList[i];
+            SystemFlags::logDebugEntry(entry.type, entry.entry, entry.entryDateTime, entry.threadId, false);
         }
-    }
-    else {
-        safeMutex.ReleaseLock();
+        SystemFlags::flushDebugLogs();
+
+        SDL_AtomicAdd(&writtenCount,(int)logCount);
+        logList.clear();
     }
 }
 
@@ -1458,6 +1458,43 @@ int Socket::send(const void *data, int dataSize) {
 	return static_cast<int>(bytesSent);
 }
 
+// Writes as much of data as the socket accepts right now, never waits for
+// buffer space. Returns the bytes written, 0 if the send buffer is full or
+// -1 on error.
+int Socket::sendWithoutWait(const void *data, int dataSize) {
+	if(isSocketValid() == false) {
+		return -1;
+	}
+
+	int bytesSent = 0;
+	int lastSocketError = 0;
+	errno = 0;
+	MutexSafeWrapper safeMutex(dataSynchAccessorWrite,CODE_AT_LINE);
+	if(isSocketValid() == true)	{
+#if defined(WIN32) || defined(__APPLE__)
+		// No MSG_DONTWAIT here, switch the socket to non blocking mode for
+		// this send so a partially writable buffer can never block us
+		SafeSocketBlockToggleWrapper safeBlockToggle(this, false);
+#endif
+#ifdef __APPLE__
+		bytesSent = ::send(sock, (const char *)data, dataSize, SO_NOSIGPIPE);
+#else
+		bytesSent = ::send(sock, (const char *)data, dataSize, MSG_NOSIGNAL | MSG_DONTWAIT);
+#endif
+		// Read the error before restoring the blocking mode can overwrite it
+		lastSocketError = getLastSocketError();
+	}
+	safeMutex.ReleaseLock();
+
+	if(bytesSent < 0) {
+		if(lastSocketError == PLATFORM_SOCKET_TRY_AGAIN) {
+			bytesSent = 0;
+		}
+		else if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] ERROR WRITING SOCKET DATA, err = %d error = %s dataSize = %d\n",__FILE__,__FUNCTION__,__LINE__,bytesSent,getLastSocketErrorFormattedText(&lastSocketError).c_str(),dataSize);
+	}
+	return bytesSent;
+}
+
 int Socket::receive(void *data, int dataSize, bool tryReceiveUntilDataSizeMet) {
 	ssize_t bytesReceived = 0;
 
@@ -195,6 +195,10 @@ SDL_Window *Window::getSDLWindow() {
 }
 
 bool Window::handleEvent() {
+	if(GlobalStaticFlags::isFlagSet(gsft_no_window) == true) {
+		return true;
+	}
+
 	string codeLocation = "a";
 
 	SDL_Event event;
@@ -500,6 +504,12 @@ bool Window::handleEvent() {
 	return true;
 }
 
+void Window::pumpEvents() {
+	if(GlobalStaticFlags::isFlagSet(gsft_no_window) == false) {
+		SDL_PumpEvents();
+	}
+}
+
 void Window::revertMousePos() {
 	SDL_WarpMouseInWindow(sdlWindow,oldX, oldY);
 }
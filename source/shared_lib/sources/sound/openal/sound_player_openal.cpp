@@ -149,6 +149,12 @@ StaticSoundSource::~StaticSoundSource() {
 void StaticSoundSource::play(StaticSound* sound) {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugSound).enabled) SystemFlags::OutputDebug(SystemFlags::debugSound,"In [%s::%s Line: %d]\n",__FILE__,__FUNCTION__,__LINE__);
 
+	// NULL while a lazy decode is still running, this play is skipped
+	int8 *samples = sound->getSamples();
+	if(samples == NULL) {
+		return;
+	}
+
 	if(bufferAllocated) {
 		stop();
 		alDeleteBuffers(1, &buffer);
@@ -159,10 +165,10 @@ void StaticSoundSource::play(StaticSound* sound) {
 	alGenBuffers(1, &buffer);
 	SoundPlayerOpenAL::checkAlError("Couldn't create audio buffer: ");
 
-	if(SystemFlags::getSystemSettingType(SystemFlags::debugSound).enabled) SystemFlags::OutputDebug(SystemFlags::debugSound,"In [%s::%s Line: %d] filename [%s] format = %d, sound->getSamples() = %d, sound->getInfo()->getSize() = %d, sound->getInfo()->getSamplesPerSecond() = %d\n",__FILE__,__FUNCTION__,__LINE__,sound->getFileName().c_str(),format,sound->getSamples(),sound->getInfo()->getSize(),sound->getInfo()->getSamplesPerSecond());
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugSound).enabled) SystemFlags::OutputDebug(SystemFlags::debugSound,"In [%s::%s Line: %d] filename [%s] format = %d, samples = %p, sound->getInfo()->getSize() = %d, sound->getInfo()->getSamplesPerSecond() = %d\n",__FILE__,__FUNCTION__,__LINE__,sound->getFileName().c_str(),format,samples,sound->getInfo()->getSize(),sound->getInfo()->getSamplesPerSecond());
 
 	bufferAllocated = true;
-	alBufferData(buffer, format, sound->getSamples(),
+	alBufferData(buffer, format, samples,
 			static_cast<ALsizei> (sound->getInfo()->getSize()),
 			static_cast<ALsizei> (sound->getInfo()->getSamplesPerSecond()));
 
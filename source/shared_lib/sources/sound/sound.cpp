@@ -10,6 +10,7 @@
 // ==============================================================
 
 #include "sound.h"
+#include "sound_sample_cache.h"
 
 #include <fstream>
 #include <stdexcept>
@@ -48,7 +49,7 @@ Sound::Sound() {
 // =====================================================
 
 StaticSound::StaticSound() {
-	samples= NULL;
+	sample= NULL;
 	soundFileLoader = NULL;
 	fileName = "";
 }
@@ -57,10 +58,17 @@ StaticSound::~StaticSound() {
 	close();
 }
 
+int8 *StaticSound::getSamples() const {
+	if(sample == NULL) {
+		return NULL;
+	}
+	return SoundSampleCache::getInstance()->getSamples(sample);
+}
+
 void StaticSound::close() {
-	if(samples != NULL) {
-		delete [] samples;
-		samples = NULL;
+	if(sample != NULL) {
+		SoundSampleCache::release(sample);
+		sample = NULL;
 	}
 
 	if(soundFileLoader!=NULL){
@@ -78,19 +86,9 @@ void StaticSound::load(const string &path) {
 	if(GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
 		return;
 	}
-	string ext = (path.empty() == false ? path.substr(path.find_last_of('.')+1) : "");
-	soundFileLoader= SoundFileLoaderFactory::getInstance()->newInstance(ext);
-
-	if(soundFileLoader == NULL) {
-		throw megaglest_runtime_error("soundFileLoader == NULL");
-	}
-	soundFileLoader->open(path, &info);
-	samples= new int8[info.getSize()];
-	soundFileLoader->read(samples, info.getSize());
-	soundFileLoader->close();
-
-	delete soundFileLoader;
-	soundFileLoader= NULL;
+	//files used by several skills are only decoded once
+	sample= SoundSampleCache::getInstance()->acquire(path);
+	info= *sample->getInfo();
 }
 
 // =====================================================
@@ -0,0 +1,409 @@
+// ==============================================================
+//	This file is part of Glest Shared Library (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martiño Figueroa
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "sound_sample_cache.h"
+
+#include <stdexcept>
+#include "util.h"
+#include "platform_util.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Util;
+using namespace Shared::PlatformCommon;
+
+namespace Shared{ namespace Sound{
+
+//how long the idle decode thread sleeps before re-checking its quit status
+static const int IDLE_DECODE_WAIT_MILLISECONDS = 250;
+
+// =====================================================
+//	class SoundSample
+// =====================================================
+
+SoundSample::SoundSample(const string &path) {
+	this->path = path;
+	samples = NULL;
+	decodeQueued = false;
+	decodeFailed = false;
+	referenceCount = 0;
+	lastUsedMillis = 0;
+}
+
+SoundSample::~SoundSample() {
+	delete [] samples;
+	samples = NULL;
+}
+
+// =====================================================
+//	class SoundSampleDecodeThread
+// =====================================================
+
+SoundSampleDecodeThread::SoundSampleDecodeThread(SoundSampleCache *cache) : BaseThread() {
+	this->cache = cache;
+	uniqueID = "SoundSampleDecodeThread";
+}
+
+void SoundSampleDecodeThread::setQuitStatus(bool value) {
+	BaseThread::setQuitStatus(value);
+	if(value == true && cache != NULL) {
+		cache->wakeDecodeThread();
+	}
+}
+
+void SoundSampleDecodeThread::execute() {
+	RunningStatusSafeWrapper runningStatus(this);
+	try {
+		for(;getQuitStatus() == false;) {
+			cache->decodeNextQueued(this);
+		}
+	}
+	catch(const exception &ex) {
+		SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,ex.what());
+	}
+}
+
+// =====================================================
+//	class SoundSampleCache
+// =====================================================
+
+bool SoundSampleCache::instanceValid = false;
+
+SoundSampleCache::SoundSampleCache() {
+	mutex = new Mutex(CODE_AT_LINE);
+	decodeQueuedTrigger = new Trigger(mutex);
+	decodeThread = NULL;
+
+	lazyDecode = false;
+	memoryBudget = 0;
+	decodedBytes = 0;
+
+	shareCount = 0;
+	decodeCount = 0;
+	decodeMillis = 0;
+	evictionCount = 0;
+	failedCount = 0;
+
+	instanceValid = true;
+}
+
+SoundSampleCache::~SoundSampleCache() {
+	instanceValid = false;
+
+	stopDecodeThread();
+
+	for(map<string,SoundSample *>::iterator iterMap = samplesByPath.begin();
+		iterMap != samplesByPath.end(); ++iterMap) {
+		delete iterMap->second;
+	}
+	samplesByPath.clear();
+	decodeQueue.clear();
+
+	delete decodeQueuedTrigger;
+	decodeQueuedTrigger = NULL;
+	delete mutex;
+	mutex = NULL;
+}
+
+SoundSampleCache *SoundSampleCache::getInstance() {
+	static SoundSampleCache soundSampleCache;
+	return &soundSampleCache;
+}
+
+void SoundSampleCache::readInfo(const string &path, SoundInfo *info) {
+	string ext = (path.empty() == false ? path.substr(path.find_last_of('.')+1) : "");
+	SoundFileLoader *soundFileLoader = SoundFileLoaderFactory::getInstance()->newInstance(ext);
+	if(soundFileLoader == NULL) {
+		throw megaglest_runtime_error("soundFileLoader == NULL");
+	}
+	try {
+		soundFileLoader->open(path, info);
+	}
+	catch(...) {
+		delete soundFileLoader;
+		throw;
+	}
+	soundFileLoader->close();
+	delete soundFileLoader;
+}
+
+int8 *SoundSampleCache::decodeFile(const string &path, SoundInfo *info) {
+	string ext = (path.empty() == false ? path.substr(path.find_last_of('.')+1) : "");
+	SoundFileLoader *soundFileLoader = SoundFileLoaderFactory::getInstance()->newInstance(ext);
+	if(soundFileLoader == NULL) {
+		throw megaglest_runtime_error("soundFileLoader == NULL");
+	}
+
+	int8 *samples = NULL;
+	try {
+		soundFileLoader->open(path, info);
+		samples = new int8[info->getSize()];
+		soundFileLoader->read(samples, info->getSize());
+	}
+	catch(...) {
+		delete [] samples;
+		delete soundFileLoader;
+		throw;
+	}
+	soundFileLoader->close();
+	delete soundFileLoader;
+
+	return samples;
+}
+
+//returns the shared sample for path with a reference taken. The header is
+//always read here so the caller has its SoundInfo, samples only when not lazy.
+SoundSample *SoundSampleCache::acquire(const string &path) {
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	map<string,SoundSample *>::iterator iterFind = samplesByPath.find(path);
+	if(iterFind != samplesByPath.end()) {
+		iterFind->second->referenceCount++;
+		shareCount++;
+		return iterFind->second;
+	}
+	safeMutex.ReleaseLock();
+
+	SoundSample *sample = new SoundSample(path);
+	try {
+		if(lazyDecode == true) {
+			readInfo(path, &sample->info);
+		}
+		else {
+			Chrono chrono;
+			chrono.start();
+			sample->samples = decodeFile(path, &sample->info);
+
+			MutexSafeWrapper safeMutexDecode(mutex,CODE_AT_LINE);
+			decodedBytes += sample->info.getSize();
+			decodeCount++;
+			decodeMillis += chrono.getMillis();
+		}
+	}
+	catch(...) {
+		delete sample;
+		throw;
+	}
+
+	safeMutex.Lock();
+	//another thread may have loaded the same file meanwhile
+	iterFind = samplesByPath.find(path);
+	if(iterFind != samplesByPath.end()) {
+		if(sample->samples != NULL) {
+			decodedBytes -= sample->info.getSize();
+		}
+		delete sample;
+		iterFind->second->referenceCount++;
+		shareCount++;
+		return iterFind->second;
+	}
+	sample->referenceCount = 1;
+	samplesByPath[path] = sample;
+	return sample;
+}
+
+void SoundSampleCache::release(SoundSample *sample) {
+	if(sample == NULL || instanceValid == false) {
+		return;
+	}
+
+	SoundSampleCache *cache = getInstance();
+	MutexSafeWrapper safeMutex(cache->mutex,CODE_AT_LINE);
+	sample->referenceCount--;
+	if(sample->referenceCount <= 0 && sample->decodeQueued == false) {
+		cache->deleteSample(sample);
+	}
+	//a queued sample is deleted by the decode thread once it is done
+}
+
+//called with the mutex held
+void SoundSampleCache::deleteSample(SoundSample *sample) {
+	map<string,SoundSample *>::iterator iterFind = samplesByPath.find(sample->path);
+	if(iterFind != samplesByPath.end() && iterFind->second == sample) {
+		samplesByPath.erase(iterFind);
+	}
+	if(sample->samples != NULL) {
+		decodedBytes -= sample->info.getSize();
+	}
+	delete sample;
+}
+
+//returns NULL while a lazy decode is still pending, the pointer stays valid
+//until the next call made from the sound player
+int8 *SoundSampleCache::getSamples(SoundSample *sample) {
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	sample->lastUsedMillis = Chrono::getCurMillis();
+	evictLeastRecentlyUsed(sample);
+
+	if(sample->samples != NULL) {
+		return sample->samples;
+	}
+	if(sample->decodeFailed == true) {
+		return NULL;
+	}
+	if(lazyDecode == true) {
+		if(sample->decodeQueued == false) {
+			sample->decodeQueued = true;
+			decodeQueue.push_back(sample);
+			if(decodeThread == NULL) {
+				decodeThread = new SoundSampleDecodeThread(this);
+				decodeThread->start();
+			}
+			decodeQueuedTrigger->signal();
+		}
+		return NULL;
+	}
+	safeMutex.ReleaseLock();
+
+	//evicted earlier, decode it again right away
+	Chrono chrono;
+	chrono.start();
+	SoundInfo info;
+	int8 *samples = NULL;
+	string error;
+	try {
+		samples = decodeFile(sample->path, &info);
+	}
+	catch(const exception &ex) {
+		error = ex.what();
+	}
+
+	safeMutex.Lock();
+	if(samples == NULL) {
+		markDecodeFailed(sample, error);
+		return NULL;
+	}
+	storeDecoded(sample, samples, chrono.getMillis());
+	return sample->samples;
+}
+
+//called with the mutex held, the sample is never decoded again
+void SoundSampleCache::markDecodeFailed(SoundSample *sample, const string &error) {
+	sample->decodeFailed = true;
+	failedCount++;
+	SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error decoding [%s] [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,sample->path.c_str(),error.c_str());
+}
+
+//called with the mutex held
+void SoundSampleCache::storeDecoded(SoundSample *sample, int8 *samples, int64 millis) {
+	if(sample->samples != NULL) {
+		delete [] samples;
+		return;
+	}
+	sample->samples = samples;
+	decodedBytes += sample->info.getSize();
+	decodeCount++;
+	decodeMillis += millis;
+}
+
+//called with the mutex held, drops least recently used samples until the
+//decoded total fits the budget again
+void SoundSampleCache::evictLeastRecentlyUsed(SoundSample *keep) {
+	for(;memoryBudget > 0 && decodedBytes > memoryBudget;) {
+		SoundSample *oldest = NULL;
+		for(map<string,SoundSample *>::iterator iterMap = samplesByPath.begin();
+			iterMap != samplesByPath.end(); ++iterMap) {
+			SoundSample *sample = iterMap->second;
+			if(sample != keep && sample->samples != NULL &&
+				(oldest == NULL || sample->lastUsedMillis < oldest->lastUsedMillis)) {
+				oldest = sample;
+			}
+		}
+		if(oldest == NULL) {
+			break;
+		}
+
+		delete [] oldest->samples;
+		oldest->samples = NULL;
+		decodedBytes -= oldest->info.getSize();
+		evictionCount++;
+	}
+}
+
+void SoundSampleCache::wakeDecodeThread() {
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	decodeQueuedTrigger->signal(true);
+}
+
+bool SoundSampleCache::decodeNextQueued(BaseThread *worker) {
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	if(decodeQueue.empty() == true && worker->getQuitStatus() == false) {
+		decodeQueuedTrigger->waitTillSignalled(mutex,IDLE_DECODE_WAIT_MILLISECONDS);
+	}
+	if(decodeQueue.empty() == true || worker->getQuitStatus() == true) {
+		return false;
+	}
+	SoundSample *sample = decodeQueue.front();
+	decodeQueue.pop_front();
+	string path = sample->path;
+	safeMutex.ReleaseLock();
+
+	Chrono chrono;
+	chrono.start();
+	SoundInfo info;
+	int8 *samples = NULL;
+	string error;
+	try {
+		samples = decodeFile(path, &info);
+	}
+	catch(const exception &ex) {
+		error = ex.what();
+	}
+
+	safeMutex.Lock();
+	sample->decodeQueued = false;
+	if(sample->referenceCount <= 0) {
+		delete [] samples;
+		deleteSample(sample);
+	}
+	else if(samples != NULL) {
+		storeDecoded(sample, samples, chrono.getMillis());
+	}
+	else {
+		markDecodeFailed(sample, error);
+	}
+	return true;
+}
+
+//joins the decode thread, called at program shutdown so it never outlives
+//the objects it uses during static destruction. A later lazy play starts it again.
+void SoundSampleCache::stopDecodeThread() {
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	SoundSampleDecodeThread *thread = decodeThread;
+	decodeThread = NULL;
+	safeMutex.ReleaseLock();
+
+	if(thread != NULL) {
+		thread->signalQuit();
+		if(thread->shutdownAndWait() == true) {
+			delete thread;
+		}
+	}
+
+	//whatever was still queued is queued again by its next play
+	safeMutex.Lock();
+	for(;decodeQueue.empty() == false;) {
+		SoundSample *sample = decodeQueue.front();
+		decodeQueue.pop_front();
+		sample->decodeQueued = false;
+		if(sample->referenceCount <= 0) {
+			deleteSample(sample);
+		}
+	}
+}
+
+string SoundSampleCache::getStats() {
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	char szBuf[8096]="";
+	snprintf(szBuf,8096,"files: " MG_SIZE_T_SPECIFIER " shared loads: %d decoded: %d in " MG_I64_SPECIFIER " ms, resident KB: " MG_I64_SPECIFIER " evicted: %d failed: %d",
+			samplesByPath.size(),shareCount,decodeCount,decodeMillis,decodedBytes / 1024,evictionCount,failedCount);
+	return szBuf;
+}
+
+}}//end namespace
@@ -25,6 +25,7 @@
 #include "platform_common.h"
 #include "conversion.h"
 #include "platform_util.h"
+#include "base_thread.h"
 #include "leak_dumper.h"
 
 using namespace std;
@@ -33,12 +34,102 @@ using namespace Shared::Util;
 
 namespace Shared{ namespace Util{
 
+//below this many uncached files per thread hashing them serially is faster
+static const unsigned int MIN_FILES_PER_HASH_THREAD = 16;
+
+// =====================================================
+//	class ChecksumFileHashJobs
+// =====================================================
+
+//files shared out to the hash threads and the calling thread. Sums are
+//stored by index so the order they finish in can't change the result.
+class ChecksumFileHashJobs {
+private:
+	Mutex mutex;
+	Trigger *workerDoneTrigger;
+	unsigned int nextIndex;
+	int runningWorkers;
+
+public:
+	vector<string> pathList;
+	vector<uint32> sumList;
+	vector<int> hashedList;
+
+	ChecksumFileHashJobs(const vector<string> &pathList, int workerCount) : mutex(CODE_AT_LINE) {
+		workerDoneTrigger = new Trigger(&mutex);
+		nextIndex = 0;
+		runningWorkers = workerCount;
+		this->pathList = pathList;
+		sumList.resize(pathList.size(),0);
+		hashedList.resize(pathList.size(),0);
+	}
+	~ChecksumFileHashJobs() {
+		delete workerDoneTrigger;
+		workerDoneTrigger = NULL;
+	}
+
+	bool hashNextFile() {
+		MutexSafeWrapper safeMutex(&mutex,CODE_AT_LINE);
+		if(nextIndex >= pathList.size()) {
+			return false;
+		}
+		unsigned int index = nextIndex++;
+		safeMutex.ReleaseLock();
+
+		try {
+			sumList[index] = Checksum::getFileSum(pathList[index]);
+			hashedList[index] = 1;
+		}
+		catch(const exception &ex) {
+			//left uncached, getSum() hashes it again and reports the error
+			SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error hashing [%s] [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,pathList[index].c_str(),ex.what());
+		}
+		return true;
+	}
+
+	void workerDone() {
+		MutexSafeWrapper safeMutex(&mutex,CODE_AT_LINE);
+		runningWorkers--;
+		workerDoneTrigger->signal(true);
+	}
+
+	void waitForWorkers() {
+		MutexSafeWrapper safeMutex(&mutex,CODE_AT_LINE);
+		for(;runningWorkers > 0;) {
+			workerDoneTrigger->waitTillSignalled(&mutex,100);
+		}
+	}
+};
+
+// =====================================================
+//	class ChecksumFileHashThread
+// =====================================================
+
+class ChecksumFileHashThread : public BaseThread {
+protected:
+	ChecksumFileHashJobs *jobs;
+
+public:
+	ChecksumFileHashThread(ChecksumFileHashJobs *jobs) : BaseThread() {
+		this->jobs = jobs;
+		uniqueID = "ChecksumFileHashThread";
+	}
+
+	virtual void execute() {
+		RunningStatusSafeWrapper runningStatus(this);
+		for(;getQuitStatus() == false && jobs->hashNextFile() == true;) {
+		}
+		jobs->workerDone();
+	}
+};
+
 // =====================================================
 //	class Checksum
 // =====================================================
 
 Mutex Checksum::fileListCacheSynchAccessor;
 std::map<string,uint32> Checksum::fileListCache;
+int Checksum::fileHashThreadCount = 1;
 
 unsigned int crc_table[256] =
 {
@@ -362,11 +453,75 @@ bool Checksum::addFileToSum(const string &path) {
     return fileExists;
 }
 
+uint32 Checksum::getFileSum(const string &path) {
+	Checksum fileResult;
+	fileResult.addFileToSum(path);
+	return fileResult.getSum();
+}
+
+//hashes the files missing from the cache on worker threads up front, the
+//files are still combined in fileList order by getSum()
+void Checksum::addUncachedFilesToCache() {
+	if(fileHashThreadCount <= 1) {
+		return;
+	}
+
+	vector<string> uncachedList;
+	{
+	MutexSafeWrapper safeMutex(&Checksum::fileListCacheSynchAccessor,string(__FILE__) + "_" + intToStr(__LINE__));
+	for(std::map<string,uint32>::iterator iterMap = fileList.begin();
+		iterMap != fileList.end(); ++iterMap) {
+		if(Checksum::fileListCache.find(iterMap->first) == Checksum::fileListCache.end()) {
+			uncachedList.push_back(iterMap->first);
+		}
+	}
+	}
+
+	int threadCount = min(fileHashThreadCount,(int)(uncachedList.size() / MIN_FILES_PER_HASH_THREAD));
+	if(threadCount <= 1) {
+		return;
+	}
+
+	Chrono chrono;
+	chrono.start();
+
+	//the calling thread is one of the hashing threads
+	ChecksumFileHashJobs jobs(uncachedList,threadCount - 1);
+	vector<ChecksumFileHashThread *> workers;
+	for(int index = 0; index < threadCount - 1; ++index) {
+		ChecksumFileHashThread *worker = new ChecksumFileHashThread(&jobs);
+		workers.push_back(worker);
+		worker->start();
+	}
+	for(;jobs.hashNextFile() == true;) {
+	}
+	jobs.waitForWorkers();
+
+	for(unsigned int index = 0; index < workers.size(); ++index) {
+		if(workers[index]->shutdownAndWait() == true) {
+			delete workers[index];
+		}
+	}
+	workers.clear();
+
+	MutexSafeWrapper safeMutex(&Checksum::fileListCacheSynchAccessor,string(__FILE__) + "_" + intToStr(__LINE__));
+	for(unsigned int index = 0; index < jobs.pathList.size(); ++index) {
+		if(jobs.hashedList[index] == 1) {
+			Checksum::fileListCache[jobs.pathList[index]] = jobs.sumList[index];
+		}
+	}
+	safeMutex.ReleaseLock();
+
+	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Hashed " MG_SIZE_T_SPECIFIER " files on %d threads in " MG_I64_SPECIFIER " ms\n",uncachedList.size(),threadCount,chrono.getMillis());
+}
+
 uint32 Checksum::getSum() {
 	//printf("Getting checksum for files [%d]\n",fileList.size());
 	if(fileList.size() > 0) {
 		if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] fileList.size() = %d\n",__FILE__,__FUNCTION__,__LINE__,fileList.size());
 
+		addUncachedFilesToCache();
+
 		Checksum newResult;
 
 		{
@@ -376,10 +531,7 @@ uint32 Checksum::getSum() {
 
 			MutexSafeWrapper safeMutexSocketDestructorFlag(&Checksum::fileListCacheSynchAccessor,string(__FILE__) + "_" + intToStr(__LINE__));
 			if(Checksum::fileListCache.find(iterMap->first) == Checksum::fileListCache.end()) {
-				Checksum fileResult;
-				//bool fileAddedOk = fileResult.addFileToSum(iterMap->first);
-				fileResult.addFileToSum(iterMap->first);
-				Checksum::fileListCache[iterMap->first] = fileResult.getSum();
+				Checksum::fileListCache[iterMap->first] = getFileSum(iterMap->first);
 				//printf("fileAddedOk = %d for file [%s] CRC [%d]\n",fileAddedOk,iterMap->first.c_str(),Checksum::fileListCache[iterMap->first]);
 			}
 			else {
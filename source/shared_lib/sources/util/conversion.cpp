@@ -215,6 +215,80 @@ string formatNumber(uint64 f) {
 	return out.str();
 }
 
+static const char base64Chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+string base64Encode(const string &data) {
+	string result;
+	result.reserve(((data.size() + 2) / 3) * 4);
+
+	for(size_t i = 0; i < data.size(); i += 3) {
+		uint32 block = (uint32)(unsigned char)data[i] << 16;
+		if(i + 1 < data.size()) {
+			block |= (uint32)(unsigned char)data[i + 1] << 8;
+		}
+		if(i + 2 < data.size()) {
+			block |= (uint32)(unsigned char)data[i + 2];
+		}
+
+		result += base64Chars[(block >> 18) & 0x3F];
+		result += base64Chars[(block >> 12) & 0x3F];
+		result += (i + 1 < data.size() ? base64Chars[(block >> 6) & 0x3F] : '=');
+		result += (i + 2 < data.size() ? base64Chars[block & 0x3F] : '=');
+	}
+	return result;
+}
+
+bool base64Decode(const string &text, string &data) {
+	data.clear();
+	if(text.size() % 4 != 0) {
+		return false;
+	}
+	data.reserve((text.size() / 4) * 3);
+
+	for(size_t i = 0; i < text.size(); i += 4) {
+		uint32 block = 0;
+		int padding = 0;
+		for(size_t j = 0; j < 4; ++j) {
+			char c = text[i + j];
+			uint32 value = 0;
+			if(c >= 'A' && c <= 'Z') {
+				value = c - 'A';
+			}
+			else if(c >= 'a' && c <= 'z') {
+				value = c - 'a' + 26;
+			}
+			else if(c >= '0' && c <= '9') {
+				value = c - '0' + 52;
+			}
+			else if(c == '+') {
+				value = 62;
+			}
+			else if(c == '/') {
+				value = 63;
+			}
+			else if(c == '=' && i + 4 == text.size() && j >= 2) {
+				padding++;
+			}
+			else {
+				return false;
+			}
+			if(padding > 0 && c != '=') {
+				return false;
+			}
+			block = (block << 6) | value;
+		}
+
+		data += (char)((block >> 16) & 0xFF);
+		if(padding < 2) {
+			data += (char)((block >> 8) & 0xFF);
+		}
+		if(padding < 1) {
+			data += (char)(block & 0xFF);
+		}
+	}
+	return true;
+}
+
 double getTimeDuationMinutes(int frames, int updateFps) {
 	int framesleft = frames;
 	double hours = (int)((int) frames / (float)updateFps / 3600.0f);
@@ -85,6 +85,14 @@ std::size_t SystemFlags::getLogEntryBufferCount() {
     return ret;
 }
 
+std::size_t SystemFlags::getLogEntryDroppedCount() {
+    std::size_t ret = 0;
+    if(threadLogger != NULL && threadLogger->getRunningStatus() == true) {
+        ret = threadLogger->getLogEntryDroppedCount();
+    }
+    return ret;
+}
+
 size_t SystemFlags::httpWriteMemoryCallback(void *ptr, size_t size, size_t nmemb, void *data)
 {
   size_t realsize = size * nmemb;
@@ -436,12 +444,32 @@ void SystemFlags::handleDebug(DebugType type, const char *fmt, ...) {
     else {
         // Get the current time.
         time_t curtime = time (NULL);
-        logDebugEntry(type, (szBuf[0] != '\0' ? szBuf : ""), curtime);
+        logDebugEntry(type, (szBuf[0] != '\0' ? szBuf : ""), curtime, Thread::getCurrentThreadId());
     }
 }
 
+void SystemFlags::flushDebugLogs() {
+	if(SystemFlags::debugLogFileList == NULL) {
+		return;
+	}
+	for(std::map<SystemFlags::DebugType,SystemFlags::SystemFlagsType>::iterator iterMap = SystemFlags::debugLogFileList->begin();
+		iterMap != SystemFlags::debugLogFileList->end(); ++iterMap) {
+		SystemFlags::SystemFlagsType &currentDebugLog = iterMap->second;
+
+		// Shared streams are only flushed through their owner
+		if(currentDebugLog.fileStreamOwner == true &&
+			currentDebugLog.fileStream != NULL &&
+			currentDebugLog.fileStream->is_open() == true) {
+			static string mutexCodeLocation = string(extractFileFromDirectoryPath(__FILE__).c_str()) + "_" + intToStr(__LINE__);
+			MutexSafeWrapper safeMutex(currentDebugLog.mutex,mutexCodeLocation);
+			(*currentDebugLog.fileStream).flush();
+			safeMutex.ReleaseLock();
+		}
+	}
+}
+
 
-void SystemFlags::logDebugEntry(DebugType type, string debugEntry, time_t debugTime) {
+void SystemFlags::logDebugEntry(DebugType type, const string &debugEntry, time_t debugTime, unsigned long threadId, bool flushStream) {
 	if(SystemFlags::debugLogFileList == NULL) {
 		if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 		SystemFlags::init(false);
@@ -460,7 +488,10 @@ void SystemFlags::logDebugEntry(DebugType type, string debugEntry, time_t debugT
 		// Convert it to local time representation.
 		//struct tm *loctime = localtime (&debugTime);
 		std::tm loctime = threadsafe_localtime(debugTime);
-		strftime(szBuf2,100,"%Y-%m-%d %H:%M:%S",&loctime);
+		size_t stampLength = strftime(szBuf2,100,"%Y-%m-%d %H:%M:%S",&loctime);
+		if(threadId != 0) {
+			snprintf(&szBuf2[stampLength],100 - stampLength," T%lu",threadId);
+		}
     }
 /*
     va_list argList;
@@ -592,7 +623,9 @@ void SystemFlags::logDebugEntry(DebugType type, string debugEntry, time_t debugT
 			else {
 				(*currentDebugLog.fileStream) << debugEntry.c_str();
 			}
-			(*currentDebugLog.fileStream).flush();
+			if(flushStream == true) {
+				(*currentDebugLog.fileStream).flush();
+			}
 
 			safeMutex.ReleaseLock();
         }
@@ -620,13 +620,66 @@ XmlTree::~XmlTree() {
 	clearRootNode();
 }
 
+// =====================================================
+//	class XmlDocumentData
+// =====================================================
+
+XmlDocumentData::XmlDocumentData() {
+}
+
+XmlDocumentData::XmlDocumentData(const std::map<string,string> &tagValues) : tagValues(tagValues) {
+}
+
+int XmlDocumentData::internName(const string &name) {
+	std::map<string,int>::iterator iterFind = nameIds.find(name);
+	if(iterFind != nameIds.end()) {
+		return iterFind->second;
+	}
+	int nameId = (int)names.size();
+	iterFind = nameIds.insert(std::make_pair(name,nameId)).first;
+	names.push_back(&iterFind->first);
+	return nameId;
+}
+
+//returns -1 for names no node of this tree has
+int XmlDocumentData::findNameId(const string &name) const {
+	std::map<string,int>::const_iterator iterFind = nameIds.find(name);
+	if(iterFind != nameIds.end()) {
+		return iterFind->second;
+	}
+	return -1;
+}
+
 // =====================================================
 //	class XmlNode
 // =====================================================
 
+void XmlNode::init(XmlDocumentData *document, bool ownsDocument) {
+	this->document = document;
+	this->ownsDocument = ownsDocument;
+	nameId = -1;
+	textTagsPending = false;
+	skipUpdatePathClimbingParts = false;
+	childIndex = NULL;
+	superNode = NULL;
+}
+
 #if defined(WANT_XERCES)
 
-XmlNode::XmlNode(DOMNode *node, const std::map<string,string> &mapTagReplacementValues): superNode(NULL) {
+XmlNode::XmlNode(DOMNode *node, const std::map<string,string> &mapTagReplacementValues) {
+    if(node == NULL || node->getNodeName() == NULL) {
+        throw megaglest_runtime_error("XML structure seems to be corrupt!",true);
+    }
+	init(new XmlDocumentData(mapTagReplacementValues), true);
+	loadDOMNode(node);
+}
+
+XmlNode::XmlNode(DOMNode *node, XmlDocumentData *document) {
+	init(document, false);
+	loadDOMNode(node);
+}
+
+void XmlNode::loadDOMNode(DOMNode *node) {
     if(node == NULL || node->getNodeName() == NULL) {
         throw megaglest_runtime_error("XML structure seems to be corrupt!",true);
     }
@@ -634,11 +687,11 @@ XmlNode::XmlNode(DOMNode *node, const std::map<string,string> &mapTagReplacement
 	//get name
 	char str[strSize]="";
 	XMLString::transcode(node->getNodeName(), str, strSize-1);
-	name= str;
+	nameId= document->internName(str);
 
 	//check document
 	if(node->getNodeType() == DOMNode::DOCUMENT_NODE) {
-		name="document";
+		nameId= document->internName("document");
 	}
 
 	//check children
@@ -646,8 +699,8 @@ XmlNode::XmlNode(DOMNode *node, const std::map<string,string> &mapTagReplacement
         for(unsigned int i = 0; i < node->getChildNodes()->getLength(); ++i) {
             DOMNode *currentNode= node->getChildNodes()->item(i);
             if(currentNode != NULL && currentNode->getNodeType()==DOMNode::ELEMENT_NODE){
-                XmlNode *xmlNode= new XmlNode(currentNode, mapTagReplacementValues);
-                children.push_back(xmlNode);
+                XmlNode *xmlNode= new XmlNode(currentNode, document);
+                addChildNode(xmlNode);
             }
         }
 	}
@@ -658,7 +711,7 @@ XmlNode::XmlNode(DOMNode *node, const std::map<string,string> &mapTagReplacement
 		for(unsigned int i = 0; i < domAttributes->getLength(); ++i) {
 			DOMNode *currentNode= domAttributes->item(i);
 			if(currentNode->getNodeType() == DOMNode::ATTRIBUTE_NODE) {
-				XmlAttribute *xmlAttribute= new XmlAttribute(domAttributes->item(i), mapTagReplacementValues);
+				XmlAttribute *xmlAttribute= new XmlAttribute(domAttributes->item(i), *document->getTagValues());
 				attributes.push_back(xmlAttribute);
 			}
 		}
@@ -676,69 +729,136 @@ XmlNode::XmlNode(DOMNode *node, const std::map<string,string> &mapTagReplacement
 #endif
 
 XmlNode::XmlNode(xml_node<> *node, const std::map<string,string> &mapTagReplacementValues,
-		bool skipUpdatePathClimbingParts) : superNode(NULL) {
+		bool skipUpdatePathClimbingParts) {
+	if(node == NULL || node->name() == NULL) {
+        throw megaglest_runtime_error("XML structure seems to be corrupt!",true);
+    }
+	init(new XmlDocumentData(mapTagReplacementValues), true);
+	this->skipUpdatePathClimbingParts = skipUpdatePathClimbingParts;
+	loadRapidNode(node);
+}
+
+XmlNode::XmlNode(xml_node<> *node, XmlDocumentData *document, bool skipUpdatePathClimbingParts) {
+	init(document, false);
+	this->skipUpdatePathClimbingParts = skipUpdatePathClimbingParts;
+	loadRapidNode(node);
+}
+
+void XmlNode::loadRapidNode(xml_node<> *node) {
 	if(node == NULL || node->name() == NULL) {
         throw megaglest_runtime_error("XML structure seems to be corrupt!",true);
     }
 
 	//get name
-	name = node->name();
-	children.reserve(1000);
-	attributes.reserve(1000);
+	nameId = document->internName(node->name());
 
 	//check document
 	if(node->type() == node_document) {
-		name="document";
+		nameId = document->internName("document");
 	}
 
-	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Found XML Node\nName [%s]\nValue [%s]\n",name.c_str(),node->value());
+	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Found XML Node\nName [%s]\nValue [%s]\n",getName().c_str(),node->value());
 
 	//check children
 	for(xml_node<> *currentNode = node->first_node();
 			currentNode; currentNode = currentNode->next_sibling()) {
 		if(currentNode != NULL && currentNode->type() == node_element) {
-			XmlNode *xmlNode= new XmlNode(currentNode, mapTagReplacementValues, skipUpdatePathClimbingParts);
-			children.push_back(xmlNode);
+			XmlNode *xmlNode= new XmlNode(currentNode, document, skipUpdatePathClimbingParts);
+			addChildNode(xmlNode);
 		}
     }
 
 	//check attributes
 	for (xml_attribute<> *attr = node->first_attribute();
 			attr; attr = attr->next_attribute()) {
-		XmlAttribute *xmlAttribute= new XmlAttribute(attr, mapTagReplacementValues);
+		XmlAttribute *xmlAttribute= new XmlAttribute(attr, document->getTagValues());
 		attributes.push_back(xmlAttribute);
 	}
 
-	//get value
+	//get value, tags are applied when it is first read
 	if(node->type() == node_element && children.size() == 0) {
-		string xmlText = node->value();
-
-//		bool debugReplace = false;
-//		if(xmlText.find("{SCENARIOPATH}") != string::npos) {
-//			printf("\n----------------------\n** XML!! WILL REPLACE [%s]\n",xmlText.c_str());
-//			debugReplace = true;
-//		}
-		Properties::applyTagsToValue(xmlText,&mapTagReplacementValues, skipUpdatePathClimbingParts);
-//		if(debugReplace) {
-//			printf("\n\n** XML!! REPLACED WITH [%s]\n===================\n",xmlText.c_str());
-//		}
-		text = xmlText;
+		text = node->value();
+		textTagsPending = true;
 	}
 }
 
-XmlNode::XmlNode(const string &name): superNode(NULL) {
-	this->name= name;
+XmlNode::XmlNode(const string &name) {
+	init(new XmlDocumentData(), true);
+	nameId = document->internName(name);
+}
+
+XmlNode::XmlNode(const string &name, XmlDocumentData *document) {
+	init(document, false);
+	nameId = document->internName(name);
 }
 
 XmlNode::~XmlNode() {
+	clearChildIndex();
 	for(unsigned int i=0; i<children.size(); ++i) {
 		delete children[i];
 	}
 	children.clear();
+	childNameIds.clear();
 	for(unsigned int i=0; i<attributes.size(); ++i) {
 		delete attributes[i];
 	}
 	attributes.clear();
+
+	if(ownsDocument == true) {
+		delete document;
+	}
+	document = NULL;
+}
+
+const string &XmlNode::getText() const {
+	if(textTagsPending == true) {
+		Properties::applyTagsToValue(text,document->getTagValues(), skipUpdatePathClimbingParts);
+		textTagsPending = false;
+	}
+	return text;
+}
+
+void XmlNode::addChildNode(XmlNode *node) {
+	clearChildIndex();
+	children.push_back(node);
+	childNameIds.push_back(node->nameId);
+}
+
+void XmlNode::clearChildIndex() {
+	delete childIndex;
+	childIndex = NULL;
+}
+
+//returns the childIndex'th child with the given name id or NULL
+XmlNode *XmlNode::findChild(int childNameId, unsigned int childIndex) const {
+	if(childNameId < 0) {
+		return NULL;
+	}
+
+	if(children.size() > childIndexThreshold) {
+		if(this->childIndex == NULL) {
+			this->childIndex = new std::map<int, vector<XmlNode*> >();
+			for(unsigned int j = 0; j < children.size(); ++j) {
+				(*this->childIndex)[childNameIds[j]].push_back(children[j]);
+			}
+		}
+		std::map<int, vector<XmlNode*> >::const_iterator iterFind = this->childIndex->find(childNameId);
+		if(iterFind == this->childIndex->end() || childIndex >= iterFind->second.size()) {
+			return NULL;
+		}
+		return iterFind->second[childIndex];
+	}
+
+	unsigned int count= 0;
+	for(unsigned int j = 0; j < childNameIds.size(); ++j) {
+		if(childNameIds[j] == childNameId) {
+			if(count == childIndex) {
+				return children[j];
+			}
+			count++;
+		}
+	}
+	return NULL;
 }
 
 XmlAttribute *XmlNode::getAttribute(unsigned int i) const {
@@ -750,7 +870,7 @@ XmlAttribute *XmlNode::getAttribute(unsigned int i) const {
 
 XmlAttribute *XmlNode::getAttribute(const string &name,bool mustExist) const {
 	for(unsigned int i = 0; i < attributes.size(); ++i) {
-		if(attributes[i]->getName() == name) {
+		if(attributes[i]->name == name) {
 			return attributes[i];
 		}
 	}
@@ -764,7 +884,7 @@ XmlAttribute *XmlNode::getAttribute(const string &name,bool mustExist) const {
 bool XmlNode::hasAttribute(const string &name) const {
 	bool result = false;
 	for(unsigned int i = 0; i < attributes.size(); ++i) {
-		if(attributes[i]->getName() == name) {
+		if(attributes[i]->name == name) {
 			result = true;
 			break;
 		}
@@ -773,14 +893,19 @@ bool XmlNode::hasAttribute(const string &name) const {
 }
 
 int XmlNode::clearChild(const string &childName) {
+	int childNameId = document->findNameId(childName);
 	int clearChildCount = 0;
-	for(int i = (int)children.size()-1; i >= 0; --i) {
-		if(children[i]->getName() == childName) {
+	for(int i = (int)children.size()-1; i >= 0 && childNameId >= 0; --i) {
+		if(childNameIds[i] == childNameId) {
 			delete children[i];
 			children.erase(children.begin()+i);
+			childNameIds.erase(childNameIds.begin()+i);
 			clearChildCount++;
 		}
 	}
+	if(clearChildCount > 0) {
+		clearChildIndex();
+	}
 	return clearChildCount;
 }
 
@@ -794,8 +919,9 @@ XmlNode *XmlNode::getChild(unsigned int i) const {
 
 vector<XmlNode *> XmlNode::getChildList(const string &childName) const {
 	vector<XmlNode *> list;
-	for(unsigned int j = 0; j < children.size(); ++j) {
-		if(children[j]->getName() == childName) {
+	int childNameId = document->findNameId(childName);
+	for(unsigned int j = 0; j < childNameIds.size() && childNameId >= 0; ++j) {
+		if(childNameIds[j] == childNameId) {
 			list.push_back(children[j]);
 		}
 	}
@@ -808,31 +934,21 @@ XmlNode *XmlNode::getChild(const string &childName, unsigned int i) const {
 		return superNode->getChild(childName,i);
 	}
 	if(i >= children.size()) {
-		throw megaglest_runtime_error("\"" + name + "\" node doesn't have " + uIntToStr(i+1) +" children named \"" + childName + "\"\n\nTree: "+getTreeString(),true);
+		throw megaglest_runtime_error("\"" + getName() + "\" node doesn't have " + uIntToStr(i+1) +" children named \"" + childName + "\"\n\nTree: "+getTreeString(),true);
 	}
 
-	unsigned int count= 0;
-	for(unsigned int j = 0; j < children.size(); ++j) {
-		if(children[j]->getName() == childName) {
-			if(count == i) {
-				return children[j];
-			}
-			count++;
-		}
+	XmlNode *child = findChild(document->findNameId(childName), i);
+	if(child != NULL) {
+		return child;
 	}
 
 	throw megaglest_runtime_error("Node \""+getName()+"\" doesn't have " + uIntToStr(i+1) + " children named  \""+childName+"\"\n\nTree: "+getTreeString(),true);
 }
 
 bool XmlNode::hasChildNoSuper(const string &childName) const {
-	//int count= 0;
-	for(unsigned int j = 0; j < children.size(); ++j) {
-		if(children[j]->getName() == childName) {
-            return true;
-		}
-	}
-	return false;
+	return findChild(document->findNameId(childName), 0) != NULL;
 }
+
 XmlNode * XmlNode::getChildWithAliases(vector<string> childNameList, unsigned int childIndex) const {
 	for(int aliasIndex = 0; aliasIndex < (int)childNameList.size(); ++aliasIndex) {
 		const string &childName = childNameList[aliasIndex];
@@ -840,17 +956,12 @@ XmlNode * XmlNode::getChildWithAliases(vector<string> childNameList, unsigned in
 			return superNode->getChild(childName,childIndex);
 		}
 		if(childIndex >= children.size()) {
-			throw megaglest_runtime_error("\"" + name + "\" node doesn't have "+intToStr(childIndex+1)+" children named \"" + childName + "\"\n\nTree: "+getTreeString(),true);
+			throw megaglest_runtime_error("\"" + getName() + "\" node doesn't have "+intToStr(childIndex+1)+" children named \"" + childName + "\"\n\nTree: "+getTreeString(),true);
 		}
 
-		unsigned int count= 0;
-		for(unsigned int j = 0; j < children.size(); ++j) {
-			if(children[j]->getName() == childName) {
-				if(count == childIndex) {
-					return children[j];
-				}
-				count++;
-			}
+		XmlNode *child = findChild(document->findNameId(childName), childIndex);
+		if(child != NULL) {
+			return child;
 		}
 	}
 
@@ -860,18 +971,10 @@ XmlNode * XmlNode::getChildWithAliases(vector<string> childNameList, unsigned in
 bool XmlNode::hasChildAtIndex(const string &childName, int i) const {
 	if(superNode && !hasChildNoSuper(childName))
 		return superNode->hasChildAtIndex(childName,i);
-	int count= 0;
-	for(unsigned int j = 0; j < children.size(); ++j) {
-		//printf("Looking for [%s] at index: %d found [%s] index = %d\n",childName.c_str(),i,children[j]->getName().c_str(),j);
-		if(children[j]->getName()==childName) {
-            if(count == i) {
-				return true;
-			}
-			count++;
-		}
+	if(i < 0) {
+		return false;
 	}
-
-	return false;
+	return findChild(document->findNameId(childName), i) != NULL;
 }
 
 bool XmlNode::hasChild(const string &childName) const {
@@ -892,9 +995,9 @@ bool XmlNode::hasChildWithAliases(vector<string> childNameList) const {
 
 XmlNode *XmlNode::addChild(const string &name, const string text) {
 	assert(!superNode);
-	XmlNode *node= new XmlNode(name);
+	XmlNode *node= new XmlNode(name, document);
 	node->text = text;
-	children.push_back(node);
+	addChildNode(node);
 	return node;
 }
 
@@ -908,7 +1011,7 @@ XmlAttribute *XmlNode::addAttribute(const string &name, const string &value, con
 
 DOMElement *XmlNode::buildElement(XERCES_CPP_NAMESPACE_QUALIFIER DOMDocument *document) const{
 	XMLCh str[strSize];
-	XMLString::transcode(name.c_str(), str, strSize-1);
+	XMLString::transcode(getName().c_str(), str, strSize-1);
 
 	DOMElement *node= document->createElement(str);
 
@@ -932,7 +1035,7 @@ DOMElement *XmlNode::buildElement(XERCES_CPP_NAMESPACE_QUALIFIER DOMDocument *do
 #endif
 
 xml_node<>* XmlNode::buildElement(xml_document<> *document) const {
-	xml_node<>* node = document->allocate_node(node_element, document->allocate_string(name.c_str()));
+	xml_node<>* node = document->allocate_node(node_element, document->allocate_string(getName().c_str()));
 
 	for(unsigned int i = 0; i < attributes.size(); ++i) {
 		node->append_attribute(
@@ -978,13 +1081,13 @@ XmlAttribute::XmlAttribute(DOMNode *attribute, const std::map<string,string> &ma
 
 	skipRestrictionCheck 			= false;
 	usesCommondata 					= false;
-	this->mapTagReplacementValues 	= mapTagReplacementValues;
+	pendingTagValues 				= &mapTagReplacementValues;
 	char str[strSize]				= "";
 
 	XMLString::transcode(attribute->getNodeValue(), str, strSize-1);
 	value= str;
 	usesCommondata = ((value.find("$COMMONDATAPATH") != string::npos) || (value.find("%%COMMONDATAPATH%%") != string::npos));
-	skipRestrictionCheck = Properties::applyTagsToValue(this->value,&this->mapTagReplacementValues);
+	applyTags();
 
 	XMLString::transcode(attribute->getNodeName(), str, strSize-1);
 	name= str;
@@ -999,34 +1102,51 @@ XmlAttribute::XmlAttribute(xml_attribute<> *attribute, const std::map<string,str
 
 	skipRestrictionCheck 			= false;
 	usesCommondata 					= false;
-	if(mapTagReplacementValues.size() > 0) {
-		this->mapTagReplacementValues 	= mapTagReplacementValues;
-	}
-	//char str[strSize]				= "";
+	pendingTagValues 				= &mapTagReplacementValues;
+
+	value= attribute->value();
+	usesCommondata = ((value.find("$COMMONDATAPATH") != string::npos) || (value.find("%%COMMONDATAPATH%%") != string::npos));
+	applyTags();
+
+	name= attribute->name();
+}
+
+//tagValues belongs to the tree and outlives the attribute, so the tags are
+//only applied once the value is used
+XmlAttribute::XmlAttribute(xml_attribute<> *attribute, const std::map<string,string> *tagValues) {
+	if(attribute == NULL || attribute->name() == NULL) {
+        throw megaglest_runtime_error("XML attribute seems to be corrupt!");
+    }
+
+	skipRestrictionCheck 			= false;
+	pendingTagValues 				= tagValues;
 
-	//XMLString::transcode(attribute->getNodeValue(), str, strSize-1);
 	value= attribute->value();
 	usesCommondata = ((value.find("$COMMONDATAPATH") != string::npos) || (value.find("%%COMMONDATAPATH%%") != string::npos));
-	skipRestrictionCheck = Properties::applyTagsToValue(this->value,&this->mapTagReplacementValues);
 
-	//XMLString::transcode(attribute->getNodeName(), str, strSize-1);
 	name= attribute->name();
 }
 
 XmlAttribute::XmlAttribute(const string &name, const string &value, const std::map<string,string> &mapTagReplacementValues) {
 	skipRestrictionCheck 			= false;
 	usesCommondata 					= false;
-	if(mapTagReplacementValues.size() > 0) {
-		this->mapTagReplacementValues 	= mapTagReplacementValues;
-	}
+	pendingTagValues 				= &mapTagReplacementValues;
 	this->name						= name;
 	this->value						= value;
 
 	usesCommondata = ((value.find("$COMMONDATAPATH") != string::npos) || (value.find("%%COMMONDATAPATH%%") != string::npos));
-	skipRestrictionCheck = Properties::applyTagsToValue(this->value,&this->mapTagReplacementValues);
+	applyTags();
+}
+
+void XmlAttribute::applyTags() const {
+	if(pendingTagValues != NULL) {
+		skipRestrictionCheck = Properties::applyTagsToValue(this->value,pendingTagValues);
+		pendingTagValues = NULL;
+	}
 }
 
 bool XmlAttribute::getBoolValue() const {
+	applyTags();
 	if(value == "true") {
 		return true;
 	}
@@ -1039,14 +1159,17 @@ bool XmlAttribute::getBoolValue() const {
 }
 
 int XmlAttribute::getIntValue() const {
+	applyTags();
 	return strToInt(value);
 }
 
 uint32 XmlAttribute::getUIntValue() const {
+	applyTags();
 	return strToUInt(value);
 }
 
 int XmlAttribute::getIntValue(int min, int max) const {
+	applyTags();
 	int i= strToInt(value);
 	if(i<min || i>max){
 		throw megaglest_runtime_error("Xml Attribute int out of range: " + getName() + ": " + value,true);
@@ -1055,10 +1178,12 @@ int XmlAttribute::getIntValue(int min, int max) const {
 }
 
 float XmlAttribute::getFloatValue() const{
+	applyTags();
 	return strToFloat(value);
 }
 
 float XmlAttribute::getFloatValue(float min, float max) const{
+	applyTags();
 	float f= strToFloat(value);
 	//printf("getFloatValue f = %.10f [%s]\n",f,value.c_str());
 	if(f<min || f>max){
@@ -1068,6 +1193,7 @@ float XmlAttribute::getFloatValue(float min, float max) const{
 }
 
 const string XmlAttribute::getValue(string prefixValue, bool trimValueWithStartingSlash) const {
+	applyTags();
 	string result = value;
 	if(skipRestrictionCheck == false && usesCommondata == false) {
 		if(trimValueWithStartingSlash == true) {
@@ -1079,6 +1205,7 @@ const string XmlAttribute::getValue(string prefixValue, bool trimValueWithStarti
 }
 
 const string XmlAttribute::getRestrictedValue(string prefixValue, bool trimValueWithStartingSlash) const {
+	applyTags();
 	if(skipRestrictionCheck == false && usesCommondata == false) {
 		const string allowedCharacters = "abcdefghijklmnopqrstuvwxyz1234567890._-/";
 
@@ -1103,6 +1230,7 @@ const string XmlAttribute::getRestrictedValue(string prefixValue, bool trimValue
 
 void XmlAttribute::setValue(string val) {
 	value = val;
+	pendingTagValues = NULL;
 }
 
 }}//end namespace
@@ -0,0 +1,221 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#ifdef WIN32
+  #include <winsock2.h>
+  #include <winsock.h>
+#endif
+
+#include "flow_field.h"
+#include <algorithm>
+#include <cstdlib>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace Glest::Game;
+
+//
+// Tests for the group order flow fields: the distances the path finder
+// follows and the per faction cache of fields
+//
+class FlowFieldTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( FlowFieldTest );
+
+	CPPUNIT_TEST( test_Distances );
+	CPPUNIT_TEST( test_Obstacles );
+	CPPUNIT_TEST( test_Eviction );
+	CPPUNIT_TEST( test_Invalidation );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+	// a field over the w x h cells at origin with every cell passable
+	static void initField(FlowField &flowField, const Vec2i &origin, int w, int h) {
+		flowField.origin = origin;
+		flowField.size = Vec2i(w, h);
+		flowField.passable.assign(w * h, true);
+		flowField.goals.clear();
+	}
+
+	static void setPassable(FlowField &flowField, const Vec2i &pos, bool value) {
+		flowField.passable[(pos.y - flowField.origin.y) * flowField.size.x + pos.x - flowField.origin.x] = value;
+	}
+
+	// the fewest straight and diagonal steps between two cells
+	static int octileDistance(const Vec2i &pos1, const Vec2i &pos2) {
+		int dx = abs(pos1.x - pos2.x);
+		int dy = abs(pos1.y - pos2.y);
+		return FlowField::diagonalCost * std::min(dx, dy) + FlowField::straightCost * (std::max(dx, dy) - std::min(dx, dy));
+	}
+
+public:
+
+	void test_Distances() {
+		FlowField flowField;
+		initField(flowField, Vec2i(3, 2), 9, 7);
+		flowField.goals.insert(Vec2i(5, 4));
+		flowField.computeDistances();
+
+		CPPUNIT_ASSERT_EQUAL( 0, flowField.getDistance(Vec2i(5, 4)) );
+		CPPUNIT_ASSERT_EQUAL( 10, flowField.getDistance(Vec2i(6, 4)) );
+		CPPUNIT_ASSERT_EQUAL( 10, flowField.getDistance(Vec2i(5, 3)) );
+		CPPUNIT_ASSERT_EQUAL( 14, flowField.getDistance(Vec2i(4, 5)) );
+		CPPUNIT_ASSERT_EQUAL( 24, flowField.getDistance(Vec2i(7, 5)) );
+		CPPUNIT_ASSERT_EQUAL( 28, flowField.getDistance(Vec2i(3, 2)) );
+
+		// without obstacles every cell is as far as the fewest steps
+		for(int y = 2; y < 9; ++y) {
+			for(int x = 3; x < 12; ++x) {
+				CPPUNIT_ASSERT_EQUAL( octileDistance(Vec2i(x, y), Vec2i(5, 4)), flowField.getDistance(Vec2i(x, y)) );
+			}
+		}
+
+		// cells outside the field
+		CPPUNIT_ASSERT_EQUAL( -1, flowField.getDistance(Vec2i(2, 4)) );
+		CPPUNIT_ASSERT_EQUAL( -1, flowField.getDistance(Vec2i(12, 4)) );
+		CPPUNIT_ASSERT_EQUAL( -1, flowField.getDistance(Vec2i(5, 9)) );
+		CPPUNIT_ASSERT_EQUAL( false, flowField.isPassable(Vec2i(5, 1)) );
+
+		// several goals, each cell leads to the nearest one
+		flowField.goals.insert(Vec2i(11, 8));
+		flowField.computeDistances();
+		for(int y = 2; y < 9; ++y) {
+			for(int x = 3; x < 12; ++x) {
+				int expected = std::min(octileDistance(Vec2i(x, y), Vec2i(5, 4)), octileDistance(Vec2i(x, y), Vec2i(11, 8)));
+				CPPUNIT_ASSERT_EQUAL( expected, flowField.getDistance(Vec2i(x, y)) );
+			}
+		}
+
+		// a goal outside the field leaves it unreachable
+		flowField.goals.clear();
+		flowField.goals.insert(Vec2i(20, 20));
+		flowField.computeDistances();
+		CPPUNIT_ASSERT_EQUAL( -1, flowField.getDistance(Vec2i(5, 4)) );
+	}
+
+	void test_Obstacles() {
+		FlowField flowField;
+		initField(flowField, Vec2i(0, 0), 6, 6);
+		flowField.goals.insert(Vec2i(0, 0));
+
+		// the diagonal step may not cut the corner of a blocked cell
+		setPassable(flowField, Vec2i(1, 0), false);
+		flowField.computeDistances();
+		CPPUNIT_ASSERT_EQUAL( -1, flowField.getDistance(Vec2i(1, 0)) );
+		CPPUNIT_ASSERT_EQUAL( 20, flowField.getDistance(Vec2i(1, 1)) );
+		CPPUNIT_ASSERT_EQUAL( 30, flowField.getDistance(Vec2i(2, 1)) );
+
+		// a wall with a gap at the bottom is walked around, the gap can
+		// only be entered and left straight
+		for(int y = 0; y < 5; ++y) {
+			setPassable(flowField, Vec2i(3, y), false);
+		}
+		flowField.computeDistances();
+		CPPUNIT_ASSERT_EQUAL( 58, flowField.getDistance(Vec2i(2, 5)) );
+		CPPUNIT_ASSERT_EQUAL( 68, flowField.getDistance(Vec2i(3, 5)) );
+		CPPUNIT_ASSERT_EQUAL( 78, flowField.getDistance(Vec2i(4, 5)) );
+		CPPUNIT_ASSERT_EQUAL( 128, flowField.getDistance(Vec2i(4, 0)) );
+		CPPUNIT_ASSERT_EQUAL( 122, flowField.getDistance(Vec2i(5, 1)) );
+
+		// closing the gap cuts the right side off
+		setPassable(flowField, Vec2i(3, 5), false);
+		flowField.computeDistances();
+		for(int y = 0; y < 6; ++y) {
+			CPPUNIT_ASSERT_EQUAL( -1, flowField.getDistance(Vec2i(4, y)) );
+			CPPUNIT_ASSERT_EQUAL( -1, flowField.getDistance(Vec2i(5, y)) );
+		}
+		CPPUNIT_ASSERT_EQUAL( 50, flowField.getDistance(Vec2i(0, 5)) );
+	}
+
+	void test_Eviction() {
+		FlowFieldCache cache(3);
+		FlowFieldCache::Key key1(1, 0);
+		FlowFieldCache::Key key2(2, 0);
+		FlowFieldCache::Key key3(2, 1);
+		FlowFieldCache::Key key4(4, 0);
+
+		FlowField *flowField1 = cache.getFlowField(key1);
+		CPPUNIT_ASSERT_EQUAL( true, flowField1->dirty );
+		flowField1->dirty = false;
+		cache.getFlowField(key2);
+		cache.getFlowField(key3);
+		CPPUNIT_ASSERT_EQUAL( 3, cache.getCount() );
+
+		// the same key gives back the same field
+		CPPUNIT_ASSERT( cache.getFlowField(key1) == flowField1 );
+		CPPUNIT_ASSERT_EQUAL( false, flowField1->dirty );
+
+		// a fourth field replaces the one used longest ago
+		cache.getFlowField(key4);
+		CPPUNIT_ASSERT_EQUAL( 3, cache.getCount() );
+		CPPUNIT_ASSERT_EQUAL( true, cache.hasFlowField(key1) );
+		CPPUNIT_ASSERT_EQUAL( false, cache.hasFlowField(key2) );
+		CPPUNIT_ASSERT_EQUAL( true, cache.hasFlowField(key3) );
+		CPPUNIT_ASSERT_EQUAL( true, cache.hasFlowField(key4) );
+
+		cache.getFlowField(key3);
+		cache.getFlowField(key2);
+		CPPUNIT_ASSERT_EQUAL( false, cache.hasFlowField(key1) );
+		CPPUNIT_ASSERT_EQUAL( true, cache.hasFlowField(key2) );
+		CPPUNIT_ASSERT_EQUAL( true, cache.hasFlowField(key3) );
+		CPPUNIT_ASSERT_EQUAL( true, cache.hasFlowField(key4) );
+
+		cache.clear();
+		CPPUNIT_ASSERT_EQUAL( true, cache.empty() );
+	}
+
+	void test_Invalidation() {
+		FlowFieldCache cache(4);
+		FlowField *team0Field = cache.getFlowField(FlowFieldCache::Key(1, 0));
+		FlowField *team1Field = cache.getFlowField(FlowFieldCache::Key(2, 0));
+		FlowField *flowFields[] = { team0Field, team1Field };
+		for(int i = 0; i < 2; ++i) {
+			initField(*flowFields[i], Vec2i(10, 10), 8, 8);
+			flowFields[i]->teamIndex = i;
+			flowFields[i]->unitSize = 2;
+			flowFields[i]->dirty = false;
+		}
+
+		// changes the units of the field can not reach
+		cache.markDirty(Vec2i(6, 12), 1, -1);
+		cache.markDirty(Vec2i(12, 19), 1, -1);
+		cache.markDirty(Vec2i(2, 2), 4, -1);
+		CPPUNIT_ASSERT_EQUAL( false, team0Field->dirty );
+		CPPUNIT_ASSERT_EQUAL( false, team1Field->dirty );
+
+		// only the fields of the team that saw the change
+		cache.markDirty(Vec2i(7, 12), 1, 1);
+		CPPUNIT_ASSERT_EQUAL( false, team0Field->dirty );
+		CPPUNIT_ASSERT_EQUAL( true, team1Field->dirty );
+
+		// a building whose cells start before the field still covers it
+		team1Field->dirty = false;
+		cache.markDirty(Vec2i(4, 4), 4, 0);
+		CPPUNIT_ASSERT_EQUAL( true, team0Field->dirty );
+		CPPUNIT_ASSERT_EQUAL( false, team1Field->dirty );
+
+		// changes seen by every team
+		team0Field->dirty = false;
+		cache.markDirty(Vec2i(18, 18), 1, -1);
+		CPPUNIT_ASSERT_EQUAL( true, team0Field->dirty );
+		CPPUNIT_ASSERT_EQUAL( true, team1Field->dirty );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( FlowFieldTest );
+//
@@ -0,0 +1,788 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#ifdef WIN32
+  #include <winsock2.h>
+  #include <winsock.h>
+#endif
+
+#include "network_message.h"
+#include "network_protocol.h"
+#include "platform_common.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using Shared::PlatformCommon::Chrono;
+
+namespace Glest{ namespace Game{
+
+//
+// Tests that the serialize() schemas of the packed network messages write
+// the same bytes as the pack() format strings they replaced, so older
+// clients still understand them. The launch message, whose format string
+// was broken, is checked field by field against the pack() encodings
+//
+class NetworkMessageTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( NetworkMessageTest );
+
+	CPPUNIT_TEST( test_Intro );
+	CPPUNIT_TEST( test_PingReadyQuit );
+	CPPUNIT_TEST( test_CommandList );
+	CPPUNIT_TEST( test_Text );
+	CPPUNIT_TEST( test_FileMessages );
+	CPPUNIT_TEST( test_SwitchSetupRequest );
+	CPPUNIT_TEST( test_PlayerIndexAndLoadingStatus );
+	CPPUNIT_TEST( test_CellMessages );
+	CPPUNIT_TEST( test_Launch );
+	CPPUNIT_TEST( test_SynchNetworkGameData );
+	CPPUNIT_TEST( test_EncodeDecodeTime );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+	static const unsigned int maxPackedSize = 2048;
+
+	// writes the message with its schema, compares the bytes with the old
+	// pack() output, then reads them back and checks they pack the same
+	template<class Message, class Data>
+	void checkMessage(const unsigned char *expected, unsigned int expectedSize, int8 messageType, Data &data) {
+		NetworkPackedSize size;
+		Message::serialize(size, messageType, data);
+		CPPUNIT_ASSERT_EQUAL( expectedSize, size.getSize() );
+
+		std::vector<unsigned char> packed(expectedSize + 1, 0xCD);
+		NetworkPacker packer(&packed[0], size.getSize());
+		Message::serialize(packer, messageType, data);
+		CPPUNIT_ASSERT_EQUAL( expectedSize, packer.getSize() );
+		CPPUNIT_ASSERT( memcmp(expected, &packed[0], expectedSize) == 0 );
+
+		int8 readType = 0;
+		Data readData = Data();
+		NetworkUnpacker unpacker(&packed[0], size.getSize());
+		Message::serialize(unpacker, readType, readData);
+		CPPUNIT_ASSERT_EQUAL( (int)messageType, (int)readType );
+
+		std::vector<unsigned char> repacked(expectedSize + 1, 0xCD);
+		NetworkPacker repacker(&repacked[0], size.getSize());
+		Message::serialize(repacker, readType, readData);
+		CPPUNIT_ASSERT( packed == repacked );
+	}
+
+	// packs and unpacks the message iterations times with its schema and
+	// prints how long it took
+	template<class Message, class Data>
+	void timeMessage(const char *name, int8 messageType, Data &data, int iterations) {
+		NetworkPackedSize size;
+		Message::serialize(size, messageType, data);
+		std::vector<unsigned char> packed(size.getSize() + 1);
+
+		Chrono chrono;
+		chrono.start();
+		for(int i = 0; i < iterations; ++i) {
+			NetworkPacker packer(&packed[0], size.getSize());
+			Message::serialize(packer, messageType, data);
+		}
+		int64 encodeMicros = chrono.getMicros();
+
+		int8 readType = 0;
+		Data *readData = new Data();
+		chrono.start();
+		for(int i = 0; i < iterations; ++i) {
+			NetworkUnpacker unpacker(&packed[0], size.getSize());
+			Message::serialize(unpacker, readType, *readData);
+		}
+		int64 decodeMicros = chrono.getMicros();
+		delete readData;
+		CPPUNIT_ASSERT_EQUAL( (int)messageType, (int)readType );
+
+		printMessageTime(name, size.getSize(), iterations, encodeMicros, decodeMicros);
+	}
+
+	static void printMessageTime(const char *name, unsigned int packedSize, int iterations, int64 encodeMicros, int64 decodeMicros) {
+		double megaBytes = (double)packedSize * iterations / (1024.0 * 1024.0);
+		printf("%-36s %6u bytes  encode %8.1f MB/s  decode %8.1f MB/s\n", name, packedSize,
+				megaBytes * 1000000.0 / (double)(encodeMicros > 0 ? encodeMicros : 1),
+				megaBytes * 1000000.0 / (double)(decodeMicros > 0 ? decodeMicros : 1));
+	}
+
+public:
+
+	void test_Intro() {
+		int8 messageType = nmtIntro;
+		NetworkMessageIntro::Data data;
+		data.sessionId = -123456;
+		data.versionString = string("v3.13.0-dev");
+		// a name filling the whole buffer
+		data.name = string("abcdefghijklmnopqrstuvwxyz01234");
+		data.playerIndex = -2;
+		data.gameState = nmgstOk;
+		data.externalIp = 0xDEADBEEF;
+		data.ftpPort = 61357;
+		data.language = string("english");
+		data.gameInProgress = 1;
+		data.playerUUID = string("a8f0b3c2-64e1-4c6e-9d3b-0f7b1e2d3c4a");
+		data.platform = string("");
+
+		unsigned char expected[maxPackedSize];
+		unsigned int expectedSize = pack(expected, "cl128s32shcLL60sc60s60s",
+				messageType,
+				data.sessionId,
+				data.versionString.getBuffer(),
+				data.name.getBuffer(),
+				data.playerIndex,
+				data.gameState,
+				data.externalIp,
+				data.ftpPort,
+				data.language.getBuffer(),
+				data.gameInProgress,
+				data.playerUUID.getBuffer(),
+				data.platform.getBuffer());
+		checkMessage<NetworkMessageIntro>(expected, expectedSize, messageType, data);
+	}
+
+	void test_PingReadyQuit() {
+		int8 messageType = nmtPing;
+		NetworkMessagePing::Data ping;
+		ping.pingFrequency = 1000;
+		ping.pingTime = -9876543210LL;
+
+		unsigned char expected[maxPackedSize];
+		unsigned int expectedSize = pack(expected, "clq",
+				messageType,
+				ping.pingFrequency,
+				ping.pingTime);
+		checkMessage<NetworkMessagePing>(expected, expectedSize, messageType, ping);
+
+		messageType = nmtReady;
+		NetworkMessageReady::Data ready;
+		ready.checksum = 0xFEDCBA98;
+		expectedSize = pack(expected, "cL",
+				messageType,
+				ready.checksum);
+		checkMessage<NetworkMessageReady>(expected, expectedSize, messageType, ready);
+
+		messageType = nmtQuit;
+		expectedSize = pack(expected, "c", messageType);
+
+		NetworkPackedSize size;
+		NetworkMessageQuit::serialize(size, messageType);
+		CPPUNIT_ASSERT_EQUAL( expectedSize, size.getSize() );
+
+		unsigned char packed[maxPackedSize];
+		NetworkPacker packer(packed, size.getSize());
+		NetworkMessageQuit::serialize(packer, messageType);
+		CPPUNIT_ASSERT( memcmp(expected, packed, expectedSize) == 0 );
+	}
+
+	void test_CommandList() {
+		NetworkMessageCommandList::Data data;
+		data.messageType = nmtCommandList;
+		data.header.commandCount = 65000;
+		data.header.frameCount = -77;
+		for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+			data.header.networkPlayerFactionCRC[i] = 0x80000001u + i * 0x01010101u;
+		}
+
+		// only the first 8 CRCs are on the wire
+		unsigned char expected[maxPackedSize];
+		unsigned int expectedSize = pack(expected, "cHlLLLLLLLL",
+				data.messageType,
+				data.header.commandCount,
+				data.header.frameCount,
+				data.header.networkPlayerFactionCRC[0],
+				data.header.networkPlayerFactionCRC[1],
+				data.header.networkPlayerFactionCRC[2],
+				data.header.networkPlayerFactionCRC[3],
+				data.header.networkPlayerFactionCRC[4],
+				data.header.networkPlayerFactionCRC[5],
+				data.header.networkPlayerFactionCRC[6],
+				data.header.networkPlayerFactionCRC[7]);
+
+		NetworkPackedSize size;
+		NetworkMessageCommandList::serializeHeader(size, data);
+		CPPUNIT_ASSERT_EQUAL( expectedSize, size.getSize() );
+
+		unsigned char packed[maxPackedSize];
+		NetworkPacker packer(packed, size.getSize());
+		NetworkMessageCommandList::serializeHeader(packer, data);
+		CPPUNIT_ASSERT( memcmp(expected, packed, expectedSize) == 0 );
+
+		NetworkMessageCommandList::Data readData = NetworkMessageCommandList::Data();
+		NetworkUnpacker unpacker(packed, size.getSize());
+		NetworkMessageCommandList::serializeHeader(unpacker, readData);
+		CPPUNIT_ASSERT_EQUAL( data.header.commandCount, readData.header.commandCount );
+		CPPUNIT_ASSERT_EQUAL( data.header.frameCount, readData.header.frameCount );
+		CPPUNIT_ASSERT_EQUAL( data.header.networkPlayerFactionCRC[7], readData.header.networkPlayerFactionCRC[7] );
+		CPPUNIT_ASSERT_EQUAL( (uint32)0, readData.header.networkPlayerFactionCRC[8] );
+
+		// the commands follow the header one after the other
+		NetworkCommand command;
+		command.networkCommandType = nctGiveCommand;
+		command.unitId = 123456;
+		command.unitTypeId = -1;
+		command.commandTypeId = 7;
+		command.positionX = 250;
+		command.positionY = -3;
+		command.targetId = -1;
+		command.wantQueue = 1;
+		command.fromFactionIndex = 3;
+		command.unitFactionUnitCount = 40000;
+		command.unitFactionIndex = 2;
+		command.commandStateType = -1;
+		command.commandStateValue = 0x7FFFFFFF;
+		command.unitCommandGroupId = -123;
+
+		expectedSize = pack(expected, "hlhhhhlccHccll",
+				command.networkCommandType,
+				command.unitId,
+				command.unitTypeId,
+				command.commandTypeId,
+				command.positionX,
+				command.positionY,
+				command.targetId,
+				command.wantQueue,
+				command.fromFactionIndex,
+				command.unitFactionUnitCount,
+				command.unitFactionIndex,
+				command.commandStateType,
+				command.commandStateValue,
+				command.unitCommandGroupId);
+
+		NetworkPackedSize commandSize;
+		command.serialize(commandSize);
+		CPPUNIT_ASSERT_EQUAL( expectedSize, commandSize.getSize() );
+
+		NetworkPacker commandPacker(packed, commandSize.getSize());
+		command.serialize(commandPacker);
+		CPPUNIT_ASSERT( memcmp(expected, packed, expectedSize) == 0 );
+
+		NetworkCommand readCommand;
+		NetworkUnpacker commandUnpacker(packed, commandSize.getSize());
+		readCommand.serialize(commandUnpacker);
+		CPPUNIT_ASSERT_EQUAL( command.unitId, readCommand.unitId );
+		CPPUNIT_ASSERT_EQUAL( command.positionY, readCommand.positionY );
+		CPPUNIT_ASSERT_EQUAL( command.unitFactionUnitCount, readCommand.unitFactionUnitCount );
+		CPPUNIT_ASSERT_EQUAL( command.unitCommandGroupId, readCommand.unitCommandGroupId );
+	}
+
+	void test_Text() {
+		int8 messageType = nmtText;
+		NetworkMessageText::Data data;
+		data.text = string("gg, well played");
+		data.teamIndex = -1;
+		data.playerIndex = 5;
+		data.targetLanguage = string("deutsch");
+
+		unsigned char expected[maxPackedSize];
+		unsigned int expectedSize = pack(expected, "c500scc60s",
+				messageType,
+				data.text.getBuffer(),
+				data.teamIndex,
+				data.playerIndex,
+				data.targetLanguage.getBuffer());
+		checkMessage<NetworkMessageText>(expected, expectedSize, messageType, data);
+	}
+
+	void test_FileMessages() {
+		int8 messageType = nmtSynchNetworkGameDataFileCRCCheck;
+		NetworkMessageSynchNetworkGameDataFileCRCCheck::Data check;
+		check.totalFileCount = 300;
+		check.fileIndex = 299;
+		check.fileCRC = 0xCAFEBABE;
+		check.fileName = string("/techs/megapack/factions/magic/magic.xml");
+
+		unsigned char expected[maxPackedSize];
+		unsigned int expectedSize = pack(expected, "cLLL256s",
+				messageType,
+				check.totalFileCount,
+				check.fileIndex,
+				check.fileCRC,
+				check.fileName.getBuffer());
+		checkMessage<NetworkMessageSynchNetworkGameDataFileCRCCheck>(expected, expectedSize, messageType, check);
+
+		messageType = nmtSynchNetworkGameDataFileGet;
+		NetworkMessageSynchNetworkGameDataFileGet::Data get;
+		get.fileName = string("/maps/conflict.gbm");
+		expectedSize = pack(expected, "c256s",
+				messageType,
+				get.fileName.getBuffer());
+		checkMessage<NetworkMessageSynchNetworkGameDataFileGet>(expected, expectedSize, messageType, get);
+	}
+
+	void test_SwitchSetupRequest() {
+		int8 messageType = nmtSwitchSetupRequest;
+		SwitchSetupRequest::Data data;
+		data.selectedFactionName = string("tech");
+		data.currentSlotIndex = 1;
+		data.toSlotIndex = -1;
+		data.toTeam = 4;
+		data.networkPlayerName = string("player two");
+		data.networkPlayerStatus = 2;
+		data.switchFlags = 3;
+		data.language = string("english");
+
+		unsigned char expected[maxPackedSize];
+		unsigned int expectedSize = pack(expected, "c256sccc80scc60s",
+				messageType,
+				data.selectedFactionName.getBuffer(),
+				data.currentSlotIndex,
+				data.toSlotIndex,
+				data.toTeam,
+				data.networkPlayerName.getBuffer(),
+				data.networkPlayerStatus,
+				data.switchFlags,
+				data.language.getBuffer());
+		checkMessage<SwitchSetupRequest>(expected, expectedSize, messageType, data);
+	}
+
+	void test_PlayerIndexAndLoadingStatus() {
+		int8 messageType = nmtPlayerIndexMessage;
+		PlayerIndexMessage::Data index;
+		index.playerIndex = 7;
+
+		unsigned char expected[maxPackedSize];
+		unsigned int expectedSize = pack(expected, "ch",
+				messageType,
+				index.playerIndex);
+		checkMessage<PlayerIndexMessage>(expected, expectedSize, messageType, index);
+
+		messageType = nmtLoadingStatusMessage;
+		NetworkMessageLoadingStatus::Data status;
+		status.status = 0x00FF00FF;
+		expectedSize = pack(expected, "cL",
+				messageType,
+				status.status);
+		checkMessage<NetworkMessageLoadingStatus>(expected, expectedSize, messageType, status);
+	}
+
+	void test_CellMessages() {
+		int8 messageType = nmtMarkCell;
+		NetworkMessageMarkCell::Data mark;
+		mark.targetX = 511;
+		mark.targetY = -1;
+		mark.factionIndex = 6;
+		mark.playerIndex = -1;
+		mark.text = string("attack here");
+
+		unsigned char expected[maxPackedSize];
+		unsigned int expectedSize = pack(expected, "chhcc500s",
+				messageType,
+				mark.targetX,
+				mark.targetY,
+				mark.factionIndex,
+				mark.playerIndex,
+				mark.text.getBuffer());
+		checkMessage<NetworkMessageMarkCell>(expected, expectedSize, messageType, mark);
+
+		messageType = nmtUnMarkCell;
+		NetworkMessageUnMarkCell::Data unmark;
+		unmark.targetX = 12;
+		unmark.targetY = 300;
+		unmark.factionIndex = 0;
+		expectedSize = pack(expected, "chhc",
+				messageType,
+				unmark.targetX,
+				unmark.targetY,
+				unmark.factionIndex);
+		checkMessage<NetworkMessageUnMarkCell>(expected, expectedSize, messageType, unmark);
+
+		messageType = nmtHighlightCell;
+		NetworkMessageHighlightCell::Data highlight;
+		highlight.targetX = -5;
+		highlight.targetY = 32767;
+		highlight.factionIndex = 9;
+		expectedSize = pack(expected, "chhc",
+				messageType,
+				highlight.targetX,
+				highlight.targetY,
+				highlight.factionIndex);
+		checkMessage<NetworkMessageHighlightCell>(expected, expectedSize, messageType, highlight);
+	}
+
+	void test_Launch() {
+		int8 messageType = nmtLaunch;
+		NetworkMessageLaunch::Data *data = new NetworkMessageLaunch::Data();
+		data->description = string("Launching game...");
+		data->map = string("conflict");
+		data->tileset = string("forest");
+		data->tech = string("zetapack");
+		for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+			data->factionTypeNames[i] = string("faction_") + char('a' + i);
+			data->networkPlayerNames[i] = string("player ") + char('0' + i);
+			data->networkPlayerPlatform[i] = string("Linux");
+			data->networkPlayerStatuses[i] = -i;
+			data->networkPlayerLanguages[i] = string("english");
+			data->factionControls[i] = i % 5;
+			data->resourceMultiplierIndex[i] = 5 + i;
+			data->teams[i] = i / 2;
+			data->startLocationIndex[i] = GameConstants::maxPlayers - 1 - i;
+			data->networkPlayerUUID[i] = string("uuid-") + char('a' + i);
+		}
+		data->mapCRC = 0x89ABCDEF;
+		data->mapFilter = -3;
+		data->tilesetCRC = 0x01020304;
+		data->techCRC = 0xF0E0D0C0;
+		for(int i = 0; i < NetworkMessageLaunch::maxFactionCRCCount; ++i) {
+			data->factionNameList[i] = string("crc_faction_") + char('a' + i);
+			data->factionCRCList[i] = 0x10000000u * (i % 16) + i;
+		}
+		data->thisFactionIndex = 9;
+		data->factionCount = GameConstants::maxPlayers;
+		data->defaultResources = 1;
+		data->defaultUnits = 0;
+		data->defaultVictoryConditions = 1;
+		data->fogOfWar = 1;
+		data->allowObservers = 0;
+		data->enableObserverModeAtEndGame = 1;
+		data->enableServerControlledAI = 1;
+		data->networkFramePeriod = 200;
+		data->networkPauseGameForLaggedClients = 0;
+		data->pathFinderType = 1;
+		data->flagTypes1 = 0x80000003;
+		data->aiAcceptSwitchTeamPercentChance = 30;
+		data->cpuReplacementMultiplier = 10;
+		data->masterserver_admin = -1;
+		data->masterserver_admin_factionIndex = 1234567;
+		data->scenario = string("");
+		data->networkAllowNativeLanguageTechtree = 1;
+		data->gameUUID = string("5e1f3f4c-0a5b-4d6e-8f7a-1b2c3d4e5f60");
+
+		// the old format string sent mapFilter as a 32 bit value in place
+		// of mapCRC and ran out of arguments. The fields are now sent in
+		// Data order, each with the pack() encoding of its type, for every
+		// player slot
+		std::vector<unsigned char> expected(sizeof(NetworkMessageLaunch::Data) * 2);
+		unsigned char *pos = &expected[0];
+		pos += pack(pos, "c256s60s60s60s", messageType, data->description.getBuffer(),
+				data->map.getBuffer(), data->tileset.getBuffer(), data->tech.getBuffer());
+		for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+			pos += pack(pos, "60s", data->factionTypeNames[i].getBuffer());
+		}
+		for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+			pos += pack(pos, "60s", data->networkPlayerNames[i].getBuffer());
+		}
+		for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+			pos += pack(pos, "60s", data->networkPlayerPlatform[i].getBuffer());
+		}
+		for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+			pos += pack(pos, "l", data->networkPlayerStatuses[i]);
+		}
+		for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+			pos += pack(pos, "60s", data->networkPlayerLanguages[i].getBuffer());
+		}
+		pos += pack(pos, "LcLL", data->mapCRC, data->mapFilter, data->tilesetCRC, data->techCRC);
+		for(int i = 0; i < NetworkMessageLaunch::maxFactionCRCCount; ++i) {
+			pos += pack(pos, "60s", data->factionNameList[i].getBuffer());
+		}
+		for(int i = 0; i < NetworkMessageLaunch::maxFactionCRCCount; ++i) {
+			pos += pack(pos, "L", data->factionCRCList[i]);
+		}
+		for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+			pos += pack(pos, "c", data->factionControls[i]);
+		}
+		for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+			pos += pack(pos, "c", data->resourceMultiplierIndex[i]);
+		}
+		pos += pack(pos, "cc", data->thisFactionIndex, data->factionCount);
+		for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+			pos += pack(pos, "c", data->teams[i]);
+		}
+		for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+			pos += pack(pos, "c", data->startLocationIndex[i]);
+		}
+		pos += pack(pos, "cccccccCccLccll256s",
+				data->defaultResources,
+				data->defaultUnits,
+				data->defaultVictoryConditions,
+				data->fogOfWar,
+				data->allowObservers,
+				data->enableObserverModeAtEndGame,
+				data->enableServerControlledAI,
+				data->networkFramePeriod,
+				data->networkPauseGameForLaggedClients,
+				data->pathFinderType,
+				data->flagTypes1,
+				data->aiAcceptSwitchTeamPercentChance,
+				data->cpuReplacementMultiplier,
+				data->masterserver_admin,
+				data->masterserver_admin_factionIndex,
+				data->scenario.getBuffer());
+		for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+			pos += pack(pos, "60s", data->networkPlayerUUID[i].getBuffer());
+		}
+		pos += pack(pos, "c60s", data->networkAllowNativeLanguageTechtree, data->gameUUID.getBuffer());
+		unsigned int expectedSize = (unsigned int)(pos - &expected[0]);
+
+		checkMessage<NetworkMessageLaunch>(&expected[0], expectedSize, messageType, *data);
+
+		// the fields the old format lost or overran
+		int8 readType = 0;
+		NetworkMessageLaunch::Data *readData = new NetworkMessageLaunch::Data();
+		NetworkUnpacker unpacker(&expected[0], expectedSize);
+		NetworkMessageLaunch::serialize(unpacker, readType, *readData);
+		CPPUNIT_ASSERT_EQUAL( data->mapCRC, readData->mapCRC );
+		CPPUNIT_ASSERT_EQUAL( (int)data->mapFilter, (int)readData->mapFilter );
+		CPPUNIT_ASSERT_EQUAL( data->tilesetCRC, readData->tilesetCRC );
+		CPPUNIT_ASSERT_EQUAL( data->techCRC, readData->techCRC );
+		CPPUNIT_ASSERT_EQUAL( data->factionCRCList[19], readData->factionCRCList[19] );
+		CPPUNIT_ASSERT_EQUAL( (int)data->networkFramePeriod, (int)readData->networkFramePeriod );
+		CPPUNIT_ASSERT_EQUAL( (int)data->startLocationIndex[GameConstants::maxPlayers - 1], (int)readData->startLocationIndex[GameConstants::maxPlayers - 1] );
+		CPPUNIT_ASSERT_EQUAL( data->networkPlayerUUID[GameConstants::maxPlayers - 1].getString(), readData->networkPlayerUUID[GameConstants::maxPlayers - 1].getString() );
+		CPPUNIT_ASSERT_EQUAL( data->gameUUID.getString(), readData->gameUUID.getString() );
+		delete readData;
+		delete data;
+	}
+
+	void test_SynchNetworkGameData() {
+		NetworkMessageSynchNetworkGameData::Data *data = new NetworkMessageSynchNetworkGameData::Data();
+		data->messageType = nmtSynchNetworkGameData;
+		data->header.map = string("conflict");
+		data->header.tileset = string("forest");
+		data->header.tech = string("zetapack");
+		data->header.mapCRC = 0x11223344;
+		data->header.tilesetCRC = 0x55667788;
+		data->header.techCRC = 0x99AABBCC;
+		data->header.techCRCFileCount = NetworkMessageSynchNetworkGameData::maxFileCRCCount;
+		for(int i = 0; i < NetworkMessageSynchNetworkGameData::maxFileCRCCount; ++i) {
+			data->detail.techCRCFileList[i] = "/techs/zetapack/file_" + intToStr(i) + ".xml";
+			data->detail.techCRCFileCRCList[i] = 0x9E3779B9u * (i + 1);
+		}
+
+		unsigned char expected[maxPackedSize];
+		unsigned int expectedSize = pack(expected, "c255s255s255sLLLL",
+				data->messageType,
+				data->header.map.getBuffer(),
+				data->header.tileset.getBuffer(),
+				data->header.tech.getBuffer(),
+				data->header.mapCRC,
+				data->header.tilesetCRC,
+				data->header.techCRC,
+				data->header.techCRCFileCount);
+
+		NetworkPackedSize size;
+		NetworkMessageSynchNetworkGameData::serializeHeader(size, *data);
+		CPPUNIT_ASSERT_EQUAL( expectedSize, size.getSize() );
+
+		unsigned char packed[maxPackedSize];
+		NetworkPacker packer(packed, size.getSize());
+		NetworkMessageSynchNetworkGameData::serializeHeader(packer, *data);
+		CPPUNIT_ASSERT( memcmp(expected, packed, expectedSize) == 0 );
+
+		NetworkMessageSynchNetworkGameData::Data *readData = new NetworkMessageSynchNetworkGameData::Data();
+		NetworkUnpacker unpacker(packed, size.getSize());
+		NetworkMessageSynchNetworkGameData::serializeHeader(unpacker, *readData);
+		CPPUNIT_ASSERT_EQUAL( (int)data->messageType, (int)readData->messageType );
+		CPPUNIT_ASSERT_EQUAL( data->header.tech.getString(), readData->header.tech.getString() );
+		CPPUNIT_ASSERT_EQUAL( data->header.techCRC, readData->header.techCRC );
+		CPPUNIT_ASSERT_EQUAL( data->header.techCRCFileCount, readData->header.techCRCFileCount );
+
+		// every file name, then every CRC
+		std::vector<unsigned char> expectedDetail(sizeof(NetworkMessageSynchNetworkGameData::DataDetail) * 2);
+		unsigned char *pos = &expectedDetail[0];
+		for(int i = 0; i < NetworkMessageSynchNetworkGameData::maxFileCRCCount; ++i) {
+			pos += pack(pos, "255s", data->detail.techCRCFileList[i].getBuffer());
+		}
+		for(int i = 0; i < NetworkMessageSynchNetworkGameData::maxFileCRCCount; ++i) {
+			pos += pack(pos, "L", data->detail.techCRCFileCRCList[i]);
+		}
+		unsigned int expectedDetailSize = (unsigned int)(pos - &expectedDetail[0]);
+
+		NetworkPackedSize detailSize;
+		NetworkMessageSynchNetworkGameData::serializeDetail(detailSize, data->detail);
+		CPPUNIT_ASSERT_EQUAL( expectedDetailSize, detailSize.getSize() );
+
+		std::vector<unsigned char> packedDetail(detailSize.getSize() + 1, 0xCD);
+		NetworkPacker detailPacker(&packedDetail[0], detailSize.getSize());
+		NetworkMessageSynchNetworkGameData::serializeDetail(detailPacker, data->detail);
+		CPPUNIT_ASSERT( memcmp(&expectedDetail[0], &packedDetail[0], expectedDetailSize) == 0 );
+
+		NetworkUnpacker detailUnpacker(&packedDetail[0], detailSize.getSize());
+		NetworkMessageSynchNetworkGameData::serializeDetail(detailUnpacker, readData->detail);
+		for(int i = 0; i < NetworkMessageSynchNetworkGameData::maxFileCRCCount; ++i) {
+			CPPUNIT_ASSERT_EQUAL( data->detail.techCRCFileList[i].getString(), readData->detail.techCRCFileList[i].getString() );
+			CPPUNIT_ASSERT_EQUAL( data->detail.techCRCFileCRCList[i], readData->detail.techCRCFileCRCList[i] );
+		}
+		delete readData;
+		delete data;
+	}
+
+	// encode and decode throughput of every packed message type, printed
+	// for comparing builds, nothing is asserted about the speed
+	void test_EncodeDecodeTime() {
+		const int iterations = 20000;
+		printf("\n");
+
+		NetworkMessageIntro::Data intro = NetworkMessageIntro::Data();
+		intro.versionString = string("v3.13.0-dev");
+		intro.name = string("player");
+		timeMessage<NetworkMessageIntro>("NetworkMessageIntro", nmtIntro, intro, iterations);
+
+		NetworkMessagePing::Data ping = NetworkMessagePing::Data();
+		timeMessage<NetworkMessagePing>("NetworkMessagePing", nmtPing, ping, iterations);
+
+		NetworkMessageReady::Data ready = NetworkMessageReady::Data();
+		timeMessage<NetworkMessageReady>("NetworkMessageReady", nmtReady, ready, iterations);
+
+		NetworkMessageLaunch::Data *launch = new NetworkMessageLaunch::Data();
+		timeMessage<NetworkMessageLaunch>("NetworkMessageLaunch", nmtLaunch, *launch, iterations);
+		delete launch;
+
+		NetworkMessageText::Data text = NetworkMessageText::Data();
+		text.text = string("gg, well played");
+		timeMessage<NetworkMessageText>("NetworkMessageText", nmtText, text, iterations);
+
+		NetworkMessageSynchNetworkGameDataFileCRCCheck::Data check = NetworkMessageSynchNetworkGameDataFileCRCCheck::Data();
+		timeMessage<NetworkMessageSynchNetworkGameDataFileCRCCheck>("NetworkMessageSynchNetworkGameDataFileCRCCheck", nmtSynchNetworkGameDataFileCRCCheck, check, iterations);
+
+		NetworkMessageSynchNetworkGameDataFileGet::Data get = NetworkMessageSynchNetworkGameDataFileGet::Data();
+		timeMessage<NetworkMessageSynchNetworkGameDataFileGet>("NetworkMessageSynchNetworkGameDataFileGet", nmtSynchNetworkGameDataFileGet, get, iterations);
+
+		SwitchSetupRequest::Data switchSetup = SwitchSetupRequest::Data();
+		timeMessage<SwitchSetupRequest>("SwitchSetupRequest", nmtSwitchSetupRequest, switchSetup, iterations);
+
+		PlayerIndexMessage::Data playerIndex = PlayerIndexMessage::Data();
+		timeMessage<PlayerIndexMessage>("PlayerIndexMessage", nmtPlayerIndexMessage, playerIndex, iterations);
+
+		NetworkMessageLoadingStatus::Data status = NetworkMessageLoadingStatus::Data();
+		timeMessage<NetworkMessageLoadingStatus>("NetworkMessageLoadingStatus", nmtLoadingStatusMessage, status, iterations);
+
+		NetworkMessageMarkCell::Data mark = NetworkMessageMarkCell::Data();
+		timeMessage<NetworkMessageMarkCell>("NetworkMessageMarkCell", nmtMarkCell, mark, iterations);
+
+		NetworkMessageUnMarkCell::Data unmark = NetworkMessageUnMarkCell::Data();
+		timeMessage<NetworkMessageUnMarkCell>("NetworkMessageUnMarkCell", nmtUnMarkCell, unmark, iterations);
+
+		NetworkMessageHighlightCell::Data highlight = NetworkMessageHighlightCell::Data();
+		timeMessage<NetworkMessageHighlightCell>("NetworkMessageHighlightCell", nmtHighlightCell, highlight, iterations);
+
+		// the quit message is its type alone
+		{
+			int8 messageType = nmtQuit;
+			unsigned char packed[maxPackedSize];
+			NetworkPackedSize size;
+			NetworkMessageQuit::serialize(size, messageType);
+
+			Chrono chrono;
+			chrono.start();
+			for(int i = 0; i < iterations; ++i) {
+				NetworkPacker packer(packed, size.getSize());
+				NetworkMessageQuit::serialize(packer, messageType);
+			}
+			int64 encodeMicros = chrono.getMicros();
+
+			int8 readType = 0;
+			chrono.start();
+			for(int i = 0; i < iterations; ++i) {
+				NetworkUnpacker unpacker(packed, size.getSize());
+				NetworkMessageQuit::serialize(unpacker, readType);
+			}
+			int64 decodeMicros = chrono.getMicros();
+			CPPUNIT_ASSERT_EQUAL( (int)messageType, (int)readType );
+			printMessageTime("NetworkMessageQuit", size.getSize(), iterations, encodeMicros, decodeMicros);
+		}
+
+		// the header and commands of a full command list
+		{
+			const int commandCount = 64;
+			NetworkMessageCommandList::Data commandList = NetworkMessageCommandList::Data();
+			commandList.messageType = nmtCommandList;
+			commandList.header.commandCount = commandCount;
+			commandList.commands.resize(commandCount);
+
+			NetworkPackedSize size;
+			NetworkMessageCommandList::serializeHeader(size, commandList);
+			for(int i = 0; i < commandCount; ++i) {
+				commandList.commands[i].serialize(size);
+			}
+			std::vector<unsigned char> packed(size.getSize() + 1);
+
+			Chrono chrono;
+			chrono.start();
+			for(int i = 0; i < iterations; ++i) {
+				NetworkPacker packer(&packed[0], size.getSize());
+				NetworkMessageCommandList::serializeHeader(packer, commandList);
+				for(int j = 0; j < commandCount; ++j) {
+					commandList.commands[j].serialize(packer);
+				}
+			}
+			int64 encodeMicros = chrono.getMicros();
+
+			NetworkMessageCommandList::Data readList = NetworkMessageCommandList::Data();
+			readList.commands.resize(commandCount);
+			chrono.start();
+			for(int i = 0; i < iterations; ++i) {
+				NetworkUnpacker unpacker(&packed[0], size.getSize());
+				NetworkMessageCommandList::serializeHeader(unpacker, readList);
+				for(int j = 0; j < commandCount; ++j) {
+					readList.commands[j].serialize(unpacker);
+				}
+			}
+			int64 decodeMicros = chrono.getMicros();
+			CPPUNIT_ASSERT_EQUAL( commandList.header.commandCount, readList.header.commandCount );
+			printMessageTime("NetworkMessageCommandList (64 cmds)", size.getSize(), iterations, encodeMicros, decodeMicros);
+		}
+
+		// the header and every file of the game data synch, far bigger
+		// than the others so it runs fewer times
+		{
+			const int synchIterations = iterations / 100;
+			NetworkMessageSynchNetworkGameData::Data *synch = new NetworkMessageSynchNetworkGameData::Data();
+			synch->messageType = nmtSynchNetworkGameData;
+			synch->header.techCRCFileCount = NetworkMessageSynchNetworkGameData::maxFileCRCCount;
+			for(int i = 0; i < NetworkMessageSynchNetworkGameData::maxFileCRCCount; ++i) {
+				synch->detail.techCRCFileCRCList[i] = 0;
+			}
+
+			NetworkPackedSize size;
+			NetworkMessageSynchNetworkGameData::serializeHeader(size, *synch);
+			NetworkMessageSynchNetworkGameData::serializeDetail(size, synch->detail);
+			std::vector<unsigned char> packed(size.getSize() + 1);
+
+			Chrono chrono;
+			chrono.start();
+			for(int i = 0; i < synchIterations; ++i) {
+				NetworkPacker packer(&packed[0], size.getSize());
+				NetworkMessageSynchNetworkGameData::serializeHeader(packer, *synch);
+				NetworkMessageSynchNetworkGameData::serializeDetail(packer, synch->detail);
+			}
+			int64 encodeMicros = chrono.getMicros();
+
+			NetworkMessageSynchNetworkGameData::Data *readSynch = new NetworkMessageSynchNetworkGameData::Data();
+			chrono.start();
+			for(int i = 0; i < synchIterations; ++i) {
+				NetworkUnpacker unpacker(&packed[0], size.getSize());
+				NetworkMessageSynchNetworkGameData::serializeHeader(unpacker, *readSynch);
+				NetworkMessageSynchNetworkGameData::serializeDetail(unpacker, readSynch->detail);
+			}
+			int64 decodeMicros = chrono.getMicros();
+			CPPUNIT_ASSERT_EQUAL( synch->header.techCRCFileCount, readSynch->header.techCRCFileCount );
+			printMessageTime("NetworkMessageSynchNetworkGameData", size.getSize(), synchIterations, encodeMicros, decodeMicros);
+			delete readSynch;
+			delete synch;
+		}
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( NetworkMessageTest );
+
+}}//end namespace
+//
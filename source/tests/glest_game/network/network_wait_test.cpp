@@ -0,0 +1,259 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#ifdef WIN32
+  #include <winsock2.h>
+  #include <winsock.h>
+#endif
+
+#include "network_latency_histogram.h"
+#include "socket.h"
+#include "base_thread.h"
+#include "platform_util.h"
+#include "platform_common.h"
+#include <cstdio>
+#include <string>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace Shared::Platform;
+using namespace Shared::PlatformCommon;
+
+namespace Glest{ namespace Game{
+
+// the same wait slices ClientInterface uses for messages and frames
+static const int testMessageWaitSliceMicroseconds	= 20000;
+static const int testFrameWaitTimeoutMilliseconds	= 250;
+
+static const int testSampleCount					= 50;
+static const int testSendIntervalMilliseconds		= 5;
+
+//
+// Sends a millisecond time stamp over a socket at a steady interval
+//
+class LoopbackSenderThread : public BaseThread {
+private:
+	Socket *socket;
+
+public:
+	LoopbackSenderThread(Socket *socket) : BaseThread() {
+		this->socket = socket;
+	}
+
+	virtual void execute() {
+		RunningStatusSafeWrapper runningStatus(this);
+		for(int index = 0; index < testSampleCount && getQuitStatus() == false; ++index) {
+			sleep(testSendIntervalMilliseconds);
+
+			int64 stamp = Chrono::getCurMillis();
+			socket->send(&stamp, sizeof(stamp));
+		}
+	}
+};
+
+//
+// Marks a frame ready and signals the waiting thread like the client
+// network thread does after caching a command list
+//
+class FrameSignalThread : public BaseThread {
+private:
+	Mutex *mutex;
+	Trigger *trigger;
+	int *readyFrame;
+	int64 *readyStamp;
+
+public:
+	FrameSignalThread(Mutex *mutex, Trigger *trigger, int *readyFrame, int64 *readyStamp) : BaseThread() {
+		this->mutex = mutex;
+		this->trigger = trigger;
+		this->readyFrame = readyFrame;
+		this->readyStamp = readyStamp;
+	}
+
+	virtual void execute() {
+		RunningStatusSafeWrapper runningStatus(this);
+		for(int index = 0; index < testSampleCount && getQuitStatus() == false; ++index) {
+			sleep(testSendIntervalMilliseconds);
+
+			MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+			*readyFrame = index;
+			*readyStamp = Chrono::getCurMillis();
+			trigger->signal(true);
+		}
+	}
+};
+
+//
+// Measures how long a client takes to notice a message or frame that has
+// arrived on a loopback connection, printing the latency histograms of
+// the blocking waits next to the old sleep polling
+//
+class NetworkWaitTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( NetworkWaitTest );
+
+	CPPUNIT_TEST( test_MessageWait );
+	CPPUNIT_TEST( test_FrameWait );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+	ServerSocket *serverSocket;
+	ClientSocket *clientSocket;
+	Socket *acceptedSocket;
+
+	void connectLoopback() {
+		serverSocket = new ServerSocket(true);
+
+		int port = 0;
+		for(int tryPort = 61450; port == 0 && tryPort < 61500; ++tryPort) {
+			try {
+				serverSocket->setBindPort(tryPort);
+				serverSocket->bind(tryPort);
+				port = tryPort;
+			}
+			catch(const megaglest_runtime_error &) {
+				delete serverSocket;
+				serverSocket = new ServerSocket(true);
+			}
+		}
+		CPPUNIT_ASSERT( port != 0 );
+		serverSocket->listen(1);
+
+		clientSocket = new ClientSocket();
+		clientSocket->connect(Ip("127.0.0.1"), port);
+		CPPUNIT_ASSERT_EQUAL( true, clientSocket->isConnected() );
+
+		// the server socket does not block, so retry the accept
+		int64 start = Chrono::getCurMillis();
+		while(acceptedSocket == NULL && Chrono::getCurMillis() - start < 5000) {
+			acceptedSocket = serverSocket->accept(false);
+			if(acceptedSocket == NULL) {
+				sleep(1);
+			}
+		}
+		CPPUNIT_ASSERT( acceptedSocket != NULL );
+	}
+
+	// receives every time stamp from the sender, waiting with the given
+	// strategy, and records how late each one was noticed
+	void receiveStamps(bool blockingWait, NetworkLatencyHistogram &histogram) {
+		LoopbackSenderThread *sender = new LoopbackSenderThread(acceptedSocket);
+		sender->start();
+
+		int64 start = Chrono::getCurMillis();
+		for(int received = 0; received < testSampleCount && Chrono::getCurMillis() - start < 30000;) {
+			bool dataReady = false;
+			if(blockingWait == true) {
+				dataReady = Socket::hasDataToReadWithWait(clientSocket->getSocketId(),testMessageWaitSliceMicroseconds);
+			}
+			else {
+				dataReady = clientSocket->hasDataToRead();
+				if(dataReady == false) {
+					sleep(1);
+				}
+			}
+
+			// a stamp may already be queued behind the previous one, it is
+			// counted from when it was sent either way
+			while(dataReady == true && received < testSampleCount) {
+				int64 stamp = 0;
+				CPPUNIT_ASSERT_EQUAL( (int)sizeof(stamp), clientSocket->receive(&stamp, sizeof(stamp), true) );
+				histogram.addSample(Chrono::getCurMillis() - stamp);
+				received++;
+
+				dataReady = clientSocket->hasDataToRead();
+			}
+		}
+
+		if(BaseThread::shutdownAndWait(sender) == true) {
+			delete sender;
+		}
+	}
+
+public:
+
+	void setUp() {
+		serverSocket = NULL;
+		clientSocket = NULL;
+		acceptedSocket = NULL;
+	}
+
+	void tearDown() {
+		delete acceptedSocket;
+		delete clientSocket;
+		delete serverSocket;
+	}
+
+	void test_MessageWait() {
+		connectLoopback();
+
+		NetworkLatencyHistogram pollHistogram;
+		receiveStamps(false, pollHistogram);
+
+		NetworkLatencyHistogram waitHistogram;
+		receiveStamps(true, waitHistogram);
+
+		printf("\nloopback message latency, sleep polling: %s\n",pollHistogram.toString().c_str());
+		printf("loopback message latency, socket wait: %s\n",waitHistogram.toString().c_str());
+
+		CPPUNIT_ASSERT_EQUAL( (uint64)testSampleCount, pollHistogram.getSampleCount() );
+		CPPUNIT_ASSERT_EQUAL( (uint64)testSampleCount, waitHistogram.getSampleCount() );
+	}
+
+	void test_FrameWait() {
+		Mutex mutex(CODE_AT_LINE);
+		Trigger trigger(&mutex);
+		int readyFrame = -1;
+		int64 readyStamp = 0;
+
+		FrameSignalThread *signaller = new FrameSignalThread(&mutex, &trigger, &readyFrame, &readyStamp);
+		signaller->start();
+
+		// waits for each frame like ClientInterface::getNetworkCommand,
+		// checking under the mutex before blocking on the trigger
+		NetworkLatencyHistogram histogram;
+		int64 start = Chrono::getCurMillis();
+		for(int frame = 0; frame < testSampleCount && Chrono::getCurMillis() - start < 30000;) {
+			MutexSafeWrapper safeMutex(&mutex,CODE_AT_LINE);
+			if(readyFrame >= frame) {
+				// frames signalled while we were busy were ready at the
+				// latest stamp, only the newest one is timed
+				histogram.addSample(Chrono::getCurMillis() - readyStamp);
+				frame = readyFrame + 1;
+			}
+			else {
+				trigger.waitTillSignalled(&mutex,testFrameWaitTimeoutMilliseconds);
+			}
+		}
+
+		if(BaseThread::shutdownAndWait(signaller) == true) {
+			delete signaller;
+		}
+
+		printf("\nframe wait latency, trigger wait: %s\n",histogram.toString().c_str());
+
+		CPPUNIT_ASSERT( histogram.getSampleCount() > 0 );
+		CPPUNIT_ASSERT_EQUAL( testSampleCount - 1, readyFrame );
+		CPPUNIT_ASSERT( histogram.getMaxMillis() < testFrameWaitTimeoutMilliseconds );
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( NetworkWaitTest );
+
+}}//end namespace
+//
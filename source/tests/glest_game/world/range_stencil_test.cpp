@@ -0,0 +1,96 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "range_stencil.h"
+#include <cmath>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace Shared::Graphics;
+using namespace Glest::Game;
+
+//
+// Tests for the cells findUnitsInRange() visits around a unit
+//
+class RangeStencilTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( RangeStencilTest );
+
+	CPPUNIT_TEST( test_OldPredicate );
+	CPPUNIT_TEST( test_Stencil );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+	// the float test findUnitsInRange() used before the stencils, with the
+	// center from Unit::getFloatCenteredPos()
+	static bool oldIsInRange(const Vec2i &pos, int size, const Vec2i &cell, int range) {
+		Vec2f floatCenter(truncateDecimal<float>(pos.x - 0.5f + size / 2.f, 6),
+						  truncateDecimal<float>(pos.y - 0.5f + size / 2.f, 6));
+		return floor(floatCenter.dist(Vec2f((float)cell.x, (float)cell.y))) <= (range + 1);
+	}
+
+public:
+
+	void test_OldPredicate() {
+		// positions near the origin and far out on a big map
+		const Vec2i positions[] = { Vec2i(0, 0), Vec2i(37, 53), Vec2i(511, 1020) };
+		for(int p = 0; p < 3; ++p) {
+			for(int size = 1; size <= 6; ++size) {
+				for(int range = 0; range <= 24; ++range) {
+					// the scan window of findUnitsInRange() and one cell more
+					for(int i = -range - 1; i <= range + size; ++i) {
+						for(int j = -range - 1; j <= range + size; ++j) {
+							Vec2i cell = positions[p] + Vec2i(i, j);
+							CPPUNIT_ASSERT_EQUAL( oldIsInRange(positions[p], size, cell, range),
+												  RangeStencilCache::isInRangeCell(i, j, range, size) );
+						}
+					}
+				}
+			}
+		}
+	}
+
+	void test_Stencil() {
+		RangeStencilCache stencils;
+		const Vec2i pos(37, 53);
+		for(int size = 1; size <= 6; ++size) {
+			for(int range = 0; range <= 24; ++range) {
+				const vector<Vec2i> &stencil = stencils.getStencil(range, size);
+
+				// the cells the old loop visited, in the same order
+				unsigned int index = 0;
+				for(int i = pos.x - range; i < pos.x + range + size; ++i) {
+					for(int j = pos.y - range; j < pos.y + range + size; ++j) {
+						if(oldIsInRange(pos, size, Vec2i(i, j), range)) {
+							CPPUNIT_ASSERT( index < stencil.size() );
+							CPPUNIT_ASSERT( pos + stencil[index] == Vec2i(i, j) );
+							index++;
+						}
+					}
+				}
+				CPPUNIT_ASSERT_EQUAL( (unsigned int)stencil.size(), index );
+
+				// later lookups give back the cached stencil
+				CPPUNIT_ASSERT( &stencils.getStencil(range, size) == &stencil );
+			}
+		}
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( RangeStencilTest );
+//
@@ -0,0 +1,114 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+#include "fixed_point.h"
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace Shared::Graphics;
+
+//
+// Tests for fixed point simulation math
+//
+class FixedPointTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( FixedPointTest );
+
+	CPPUNIT_TEST( test_Arithmetic );
+	CPPUNIT_TEST( test_Distance );
+	CPPUNIT_TEST( test_DistanceOrder );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_Arithmetic() {
+		// These raw values are what every platform has to produce
+		CPPUNIT_ASSERT_EQUAL( (int64)229376, (Fixed(7) / Fixed(2)).getRaw() );
+		CPPUNIT_ASSERT_EQUAL( (int64)-229376, (Fixed(-7) / Fixed(2)).getRaw() );
+		CPPUNIT_ASSERT_EQUAL( (int64)21845, (Fixed(1) / Fixed(3)).getRaw() );
+		CPPUNIT_ASSERT_EQUAL( (int64)98304, (Fixed::fromFloat(0.75) * Fixed(2)).getRaw() );
+		CPPUNIT_ASSERT_EQUAL( (int64)92681, Fixed(2).sqrt().getRaw() );
+		CPPUNIT_ASSERT_EQUAL( (int64)0, Fixed(-2).sqrt().getRaw() );
+		CPPUNIT_ASSERT_EQUAL( (int64)4915200, Fixed(150).mulDiv(50, 100).getRaw() );
+
+		Fixed minusOneAndHalf = Fixed::fromFloat(-1.5);
+		CPPUNIT_ASSERT_EQUAL( -2, minusOneAndHalf.floorToInt() );
+		CPPUNIT_ASSERT_EQUAL( -1, minusOneAndHalf.ceilToInt() );
+		CPPUNIT_ASSERT_EQUAL( -1, minusOneAndHalf.roundToInt() );
+		CPPUNIT_ASSERT_EQUAL( 3, Fixed::fromFloat(2.5).roundToInt() );
+		CPPUNIT_ASSERT_EQUAL( 1.5f, minusOneAndHalf.abs().toFloat() );
+
+		// products of negative numbers round down like the positive ones
+		CPPUNIT_ASSERT_EQUAL( (int64)-1, (Fixed::fromRaw(-1) * Fixed::fromRaw(1)).getRaw() );
+		CPPUNIT_ASSERT_EQUAL( (int64)0, (Fixed::fromRaw(1) * Fixed::fromRaw(1)).getRaw() );
+		CPPUNIT_ASSERT_EQUAL( (int64)-98304, (Fixed::fromFloat(-0.75) * Fixed(2)).getRaw() );
+		CPPUNIT_ASSERT_EQUAL( -1, Fixed::fromRaw(-1).floorToInt() );
+		CPPUNIT_ASSERT_EQUAL( 0, Fixed::fromRaw(-1).ceilToInt() );
+		CPPUNIT_ASSERT_EQUAL( -3, Fixed(-3).floorToInt() );
+		CPPUNIT_ASSERT_EQUAL( -3, Fixed(-3).ceilToInt() );
+	}
+
+	void test_Distance() {
+		CPPUNIT_ASSERT_EQUAL( (int64)327680, Vec2x(Vec2i(0,0)).dist(Vec2x(Vec2i(3,4))).getRaw() );
+		CPPUNIT_ASSERT_EQUAL( (int64)92681, Vec2x(Vec2i(5,5)).dist(Vec2x(Vec2i(4,4))).getRaw() );
+		CPPUNIT_ASSERT_EQUAL( (int64)0, Vec2x(Vec2i(9,9)).dist(Vec2x(Vec2i(9,9))).getRaw() );
+
+		// fractions and the third axis
+		Vec2x half(Fixed::fromFloat(0.5), Fixed::fromFloat(-0.5));
+		CPPUNIT_ASSERT_EQUAL( (int64)46340, half.length().getRaw() );
+		CPPUNIT_ASSERT_EQUAL( (int64)65536, Vec3x(Vec3i(1,2,3)).dist(Vec3x(Vec3i(1,2,2))).getRaw() );
+		CPPUNIT_ASSERT_EQUAL( (int64)851968, Vec3x(Vec3i(0,0,0)).dist(Vec3x(Vec3i(-3,4,-12))).getRaw() );
+		CPPUNIT_ASSERT_EQUAL( (int64)-393216, Vec2x(Vec2i(2,-3)).dot(Vec2x(Vec2i(3,4))).getRaw() );
+	}
+
+	void test_DistanceOrder() {
+		// Path finder nodes must come in the order of the exact distances,
+		// checked on pairs of arbitrary cell pairs all over a large map
+		uint32 seed = 12345;
+		for(int i = 0; i < 200000; ++i) {
+			Vec2i pos[4];
+			for(int j = 0; j < 4; ++j) {
+				seed = seed * 1103515245 + 12345;
+				pos[j].x = (seed >> 8) % 1024;
+				seed = seed * 1103515245 + 12345;
+				pos[j].y = (seed >> 8) % 1024;
+			}
+			// every few pairs share a cell so short and equal distances come up
+			if(i % 4 == 0) {
+				pos[1] = pos[0] + (pos[1] - pos[0]) / 64;
+				pos[3] = pos[0] + (pos[3] - pos[0]) / 64;
+				pos[2] = pos[0];
+			}
+			Vec2i diff1 = pos[1] - pos[0];
+			Vec2i diff2 = pos[3] - pos[2];
+			int64 squared1 = (int64)diff1.x * diff1.x + (int64)diff1.y * diff1.y;
+			int64 squared2 = (int64)diff2.x * diff2.x + (int64)diff2.y * diff2.y;
+
+			Fixed dist1 = Vec2x(pos[0]).dist(Vec2x(pos[1]));
+			Fixed dist2 = Vec2x(pos[2]).dist(Vec2x(pos[3]));
+			CPPUNIT_ASSERT_EQUAL( squared1 < squared2, dist1 < dist2 );
+			CPPUNIT_ASSERT_EQUAL( squared1 == squared2, dist1 == dist2 );
+		}
+	}
+
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( FixedPointTest );
+//
@@ -14,6 +14,8 @@
 #include "font.h"
 #include <vector>
 #include <algorithm>
+#include <cstring>
+#include "conversion.h"
 
 #ifdef WIN32
 #include <io.h>
@@ -23,6 +25,20 @@
 
 using namespace Shared::Graphics;
 
+// Text handler that measures every character as 10 units and counts calls
+class CountingText : public Text {
+public:
+	int advanceCount;
+
+	CountingText() : Text(ftht_2D) {
+		advanceCount = 0;
+	}
+	virtual float Advance(const char *str, const int len) {
+		advanceCount++;
+		return (float)strlen(str) * 10.f;
+	}
+};
+
 //
 // Tests for font class
 //
@@ -32,12 +48,41 @@ class FontTest : public CppUnit::TestFixture {
 
 	CPPUNIT_TEST( test_LTR_RTL_Mixed );
 	CPPUNIT_TEST( test_bidi_newline_handling );
+	CPPUNIT_TEST( test_text_width_cache );
 
 	CPPUNIT_TEST_SUITE_END();
 	// End of Fixture registration
 
 public:
 
+	void test_text_width_cache() {
+		CountingText text;
+		FontMetrics metrics(&text);
+		float scale = Font::scaleFontValue;
+
+		CPPUNIT_ASSERT_EQUAL( 50.f * scale, metrics.getTextWidth("Wood:") );
+		CPPUNIT_ASSERT_EQUAL( 50.f * scale, metrics.getTextWidth("Wood:") );
+		CPPUNIT_ASSERT_EQUAL( 1, text.advanceCount );
+
+		// the longest line of a multi line string is measured
+		CPPUNIT_ASSERT_EQUAL( 80.f * scale, metrics.getTextWidth("HP: 9\nArmor: 0\nSight") );
+		CPPUNIT_ASSERT_EQUAL( 2, text.advanceCount );
+
+		// the cache stays bounded and forgets the least recently used strings
+		for(int i = 0; i < 2000; ++i) {
+			metrics.getTextWidth("label " + Shared::Util::intToStr(i));
+			metrics.getTextWidth("Wood:");
+		}
+		CPPUNIT_ASSERT( metrics.getTextLayoutCacheSize() <= 512 );
+		int advanceCount = text.advanceCount;
+		metrics.getTextWidth("Wood:");
+		metrics.getTextWidth("label 0");
+		CPPUNIT_ASSERT_EQUAL( advanceCount + 1, text.advanceCount );
+
+		metrics.setTextHandler(NULL);
+		CPPUNIT_ASSERT_EQUAL( 0, metrics.getTextLayoutCacheSize() );
+	}
+
 	void test_bidi_newline_handling() {
 
 		string text = "\n\nHP: 9000/9000\nArmor: 0 (Stone)\nSight: 15\nProduce Slave";
@@ -12,8 +12,14 @@
 #include <cppunit/extensions/HelperMacros.h>
 #include <memory>
 #include "model.h"
+#include "model_header.h"
+#include "interpolation.h"
+#include "platform_common.h"
 #include <vector>
 #include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 
 #ifdef WIN32
 #include <io.h>
@@ -22,6 +28,7 @@
 #endif
 
 using namespace Shared::Graphics;
+using namespace Shared::PlatformCommon;
 
 class TestBaseColorPickEntity : public BaseColorPickEntity {
 public:
@@ -29,6 +36,119 @@ public:
 		return getColorDescription();
 	}
 };
+class TestModel : public Model {
+public:
+	virtual void init() {}
+	virtual void end() {}
+
+	void loadFile(const string &path) {
+		load(path);
+	}
+};
+
+// one mesh of a g3d file, the vertices and normals of every frame one after
+// the other, no texture coordinates means an untextured mesh
+class TestMeshData {
+public:
+	uint32 frameCount;
+	std::vector<Vec3f> vertices;
+	std::vector<Vec3f> normals;
+	std::vector<Vec2f> texCoords;
+	std::vector<uint32> indices;
+
+	TestMeshData() {
+		frameCount = 1;
+	}
+
+	uint32 addVertex(const Vec3f &vertex, const Vec2f &texCoord) {
+		vertices.push_back(vertex);
+		normals.push_back(Vec3f(0.f, 0.f, 1.f));
+		texCoords.push_back(texCoord);
+		return (uint32)vertices.size() - 1;
+	}
+
+	void addTriangle(uint32 a, uint32 b, uint32 c) {
+		indices.push_back(a);
+		indices.push_back(b);
+		indices.push_back(c);
+	}
+
+	// a size x size grid of quads where every triangle has its own three
+	// vertices, so neighbouring triangles share identical ones
+	void addGrid(int size) {
+		for(int y = 0; y < size; ++y) {
+			for(int x = 0; x < size; ++x) {
+				uint32 a0 = addCorner(x, y, size);
+				uint32 b0 = addCorner(x + 1, y, size);
+				uint32 c0 = addCorner(x + 1, y + 1, size);
+				addTriangle(a0, b0, c0);
+
+				uint32 a1 = addCorner(x, y, size);
+				uint32 b1 = addCorner(x + 1, y + 1, size);
+				uint32 c1 = addCorner(x, y + 1, size);
+				addTriangle(a1, b1, c1);
+			}
+		}
+	}
+
+	uint32 addCorner(int x, int y, int size) {
+		return addVertex(Vec3f((float)x, (float)y, (float)((x * 7 + y * 3) % 5)), Vec2f((float)x / size, (float)y / size));
+	}
+
+	// repeats the first frame, moving every vertex by offset times the
+	// frame number
+	void addFrames(uint32 count, const Vec3f &offset) {
+		uint32 vertexCount = (uint32)vertices.size();
+		for(uint32 frame = 1; frame < count; ++frame) {
+			for(uint32 vertex = 0; vertex < vertexCount; ++vertex) {
+				vertices.push_back(vertices[vertex] + offset * (float)frame);
+				normals.push_back(normals[vertex]);
+			}
+		}
+		frameCount = count;
+	}
+
+	void write(const string &path) const {
+		FILE *f = fopen(path.c_str(), "wb");
+		CPPUNIT_ASSERT( f != NULL );
+
+		FileHeader fileHeader;
+		memcpy(fileHeader.id, "G3D", 3);
+		fileHeader.version = 4;
+		fwrite(&fileHeader, sizeof(FileHeader), 1, f);
+
+		ModelHeader modelHeader;
+		modelHeader.meshCount = 1;
+		modelHeader.type = mtMorphMesh;
+		fwrite(&modelHeader, sizeof(ModelHeader), 1, f);
+
+		MeshHeader meshHeader;
+		memset(&meshHeader, 0, sizeof(MeshHeader));
+		strcpy((char *)meshHeader.name, "test");
+		meshHeader.frameCount = frameCount;
+		meshHeader.vertexCount = (uint32)vertices.size() / frameCount;
+		meshHeader.indexCount = (uint32)indices.size();
+		meshHeader.opacity = 1.f;
+		meshHeader.textures = (texCoords.empty() ? 0 : 1);
+		fwrite(&meshHeader, sizeof(MeshHeader), 1, f);
+
+		if(texCoords.empty() == false) {
+			// the texture is not loaded without a texture manager
+			char texturePath[mapPathSize];
+			memset(texturePath, 0, mapPathSize);
+			strcpy(texturePath, "test.tga");
+			fwrite(texturePath, mapPathSize, 1, f);
+		}
+		fwrite(&vertices[0], sizeof(Vec3f), vertices.size(), f);
+		fwrite(&normals[0], sizeof(Vec3f), normals.size(), f);
+		if(texCoords.empty() == false) {
+			fwrite(&texCoords[0], sizeof(Vec2f), texCoords.size(), f);
+		}
+		fwrite(&indices[0], sizeof(uint32), indices.size(), f);
+		fclose(f);
+	}
+};
+
 //
 // Tests for font class
 //
@@ -38,10 +158,69 @@ class ModelTest : public CppUnit::TestFixture {
 
 	CPPUNIT_TEST( test_ColorPicking_loop );
 	CPPUNIT_TEST( test_ColorPicking_prime );
+	CPPUNIT_TEST( test_octahedral_normals );
+	CPPUNIT_TEST( test_optimize_merges_vertices );
+	CPPUNIT_TEST( test_optimize_drops_degenerate_triangles );
+	CPPUNIT_TEST( test_optimize_keeps_triangles );
+	CPPUNIT_TEST( test_optimize_collapses_frames );
+	CPPUNIT_TEST( test_quantized_interpolation );
 
 	CPPUNIT_TEST_SUITE_END();
 	// End of Fixture registration
 
+	// writes the mesh to a g3d file and loads it back as a model
+	static void loadTestModel(TestModel &model, const TestMeshData &data) {
+		const string path = "model_test_optimize.g3d";
+		data.write(path);
+		model.loadFile(path);
+		removeFile(path);
+		CPPUNIT_ASSERT_EQUAL( (uint32)1, model.getMeshCount() );
+	}
+
+	static void appendBytes(string &result, const void *data, size_t size) {
+		result.append(static_cast<const char *>(data), size);
+	}
+
+	// every non degenerate triangle as the data of its three corners in
+	// all frames, rotated to start at its smallest corner so the winding
+	// is kept and the order of the list does not matter
+	static std::vector<string> getTriangles(const Mesh *mesh) {
+		std::vector<string> result;
+		uint32 vertexCount = mesh->getVertexCount();
+		for(uint32 i = 0; i + 2 < mesh->getIndexCount(); i += 3) {
+			string corners[3];
+			for(int corner = 0; corner < 3; ++corner) {
+				uint32 vertex = mesh->getIndices()[i + corner];
+				for(uint32 frame = 0; frame < mesh->getFrameCount(); ++frame) {
+					appendBytes(corners[corner], &mesh->getVertices()[frame * vertexCount + vertex], sizeof(Vec3f));
+					appendBytes(corners[corner], &mesh->getNormals()[frame * vertexCount + vertex], sizeof(Vec3f));
+				}
+				if(mesh->getTextureFlags() != 0) {
+					appendBytes(corners[corner], &mesh->getTexCoords()[vertex], sizeof(Vec2f));
+				}
+			}
+			if(corners[0] == corners[1] || corners[1] == corners[2] || corners[0] == corners[2]) {
+				continue;
+			}
+
+			int first = 0;
+			for(int corner = 1; corner < 3; ++corner) {
+				if(corners[corner] < corners[first]) {
+					first = corner;
+				}
+			}
+			result.push_back(corners[first] + corners[(first + 1) % 3] + corners[(first + 2) % 3]);
+		}
+		std::sort(result.begin(), result.end());
+		return result;
+	}
+
+	static void checkIndices(const Mesh *mesh) {
+		for(uint32 i = 0; i < mesh->getIndexCount(); ++i) {
+			CPPUNIT_ASSERT( mesh->getIndices()[i] < mesh->getVertexCount() );
+		}
+	}
+
 public:
 
 	void test_ColorPicking_loop() {
@@ -100,6 +279,215 @@ public:
 		BaseColorPickEntity::setTrackColorUse(false);
 	}
 
+	void test_octahedral_normals() {
+		// 16 bit octahedral normals of quantized keyframes stay within a tenth of a degree
+		const float minCos = cos(0.1f * 3.14159265f / 180.f);
+		for(int i = 0; i < 64; ++i) {
+			for(int j = 0; j <= 32; ++j) {
+				float theta = i * 2.f * 3.14159265f / 64.f;
+				float phi = j * 3.14159265f / 32.f;
+				Vec3f normal(cos(theta) * sin(phi), sin(theta) * sin(phi), cos(phi));
+
+				int16 x = 0;
+				int16 y = 0;
+				Mesh::encodeOctahedral(normal, x, y);
+				Vec3f decoded = Mesh::decodeOctahedral(x, y);
+				decoded.normalize();
+				CPPUNIT_ASSERT( normal.dot(decoded) >= minCos );
+			}
+		}
+
+		int16 x = 1;
+		int16 y = 1;
+		Mesh::encodeOctahedral(Vec3f(0.f), x, y);
+		CPPUNIT_ASSERT_EQUAL( (int16)0, x );
+		CPPUNIT_ASSERT_EQUAL( (int16)0, y );
+	}
+
+	void test_optimize_merges_vertices() {
+		const int size = 6;
+		TestMeshData data;
+		data.addGrid(size);
+
+		// the same corners with other texture coordinates stay apart
+		uint32 a = data.addVertex(Vec3f(0.f, 0.f, 0.f), Vec2f(0.5f, 0.5f));
+		uint32 b = data.addVertex(Vec3f(1.f, 0.f, 2.f), Vec2f(0.75f, 0.5f));
+		uint32 c = data.addVertex(Vec3f(1.f, 1.f, 0.f), Vec2f(0.75f, 0.75f));
+		data.addTriangle(a, b, c);
+
+		TestModel model;
+		loadTestModel(model, data);
+		CPPUNIT_ASSERT_EQUAL( (uint32)data.vertices.size(), model.getMesh(0)->getVertexCount() );
+
+		model.optimizeMeshes();
+		const Mesh *mesh = model.getMesh(0);
+		CPPUNIT_ASSERT_EQUAL( (uint32)((size + 1) * (size + 1) + 3), mesh->getVertexCount() );
+		CPPUNIT_ASSERT_EQUAL( (uint32)data.indices.size(), mesh->getIndexCount() );
+		checkIndices(mesh);
+
+		// no two vertices left are the same
+		for(uint32 i = 0; i < mesh->getVertexCount(); ++i) {
+			for(uint32 j = i + 1; j < mesh->getVertexCount(); ++j) {
+				bool same = (mesh->getVertices()[i] == mesh->getVertices()[j] &&
+							 mesh->getNormals()[i] == mesh->getNormals()[j] &&
+							 mesh->getTexCoords()[i] == mesh->getTexCoords()[j]);
+				CPPUNIT_ASSERT_EQUAL( false, same );
+			}
+		}
+	}
+
+	void test_optimize_drops_degenerate_triangles() {
+		TestMeshData data;
+		data.addGrid(3);
+		uint32 triangleCount = (uint32)data.indices.size() / 3;
+
+		// a triangle using one vertex twice and one whose vertices only
+		// become the same one when identical vertices are merged
+		data.addTriangle(0, 0, 1);
+		uint32 a = data.addVertex(Vec3f(2.f, 2.f, 0.f), Vec2f(0.f, 0.f));
+		uint32 b = data.addVertex(Vec3f(2.f, 2.f, 0.f), Vec2f(0.f, 0.f));
+		uint32 c = data.addVertex(Vec3f(3.f, 2.f, 0.f), Vec2f(0.f, 0.f));
+		data.addTriangle(a, b, c);
+
+		TestModel model;
+		loadTestModel(model, data);
+		std::vector<string> trianglesBefore = getTriangles(model.getMesh(0));
+		CPPUNIT_ASSERT_EQUAL( (size_t)triangleCount, trianglesBefore.size() );
+
+		model.optimizeMeshes();
+		const Mesh *mesh = model.getMesh(0);
+		CPPUNIT_ASSERT_EQUAL( triangleCount * 3, mesh->getIndexCount() );
+		for(uint32 i = 0; i < mesh->getIndexCount(); i += 3) {
+			const uint32 *triangle = &mesh->getIndices()[i];
+			CPPUNIT_ASSERT( triangle[0] != triangle[1] && triangle[1] != triangle[2] && triangle[0] != triangle[2] );
+		}
+		CPPUNIT_ASSERT( trianglesBefore == getTriangles(mesh) );
+	}
+
+	void test_optimize_keeps_triangles() {
+		// an animated mesh, its frames differ so all are kept
+		TestMeshData data;
+		data.addGrid(8);
+		data.addFrames(3, Vec3f(0.25f, 0.f, 0.5f));
+
+		TestModel model;
+		loadTestModel(model, data);
+		std::vector<string> trianglesBefore = getTriangles(model.getMesh(0));
+
+		model.optimizeMeshes();
+		const Mesh *mesh = model.getMesh(0);
+		CPPUNIT_ASSERT_EQUAL( (uint32)3, mesh->getFrameCount() );
+		CPPUNIT_ASSERT_EQUAL( (uint32)(9 * 9), mesh->getVertexCount() );
+		checkIndices(mesh);
+		CPPUNIT_ASSERT( trianglesBefore == getTriangles(mesh) );
+
+		// the triangles were reordered for the vertex cache, not just kept
+		// in their old order with new indices
+		bool reordered = false;
+		for(uint32 i = 0; i < mesh->getIndexCount() && reordered == false; ++i) {
+			reordered = (mesh->getVertices()[mesh->getIndices()[i]] != data.vertices[data.indices[i]]);
+		}
+		CPPUNIT_ASSERT( reordered );
+	}
+
+	void test_optimize_collapses_frames() {
+		TestMeshData data;
+		data.addGrid(4);
+		data.addFrames(4, Vec3f(0.f));
+
+		TestModel model;
+		loadTestModel(model, data);
+		CPPUNIT_ASSERT_EQUAL( (uint32)4, model.getMesh(0)->getFrameCount() );
+		std::vector<string> firstFrameTriangles;
+		{
+			// the triangles of one frame are what the collapsed mesh holds
+			TestMeshData oneFrame = data;
+			oneFrame.vertices.resize(oneFrame.texCoords.size());
+			oneFrame.normals.resize(oneFrame.texCoords.size());
+			oneFrame.frameCount = 1;
+			TestModel oneFrameModel;
+			loadTestModel(oneFrameModel, oneFrame);
+			firstFrameTriangles = getTriangles(oneFrameModel.getMesh(0));
+		}
+
+		model.optimizeMeshes();
+		const Mesh *mesh = model.getMesh(0);
+		CPPUNIT_ASSERT_EQUAL( (uint32)1, mesh->getFrameCount() );
+		CPPUNIT_ASSERT_EQUAL( (uint32)(5 * 5), mesh->getVertexCount() );
+		checkIndices(mesh);
+		CPPUNIT_ASSERT( firstFrameTriangles == getTriangles(mesh) );
+
+		// one differing vertex in the last frame keeps every frame
+		TestMeshData animated;
+		animated.addGrid(4);
+		animated.addFrames(4, Vec3f(0.f));
+		animated.vertices.back().z += 1.f;
+
+		TestModel animatedModel;
+		loadTestModel(animatedModel, animated);
+		animatedModel.optimizeMeshes();
+		CPPUNIT_ASSERT_EQUAL( (uint32)4, animatedModel.getMesh(0)->getFrameCount() );
+	}
+
+	void test_quantized_interpolation() {
+		TestMeshData data;
+		data.addGrid(5);
+		data.addFrames(4, Vec3f(0.5f, -0.25f, 1.f));
+		// unit normals pointing every way and turning a little from frame
+		// to frame, like the normals of an animated model
+		uint32 frameVertexCount = (uint32)data.normals.size() / data.frameCount;
+		for(uint32 i = 0; i < data.normals.size(); ++i) {
+			float angle = (i % frameVertexCount) * 0.37f + (i / frameVertexCount) * 0.2f;
+			data.normals[i] = Vec3f(cos(angle), sin(angle * 1.3f), cos(angle * 0.7f) - 0.5f);
+			data.normals[i].normalize();
+		}
+
+		TestModel floatModel;
+		loadTestModel(floatModel, data);
+		CPPUNIT_ASSERT( floatModel.getMesh(0)->getQuantizedVertices() == NULL );
+
+		bool quantizeKeyframes = Mesh::getQuantizeKeyframes();
+		Mesh::setQuantizeKeyframes(true);
+		TestModel quantizedModel;
+		loadTestModel(quantizedModel, data);
+		Mesh::setQuantizeKeyframes(quantizeKeyframes);
+
+		const Mesh *floatMesh = floatModel.getMesh(0);
+		const Mesh *quantizedMesh = quantizedModel.getMesh(0);
+		CPPUNIT_ASSERT( quantizedMesh->getQuantizedVertices() != NULL );
+		CPPUNIT_ASSERT( quantizedMesh->getVertices() == NULL );
+
+		// half a quantization step per axis, with a little room for the
+		// float rounding of both interpolations
+		Vec3f maxError = quantizedMesh->getQuantizeScale() * 0.5f + Vec3f(1e-4f);
+		const float minNormalCos = cos(0.2f * 3.14159265f / 180.f);
+
+		for(int pass = 0; pass < 2; ++pass) {
+			bool cycle = (pass == 1);
+			for(int step = 0; step <= 20; ++step) {
+				float t = step / 20.f;
+				floatModel.updateInterpolationData(t, cycle);
+				quantizedModel.updateInterpolationData(t, cycle);
+
+				const Vec3f *expectedVertices = floatMesh->getInterpolationData()->getVertices();
+				const Vec3f *expectedNormals = floatMesh->getInterpolationData()->getNormals();
+				const Vec3f *vertices = quantizedMesh->getInterpolationData()->getVertices();
+				const Vec3f *normals = quantizedMesh->getInterpolationData()->getNormals();
+				for(uint32 i = 0; i < floatMesh->getVertexCount(); ++i) {
+					CPPUNIT_ASSERT( fabs(vertices[i].x - expectedVertices[i].x) <= maxError.x );
+					CPPUNIT_ASSERT( fabs(vertices[i].y - expectedVertices[i].y) <= maxError.y );
+					CPPUNIT_ASSERT( fabs(vertices[i].z - expectedVertices[i].z) <= maxError.z );
+
+					Vec3f expectedNormal = expectedNormals[i];
+					Vec3f normal = normals[i];
+					expectedNormal.normalize();
+					normal.normalize();
+					CPPUNIT_ASSERT( expectedNormal.dot(normal) >= minNormalCos );
+				}
+			}
+		}
+	}
+
 };
 
 
@@ -0,0 +1,195 @@
+// ==============================================================
+//	This file is part of ZetaGlest Unit Tests
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <map>
+#include <cstring>
+#include <cstdio>
+#include <vector>
+#include "texture_decoder.h"
+#include "ImageReaders.h"
+#include "platform_util.h"
+#include "conversion.h"
+
+using namespace Shared::Graphics;
+using namespace Shared::Util;
+using namespace Shared::PlatformCommon;
+
+//
+// Tests for the texture decoder, no GL context is needed
+//
+class TextureDecoderTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( TextureDecoderTest );
+
+	CPPUNIT_TEST( test_decode_all_jobs );
+	CPPUNIT_TEST( test_decode_missing_file );
+	CPPUNIT_TEST( test_pixmap_cache );
+	CPPUNIT_TEST( test_load_time );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_decode_all_jobs() {
+		const int fileCount = 6;
+		std::map<string,int> expectedWidths;
+		for(int i = 0; i < fileCount; ++i) {
+			Pixmap2D pixmap(4 + i, 2, 4);
+			uint8 pixel[4] = { (uint8)(i * 10), 0, 0, 255 };
+			for(int x = 0; x < pixmap.getW(); ++x) {
+				for(int y = 0; y < pixmap.getH(); ++y) {
+					pixmap.setPixel(x, y, pixel, 4);
+				}
+			}
+			string file = "texture_decoder_test_" + intToStr(i) + ".tga";
+			pixmap.saveTga(file);
+			expectedWidths[file] = pixmap.getW();
+		}
+
+		// a queue depth of one makes the decode threads wait on the consumer
+		TextureDecoder decoder(2, 1);
+		for(std::map<string,int>::iterator iterMap = expectedWidths.begin();
+			iterMap != expectedWidths.end(); ++iterMap) {
+			decoder.queueDecode(iterMap->first, 4, NULL);
+		}
+
+		int decodedCount = 0;
+		for(;decoder.getOutstandingCount() > 0;) {
+			TextureDecodeJob job;
+			if(decoder.getDecoded(job, 100) == false) {
+				continue;
+			}
+			CPPUNIT_ASSERT_EQUAL( string(""), job.error );
+			CPPUNIT_ASSERT_EQUAL( expectedWidths[job.path], job.pixmap->getW() );
+			CPPUNIT_ASSERT_EQUAL( 2, job.pixmap->getH() );
+			CPPUNIT_ASSERT_EQUAL( job.path, job.pixmap->getPath() );
+			delete job.pixmap;
+			decodedCount++;
+		}
+		CPPUNIT_ASSERT_EQUAL( fileCount, decodedCount );
+		CPPUNIT_ASSERT_EQUAL( fileCount, decoder.getDecodedCount() );
+
+		for(std::map<string,int>::iterator iterMap = expectedWidths.begin();
+			iterMap != expectedWidths.end(); ++iterMap) {
+			removeFile(iterMap->first);
+		}
+	}
+
+	void test_decode_missing_file() {
+		TextureDecoder decoder(1);
+		decoder.queueDecode("texture_decoder_test_missing.tga", 4, NULL);
+
+		TextureDecodeJob job;
+		for(;decoder.getDecoded(job, 100) == false;) {
+		}
+		CPPUNIT_ASSERT( job.error != "" );
+		CPPUNIT_ASSERT_EQUAL( 0, decoder.getOutstandingCount() );
+		delete job.pixmap;
+	}
+
+	void test_pixmap_cache() {
+		const string file = "texture_decoder_test_cache.png";
+		Pixmap2D source(5, 3, 4);
+		for(int x = 0; x < source.getW(); ++x) {
+			for(int y = 0; y < source.getH(); ++y) {
+				uint8 pixel[4] = { (uint8)(x * 40), (uint8)(y * 80), 7, 255 };
+				source.setPixel(x, y, pixel, 4);
+			}
+		}
+		source.savePng(file);
+
+		Pixmap2DCache::setCachePath("");
+		Pixmap2D decoded(4);
+		decoded.load(file);
+
+		// the first load decodes the png and writes the cache entry
+		Pixmap2DCache::setCachePath("./");
+		string cacheFile = Pixmap2DCache::getCacheFileName(file, 4);
+		removeFile(cacheFile);
+		Pixmap2D first(4);
+		first.load(file);
+		CPPUNIT_ASSERT( fileExists(cacheFile) );
+
+		// a cache hit must give the same pixels as decoding the png
+		Pixmap2D cached(4);
+		CPPUNIT_ASSERT( Pixmap2DCache::load(file, &cached) );
+		CPPUNIT_ASSERT_EQUAL( decoded.getW(), cached.getW() );
+		CPPUNIT_ASSERT_EQUAL( decoded.getH(), cached.getH() );
+		CPPUNIT_ASSERT_EQUAL( decoded.getComponents(), cached.getComponents() );
+		CPPUNIT_ASSERT( memcmp(decoded.getPixels(), cached.getPixels(), decoded.getPixelByteCount()) == 0 );
+
+		Pixmap2DCache::setCachePath("");
+		removeFile(cacheFile);
+		removeFile(file);
+	}
+
+	// times loading a batch of png files on the calling thread against the
+	// decoder with a few thread counts and prints the results
+	void test_load_time() {
+		const int fileCount = 24;
+		const int size = 256;
+		Pixmap2DCache::setCachePath("");
+
+		vector<string> files;
+		for(int i = 0; i < fileCount; ++i) {
+			Pixmap2D pixmap(size, size, 4);
+			for(int x = 0; x < size; ++x) {
+				for(int y = 0; y < size; ++y) {
+					uint8 pixel[4] = { (uint8)(x ^ y ^ i), (uint8)(x * 3 + i), (uint8)(y * 5), 255 };
+					pixmap.setPixel(x, y, pixel, 4);
+				}
+			}
+			string file = "texture_decoder_test_load_" + intToStr(i) + ".png";
+			pixmap.savePng(file);
+			files.push_back(file);
+		}
+
+		Chrono chrono;
+		chrono.start();
+		for(int i = 0; i < fileCount; ++i) {
+			Pixmap2D pixmap(4);
+			pixmap.load(files[i]);
+			CPPUNIT_ASSERT_EQUAL( size, pixmap.getW() );
+		}
+		printf("\nloading %d %dx%d png textures on the calling thread took %lld msecs\n",fileCount,size,size,(long long int)chrono.getMillis());
+
+		const int threadCounts[] = { 1, 2, 4 };
+		for(int t = 0; t < 3; ++t) {
+			chrono.start();
+			TextureDecoder decoder(threadCounts[t]);
+			for(int i = 0; i < fileCount; ++i) {
+				decoder.queueDecode(files[i], 4, NULL);
+			}
+
+			int decodedCount = 0;
+			for(;decoder.getOutstandingCount() > 0;) {
+				TextureDecodeJob job;
+				if(decoder.getDecoded(job, 100) == false) {
+					continue;
+				}
+				CPPUNIT_ASSERT_EQUAL( string(""), job.error );
+				CPPUNIT_ASSERT_EQUAL( size, job.pixmap->getW() );
+				delete job.pixmap;
+				decodedCount++;
+			}
+			CPPUNIT_ASSERT_EQUAL( fileCount, decodedCount );
+			printf("loading %d %dx%d png textures on %d decode threads took %lld msecs\n",fileCount,size,size,threadCounts[t],(long long int)chrono.getMillis());
+		}
+
+		for(int i = 0; i < fileCount; ++i) {
+			removeFile(files[i]);
+		}
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( TextureDecoderTest );
+//
@@ -0,0 +1,143 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#ifdef WIN32
+  #include <winsock2.h>
+  #include <winsock.h>
+#endif
+
+#include "unit_draw_list.h"
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace Shared::Graphics;
+using namespace Glest::Game;
+
+//
+// Tests for the unit draw list sorting and transforms. Gathering reads live
+// game units so it is not covered here, the draw list itself never calls
+// the model renderer.
+//
+class UnitDrawListTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( UnitDrawListTest );
+
+	CPPUNIT_TEST( test_SortOrder );
+	CPPUNIT_TEST( test_Transforms );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+	UnitDrawItem newItem(int visibleIndex, Model *model, float animProgress, const Texture *teamTexture, float fadeAlpha) {
+		UnitDrawItem item;
+		item.unit = NULL;
+		item.visibleIndex = visibleIndex;
+		item.model = model;
+		item.teamTexture = teamTexture;
+		item.animProgress = animProgress;
+		item.animCycle = true;
+		item.airUnit = false;
+		item.mobile = true;
+		item.alive = true;
+		item.fadeAlpha = fadeAlpha;
+		return item;
+	}
+
+	// column major matrix times point, as OpenGL applies it
+	Vec3f transform(const Matrix4f &matrix, const Vec3f &point) {
+		return Vec3f(
+			matrix[0] * point.x + matrix[4] * point.y + matrix[8] * point.z + matrix[12],
+			matrix[1] * point.x + matrix[5] * point.y + matrix[9] * point.z + matrix[13],
+			matrix[2] * point.x + matrix[6] * point.y + matrix[10] * point.z + matrix[14]);
+	}
+
+	void assertNear(const Vec3f &expected, const Vec3f &actual) {
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( expected.x, actual.x, 0.0001 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( expected.y, actual.y, 0.0001 );
+		CPPUNIT_ASSERT_DOUBLES_EQUAL( expected.z, actual.z, 0.0001 );
+	}
+
+public:
+
+	void test_SortOrder() {
+		// The items are only compared by address, nothing is drawn
+		char models[2];
+		char textures[2];
+		Model *modelA = reinterpret_cast<Model *>(&models[0]);
+		Model *modelB = reinterpret_cast<Model *>(&models[1]);
+		const Texture *teamA = reinterpret_cast<const Texture *>(&textures[0]);
+		const Texture *teamB = reinterpret_cast<const Texture *>(&textures[1]);
+
+		vector<UnitDrawItem> items;
+		items.push_back(newItem(0, modelB, 0.5f, teamA, -1.f));
+		items.push_back(newItem(1, modelA, 0.5f, teamB, 0.3f));
+		items.push_back(newItem(2, modelA, 0.5f, teamB, -1.f));
+		items.push_back(newItem(3, modelA, 0.2f, teamA, -1.f));
+		items.push_back(newItem(4, modelA, 0.5f, teamA, -1.f));
+		items.push_back(newItem(5, modelB, 0.5f, teamA, -1.f));
+
+		vector<int> sorted;
+		for(int i = 0; i < (int)items.size(); ++i) {
+			sorted.push_back(i);
+		}
+		std::sort(sorted.begin(), sorted.end(), UnitDrawItemCompare(&items));
+
+		// model, then pose, then team texture, then the visible order and
+		// the fading unit last
+		int expected[] = { 3, 4, 2, 0, 5, 1 };
+		for(int i = 0; i < (int)items.size(); ++i) {
+			CPPUNIT_ASSERT_EQUAL( expected[i], sorted[i] );
+		}
+	}
+
+	void test_Transforms() {
+		Matrix4f worldMatrix;
+		Matrix4f headingMatrix;
+		Vec3f pos(10.f, 2.f, -4.f);
+
+		UnitDrawList::computeMatrices(pos, 0.f, 0.f, 0.f, worldMatrix, headingMatrix);
+		assertNear(pos, transform(worldMatrix, Vec3f(0.f, 0.f, 0.f)));
+		assertNear(Vec3f(11.f, 3.f, -3.f), transform(worldMatrix, Vec3f(1.f, 1.f, 1.f)));
+
+		// glRotatef(90, 0, 1, 0) turns +x into -z
+		UnitDrawList::computeMatrices(pos, 0.f, 0.f, 90.f, worldMatrix, headingMatrix);
+		assertNear(Vec3f(10.f, 2.f, -5.f), transform(headingMatrix, Vec3f(1.f, 0.f, 0.f)));
+		assertNear(Vec3f(10.f, 2.f, -5.f), transform(worldMatrix, Vec3f(1.f, 0.f, 0.f)));
+
+		// the ground tilt is only in the world matrix, x then z turn +y
+		UnitDrawList::computeMatrices(pos, 0.f, 90.f, 0.f, worldMatrix, headingMatrix);
+		assertNear(Vec3f(10.f, 2.f, -3.f), transform(worldMatrix, Vec3f(0.f, 1.f, 0.f)));
+		assertNear(Vec3f(10.f, 3.f, -4.f), transform(headingMatrix, Vec3f(0.f, 1.f, 0.f)));
+
+		UnitDrawList::computeMatrices(pos, 90.f, 0.f, 0.f, worldMatrix, headingMatrix);
+		assertNear(Vec3f(10.f, 3.f, -4.f), transform(worldMatrix, Vec3f(1.f, 0.f, 0.f)));
+		assertNear(Vec3f(11.f, 2.f, -4.f), transform(headingMatrix, Vec3f(1.f, 0.f, 0.f)));
+
+		// rotations apply in the order z, x, y to the model like the old
+		// glRotatef calls: y first on the point, then x, then z
+		UnitDrawList::computeMatrices(pos, 90.f, 90.f, 90.f, worldMatrix, headingMatrix);
+		// +x -> y turns it to -z -> x tilts -z to +y -> z turns +y to -x
+		assertNear(Vec3f(9.f, 2.f, -4.f), transform(worldMatrix, Vec3f(1.f, 0.f, 0.f)));
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( UnitDrawListTest );
+//
@@ -0,0 +1,214 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "lua_script.h"
+#include <string>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace Shared::Lua;
+
+//
+// Tests for the cached references of the script handlers: assigning a
+// handler at runtime must call the new function from then on. And for the
+// saved globals
+//
+class LuaScriptTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( LuaScriptTest );
+
+	CPPUNIT_TEST( test_Reassigned );
+	CPPUNIT_TEST( test_ReassignedByItself );
+	CPPUNIT_TEST( test_DefinedLater );
+	CPPUNIT_TEST( test_OtherGlobals );
+	CPPUNIT_TEST( test_Sandbox );
+	CPPUNIT_TEST( test_SaveSharedTables );
+	CPPUNIT_TEST( test_SaveTrackedTables );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+	static void call(LuaScript &script, const std::string &functionName) {
+		script.beginCall(functionName);
+		script.endCall();
+	}
+
+	// whether the lua expression is true in the script
+	static bool check(LuaScript &script, const std::string &expression) {
+		return script.runCode("if not (" + expression + ") then error('failed') end") == 0;
+	}
+
+	// saves the globals of script and loads them into loaded
+	static void saveAndLoad(LuaScript &script, LuaScript &loaded) {
+		XmlNode rootNode("ScriptManager");
+		script.saveGame(&rootNode);
+		loaded.loadGame(&rootNode);
+	}
+
+public:
+
+	void test_Reassigned() {
+		LuaScript script;
+		script.loadCode("calls = 0 function onEvent() calls = calls + 1 end", "test");
+		call(script, "onEvent");
+		CPPUNIT_ASSERT( check(script, "calls == 1") );
+
+		// the handler is still a global for the scripts
+		CPPUNIT_ASSERT( check(script, "type(onEvent) == 'function'") );
+
+		CPPUNIT_ASSERT_EQUAL( 0, script.runCode("function onEvent() calls = calls + 10 end") );
+		call(script, "onEvent");
+		CPPUNIT_ASSERT( check(script, "calls == 11") );
+
+		CPPUNIT_ASSERT_EQUAL( 0, script.runCode("onEvent = nil") );
+		CPPUNIT_ASSERT_EQUAL( false, script.hasFunction("onEvent") );
+		call(script, "onEvent");
+		CPPUNIT_ASSERT( check(script, "calls == 11") );
+
+		CPPUNIT_ASSERT_EQUAL( 0, script.runCode("onEvent = function() calls = calls + 100 end") );
+		CPPUNIT_ASSERT_EQUAL( true, script.hasFunction("onEvent") );
+		call(script, "onEvent");
+		CPPUNIT_ASSERT( check(script, "calls == 111") );
+
+		// the timing counters survive the reassignments
+		CPPUNIT_ASSERT_EQUAL( (int64)3, script.getFunctionStats()["onEvent"].callCount );
+	}
+
+	void test_ReassignedByItself() {
+		LuaScript script;
+		script.loadCode("calls = 0 "
+						"function onEvent() "
+						"  calls = calls + 1 "
+						"  onEvent = function() calls = calls + 100 end "
+						"end", "test");
+		call(script, "onEvent");
+		call(script, "onEvent");
+		CPPUNIT_ASSERT( check(script, "calls == 101") );
+	}
+
+	void test_DefinedLater() {
+		LuaScript script;
+		script.loadCode("calls = 0", "test");
+		CPPUNIT_ASSERT_EQUAL( false, script.hasFunction("onLater") );
+		call(script, "onLater");
+
+		CPPUNIT_ASSERT_EQUAL( 0, script.runCode("function onLater() calls = calls + 1 end") );
+		CPPUNIT_ASSERT_EQUAL( true, script.hasFunction("onLater") );
+		call(script, "onLater");
+		CPPUNIT_ASSERT( check(script, "calls == 1") );
+
+		// a value that is not a function is not called
+		CPPUNIT_ASSERT_EQUAL( 0, script.runCode("onLater = 5") );
+		CPPUNIT_ASSERT_EQUAL( false, script.hasFunction("onLater") );
+		CPPUNIT_ASSERT( check(script, "onLater == 5") );
+		CPPUNIT_ASSERT_EQUAL( 0, script.runCode("onLater = function() calls = calls + 10 end") );
+		call(script, "onLater");
+		CPPUNIT_ASSERT( check(script, "calls == 11") );
+	}
+
+	void test_OtherGlobals() {
+		LuaScript script;
+		script.loadCode("x = 1 function onEvent() x = x + 1 end", "test");
+		call(script, "onEvent");
+		CPPUNIT_ASSERT_EQUAL( 0, script.runCode("x = x * 10 y = x") );
+		CPPUNIT_ASSERT( check(script, "x == 20 and y == 20") );
+		CPPUNIT_ASSERT_EQUAL( 0, script.runCode("y = nil") );
+		CPPUNIT_ASSERT( check(script, "y == nil") );
+	}
+
+	void test_Sandbox() {
+		LuaScript script;
+		script.setSandboxWrapperFunctionName("runSandboxed");
+		script.setSandboxCode("sandboxed");
+		script.loadCode("calls = 0 wrapped = 0 "
+						"function runSandboxed(code) "
+						"  wrapped = wrapped + 1 "
+						"  _G[string.match(code, '^(.-)%(%)$')]() "
+						"end "
+						"function onEvent() calls = calls + 1 end", "test");
+		call(script, "onEvent");
+		call(script, "onEvent");
+		CPPUNIT_ASSERT( check(script, "calls == 2 and wrapped == 2") );
+
+		CPPUNIT_ASSERT_EQUAL( 0, script.runCode("function onEvent() calls = calls + 10 end") );
+		call(script, "onEvent");
+		CPPUNIT_ASSERT( check(script, "calls == 12 and wrapped == 3") );
+	}
+
+	void test_SaveSharedTables() {
+		LuaScript script;
+		script.loadCode("a = { n = 1 } b = a c = { a, { a } } d = { a, print } e = { b } "
+						"cycle = { } cycle.self = cycle", "test");
+		LuaScript loaded;
+		saveAndLoad(script, loaded);
+
+		CPPUNIT_ASSERT( check(loaded, "a == b and c[1] == a and c[2][1] == a and e[1] == a") );
+		CPPUNIT_ASSERT( check(loaded, "a.n == 1 and cycle.self == cycle") );
+		// the global with a function is left out without breaking the others
+		CPPUNIT_ASSERT( check(loaded, "d == nil") );
+	}
+
+	void test_SaveTrackedTables() {
+		LuaScript script;
+		script.loadCode("log = { 'a' } other = { 1 } trackSaveChanges('log')", "test");
+		{
+			LuaScript loaded;
+			saveAndLoad(script, loaded);
+			CPPUNIT_ASSERT( check(loaded, "log[1] == 'a' and other[1] == 1") );
+		}
+
+		// a change the script did not mark keeps the bytes of the last
+		// save, which shows they were not written again
+		CPPUNIT_ASSERT_EQUAL( 0, script.runCode("log[2] = 'b' other[2] = 2") );
+		{
+			LuaScript loaded;
+			saveAndLoad(script, loaded);
+			CPPUNIT_ASSERT( check(loaded, "log[2] == nil and other[2] == 2") );
+		}
+
+		CPPUNIT_ASSERT_EQUAL( 0, script.runCode("markSaveChanged('log')") );
+		{
+			LuaScript loaded;
+			saveAndLoad(script, loaded);
+			CPPUNIT_ASSERT( check(loaded, "log[2] == 'b'") );
+		}
+
+		// a new table is always written
+		CPPUNIT_ASSERT_EQUAL( 0, script.runCode("log = { 'c' }") );
+		{
+			LuaScript loaded;
+			saveAndLoad(script, loaded);
+			CPPUNIT_ASSERT( check(loaded, "log[1] == 'c' and log[2] == nil") );
+		}
+
+		// a reused table referred to by another global is still shared
+		CPPUNIT_ASSERT_EQUAL( 0, script.runCode("markSaveChanged('log')") );
+		{
+			LuaScript loaded;
+			saveAndLoad(script, loaded);
+		}
+		CPPUNIT_ASSERT_EQUAL( 0, script.runCode("other = { log }") );
+		{
+			LuaScript loaded;
+			saveAndLoad(script, loaded);
+			CPPUNIT_ASSERT( check(loaded, "other[1] == log and log[1] == 'c'") );
+		}
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( LuaScriptTest );
+//
@@ -0,0 +1,343 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "lua_value_io.h"
+#include "platform_util.h"
+#include <string>
+#include <vector>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace Shared::Lua;
+using namespace Shared::Platform;
+
+//
+// Tests for the binary lua save format: values are written from one lua
+// state and read back into another one
+//
+class LuaValueIOTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( LuaValueIOTest );
+
+	CPPUNIT_TEST( test_Nesting );
+	CPPUNIT_TEST( test_SharedTables );
+	CPPUNIT_TEST( test_Cycles );
+	CPPUNIT_TEST( test_SharedBetweenValues );
+	CPPUNIT_TEST( test_Rollback );
+	CPPUNIT_TEST( test_Segments );
+	CPPUNIT_TEST( test_NegativeZero );
+	CPPUNIT_TEST( test_Numbers );
+	CPPUNIT_TEST( test_UnsupportedValues );
+	CPPUNIT_TEST( test_BadData );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+	lua_State *source;
+	lua_State *target;
+
+	// runs code returning one value in the source state and writes it
+	std::string write(const char *code) {
+		CPPUNIT_ASSERT_EQUAL( 0, luaL_dostring(source, code) );
+
+		std::string data;
+		LuaValueWriter writer(source, &data);
+		CPPUNIT_ASSERT_EQUAL( true, writer.writeValue(-1) );
+		lua_settop(source, 0);
+		return data;
+	}
+
+	// reads the value into the target state as the global r
+	void read(const std::string &data) {
+		LuaValueReader reader(target, data);
+		reader.readValue();
+		CPPUNIT_ASSERT_EQUAL( true, reader.atEnd() );
+		CPPUNIT_ASSERT_EQUAL( 1, lua_gettop(target) );
+		lua_setglobal(target, "r");
+	}
+
+	bool check(const char *condition) {
+		std::string code = std::string("return ") + condition;
+		CPPUNIT_ASSERT_EQUAL( 0, luaL_dostring(target, code.c_str()) );
+		bool result = (lua_toboolean(target, -1) != 0);
+		lua_settop(target, 0);
+		return result;
+	}
+
+public:
+
+	void setUp() {
+		source = luaL_newstate();
+		luaL_openlibs(source);
+		target = luaL_newstate();
+		luaL_openlibs(target);
+	}
+
+	void tearDown() {
+		lua_close(source);
+		lua_close(target);
+	}
+
+	void test_Nesting() {
+		read(write("return { a = { b = { c = { 1, 2, 3 } } }, s = 'x\\0y', f = false, t = true, [5] = 'five' }"));
+
+		CPPUNIT_ASSERT( check("#r.a.b.c == 3 and r.a.b.c[1] == 1 and r.a.b.c[3] == 3") );
+		CPPUNIT_ASSERT( check("r.s == 'x\\0y' and #r.s == 3") );
+		CPPUNIT_ASSERT( check("r.f == false and r.t == true and r[5] == 'five'") );
+
+		// 127 tables below the top level one still fit
+		std::string nested = "local t = {} for i = 1, 127 do t = { t } end return t";
+		read(write(nested.c_str()));
+		CPPUNIT_ASSERT( check("(function() local t, n = r, 0 while t[1] do t = t[1] n = n + 1 end return n == 127 end)()") );
+
+		CPPUNIT_ASSERT_EQUAL( 0, luaL_dostring(source, "local t = {} for i = 1, 128 do t = { t } end return t") );
+		std::string data;
+		LuaValueWriter writer(source, &data);
+		CPPUNIT_ASSERT_EQUAL( false, writer.writeValue(-1) );
+		lua_settop(source, 0);
+	}
+
+	void test_SharedTables() {
+		std::string data = write("local s = { n = 1 } return { x = s, y = { s }, z = { s } }");
+		read(data);
+
+		CPPUNIT_ASSERT( check("r.x == r.y[1] and r.x == r.z[1] and r.x.n == 1") );
+		CPPUNIT_ASSERT( check("r.y ~= r.z") );
+
+		// the shared table is written once
+		int tableCount = 0;
+		int refCount = 0;
+		for(size_t i = 0; i < data.size(); ++i) {
+			if((unsigned char)data[i] == lstTable) {
+				tableCount++;
+			}
+			else if((unsigned char)data[i] == lstTableRef) {
+				refCount++;
+			}
+		}
+		CPPUNIT_ASSERT_EQUAL( 4, tableCount );
+		CPPUNIT_ASSERT_EQUAL( 2, refCount );
+	}
+
+	void test_Cycles() {
+		read(write("local t = { name = 'root' } t.self = t t.child = { parent = t } t.child.child = t.child return t"));
+
+		CPPUNIT_ASSERT( check("r.self == r and r.child.parent == r") );
+		CPPUNIT_ASSERT( check("r.child.child == r.child and r.self.self.name == 'root'") );
+
+		// a table used as a key is restored as the same table
+		read(write("local k = {} return { [k] = k }"));
+		CPPUNIT_ASSERT( check("(function() local key, value = next(r) return key == value and next(r, key) == nil end)()") );
+	}
+
+	void test_SharedBetweenValues() {
+		CPPUNIT_ASSERT_EQUAL( 0, luaL_dostring(source, "a = { n = 1 } b = a c = { a, { a } } return a, b, c") );
+		std::string data;
+		LuaValueWriter writer(source, &data);
+		for(int i = 1; i <= 3; ++i) {
+			CPPUNIT_ASSERT_EQUAL( true, writer.writeValue(i) );
+		}
+		lua_settop(source, 0);
+
+		LuaValueReader reader(target, data);
+		const char *names[] = { "a", "b", "c" };
+		for(int i = 0; i < 3; ++i) {
+			reader.readValue();
+			lua_setglobal(target, names[i]);
+		}
+		CPPUNIT_ASSERT_EQUAL( true, reader.atEnd() );
+		CPPUNIT_ASSERT( check("a == b and c[1] == a and c[2][1] == a and a.n == 1") );
+
+		// saves made before the shared ids count them per value from 0
+		std::string oldData;
+		oldData.push_back((char)lstTable);
+		oldData.push_back((char)lstEnd);
+		oldData.push_back((char)lstTable);
+		oldData.push_back((char)lstInteger);
+		oldData.push_back((char)2);
+		oldData.push_back((char)lstTableRef);
+		oldData.push_back((char)0);
+		oldData.push_back((char)lstEnd);
+		LuaValueReader oldReader(target, oldData, 1);
+		oldReader.readValue();
+		lua_setglobal(target, "x");
+		oldReader.readValue();
+		lua_setglobal(target, "y");
+		CPPUNIT_ASSERT( check("y[1] == y and y[1] ~= x") );
+	}
+
+	void test_Rollback() {
+		CPPUNIT_ASSERT_EQUAL( 0, luaL_dostring(source, "s = { n = 1 } return { s }, { s, { 2 }, print }, { { 3 }, s }") );
+		std::string data;
+		LuaValueWriter writer(source, &data);
+		CPPUNIT_ASSERT_EQUAL( true, writer.writeValue(1) );
+		size_t size = data.size();
+
+		// the failed value leaves neither bytes nor table ids behind
+		writer.beginSegment();
+		CPPUNIT_ASSERT_EQUAL( false, writer.writeValue(2) );
+		writer.rollbackSegment();
+		CPPUNIT_ASSERT_EQUAL( size, data.size() );
+
+		writer.beginSegment();
+		CPPUNIT_ASSERT_EQUAL( true, writer.writeValue(3) );
+		CPPUNIT_ASSERT_EQUAL( false, writer.isSegmentSelfContained() );
+		lua_settop(source, 0);
+
+		LuaValueReader reader(target, data);
+		reader.readValue();
+		lua_setglobal(target, "a");
+		reader.readValue();
+		lua_setglobal(target, "b");
+		CPPUNIT_ASSERT_EQUAL( true, reader.atEnd() );
+		CPPUNIT_ASSERT( check("b[2] == a[1] and a[1].n == 1 and b[1][1] == 3") );
+	}
+
+	void test_Segments() {
+		CPPUNIT_ASSERT_EQUAL( 0, luaL_dostring(source, "t = { x = { 1 } } t.y = t.x t.z = t return { 5 }, t") );
+
+		// a self contained value written after one table
+		std::string first;
+		LuaValueWriter firstWriter(source, &first);
+		CPPUNIT_ASSERT_EQUAL( true, firstWriter.writeValue(1) );
+		size_t firstSize = first.size();
+		firstWriter.beginSegment();
+		CPPUNIT_ASSERT_EQUAL( true, firstWriter.writeValue(2) );
+		CPPUNIT_ASSERT_EQUAL( true, firstWriter.isSegmentSelfContained() );
+		std::string segment = first.substr(firstSize);
+		std::vector<const void *> tables;
+		firstWriter.getSegmentTables(tables);
+		CPPUNIT_ASSERT_EQUAL( 2, (int)tables.size() );
+
+		// is reused as the first value of another save, values after it
+		// still refer to its tables
+		std::string second;
+		LuaValueWriter secondWriter(source, &second);
+		secondWriter.beginSegment();
+		CPPUNIT_ASSERT_EQUAL( true, secondWriter.appendSegment(segment, tables) );
+		CPPUNIT_ASSERT_EQUAL( false, secondWriter.appendSegment(segment, tables) );
+		lua_getglobal(source, "t");
+		lua_getfield(source, -1, "x");
+		secondWriter.beginSegment();
+		CPPUNIT_ASSERT_EQUAL( true, secondWriter.writeValue(-1) );
+		CPPUNIT_ASSERT_EQUAL( false, secondWriter.isSegmentSelfContained() );
+		lua_settop(source, 0);
+
+		LuaValueReader reader(target, second);
+		reader.readValue();
+		lua_setglobal(target, "t");
+		reader.readValue();
+		lua_setglobal(target, "x");
+		CPPUNIT_ASSERT_EQUAL( true, reader.atEnd() );
+		CPPUNIT_ASSERT( check("t.z == t and t.x == t.y and t.x == x and x[1] == 1") );
+	}
+
+	void test_NegativeZero() {
+		// computed at run time so the parser can not fold the sign away
+		std::string data = write("local zero = 0.0 return -zero");
+		CPPUNIT_ASSERT_EQUAL( (int)lstNumber, (int)(unsigned char)data[0] );
+		read(data);
+		CPPUNIT_ASSERT( check("r == 0 and 1 / r < 0") );
+
+		data = write("return 0");
+		CPPUNIT_ASSERT_EQUAL( (int)lstInteger, (int)(unsigned char)data[0] );
+		read(data);
+		CPPUNIT_ASSERT( check("r == 0 and 1 / r > 0") );
+	}
+
+	void test_Numbers() {
+		read(write("return { 0, 1, -1, 63, -64, 64, 2147483647, -2147483648, 9007199254740991, -9007199254740991 }"));
+		CPPUNIT_ASSERT( check("r[1] == 0 and r[2] == 1 and r[3] == -1 and r[4] == 63 and r[5] == -64 and r[6] == 64") );
+		CPPUNIT_ASSERT( check("r[7] == 2147483647 and r[8] == -2147483648") );
+		CPPUNIT_ASSERT( check("r[9] == 9007199254740991 and r[10] == -9007199254740991") );
+
+		read(write("return { 0.1, -2.5, 1e300, -1e-300, 1 / 0, -1 / 0 }"));
+		CPPUNIT_ASSERT( check("r[1] == 0.1 and r[2] == -2.5 and r[3] == 1e300 and r[4] == -1e-300") );
+		CPPUNIT_ASSERT( check("r[5] == 1 / 0 and r[6] == -1 / 0") );
+
+		// small whole numbers take a tag and one byte
+		CPPUNIT_ASSERT_EQUAL( 2, (int)write("return 63").size() );
+		CPPUNIT_ASSERT_EQUAL( 9, (int)write("return 0.5").size() );
+
+#if LUA_VERSION_NUM > 502
+		// integers and floats keep their subtype
+		read(write("return { 3, 3.0, math.maxinteger, math.mininteger }"));
+		CPPUNIT_ASSERT( check("math.type(r[1]) == 'integer' and math.type(r[2]) == 'float'") );
+		CPPUNIT_ASSERT( check("r[3] == math.maxinteger and r[4] == math.mininteger") );
+#endif
+	}
+
+	void test_UnsupportedValues() {
+		const char *codes[] = {
+			"return print",
+			"return { f = print }",
+			"return { [print] = 1 }",
+			"return coroutine.create(function() end)"
+		};
+		for(int i = 0; i < 4; ++i) {
+			CPPUNIT_ASSERT_EQUAL( 0, luaL_dostring(source, codes[i]) );
+			std::string data;
+			LuaValueWriter writer(source, &data);
+			CPPUNIT_ASSERT_EQUAL( false, writer.writeValue(-1) );
+			// the writer leaves the stack as it found it
+			CPPUNIT_ASSERT_EQUAL( 1, lua_gettop(source) );
+			lua_settop(source, 0);
+		}
+	}
+
+	void test_BadData() {
+		std::string data = write("return { a = { 1, 2 }, b = 'text' }");
+
+		// every cut of a valid value is rejected without leaving values
+		// behind once the caller resets the stack
+		for(size_t size = 0; size < data.size(); ++size) {
+			std::string cut = data.substr(0, size);
+			bool thrown = false;
+			try {
+				LuaValueReader reader(target, cut);
+				reader.readValue();
+			}
+			catch(const megaglest_runtime_error &) {
+				thrown = true;
+			}
+			CPPUNIT_ASSERT_EQUAL( true, thrown );
+			lua_settop(target, 0);
+		}
+
+		// a reference to a table not read yet, an end marker and an
+		// unknown tag where a value is expected
+		std::vector<std::string> badValues;
+		badValues.push_back(std::string(1, (char)lstTableRef) + std::string(1, '\0'));
+		badValues.push_back(std::string(1, (char)lstEnd));
+		badValues.push_back(std::string(1, (char)0x7F));
+		for(size_t i = 0; i < badValues.size(); ++i) {
+			bool thrown = false;
+			try {
+				LuaValueReader reader(target, badValues[i]);
+				reader.readValue();
+			}
+			catch(const megaglest_runtime_error &) {
+				thrown = true;
+			}
+			CPPUNIT_ASSERT_EQUAL( true, thrown );
+			lua_settop(target, 0);
+		}
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( LuaValueIOTest );
+//
@@ -0,0 +1,107 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2013 Mark Vejvoda
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "map_preview.h"
+#include "randomgen.h"
+#include <vector>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace Shared::Map;
+using namespace Shared::Util;
+
+//
+// Tests for the map editor preview
+//
+class MapPreviewTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( MapPreviewTest );
+
+	CPPUNIT_TEST( test_SmoothSurface );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+	// the per cell 3x3 average smoothSurface() used before the column sums
+	static void oldSmoothSurface(std::vector<float> &heights, int w, int h, bool limitHeight) {
+		std::vector<float> oldHeights = heights;
+
+		for (int j = 1; j < h - 1; ++j) {
+			for (int i = 1; i < w - 1; ++i) {
+				float height = 0.f;
+				float numUsedToSmooth = 0.f;
+				for (int k = -1; k <= 1; ++k) {
+					for (int l = -1; l <= 1; ++l) {
+						int tmpHeight=oldHeights[(j + k) * w + (i + l)];
+						if(limitHeight && tmpHeight>20){
+							tmpHeight=20;
+						}
+						if(limitHeight && tmpHeight<0){
+							tmpHeight=0;
+						}
+						height += tmpHeight;
+						numUsedToSmooth++;
+					}
+				}
+				height /= numUsedToSmooth;
+				heights[j * w + i]=height;
+			}
+		}
+	}
+
+public:
+
+	void test_SmoothSurface() {
+		const int w = 37;
+		const int h = 29;
+
+		for(int pass = 0; pass < 2; ++pass) {
+			bool limitHeight = (pass == 0);
+
+			RandomGen random;
+			random.init(1234 + pass);
+
+			// heights outside the limits and with fractions check the
+			// clamping and the truncation to int
+			MapPreview map;
+			map.reset(w, h, 10.f, st_Grass);
+			std::vector<float> expected(w * h);
+			for(int y = 0; y < h; ++y) {
+				for(int x = 0; x < w; ++x) {
+					float height = random.randRange(-8.f, 32.f);
+					map.setHeight(x, y, height);
+					expected[y * w + x] = height;
+				}
+			}
+
+			// smoothing twice also compares the results of a smoothed map
+			for(int round = 0; round < 2; ++round) {
+				map.smoothSurface(limitHeight);
+				oldSmoothSurface(expected, w, h, limitHeight);
+
+				for(int y = 0; y < h; ++y) {
+					for(int x = 0; x < w; ++x) {
+						CPPUNIT_ASSERT_EQUAL( expected[y * w + x], map.getHeight(x, y) );
+					}
+				}
+			}
+		}
+	}
+};
+
+// Test Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( MapPreviewTest );
+//
@@ -11,6 +11,7 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 #include "util.h"
+#include "conversion.h"
 #include <memory>
 #include <vector>
 #include <algorithm>
@@ -36,6 +37,7 @@ class UtilTest : public CppUnit::TestFixture {
 	CPPUNIT_TEST( test_checkVersionComptability_2_digit_versions );
 	CPPUNIT_TEST( test_checkVersionComptability_3_digit_versions );
 	CPPUNIT_TEST( test_checkVersionComptability_mixed_digit_versions );
+	CPPUNIT_TEST( test_base64 );
 
 	CPPUNIT_TEST_SUITE_END();
 	// End of Fixture registration
@@ -191,6 +193,27 @@ public:
 		SystemFlags::VERBOSE_MODE_ENABLED = false;
 	}
 
+	void test_base64() {
+		CPPUNIT_ASSERT_EQUAL( string(""), base64Encode("") );
+		CPPUNIT_ASSERT_EQUAL( string("Zg=="), base64Encode("f") );
+		CPPUNIT_ASSERT_EQUAL( string("Zm8="), base64Encode("fo") );
+		CPPUNIT_ASSERT_EQUAL( string("Zm9vYmFy"), base64Encode("foobar") );
+
+		string binary;
+		for(int i = 0; i < 256; ++i) {
+			binary += (char)i;
+		}
+		string decoded;
+		CPPUNIT_ASSERT_EQUAL( true, base64Decode(base64Encode(binary), decoded) );
+		CPPUNIT_ASSERT( decoded == binary );
+
+		CPPUNIT_ASSERT_EQUAL( true, base64Decode("Zm8=", decoded) );
+		CPPUNIT_ASSERT_EQUAL( string("fo"), decoded );
+		CPPUNIT_ASSERT_EQUAL( false, base64Decode("Zm8", decoded) );
+		CPPUNIT_ASSERT_EQUAL( false, base64Decode("Z=8=", decoded) );
+		CPPUNIT_ASSERT_EQUAL( false, base64Decode("Zm8*", decoded) );
+	}
+
 };
 
 
@@ -335,6 +335,7 @@ class XmlNodeTest : public CppUnit::TestFixture {
 	CPPUNIT_TEST( test_valid_named_node );
 	CPPUNIT_TEST( test_child_nodes );
 	CPPUNIT_TEST( test_node_attributes );
+	CPPUNIT_TEST( test_large_child_list_and_tags );
 
 	CPPUNIT_TEST_SUITE_END();
 	// End of Fixture registration
@@ -471,6 +472,32 @@ public:
 		CPPUNIT_ASSERT_EQUAL( true, node.hasAttribute("some-attribute") );
 	}
 
+	void test_large_child_list_and_tags() {
+		const string test_filename = "xml_test_large.xml";
+		std::ofstream xmlFile(test_filename.c_str());
+		xmlFile << "<?xml version=\"1.0\"?>" << std::endl << "<units>" << std::endl;
+		for(int i = 0; i < 40; ++i) {
+			xmlFile << "<unit id=\"" << i << "\" path=\"{TESTTAG}/unit\"/>" << std::endl;
+			xmlFile << "<upgrade id=\"" << i << "\"/>" << std::endl;
+		}
+		xmlFile << "</units>" << std::endl;
+		xmlFile.close();
+		SafeRemoveTestFile deleteFile(test_filename);
+
+		std::map<string,string> mapTagReplacementValues;
+		mapTagReplacementValues["{TESTTAG}"] = "replaced";
+		XmlTree xmlTree(XML_RAPIDXML_ENGINE);
+		xmlTree.load(test_filename, mapTagReplacementValues);
+		const XmlNode *rootNode = xmlTree.getRootNode();
+
+		CPPUNIT_ASSERT_EQUAL( (size_t)80, rootNode->getChildCount() );
+		CPPUNIT_ASSERT_EQUAL( 30, rootNode->getChild("unit",30)->getAttribute("id")->getIntValue() );
+		CPPUNIT_ASSERT_EQUAL( 39, rootNode->getChild("upgrade",39)->getAttribute("id")->getIntValue() );
+		CPPUNIT_ASSERT_EQUAL( false, rootNode->hasChildAtIndex("unit",40) );
+		CPPUNIT_ASSERT_EQUAL( false, rootNode->hasChild("missing") );
+		CPPUNIT_ASSERT_EQUAL( string("replaced/unit"), rootNode->getChild("unit",5)->getAttribute("path")->getValue() );
+	}
+
 };
 
 #if defined(WANT_XERCES)